@@ -13,6 +13,11 @@
 #include <Tudat/Astrodynamics/Aerodynamics/UnitTests/testApolloCapsuleCoefficients.h>
 
 #include "propagationAndOptimization/applicationOutput.h"
+#include "propagationAndOptimization/campaignArchive.h"
+#include "propagationAndOptimization/ephemerisTabulationCache.h"
+#include "propagationAndOptimization/hermiteDenseOutput.h"
+#include "propagationAndOptimization/spiceKernelPool.h"
+#include "propagationAndOptimization/sweepJournal.h"
 
 
 //! Execute propagation of orbits of Apollo during entry.
@@ -43,7 +48,7 @@ int main( )
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
     // Load Spice kernels.
-    spice_interface::loadStandardSpiceKernels( );
+    tudat_applications::loadSpiceKernelSet( tudat_applications::standard_spice_kernels );
 
     // Set simulation start epoch.
     const double simulationStartEpoch = 0.0;
@@ -67,7 +72,7 @@ int main( )
     bodySettings[ "Earth" ]->rotationModelSettings->resetOriginalFrame( "J2000" );
 
     // Create Earth object
-    simulation_setup::NamedBodyMap bodyMap = simulation_setup::createBodies( bodySettings );
+    simulation_setup::NamedBodyMap bodyMap = tudat_applications::createBodiesWithCachedEphemerides( bodySettings );
 
     // Create vehicle objects.
     bodyMap[ "Apollo" ] = std::make_shared< simulation_setup::Body >( );
@@ -87,6 +92,14 @@ int main( )
 
     double angleStep = mathematical_constants::PI / 10.0;
 
+    // Create single archive for output of all cases (entry keys are equal to the former file names, without extension),
+    // and journal of completed cases. When resuming an interrupted run (TUDAT_APPLICATION_RESUME set), completed cases are
+    // skipped, and the output of the remaining cases is appended to the existing archive.
+    const bool resumeSweep = tudat_applications::getSweepResumeSetting( );
+    tudat_applications::CampaignArchiveWriter campaignArchive(
+                "reEntrySphericalHarmonicCases.tca", outputPath, resumeSweep );
+    tudat_applications::SweepJournal sweepJournal( "reEntrySphericalHarmonicCases.journal", outputPath, resumeSweep );
+
     for( unsigned int simulationCase = 0; simulationCase < 1; simulationCase++ )
     {
         int latitudeCase = 0;
@@ -103,6 +116,18 @@ int main( )
                 for( double initialHeadingAngle = 0.0; initialHeadingAngle <= mathematical_constants::PI / 2.0 + 0.001;
                      initialHeadingAngle += mathematical_constants::PI / 4.0 )
                 {
+                    // Define tag of current case, and skip case if it was completed before the run was interrupted.
+                    std::string caseTag =
+                            boost::lexical_cast< std::string >( latitudeCase ) + "_" +
+                            boost::lexical_cast< std::string >( longitudeCase ) + "_" +
+                            boost::lexical_cast< std::string >( headingCase ) + "_" +
+                            boost::lexical_cast< std::string >( simulationCase );
+                    if( sweepJournal.isCompleted( caseTag ) )
+                    {
+                        headingCase++;
+                        continue;
+                    }
+
                     std::cout<<std::setprecision( 16 )<<simulationCase<<" "<<initialLatitude<<" "<<initialLongitude<<" "<<initialHeadingAngle<<std::endl;
                     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
                     ///////////////////////             CREATE ACCELERATIONS            ///////////////////////////////////////////////////
@@ -244,75 +269,47 @@ int main( )
 
                     std::map< double, Eigen::VectorXd > stateHistoryInertialFrame =
                             dynamicsSimulator.getEquationsOfMotionNumericalSolution( );
-                    std::map< double, Eigen::VectorXd > stateHistoryEarthFixedFrame;
-
-                    for( std::map< double, Eigen::VectorXd >::const_iterator stateIterator = stateHistoryInertialFrame.begin( );
-                         stateIterator != stateHistoryInertialFrame.end( ); stateIterator++ )
-                    {
-                        stateHistoryEarthFixedFrame[ stateIterator->first ] =
-                                transformStateToTargetFrame(
-                                    Eigen::Vector6d( stateIterator->second ), stateIterator->first, earthRotationalEphemeris );
-                    }
-
-                    std::shared_ptr< interpolators::OneDimensionalInterpolator< double, Eigen::VectorXd > > inertialInterpolator =
-                            std::make_shared< interpolators::LagrangeInterpolator< double, Eigen::VectorXd > >(
-                                stateHistoryInertialFrame, 8 );
-                    std::shared_ptr< interpolators::OneDimensionalInterpolator< double, Eigen::VectorXd > > bodyFixedInterpolator =
-                            std::make_shared< interpolators::LagrangeInterpolator< double, Eigen::VectorXd > >(
-                                stateHistoryEarthFixedFrame, 8 );
-
-
-                    std::map< double, Eigen::VectorXd > interpolatedStateHistoryInertialFrame;
-                    std::map< double, Eigen::VectorXd > interpolatedStateHistoryEarthFixedFrame;
 
+                    // Compute states at 1 s intervals by dense output of the inertial state, transforming each output
+                    // state to the body-fixed frame.
+                    std::vector< double > outputEpochs;
                     double currentTime = 0;
                     double endTime = stateHistoryInertialFrame.rbegin( )->first;
                     while( currentTime < endTime )
                     {
-                        interpolatedStateHistoryInertialFrame[ currentTime ] = inertialInterpolator->interpolate( currentTime );
-                        interpolatedStateHistoryEarthFixedFrame[ currentTime ] = bodyFixedInterpolator->interpolate( currentTime );
+                        outputEpochs.push_back( currentTime );
                         currentTime += 1.0;
                     }
 
+                    std::map< double, Eigen::VectorXd > interpolatedStateHistoryInertialFrame;
+                    std::map< double, Eigen::VectorXd > interpolatedStateHistoryEarthFixedFrame;
+                    std::shared_ptr< tudat_applications::FunctionStateHistorySink< > > outputSink =
+                            std::make_shared< tudat_applications::FunctionStateHistorySink< > >(
+                                [ & ]( const double outputTime, const Eigen::VectorXd& outputState )
+                    {
+                        interpolatedStateHistoryInertialFrame[ outputTime ] = outputState;
+                        interpolatedStateHistoryEarthFixedFrame[ outputTime ] = transformStateToTargetFrame(
+                                    Eigen::Vector6d( outputState ), outputTime, earthRotationalEphemeris );
+                    } );
+                    tudat_applications::processStateHistory< double, double >(
+                                stateHistoryInertialFrame,
+                                std::make_shared< tudat_applications::DenseOutputStateHistorySink< > >(
+                                    outputEpochs, outputSink ) );
+
                     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
                     ///////////////////////        PROVIDE OUTPUT TO FILE                        //////////////////////////////////////////
                     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 
                     // Write Apollo propagation history to file.
-                    writeDataMapToTextFile( interpolatedStateHistoryInertialFrame,
-                                            "stateReEntrySphericalHarmonicCases_" +
-                                            boost::lexical_cast< std::string >( latitudeCase ) + "_" +
-                                            boost::lexical_cast< std::string >( longitudeCase ) + "_" +
-                                            boost::lexical_cast< std::string >( headingCase ) + "_" +
-                                            boost::lexical_cast< std::string >( simulationCase ) +".dat",
-                                            outputPath,
-                                            "",
-                                            std::numeric_limits< double >::digits10,
-                                            std::numeric_limits< double >::digits10,
-                                            "," );
-                    writeDataMapToTextFile( interpolatedStateHistoryEarthFixedFrame,
-                                            "bodyFixedStateReEntrySphericalHarmonicCases_" +
-                                            boost::lexical_cast< std::string >( latitudeCase ) + "_" +
-                                            boost::lexical_cast< std::string >( longitudeCase ) + "_" +
-                                            boost::lexical_cast< std::string >( headingCase ) + "_" +
-                                            boost::lexical_cast< std::string >( simulationCase ) +".dat",
-                                            outputPath,
-                                            "",
-                                            std::numeric_limits< double >::digits10,
-                                            std::numeric_limits< double >::digits10,
-                                            "," );
-                    writeDataMapToTextFile( dynamicsSimulator.getDependentVariableHistory( ),
-                                            "dependentVariablesReEntrySphericalHarmonicCases_" +
-                                            boost::lexical_cast< std::string >( latitudeCase ) + "_" +
-                                            boost::lexical_cast< std::string >( longitudeCase ) + "_" +
-                                            boost::lexical_cast< std::string >( headingCase ) + "_" +
-                                            boost::lexical_cast< std::string >( simulationCase ) +".dat",
-                                            outputPath,
-                                            "",
-                                            std::numeric_limits< double >::digits10,
-                                            std::numeric_limits< double >::digits10,
-                                            "," );
+                    campaignArchive.addDataMap(
+                                interpolatedStateHistoryInertialFrame, "stateReEntrySphericalHarmonicCases_" + caseTag );
+                    campaignArchive.addDataMap(
+                                interpolatedStateHistoryEarthFixedFrame, "bodyFixedStateReEntrySphericalHarmonicCases_" + caseTag );
+                    campaignArchive.addDataMap(
+                                dynamicsSimulator.getDependentVariableHistory( ),
+                                "dependentVariablesReEntrySphericalHarmonicCases_" + caseTag );
+                    sweepJournal.markCompleted( caseTag );
                     headingCase++;
                 }
                 longitudeCase++;
@@ -320,6 +317,8 @@ int main( )
             latitudeCase++;
         }
     }
+    campaignArchive.finalize( );
+
     // Final statement.
     // The exit code EXIT_SUCCESS indicates that the program was successfully executed.
     return EXIT_SUCCESS;
@@ -13,6 +13,8 @@
 #include <Tudat/Astrodynamics/Ephemerides/tabulatedEphemeris.h>
 
 #include "propagationAndOptimization/applicationOutput.h"
+#include "propagationAndOptimization/ephemerisTabulationCache.h"
+#include "propagationAndOptimization/spiceKernelPool.h"
 
 
 //! Execute propagation of orbit of Asterix around the Earth.
@@ -43,11 +45,9 @@ int main()
     double simulationEndEpoch = physical_constants::JULIAN_YEAR / 12.0;
 
     // Load Spice kernels.
-    spice_interface::loadStandardSpiceKernels( );
+    tudat_applications::loadSpiceKernelSet( tudat_applications::standard_spice_kernels );
 
-    spice_interface::loadSpiceKernelInTudat( input_output::getSpiceKernelPath( ) + "moon_pa_de421_1900-2050.bpc" );
-    spice_interface::loadSpiceKernelInTudat( input_output::getSpiceKernelPath( ) + "moon_080317.tf" );
-    spice_interface::loadSpiceKernelInTudat( input_output::getSpiceKernelPath( ) + "moon_assoc_pa.tf" );
+    tudat_applications::loadSpiceKernelSet( tudat_applications::lunar_orientation_spice_kernels );
 
     // Create body objects.
     std::vector< std::string > bodiesToCreate;
@@ -68,7 +68,7 @@ int main()
 
 
     // Create Earth object
-    NamedBodyMap bodyMap = createBodies( bodySettings );
+    NamedBodyMap bodyMap = tudat_applications::createBodiesWithCachedEphemerides( bodySettings );
 
     // Finalize body creation.
     setGlobalFrameBodyEphemerides( bodyMap, "Earth", "ECLIPJ2000" );
@@ -14,6 +14,7 @@
 #include <Tudat/Astrodynamics/Gravitation/triAxialEllipsoidGravity.h>
 
 #include "propagationAndOptimization/applicationOutput.h"
+#include "propagationAndOptimization/spiceKernelPool.h"
 
 
 //! Execute propagation of orbit of Asterix around the Earth.
@@ -44,7 +45,8 @@ int main()
     double simulationEndEpoch = physical_constants::JULIAN_YEAR / 365.0;
 
     // Load Spice kernels.
-    spice_interface::loadStandardSpiceKernels( { input_output::getSpiceKernelPath( ) + "de430_mar097_small.bsp" } );
+    tudat_applications::loadSpiceKernelSet(
+                tudat_applications::standard_spice_kernels, { input_output::getSpiceKernelPath( ) + "de430_mar097_small.bsp" } );
 
     // Create body objects.
     std::vector< std::string > bodiesToCreate;
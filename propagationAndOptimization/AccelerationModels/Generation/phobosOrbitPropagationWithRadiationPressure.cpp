@@ -12,6 +12,8 @@
 #include <Tudat/External/SpiceInterface/spiceInterface.h>
 
 #include "propagationAndOptimization/applicationOutput.h"
+#include "propagationAndOptimization/ephemerisTabulationCache.h"
+#include "propagationAndOptimization/spiceKernelPool.h"
 
 void propagatePhobosOrbit(
         const int testCase )
@@ -39,7 +41,7 @@ void propagatePhobosOrbit(
 
 
     // Load Spice kernels.
-    spice_interface::loadStandardSpiceKernels( );
+    tudat_applications::loadSpiceKernelSet( tudat_applications::standard_spice_kernels );
 
 
     // Set simulation time settings.
@@ -59,7 +61,7 @@ void propagatePhobosOrbit(
         bodySettings[ bodiesToCreate.at( i ) ]->ephemerisSettings->resetFrameOrientation( "J2000" );
         bodySettings[ bodiesToCreate.at( i ) ]->rotationModelSettings->resetOriginalFrame( "J2000" );
     }
-    NamedBodyMap bodyMap = createBodies( bodySettings );
+    NamedBodyMap bodyMap = tudat_applications::createBodiesWithCachedEphemerides( bodySettings );
 
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     ///////////////////////             CREATE VEHICLE            /////////////////////////////////////////////////////////
@@ -11,6 +11,7 @@
 #include <Tudat/SimulationSetup/tudatSimulationHeader.h>
 
 #include "propagationAndOptimization/applicationOutput.h"
+#include "propagationAndOptimization/spiceKernelPool.h"
 
 
 //! Execute propagation of orbit of LunarOrbiter around the Earth.
@@ -37,7 +38,7 @@ int main()
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
     // Load Spice kernels.
-    spice_interface::loadStandardSpiceKernels( );
+    tudat_applications::loadSpiceKernelSet( tudat_applications::standard_spice_kernels );
 
     //for( unsigned int ephemerisCase = 0; ephemerisCase < 3; ephemerisCase++ )
 
@@ -11,6 +11,9 @@
 #include <Tudat/SimulationSetup/tudatSimulationHeader.h>
 
 #include "propagationAndOptimization/applicationOutput.h"
+#include "propagationAndOptimization/ephemerisTabulationCache.h"
+#include "propagationAndOptimization/packedSphericalHarmonicsAcceleration.h"
+#include "propagationAndOptimization/spiceKernelPool.h"
 
 
 //! Execute propagation of orbit of LunarOrbiter around the Earth.
@@ -37,11 +40,9 @@ int main()
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
     // Load Spice kernels.
-    spice_interface::loadStandardSpiceKernels( );
+    tudat_applications::loadSpiceKernelSet( tudat_applications::standard_spice_kernels );
 
-    spice_interface::loadSpiceKernelInTudat( input_output::getSpiceKernelPath( ) + "moon_pa_de421_1900-2050.bpc" );
-    spice_interface::loadSpiceKernelInTudat( input_output::getSpiceKernelPath( ) + "moon_080317.tf" );
-    spice_interface::loadSpiceKernelInTudat( input_output::getSpiceKernelPath( ) + "moon_assoc_pa.tf" );
+    tudat_applications::loadSpiceKernelSet( tudat_applications::lunar_orientation_spice_kernels );
 
 
     // Create body objects.
@@ -54,7 +55,7 @@ int main()
             getDefaultBodySettings( bodiesToCreate, -3600.0, 14.0 * tudat::physical_constants::JULIAN_DAY + 3600.0 );
 
     // Create Earth object
-    NamedBodyMap bodyMap = createBodies( bodySettings );
+    NamedBodyMap bodyMap = tudat_applications::createBodiesWithCachedEphemerides( bodySettings );
 
     // Create spacecraft object.
     bodyMap[ "LunarOrbiter" ] = std::make_shared< simulation_setup::Body >( );
@@ -112,8 +113,9 @@ int main()
             maximumOrder = 0;
         }
 
-        accelerationsOfLunarOrbiter[ "Moon" ].push_back( std::make_shared< SphericalHarmonicAccelerationSettings >(
-                                                             maximumDegree, maximumOrder ) );
+        accelerationsOfLunarOrbiter[ "Moon" ].push_back(
+                    std::make_shared< tudat_applications::PackedSphericalHarmonicAccelerationSettings >(
+                        maximumDegree, maximumOrder ) );
         accelerationsOfLunarOrbiter[ "Earth" ].push_back( std::make_shared< AccelerationSettings >(
                                                               basic_astrodynamics::central_gravity ) );
         accelerationsOfLunarOrbiter[ "Sun" ].push_back( std::make_shared< AccelerationSettings >(
@@ -122,7 +124,9 @@ int main()
 
 
         // Create acceleration models and propagation settings.
-        basic_astrodynamics::AccelerationMap accelerationModelMap = createAccelerationModelsMap(
+        // Evaluate spherical harmonic acceleration with packed coefficients, which is efficient at high degree and order.
+        basic_astrodynamics::AccelerationMap accelerationModelMap =
+                tudat_applications::createAccelerationModelsMapWithPackedSphericalHarmonics(
                     bodyMap, accelerationMap, bodiesToPropagate, centralBodies );
 
         ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -11,6 +11,8 @@
 #include <Tudat/SimulationSetup/tudatSimulationHeader.h>
 
 #include "propagationAndOptimization/applicationOutput.h"
+#include "propagationAndOptimization/spiceKernelPool.h"
+#include "propagationAndOptimization/stateHistorySink.h"
 
 //! Execute propagation of orbit of Asterix around the Earth.
 int main( )
@@ -35,7 +37,7 @@ int main( )
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
     // Load Spice kernels.
-    spice_interface::loadStandardSpiceKernels( );
+    tudat_applications::loadSpiceKernelSet( tudat_applications::standard_spice_kernels );
 
     // Set simulation time settings.
     const double simulationDuration = 3.0  * tudat::physical_constants::JULIAN_DAY;
@@ -172,27 +174,29 @@ int main( )
         ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 
-        // Create simulation object and propagate dynamics.
-        SingleArcDynamicsSimulator< > dynamicsSimulator( bodyMap, integratorSettings, propagatorSettings );
-        std::map< double, Eigen::VectorXd > integrationResult = dynamicsSimulator.getEquationsOfMotionNumericalSolution( );
+        // Propagate dynamics, outputting only the final state (the full state history is not used).
+        std::shared_ptr< tudat_applications::BoundaryStateHistorySink< > > boundaryStates =
+                std::make_shared< tudat_applications::BoundaryStateHistorySink< > >( );
+        tudat_applications::propagateToStateHistorySinks< double, double >(
+                    bodyMap, integratorSettings, propagatorSettings, simulationStartEpoch + simulationDuration,
+                    { boundaryStates }, nullptr, tudat_applications::createFinalStateOutputSchedule< double >( ) );
+        const Eigen::VectorXd& finalState = boundaryStates->getFinalState( );
 
-        finalResultMatrix.block( 0, propagationCase, 6, 1 ) =
-                integrationResult.rbegin( )->second;
+        finalResultMatrix.block( 0, propagationCase, 6, 1 ) = finalState;
 
         if( propagationCase == 0 )
         {
-            rotationToRswFrame = reference_frames::getInertialToRswSatelliteCenteredFrameRotationMatrix(
-                        integrationResult.rbegin( )->second );
-            nominalFinalState = integrationResult.rbegin( )->second;
+            rotationToRswFrame = reference_frames::getInertialToRswSatelliteCenteredFrameRotationMatrix( finalState );
+            nominalFinalState = finalState;
             finalRswDifferenceResultMatrix.block( 0, propagationCase, 3, 1 ).setZero( );
         }
         else
         {
             finalRswDifferenceResultMatrix.block( 0, propagationCase, 3, 1 ) =
-                  rotationToRswFrame * ( ( integrationResult.rbegin( )->second - nominalFinalState ).segment( 0, 3 ) );
+                  rotationToRswFrame * ( ( finalState - nominalFinalState ).segment( 0, 3 ) );
             std::cout<<finalRswDifferenceResultMatrix.block( 0, propagationCase, 3, 1 ).transpose( )<<std::endl;
         }
-        std::cout<<( integrationResult.rbegin( )->second - nominalFinalState ).transpose( )<<std::endl;
+        std::cout<<( finalState - nominalFinalState ).transpose( )<<std::endl;
 
 
         ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -11,6 +11,9 @@
 #include <Tudat/SimulationSetup/tudatSimulationHeader.h>
 
 #include "propagationAndOptimization/applicationOutput.h"
+#include "propagationAndOptimization/ephemerisTabulationCache.h"
+#include "propagationAndOptimization/gravityFieldCorrectionCache.h"
+#include "propagationAndOptimization/spiceKernelPool.h"
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////            USING STATEMENTS              //////////////////////////////////////////////////////
@@ -26,14 +29,9 @@ using namespace tudat::unit_conversions;
 using namespace tudat::ephemerides;
 using namespace tudat::spice_interface;
 
-//! Function to get tidal deformation model for earth
-std::vector< std::shared_ptr< GravityFieldVariationSettings > > getEarthGravityFieldVariationSettings( )
+//! Function to get Love numbers of degree 2 and 3 for earth
+std::vector< std::vector< std::complex< double > > > getEarthLoveNumbers( )
 {
-    std::vector< std::shared_ptr< GravityFieldVariationSettings > > gravityFieldVariations;
-
-    std::vector< std::string > deformingBodies;
-    deformingBodies.push_back( "Moon" );
-
     std::vector< std::vector< std::complex< double > > > loveNumbers;
 
     std::vector< std::complex< double > > degreeTwoLoveNumbers_;
@@ -48,6 +46,18 @@ std::vector< std::shared_ptr< GravityFieldVariationSettings > > getEarthGravityF
     loveNumbers.push_back( degreeTwoLoveNumbers_ );
     loveNumbers.push_back( degreeThreeLoveNumbers_ );
 
+    return loveNumbers;
+}
+
+//! Function to get tidal deformation model for earth
+std::vector< std::shared_ptr< GravityFieldVariationSettings > > getEarthGravityFieldVariationSettings( )
+{
+    std::vector< std::shared_ptr< GravityFieldVariationSettings > > gravityFieldVariations;
+
+    std::vector< std::string > deformingBodies;
+    deformingBodies.push_back( "Moon" );
+
+    std::vector< std::vector< std::complex< double > > > loveNumbers = getEarthLoveNumbers( );
 
     std::shared_ptr< GravityFieldVariationSettings > moonGravityFieldVariation =
             std::make_shared< BasicSolidBodyGravityFieldVariationSettings >(
@@ -73,11 +83,9 @@ int main()
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
     // Load Spice kernels.
-    spice_interface::loadStandardSpiceKernels( );
+    tudat_applications::loadSpiceKernelSet( tudat_applications::standard_spice_kernels );
 
-    spice_interface::loadSpiceKernelInTudat( input_output::getSpiceKernelPath( ) + "moon_pa_de421_1900-2050.bpc" );
-    spice_interface::loadSpiceKernelInTudat( input_output::getSpiceKernelPath( ) + "moon_080317.tf" );
-    spice_interface::loadSpiceKernelInTudat( input_output::getSpiceKernelPath( ) + "moon_assoc_pa.tf" );
+    tudat_applications::loadSpiceKernelSet( tudat_applications::lunar_orientation_spice_kernels );
 
     // Create body objects.
     std::vector< std::string > bodiesToCreate;
@@ -90,7 +98,7 @@ int main()
     bodySettings[ "Earth" ]->gravityFieldVariationSettings = getEarthGravityFieldVariationSettings( );
 
     // Create earth object
-    NamedBodyMap bodyMap = createBodies( bodySettings );
+    NamedBodyMap bodyMap = tudat_applications::createBodiesWithCachedEphemerides( bodySettings );
 
     // Create spacecraft object.
     // Create spacecraft object.
@@ -125,6 +133,12 @@ int main()
     // Finalize body creation.
     setGlobalFrameBodyEphemerides( bodyMap, "SSB", "ECLIPJ2000" );
 
+    // Recompute the tidal corrections every 10 minutes only (interpolating in between), and retain the corrections at each
+    // evaluated epoch, so that they need not be recomputed after the propagation.
+    std::vector< std::shared_ptr< tudat_applications::CadencedSolidBodyTideGravityFieldVariations > >
+            earthGravityFieldVariations = tudat_applications::setCadencedSolidBodyTideGravityFieldVariations(
+                bodyMap, "Earth", { { "Moon" }, { "Sun" } }, getEarthLoveNumbers( ), 6378137.0, 600.0 );
+
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     ///////////////////////            CREATE ACCELERATIONS          //////////////////////////////////////////////////////
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -215,16 +229,21 @@ int main()
     SingleArcDynamicsSimulator< > dynamicsSimulator(
                 bodyMap, integratorSettings, propagatorSettings );
     std::map< double, Eigen::VectorXd > dependentVariableResult = dynamicsSimulator.getDependentVariableHistory( );
+
+    // Retrieve tidal corrections retained during propagation.
+    std::vector< double > outputEpochs;
+    for( const auto& it : dependentVariableResult )
+    {
+        outputEpochs.push_back( it.first );
+    }
+    std::map< double, tudat_applications::SphericalHarmonicCorrections > totalCorrectionHistory =
+            tudat_applications::getTotalCorrectionHistory( earthGravityFieldVariations, outputEpochs, 3, 3 );
+
     std::map< double, Eigen::VectorXd > sphericalHarmonicVariations;
-    std::shared_ptr< gravitation::TimeDependentSphericalHarmonicsGravityField > earthGravityField =
-            std::dynamic_pointer_cast< gravitation::TimeDependentSphericalHarmonicsGravityField >(
-                bodyMap.at( "Earth" )->getGravityFieldModel( ) );
-    for( auto it : dependentVariableResult )
+    for( const auto& it : totalCorrectionHistory )
     {
-        dynamicsSimulator.getDynamicsStateDerivative( )->computeStateDerivative(
-                    it.first, it.second );
-        Eigen::MatrixXd cosineVariations = earthGravityField->getTotalCosineCoefficientCorrection( 3, 3 );
-        Eigen::MatrixXd sineVariations = earthGravityField->getTotalSineCoefficientCorrection( 3, 3 );
+        const Eigen::MatrixXd& cosineVariations = it.second.first;
+        const Eigen::MatrixXd& sineVariations = it.second.second;
         Eigen::VectorXd currentOutput = Eigen::VectorXd( 12 );
         currentOutput.segment( 0, 3 ) = cosineVariations.block( 2, 0, 1, 3 ).transpose( );
         currentOutput.segment( 3, 4 ) = cosineVariations.block( 3, 0, 1, 4 ).transpose( );
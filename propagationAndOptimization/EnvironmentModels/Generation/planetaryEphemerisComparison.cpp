@@ -13,6 +13,8 @@
 #include <Tudat/External/SpiceInterface/spiceEphemeris.h>
 
 #include "propagationAndOptimization/applicationOutput.h"
+#include "propagationAndOptimization/ephemerisBatchEvaluation.h"
+#include "propagationAndOptimization/spiceKernelPool.h"
 
 
 //! Execute propagation of orbit of LunarOrbiter around the Earth.
@@ -39,8 +41,8 @@ int main()
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
     // Load Spice kernels.
-    spice_interface::loadStandardSpiceKernels(
-    { input_output::getSpiceKernelPath( ) + "de430.bsp" } );
+    tudat_applications::loadSpiceKernelSet(
+                tudat_applications::standard_spice_kernels, { input_output::getSpiceKernelPath( ) + "de430.bsp" } );
 
     std::shared_ptr< Ephemeris > approximateEphemeris = std::make_shared< ApproximatePlanetPositions>(
                 ApproximatePlanetPositionsBase::BodiesWithEphemerisData::mars );
@@ -54,23 +56,31 @@ int main()
     double endTime = 400.0 * physical_constants::JULIAN_YEAR;
     double timeStep = 30.0 * physical_constants::JULIAN_DAY;
 
-    std::map< double, Eigen::Vector6d > spiceStates;
-    std::map< double, Eigen::Vector6d > approximateStates;
-
+    std::vector< double > comparisonEpochs;
     double currentTime = startTime;
     while( currentTime < endTime )
     {
-        spiceStates[ currentTime ] =
-                convertCartesianToKeplerianElements( spiceEphemeris->getCartesianState( currentTime ), sunGravitationalParameter );
-        approximateStates[ currentTime ] =
-                convertCartesianToKeplerianElements( approximateEphemeris->getCartesianState( currentTime ), sunGravitationalParameter );
+        comparisonEpochs.push_back( currentTime );
+        currentTime += timeStep;
+    }
 
-//        std::cout<<spiceStates[ currentTime ].transpose( )<<std::endl;
-//        std::cout<<approximateStates[ currentTime ].transpose( )<<std::endl;
+    // Evaluate both ephemerides at all epochs, and convert to Keplerian elements in a single pass.
+    tudat_applications::StateBatch spiceCartesianStates, approximateCartesianStates;
+    tudat_applications::getCartesianStates( spiceEphemeris, comparisonEpochs, spiceCartesianStates );
+    tudat_applications::getCartesianStates( approximateEphemeris, comparisonEpochs, approximateCartesianStates );
 
-//        std::cout<<( approximateStates[ currentTime ] - spiceStates[ currentTime ] ).transpose( ) <<std::endl;
+    tudat_applications::StateBatch spiceKeplerianStates = tudat_applications::convertCartesianStatesToKeplerianElements(
+                spiceCartesianStates, sunGravitationalParameter );
+    tudat_applications::StateBatch approximateKeplerianStates =
+            tudat_applications::convertCartesianStatesToKeplerianElements(
+                approximateCartesianStates, sunGravitationalParameter );
 
-        currentTime += timeStep;
+    std::map< double, Eigen::Vector6d > spiceStates;
+    std::map< double, Eigen::Vector6d > approximateStates;
+    for( unsigned int i = 0; i < comparisonEpochs.size( ); i++ )
+    {
+        spiceStates[ comparisonEpochs.at( i ) ] = spiceKeplerianStates.row( i ).transpose( );
+        approximateStates[ comparisonEpochs.at( i ) ] = approximateKeplerianStates.row( i ).transpose( );
     }
 
     input_output::writeDataMapToTextFile( spiceStates,
@@ -11,6 +11,8 @@
 #include <Tudat/SimulationSetup/tudatSimulationHeader.h>
 
 #include "propagationAndOptimization/applicationOutput.h"
+#include "propagationAndOptimization/ephemerisTabulationCache.h"
+#include "propagationAndOptimization/spiceKernelPool.h"
 
 
 //! Execute propagation of orbit of LunarOrbiter around the Earth.
@@ -37,7 +39,7 @@ int main()
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
     // Load Spice kernels.
-    spice_interface::loadStandardSpiceKernels( );
+    tudat_applications::loadSpiceKernelSet( tudat_applications::standard_spice_kernels );
 
     for( unsigned int ephemerisCase = 0; ephemerisCase < 3; ephemerisCase++ )
     {
@@ -153,7 +155,7 @@ int main()
         }
 
         // Create Earth object
-        NamedBodyMap bodyMap = createBodies( bodySettings );
+        NamedBodyMap bodyMap = tudat_applications::createBodiesWithCachedEphemerides( bodySettings );
 
         // Create spacecraft object.
         bodyMap[ "LunarOrbiter" ] = std::make_shared< simulation_setup::Body >( );
@@ -11,6 +11,8 @@
 #include <Tudat/SimulationSetup/tudatSimulationHeader.h>
 
 #include "propagationAndOptimization/applicationOutput.h"
+#include "propagationAndOptimization/ephemerisTabulationCache.h"
+#include "propagationAndOptimization/spiceKernelPool.h"
 
 
 //! Execute propagation of orbit of LunarOrbiter around the Earth.
@@ -41,11 +43,9 @@ int main()
     const double simulationEndEpoch = 4.0 * tudat::physical_constants::JULIAN_DAY;
 
     // Load Spice kernels.
-    spice_interface::loadStandardSpiceKernels( );
+    tudat_applications::loadSpiceKernelSet( tudat_applications::standard_spice_kernels );
 
-    spice_interface::loadSpiceKernelInTudat( input_output::getSpiceKernelPath( ) + "moon_pa_de421_1900-2050.bpc" );
-    spice_interface::loadSpiceKernelInTudat( input_output::getSpiceKernelPath( ) + "moon_080317.tf" );
-    spice_interface::loadSpiceKernelInTudat( input_output::getSpiceKernelPath( ) + "moon_assoc_pa.tf" );
+    tudat_applications::loadSpiceKernelSet( tudat_applications::lunar_orientation_spice_kernels );
 
 
     for( unsigned int rotationModelCase = 0; rotationModelCase < 4; rotationModelCase++ )
@@ -109,7 +109,7 @@ int main()
         std::cout<<"ME : "<<std::endl<<spice_interface::computeRotationQuaternionBetweenFrames( "J2000", "MOON_ME", 0.0 ).toRotationMatrix( )<<std::endl;
         std::cout<<"PA : "<<std::endl<<spice_interface::computeRotationQuaternionBetweenFrames( "J2000", "MOON_PA", 0.0 ).toRotationMatrix( )<<std::endl;
                 // Create Earth object
-        NamedBodyMap bodyMap = createBodies( bodySettings );
+        NamedBodyMap bodyMap = tudat_applications::createBodiesWithCachedEphemerides( bodySettings );
 
         // Create spacecraft object.
         bodyMap[ "LunarOrbiter" ] = std::make_shared< simulation_setup::Body >( );
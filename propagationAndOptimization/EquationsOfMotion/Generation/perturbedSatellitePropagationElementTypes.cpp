@@ -12,6 +12,9 @@
 #include <Tudat/JsonInterface/Propagation/propagator.h>
 
 #include "propagationAndOptimization/applicationOutput.h"
+#include "propagationAndOptimization/environmentEvaluationCache.h"
+#include "propagationAndOptimization/ephemerisTabulationCache.h"
+#include "propagationAndOptimization/spiceKernelPool.h"
 
 //! Execute propagation of orbit of spacecraft around the Earth, and save results in difference element types.
 /*!
@@ -52,7 +55,7 @@ int main()
 
 
     // Load Spice kernels.
-    spice_interface::loadStandardSpiceKernels( );
+    tudat_applications::loadSpiceKernelSet( tudat_applications::standard_spice_kernels );
 
     // Set simulation time settings.
     const double simulationStartEpoch = 0.0;
@@ -74,7 +77,7 @@ int main()
         bodySettings[ bodiesToCreate.at( i ) ]->ephemerisSettings->resetFrameOrientation( "J2000" );
         bodySettings[ bodiesToCreate.at( i ) ]->rotationModelSettings->resetOriginalFrame( "J2000" );
     }
-    NamedBodyMap bodyMap = createBodies( bodySettings );
+    NamedBodyMap bodyMap = tudat_applications::createBodiesWithCachedEphemerides( bodySettings );
 
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     ///////////////////////             CREATE VEHICLE            /////////////////////////////////////////////////////////
@@ -113,6 +116,9 @@ int main()
     // Finalize body creation.
     setGlobalFrameBodyEphemerides( bodyMap, "SSB", "J2000" );
 
+    // Evaluate ephemerides and rotation models only once per epoch, as epochs recur between integrator stages.
+    tudat_applications::addEnvironmentEvaluationCaches( bodyMap );
+
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     ///////////////////////            CREATE ACCELERATIONS          //////////////////////////////////////////////////////
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
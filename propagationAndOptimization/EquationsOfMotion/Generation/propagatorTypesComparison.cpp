@@ -19,6 +19,11 @@
 #include "Tudat/Basics/utilities.h"
 
 #include "propagationAndOptimization/applicationOutput.h"
+#include "propagationAndOptimization/environmentEvaluationCache.h"
+#include "propagationAndOptimization/ephemerisTabulationCache.h"
+#include "propagationAndOptimization/hermiteDenseOutput.h"
+#include "propagationAndOptimization/packedSphericalHarmonicsAcceleration.h"
+#include "propagationAndOptimization/spiceKernelPool.h"
 
 //! Execute propagation of orbit of Satellite around the Earth.
 int main( )
@@ -61,7 +66,7 @@ int main( )
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
     // Load Spice kernels
-    spice_interface::loadStandardSpiceKernels( );
+    tudat_applications::loadSpiceKernelSet( tudat_applications::standard_spice_kernels );
 
     // Set simulation time settings
     const double simulationStartEpoch = 7.0 * physical_constants::JULIAN_YEAR + 30.0 * 6.0 * physical_constants::JULIAN_DAY;
@@ -85,7 +90,7 @@ int main( )
 
     bodySettings[ "Earth" ]->gravityFieldSettings = std::make_shared< FromFileSphericalHarmonicsGravityFieldSettings >( ggm02s );
     bodySettings[ "Earth" ]->atmosphereSettings = std::make_shared< ExponentialAtmosphereSettings >( aerodynamics::earth );
-    NamedBodyMap bodyMap = createBodies( bodySettings );
+    NamedBodyMap bodyMap = tudat_applications::createBodiesWithCachedEphemerides( bodySettings );
 
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     ///////////////////////             CREATE VEHICLE            /////////////////////////////////////////////////////////
@@ -121,6 +126,9 @@ int main( )
     // Finalize body creation.
     setGlobalFrameBodyEphemerides( bodyMap, "SSB", "J2000" );
 
+    // Evaluate ephemerides and rotation models only once per epoch, as epochs recur between integrator stages.
+    tudat_applications::addEnvironmentEvaluationCaches( bodyMap );
+
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     ///////////////////////            CREATE ACCELERATIONS          //////////////////////////////////////////////////////
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -140,7 +148,7 @@ int main( )
     else
     {
         // Define spherical harmonics, third bodies, solar radiation and aerodynamic forces
-        accelerationsOfSatellite[ "Earth" ].push_back( std::make_shared< SphericalHarmonicAccelerationSettings >( 8, 8 ) );
+        accelerationsOfSatellite[ "Earth" ].push_back( std::make_shared< tudat_applications::PackedSphericalHarmonicAccelerationSettings >( 8, 8 ) );
         for ( unsigned int i = 0; i < bodiesToCreate.size( ); i++ )
         {
             if ( bodiesToCreate.at( i ) != "Earth" )
@@ -157,7 +165,7 @@ int main( )
     bodiesToPropagate.push_back( "Satellite" );
     centralBodies.push_back( "Earth" );
 
-    AccelerationMap accelerationModelMap = createAccelerationModelsMap(
+    AccelerationMap accelerationModelMap = tudat_applications::createAccelerationModelsMapWithPackedSphericalHarmonics(
                 bodyMap, accelerationMap, bodiesToPropagate, centralBodies );
 
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -194,7 +202,7 @@ int main( )
         const Eigen::Vector6d satelliteInitialState = convertKeplerianToCartesianElements(
                     satelliteInitialStateInKeplerianElements, mainGravitationalParameter );
 
-        std::shared_ptr< interpolators::OneDimensionalInterpolator< double, Eigen::VectorXd > > benchmarkStateInterpolator;
+        std::shared_ptr< CartesianHermiteInterpolator< > > benchmarkStateInterpolator;
         {
             // Propagator settings
             std::shared_ptr< TranslationalStatePropagatorSettings< long double > > propagatorSettings =
@@ -218,8 +226,8 @@ int main( )
 
             utilities::castMatrixMap( cartesianIntegrationResult, cartesianDoubleIntegrationResult );
 
-            benchmarkStateInterpolator = interpolators::createOneDimensionalInterpolator(
-                         cartesianDoubleIntegrationResult, std::make_shared< interpolators::LagrangeInterpolatorSettings >( 8 ) );
+            benchmarkStateInterpolator = std::make_shared< CartesianHermiteInterpolator< > >(
+                        cartesianDoubleIntegrationResult );
             // Store number of function evaluations for variable step-size
             std::cout << "Total Number of Function Evaluations: " <<
                       dynamicsSimulator.getCumulativeNumberOfFunctionEvaluations( ).rbegin( )->second  << std::endl;
@@ -267,7 +275,7 @@ int main( )
 
             std::map< double, Eigen::VectorXd > cartesianBenchmarkInterpolatedResult;
 
-            for( auto stateIterator : cartesianDoubleIntegrationResult )
+            for( const auto& stateIterator : cartesianDoubleIntegrationResult )
             {
                 cartesianBenchmarkInterpolatedResult[ stateIterator.first ] =
                         benchmarkStateInterpolator->interpolate( stateIterator.first );
@@ -316,7 +324,7 @@ int main( )
 
             std::map< double, Eigen::VectorXd > cartesianBenchmarkInterpolatedResult;
 
-            for( auto stateIterator : cartesianDoubleIntegrationResult )
+            for( const auto& stateIterator : cartesianDoubleIntegrationResult )
             {
                 cartesianBenchmarkInterpolatedResult[ stateIterator.first ] =
                         benchmarkStateInterpolator->interpolate( stateIterator.first );
@@ -389,7 +397,7 @@ int main( )
                 std::map< double, Eigen::VectorXd > cartesianIntegrationResult = dynamicsSimulator.getEquationsOfMotionNumericalSolution( );
                 std::map< double, Eigen::VectorXd > cartesianBenchmarkInterpolatedResult;
 
-                for( auto stateIterator : cartesianIntegrationResult )
+                for( const auto& stateIterator : cartesianIntegrationResult )
                 {
                     cartesianBenchmarkInterpolatedResult[ stateIterator.first ] =
                             benchmarkStateInterpolator->interpolate( stateIterator.first );
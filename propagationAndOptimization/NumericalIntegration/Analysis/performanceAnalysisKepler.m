@@ -8,6 +8,7 @@ clc
 
 
 folder = '../../SimulationOutput/NumericalIntegration/';
+addpath('../../');
 
 % Boolean denoting whether to load all results files separately, or if a
 % previously saved .mat file is available
@@ -26,6 +27,7 @@ else
     titleSuffix = '';
     toleranceMultiplier = 1.0;
 end
+archive = openCampaignArchive(strcat(folder,'lunarOrbiterPropagatorIntegratorSettings',fileSuffix,'.tca'));
 numberOfEccentricities = 7;
 
 if( loadProcessedData == false )
@@ -38,13 +40,13 @@ if( loadProcessedData == false )
             
             % Iterate over all tolerance/step size settings
             for j=0:5
-                tempEvaluations = load(strcat(folder,'functionEvaluations_e_',num2str(i),'_intSett',num2str(j),'_propSett',num2str(l),'_accSett0',fileSuffix,'.dat'));
+                tempEvaluations = readCampaignArchiveEntry(archive,strcat('functionEvaluations_e_',num2str(i),'_intSett',num2str(j),'_propSett',num2str(l),'_accSett0',fileSuffix));
                 functionEvaluations_Rk(i+1,j+1,1:4,l+1)= tempEvaluations(1:4,2)';
                 functionEvaluations_Bs(i+1,j+1,1:4,l+1)= tempEvaluations(5:8,2)';
                 functionEvaluations_Rk(i+1,j+1,5,l+1)= tempEvaluations(9,2)';
                 functionEvaluations_Abm(i+1,j+1,1:5,l+1)= tempEvaluations(10:14,2)';
                 
-                tempErrors =  load(strcat(folder,'forwardBackwardError_e_',num2str(i),'_intSett',num2str(j),'_propSett',num2str(l),'_accSett0',fileSuffix,'.dat'));
+                tempErrors =  readCampaignArchiveEntry(archive,strcat('forwardBackwardError_e_',num2str(i),'_intSett',num2str(j),'_propSett',num2str(l),'_accSett0',fileSuffix));
                 forwardBackwardErrors_Rk(i+1,j+1,1:4,l+1)= tempErrors(1:4,3)';
                 forwardBackwardErrors_Bs(i+1,j+1,1:4,l+1)= tempErrors(5:8,3)';
                 forwardBackwardErrors_Rk(i+1,j+1,5,l+1)= tempErrors(9,3)';
@@ -54,21 +56,21 @@ if( loadProcessedData == false )
                 for k=0:13
                     disp(strcat(num2str(i),'_',num2str(j),'_',num2str(k)))
                     if( k < 4 )
-                        errorMap_Rk{i+1,j+1,k+1,l+1}=load(strcat(folder,'numericalKeplerOrbitError_e_',num2str(i),'_intType',num2str(k),'_intSett',num2str(j),'_propSett',num2str(l),fileSuffix,'.dat'));
-                        errorMap_Rk_Back{i+1,j+1,k+1,l+1}=load(strcat(folder,'numericalKeplerOrbitErrorBack_e_',num2str(i),'_intType',num2str(k),'_intSett',num2str(j),'_propSett',num2str(l),fileSuffix,'.dat'));
+                        errorMap_Rk{i+1,j+1,k+1,l+1}=readCampaignArchiveEntry(archive,strcat('numericalKeplerOrbitError_e_',num2str(i),'_intType',num2str(k),'_intSett',num2str(j),'_propSett',num2str(l),fileSuffix));
+                        errorMap_Rk_Back{i+1,j+1,k+1,l+1}=readCampaignArchiveEntry(archive,strcat('numericalKeplerOrbitErrorBack_e_',num2str(i),'_intType',num2str(k),'_intSett',num2str(j),'_propSett',num2str(l),fileSuffix));
                         maximumError_Rk(i+1,j+1,k+1,l+1) = max(errorMap_Rk{i+1,j+1,k+1,l+1}(:,2)');
                         
                     elseif( k < 8 )
-                        errorMap_Bs{i+1,j+1,k+1- 4,l+1}=load(strcat(folder,'numericalKeplerOrbitError_e_',num2str(i),'_intType',num2str(k),'_intSett',num2str(j),'_propSett',num2str(l),fileSuffix,'.dat'));
-                        errorMap_Bs_Back{i+1,j+1,k+1-4,l+1}=load(strcat(folder,'numericalKeplerOrbitErrorBack_e_',num2str(i),'_intType',num2str(k),'_intSett',num2str(j),'_propSett',num2str(l),fileSuffix,'.dat'));
+                        errorMap_Bs{i+1,j+1,k+1- 4,l+1}=readCampaignArchiveEntry(archive,strcat('numericalKeplerOrbitError_e_',num2str(i),'_intType',num2str(k),'_intSett',num2str(j),'_propSett',num2str(l),fileSuffix));
+                        errorMap_Bs_Back{i+1,j+1,k+1-4,l+1}=readCampaignArchiveEntry(archive,strcat('numericalKeplerOrbitErrorBack_e_',num2str(i),'_intType',num2str(k),'_intSett',num2str(j),'_propSett',num2str(l),fileSuffix));
                         maximumError_Bs(i+1,j+1,k+1-4,l+1) = max(errorMap_Bs{i+1,j+1,k+1-4,l+1}(:,2)');
                     elseif( k == 8 )
-                        errorMap_Rk{i+1,j+1,5,l+1}=load(strcat(folder,'numericalKeplerOrbitError_e_',num2str(i),'_intType',num2str(k),'_intSett',num2str(j),'_propSett',num2str(l),fileSuffix,'.dat'));
-                        errorMap_Rk_Back{i+1,j+1,5,l+1}=load(strcat(folder,'numericalKeplerOrbitErrorBack_e_',num2str(i),'_intType',num2str(k),'_intSett',num2str(j),'_propSett',num2str(l),fileSuffix,'.dat'));
+                        errorMap_Rk{i+1,j+1,5,l+1}=readCampaignArchiveEntry(archive,strcat('numericalKeplerOrbitError_e_',num2str(i),'_intType',num2str(k),'_intSett',num2str(j),'_propSett',num2str(l),fileSuffix));
+                        errorMap_Rk_Back{i+1,j+1,5,l+1}=readCampaignArchiveEntry(archive,strcat('numericalKeplerOrbitErrorBack_e_',num2str(i),'_intType',num2str(k),'_intSett',num2str(j),'_propSett',num2str(l),fileSuffix));
                         maximumError_Rk(i+1,j+1,5,l+1) = max(errorMap_Rk{i+1,j+1,5,l+1}(:,2)');
                     else
-                        errorMap_Abm{i+1,j+1,k+1-9,l+1}=load(strcat(folder,'numericalKeplerOrbitError_e_',num2str(i),'_intType',num2str(k),'_intSett',num2str(j),'_propSett',num2str(l),fileSuffix,'.dat'));
-                        errorMap_Abm_Back{i+1,j+1,k+1-9,l+1}=load(strcat(folder,'numericalKeplerOrbitErrorBack_e_',num2str(i),'_intType',num2str(k),'_intSett',num2str(j),'_propSett',num2str(l),fileSuffix,'.dat'));
+                        errorMap_Abm{i+1,j+1,k+1-9,l+1}=readCampaignArchiveEntry(archive,strcat('numericalKeplerOrbitError_e_',num2str(i),'_intType',num2str(k),'_intSett',num2str(j),'_propSett',num2str(l),fileSuffix));
+                        errorMap_Abm_Back{i+1,j+1,k+1-9,l+1}=readCampaignArchiveEntry(archive,strcat('numericalKeplerOrbitErrorBack_e_',num2str(i),'_intType',num2str(k),'_intSett',num2str(j),'_propSett',num2str(l),fileSuffix));
                         maximumError_Abm(i+1,j+1,k+1-9,l+1) = max(errorMap_Abm{i+1,j+1,k+1-9,l+1}(:,2)');
                     end
                 end
@@ -7,6 +7,7 @@ clear all
 clc
 
 folder = '../../SimulationOutput/NumericalIntegration/';
+addpath('../../');
 saveResults = true;
 
 useLongValues = false;
@@ -20,6 +21,7 @@ else
     titleSuffix = '';
     toleranceMultiplier = 1.0;
 end
+archive = openCampaignArchive(strcat(folder,'lunarOrbiterPropagatorIntegratorSettings',fileSuffix,'.tca'));
 numberOfEccentricities = 3;
  
 % Stopped at Forward/backward 0 0 604800   -0.113191  -0.0602384   -0.119346 0.000264293 0.000121275 8.64794e-05 0 0 0 0 0 0
@@ -27,13 +29,13 @@ numberOfEccentricities = 3;
 for l=0:3
     for i=0:(numberOfEccentricities-1)
         for j=0:5
-            tempEvaluations = load(strcat(folder,'functionEvaluations_e_',num2str(i),'_intSett',num2str(j),'_propSett',num2str(l),fileSuffix,'_accSett1.dat'));
+            tempEvaluations = readCampaignArchiveEntry(archive,strcat('functionEvaluations_e_',num2str(i),'_intSett',num2str(j),'_propSett',num2str(l),'_accSett1',fileSuffix));
             functionEvaluations_Rk(i+1,j+1,1:4,l+1)= tempEvaluations(1:4,2)';
             functionEvaluations_Bs(i+1,j+1,1:4,l+1)= tempEvaluations(5:8,2)';
             functionEvaluations_Rk(i+1,j+1,5,l+1)= tempEvaluations(9,2)';
             functionEvaluations_Abm(i+1,j+1,1:5,l+1)= tempEvaluations(10:14,2)';
             
-            tempErrors =  load(strcat(folder,'forwardBackwardError_e_',num2str(i),'_intSett',num2str(j),'_propSett',num2str(l),fileSuffix,'_accSett1.dat'));
+            tempErrors =  readCampaignArchiveEntry(archive,strcat('forwardBackwardError_e_',num2str(i),'_intSett',num2str(j),'_propSett',num2str(l),'_accSett1',fileSuffix));
             forwardBackwardErrors_Rk(i+1,j+1,1:4,l+1)= tempErrors(1:4,3)';
             forwardBackwardErrors_Bs(i+1,j+1,1:4,l+1)= tempErrors(5:8,3)';
             forwardBackwardErrors_Rk(i+1,j+1,5,l+1)= tempErrors(9,3)';
@@ -42,18 +44,18 @@ for l=0:3
 %                 disp(strcat(num2str(i),'_',num2str(j),'_',num2str(k)))
 %                 if( j > 0 )
 %                     if( k < 4 )
-%                         errorMap_Rk{i+1,j,k+1,l+1}=load(strcat(folder,'interpolatedPerturbedOrbit_e_',num2str(i),'_intType',num2str(k),'_intSett',num2str(j),'_propSett',num2str(l),fileSuffix,'.dat'));
-%                         errorMap_Rk_B{i+1,j,k+1,l+1}=load(strcat(folder,'interpolatedPerturbedOrbitB_e_',num2str(i),'_intType',num2str(k),'_intSett',num2str(j),'_propSett',num2str(l),fileSuffix,'.dat'));
+%                         errorMap_Rk{i+1,j,k+1,l+1}=readCampaignArchiveEntry(archive,strcat('interpolatedPerturbedOrbit_e_',num2str(i),'_intType',num2str(k),'_intSett',num2str(j),'_propSett',num2str(l),fileSuffix));
+%                         errorMap_Rk_B{i+1,j,k+1,l+1}=readCampaignArchiveEntry(archive,strcat('interpolatedPerturbedOrbitB_e_',num2str(i),'_intType',num2str(k),'_intSett',num2str(j),'_propSett',num2str(l),fileSuffix));
 %                     elseif( k < 8 )
-%                         errorMap_Bs{i+1,j,k+1- 4,l+1}=load(strcat(folder,'interpolatedPerturbedOrbit_e_',num2str(i),'_intType',num2str(k),'_intSett',num2str(j),'_propSett',num2str(l),fileSuffix,'.dat'));
-%                         errorMap_Bs_B{i+1,j,k+1- 4,l+1}=load(strcat(folder,'interpolatedPerturbedOrbitB_e_',num2str(i),'_intType',num2str(k),'_intSett',num2str(j),'_propSett',num2str(l),fileSuffix,'.dat'));
+%                         errorMap_Bs{i+1,j,k+1- 4,l+1}=readCampaignArchiveEntry(archive,strcat('interpolatedPerturbedOrbit_e_',num2str(i),'_intType',num2str(k),'_intSett',num2str(j),'_propSett',num2str(l),fileSuffix));
+%                         errorMap_Bs_B{i+1,j,k+1- 4,l+1}=readCampaignArchiveEntry(archive,strcat('interpolatedPerturbedOrbitB_e_',num2str(i),'_intType',num2str(k),'_intSett',num2str(j),'_propSett',num2str(l),fileSuffix));
 %                         
 %                     elseif( k == 8 )
-%                         errorMap_Rk{i+1,j,5,l+1}=load(strcat(folder,'interpolatedPerturbedOrbit_e_',num2str(i),'_intType',num2str(k),'_intSett',num2str(j),'_propSett',num2str(l),fileSuffix,'.dat'));
-%                         errorMap_Rk_B{i+1,j,5,l+1}=load(strcat(folder,'interpolatedPerturbedOrbitB_e_',num2str(i),'_intType',num2str(k),'_intSett',num2str(j),'_propSett',num2str(l),fileSuffix,'.dat'));
+%                         errorMap_Rk{i+1,j,5,l+1}=readCampaignArchiveEntry(archive,strcat('interpolatedPerturbedOrbit_e_',num2str(i),'_intType',num2str(k),'_intSett',num2str(j),'_propSett',num2str(l),fileSuffix));
+%                         errorMap_Rk_B{i+1,j,5,l+1}=readCampaignArchiveEntry(archive,strcat('interpolatedPerturbedOrbitB_e_',num2str(i),'_intType',num2str(k),'_intSett',num2str(j),'_propSett',num2str(l),fileSuffix));
 %                     else
-%                         errorMap_Abm{i+1,j,k+1-9,l+1}=load(strcat(folder,'interpolatedPerturbedOrbit_e_',num2str(i),'_intType',num2str(k),'_intSett',num2str(j),'_propSett',num2str(l),fileSuffix,'.dat'));
-%                         errorMap_Abm_B{i+1,j,k+1-9,l+1}=load(strcat(folder,'interpolatedPerturbedOrbitB_e_',num2str(i),'_intType',num2str(k),'_intSett',num2str(j),'_propSett',num2str(l),fileSuffix,'.dat'));
+%                         errorMap_Abm{i+1,j,k+1-9,l+1}=readCampaignArchiveEntry(archive,strcat('interpolatedPerturbedOrbit_e_',num2str(i),'_intType',num2str(k),'_intSett',num2str(j),'_propSett',num2str(l),fileSuffix));
+%                         errorMap_Abm_B{i+1,j,k+1-9,l+1}=readCampaignArchiveEntry(archive,strcat('interpolatedPerturbedOrbitB_e_',num2str(i),'_intType',num2str(k),'_intSett',num2str(j),'_propSett',num2str(l),fileSuffix));
 %                     end
 %                 end
 %             end
@@ -13,6 +13,8 @@
 #include <Tudat/SimulationSetup/tudatSimulationHeader.h>
 
 #include "propagationAndOptimization/applicationOutput.h"
+#include "propagationAndOptimization/spiceKernelPool.h"
+#include "propagationAndOptimization/stateHistorySink.h"
 
 
 //! Execute propagation of orbit of spacecraft around the Earth, using an RK4 integrator with a range of time step
@@ -53,7 +55,7 @@ void runIntegrationErrorSimulation( )
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
     // Load Spice kernels.
-    spice_interface::loadStandardSpiceKernels( );
+    tudat_applications::loadSpiceKernelSet( tudat_applications::standard_spice_kernels );
 
     // Create body objects.
     std::vector< std::string > bodiesToCreate;
@@ -151,13 +153,35 @@ void runIntegrationErrorSimulation( )
         ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 
-        // Create simulation object and propagate dynamics.
+        // Create state derivative model and RK4 integrator of Tudat, without propagating.
+        typedef Eigen::Matrix< StateScalarType, Eigen::Dynamic, Eigen::Dynamic > StateType;
         SingleArcDynamicsSimulator< StateScalarType, TimeType > dynamicsSimulator(
-                    bodyMap, integratorSettings, propagatorSettings );
-        Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 > propagationEndState =
-                dynamicsSimulator.getEquationsOfMotionNumericalSolution( ).rbegin( )->second;
-        double finalPropagationTime =
-                dynamicsSimulator.getEquationsOfMotionNumericalSolution( ).rbegin( )->first;
+                    bodyMap, integratorSettings, propagatorSettings, false );
+        std::shared_ptr< DynamicsStateDerivativeModel< TimeType, StateScalarType > > stateDerivativeModel =
+                dynamicsSimulator.getDynamicsStateDerivative( );
+        std::shared_ptr< NumericalIntegrator< TimeType, StateType, StateType, TimeType > > integrator =
+                createIntegrator< TimeType, StateType >(
+                    dynamicsSimulator.getStateDerivativeFunction( ),
+                    stateDerivativeModel->convertFromOutputSolution(
+                        propagatorSettings->getInitialStates( ), integratorSettings->initialTime_ ),
+                    integratorSettings );
+
+        // Propagate dynamics with this integrator, retaining only the final state (so that no state history is stored for
+        // small steps). The last step is shortened to end on the final epoch, at which the error is evaluated.
+        std::shared_ptr< tudat_applications::BoundaryStateHistorySink< StateScalarType, TimeType > > boundaryStates =
+                std::make_shared< tudat_applications::BoundaryStateHistorySink< StateScalarType, TimeType > >( );
+        tudat_applications::integrateToStateHistorySinks< StateScalarType, TimeType, StateType >(
+                    integrator,
+                    [ & ]( const StateType& state, const TimeType time,
+                           Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 >& outputState )
+        {
+            outputState = stateDerivativeModel->convertToOutputSolution( state, time );
+        }, [ & ]( ){ return stateDerivativeModel->getNumberOfFunctionEvaluations( ); },
+                    integratorSettings->initialTime_, integratorSettings->initialTimeStep_, true, simulationEndEpoch,
+                    { boundaryStates }, nullptr, nullptr, false );
+        boundaryStates->finalize( );
+        Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 > propagationEndState = boundaryStates->getFinalState( );
+        double finalPropagationTime = boundaryStates->getFinalTime( );
         clock_t end = clock();
 
         double elapsedSeconds = double(end - begin) / CLOCKS_PER_SEC;
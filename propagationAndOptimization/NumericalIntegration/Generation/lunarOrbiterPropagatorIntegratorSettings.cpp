@@ -11,6 +11,15 @@
 #include <Tudat/SimulationSetup/tudatSimulationHeader.h>
 
 #include "propagationAndOptimization/applicationOutput.h"
+#include "propagationAndOptimization/batchKeplerOrbit.h"
+#include "propagationAndOptimization/campaignArchive.h"
+#include "propagationAndOptimization/ephemerisTabulationCache.h"
+#include "propagationAndOptimization/gaussJacksonIntegrator.h"
+#include "propagationAndOptimization/hermiteDenseOutput.h"
+#include "propagationAndOptimization/integratorAutotuner.h"
+#include "propagationAndOptimization/spiceKernelPool.h"
+#include "propagationAndOptimization/sweepExecutor.h"
+#include "propagationAndOptimization/sweepJournal.h"
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////            USING STATEMENTS              //////////////////////////////////////////////////////
@@ -26,7 +35,7 @@ using namespace tudat::unit_conversions;
 
 
 std::shared_ptr< IntegratorSettings< > > getIntegratorSettings(
-        const int j, const int k, const double simulationStartEpoch, const double toleranceFactor, const double timeStepMultiplier = 1.0 )
+        const double j, const int k, const double simulationStartEpoch, const double toleranceFactor, const double timeStepMultiplier = 1.0 )
 {
     std::shared_ptr< IntegratorSettings< > > integratorSettings;
     if( k == 0 )
@@ -146,9 +155,263 @@ std::shared_ptr< IntegratorSettings< > > getIntegratorSettings(
                     simulationStartEpoch, timeStep,
                     std::fabs( timeStep ), std::fabs( timeStep ), 1.0, 1.0 );
     }
+    else if( k == 14 )
+    {
+        double timeStep = timeStepMultiplier * std::pow( 2.0,  static_cast< double >( 2.0 + j ) );
+        integratorSettings = std::make_shared< tudat_applications::GaussJacksonIntegratorSettings< > >(
+                    simulationStartEpoch, timeStep );
+    }
     return integratorSettings;
 }
 
+//! Function to retrieve the propagator used for a given propagator index l (see runSimulations).
+TranslationalPropagatorType getPropagatorType( const unsigned int l )
+{
+    TranslationalPropagatorType propagatorType = cowell;
+
+    if( l == 1 )
+    {
+        propagatorType = gauss_keplerian;
+    }
+    else if( l == 2 )
+    {
+        propagatorType = gauss_modified_equinoctial;
+    }
+    else if( l == 3 )
+    {
+        propagatorType = encke;
+    }
+    else if( l == 4 )
+    {
+        propagatorType = unified_state_model_quaternions;
+    }
+    else if( l == 5 )
+    {
+        propagatorType = unified_state_model_modified_rodrigues_parameters;
+    }
+    else if( l == 6 )
+    {
+        propagatorType = unified_state_model_exponential_map;
+    }
+    return propagatorType;
+}
+
+//! Function to check whether integrator k can be used with propagator l (see runSimulations).
+bool isIntegratorApplicable( const unsigned int k, const unsigned int l )
+{
+    // Gauss-Jackson integrator requires second-order equations of motion (Cowell propagator).
+    return ( k != 14 || getPropagatorType( l ) == cowell );
+}
+
+//! Function to retrieve the initial Keplerian state of the Asterix satellite, for a given eccentricity.
+Eigen::Vector6d getAsterixInitialStateInKeplerianElements( const double eccentricity )
+{
+    Eigen::Vector6d asterixInitialStateInKeplerianElements;
+    asterixInitialStateInKeplerianElements( semiMajorAxisIndex ) = 7500.0E3;
+    asterixInitialStateInKeplerianElements( eccentricityIndex ) = eccentricity;
+    asterixInitialStateInKeplerianElements( inclinationIndex ) = convertDegreesToRadians( 85.3 );
+    asterixInitialStateInKeplerianElements( argumentOfPeriapsisIndex )
+            = convertDegreesToRadians( 235.7 );
+    asterixInitialStateInKeplerianElements( longitudeOfAscendingNodeIndex )
+            = convertDegreesToRadians( 23.4 );
+    asterixInitialStateInKeplerianElements( trueAnomalyIndex ) = convertDegreesToRadians( 139.87 );
+    return asterixInitialStateInKeplerianElements;
+}
+
+//! Environment and acceleration models used by a single worker of the integrator/propagator sweep.
+struct SweepEnvironment
+{
+    //! List of bodies in the environment.
+    NamedBodyMap bodyMap;
+
+    //! Acceleration models acting on the propagated spacecraft.
+    basic_astrodynamics::AccelerationMap accelerationModelMap;
+};
+
+//! Function to create the environment and acceleration models for a single worker of the integrator/propagator sweep.
+/*!
+ *  Function to create the environment and acceleration models for a single worker of the integrator/propagator sweep. Each
+ *  worker thread uses its own copy, since the bodies cache their current state during the propagation.
+ *  \param accelerationCase Acceleration case (see runSimulations) for which the acceleration models are to be created.
+ *  \return Environment and acceleration models for a single worker.
+ */
+std::shared_ptr< SweepEnvironment > createSweepEnvironment( const unsigned int accelerationCase )
+{
+    std::shared_ptr< SweepEnvironment > sweepEnvironment = std::make_shared< SweepEnvironment >( );
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    ///////////////////////     CREATE ENVIRONMENT AND VEHICLE       //////////////////////////////////////////////////////
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+    // Create body objects.
+    std::vector< std::string > bodiesToCreate;
+    bodiesToCreate.push_back( "Earth" );
+    bodiesToCreate.push_back( "Moon" );
+    bodiesToCreate.push_back( "Sun" );
+
+    std::map< std::string, std::shared_ptr< BodySettings > > bodySettings =
+            getDefaultBodySettings( bodiesToCreate, -1.0E8, 1.0E8 );
+
+
+    // Create Earth object
+    NamedBodyMap& bodyMap = sweepEnvironment->bodyMap;
+    bodyMap = tudat_applications::createBodiesWithCachedEphemerides( bodySettings );
+
+    // Create spacecraft object.
+    bodyMap[ "Asterix" ] = std::make_shared< simulation_setup::Body >( );
+    bodyMap[ "Asterix" ]->setConstantBodyMass( 400.0 );
+
+    // Create aerodynamic coefficient interface settings.
+    double referenceArea = 4.0;
+    double aerodynamicCoefficient = 1.2;
+    std::shared_ptr< AerodynamicCoefficientSettings > aerodynamicCoefficientSettings =
+            std::make_shared< ConstantAerodynamicCoefficientSettings >(
+                referenceArea, aerodynamicCoefficient * Eigen::Vector3d::UnitX( ), 1, 1 );
+
+    // Create and set aerodynamic coefficients object
+    bodyMap[ "Asterix" ]->setAerodynamicCoefficientInterface(
+                createAerodynamicCoefficientInterface( aerodynamicCoefficientSettings, "Asterix" ) );
+
+    // Create radiation pressure settings
+    double referenceAreaRadiation = 4.0;
+    double radiationPressureCoefficient = 1.2;
+    std::vector< std::string > occultingBodies;
+    occultingBodies.push_back( "Earth" );
+    std::shared_ptr< RadiationPressureInterfaceSettings > asterixRadiationPressureSettings =
+            std::make_shared< CannonBallRadiationPressureInterfaceSettings >(
+                "Sun", referenceAreaRadiation, radiationPressureCoefficient, occultingBodies );
+
+    // Create and set radiation pressure settings
+    bodyMap[ "Asterix" ]->setRadiationPressureInterface(
+                "Sun", createRadiationPressureInterface(
+                    asterixRadiationPressureSettings, "Asterix", bodyMap ) );
+
+    // Finalize body creation.
+    setGlobalFrameBodyEphemerides( bodyMap, "Earth", "ECLIPJ2000" );
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    ///////////////////////            CREATE ACCELERATIONS          //////////////////////////////////////////////////////
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+    // Define propagator settings variables.
+    SelectedAccelerationMap accelerationMap;
+    std::vector< std::string > bodiesToPropagate;
+    std::vector< std::string > centralBodies;
+
+    bodiesToPropagate.push_back( "Asterix" );
+    centralBodies.push_back( "Earth" );
+
+    // Define propagation settings.
+    std::map< std::string, std::vector< std::shared_ptr< AccelerationSettings > > > accelerationsOfAsterix;
+
+    if( accelerationCase == 0 )
+    {
+        accelerationsOfAsterix[ "Earth" ].push_back( std::make_shared< AccelerationSettings >(
+                                                         basic_astrodynamics::central_gravity ) );
+    }
+    else if( accelerationCase == 1 )
+    {
+        accelerationsOfAsterix[ "Earth" ].push_back( std::make_shared< SphericalHarmonicAccelerationSettings >(
+                                                         5, 5 ) );
+        accelerationsOfAsterix[ "Moon" ].push_back( std::make_shared< AccelerationSettings >(
+                                                        basic_astrodynamics::central_gravity ) );
+        accelerationsOfAsterix[ "Sun" ].push_back( std::make_shared< AccelerationSettings >(
+                                                       basic_astrodynamics::central_gravity ) );
+        accelerationsOfAsterix[ "Sun" ].push_back( std::make_shared< AccelerationSettings >(
+                                                       basic_astrodynamics::cannon_ball_radiation_pressure ) );
+
+    }
+    accelerationMap[  "Asterix" ] = accelerationsOfAsterix;
+
+
+    // Create acceleration models and propagation settings.
+    sweepEnvironment->accelerationModelMap = createAccelerationModelsMap(
+                bodyMap, accelerationMap, bodiesToPropagate, centralBodies );
+
+    return sweepEnvironment;
+}
+
+//! Results of a single (i, j, k, l) cell of the sweep that are written to the summary files.
+struct SweepCellResult
+{
+    //! Number of function evaluations of the forward propagation.
+    double numberOfFunctionEvaluations;
+
+    //! Final time of backward propagation, and position difference w.r.t. initial state.
+    Eigen::Vector2d forwardBackwardError;
+
+    //! Final time and final state of forward propagation.
+    Eigen::Vector7d propagatedEndState;
+
+    //! Function to retrieve all results as a list, to be stored in a sweep journal.
+    std::vector< double > getValues( ) const
+    {
+        std::vector< double > values;
+        values.push_back( numberOfFunctionEvaluations );
+        values.insert( values.end( ), forwardBackwardError.data( ), forwardBackwardError.data( ) + 2 );
+        values.insert( values.end( ), propagatedEndState.data( ), propagatedEndState.data( ) + 7 );
+        return values;
+    }
+
+    //! Function to reset all results from a list created by getValues (e.g. read from a sweep journal).
+    void setValues( const std::vector< double >& values )
+    {
+        if( values.size( ) != 10 )
+        {
+            throw std::runtime_error( "Error, number of sweep cell results is inconsistent." );
+        }
+        numberOfFunctionEvaluations = values.at( 0 );
+        forwardBackwardError = Eigen::Map< const Eigen::Vector2d >( values.data( ) + 1 );
+        propagatedEndState = Eigen::Map< const Eigen::Vector7d >( values.data( ) + 3 );
+    }
+
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+//! Function to propagate the orbit of a sweep cell, returning the state history and the number of function evaluations.
+/*!
+ *  Function to propagate the orbit of a sweep cell with propagateToStateHistorySinks, so that the RK4, RKF and DOPRI cells
+ *  use the integrators with a compile-time Butcher tableau (and, for the Cowell propagator, fixed-size states), the
+ *  Gauss-Jackson cells use the integrator of this repository, and all other cells use the integrators of Tudat.
+ *  \param bodyMap List of bodies in the environment.
+ *  \param integratorSettings Settings for the numerical integrator.
+ *  \param propagatorSettings Settings for the propagator.
+ *  \param finalTime Final time of the propagation (equal to that of the termination settings).
+ *  \param numberOfFunctionEvaluations Number of function evaluations used in the propagation (returned by reference).
+ *  \param additionalStateHistorySinks Sinks to which the state at each step is passed during the propagation, in addition
+ *  to the sink storing the returned state history (e.g. for dense output).
+ *  \param checkpointFilePath Path of the file to which the propagation is checkpointed, and from which it is resumed if the
+ *  file exists (not used for the multi-step integrators, which cannot be resumed).
+ *  \return State history of the propagation.
+ */
+template< typename StateScalarType >
+std::map< double, Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 > > propagateSweepCell(
+        const NamedBodyMap& bodyMap,
+        const std::shared_ptr< IntegratorSettings< > > integratorSettings,
+        const std::shared_ptr< TranslationalStatePropagatorSettings< StateScalarType > > propagatorSettings,
+        const double finalTime,
+        double& numberOfFunctionEvaluations,
+        const std::vector< std::shared_ptr< tudat_applications::StateHistorySink< StateScalarType > > >&
+        additionalStateHistorySinks,
+        const std::string& checkpointFilePath )
+{
+    std::shared_ptr< tudat_applications::StoredStateHistorySink< StateScalarType > > stateHistory =
+            std::make_shared< tudat_applications::StoredStateHistorySink< StateScalarType > >( );
+    std::vector< std::shared_ptr< tudat_applications::StateHistorySink< StateScalarType > > > stateHistorySinks =
+            additionalStateHistorySinks;
+    stateHistorySinks.push_back( stateHistory );
+
+    const bool isMultiStepIntegratorUsed =
+            ( integratorSettings->integratorType_ == adamsBashforthMoulton ||
+              integratorSettings->integratorType_ == tudat_applications::gaussJacksonIntegratorType );
+    numberOfFunctionEvaluations = tudat_applications::propagateToStateHistorySinks< StateScalarType, double >(
+                bodyMap, integratorSettings, propagatorSettings, finalTime, stateHistorySinks,
+                isMultiStepIntegratorUsed ? nullptr :
+                                            std::make_shared< tudat_applications::PropagationCheckpointSettings >(
+                                                checkpointFilePath ) );
+    return stateHistory->getStateHistory( );
+}
+
 //! Execute propagation of orbit of spacecraft around the Earth.
 /*!
  *
@@ -180,23 +443,34 @@ std::shared_ptr< IntegratorSettings< > > getIntegratorSettings(
  *        11: ABM, 8th order, variable step-size
  *        12: ABM, 10th order, variable step-size
  *        13: ABM, variable order, fixed step-size
+ *        14: Gauss-Jackson, 8th order, fixed step-size (Cowell propagator only, other cells are not run; the step sizes
+ *            divide the arc exactly)
  *
  *  - l: Propagtor that is used:
  *        0: Cowell
  *        1: Gauss - Kepler
  *        2: Gauss - MEE
  *        3: Encke
+ *
+ *  For each accelerationCase, the (i, j, k, l) cells are independent, and are run in parallel by a SweepExecutor, with each
+ *  worker thread using its own environment. The only exception is the benchmark for accelerationCase 1, which is produced
+ *  by the j = 0 cells, and used by the j > 0 cells: these cells are run in two consecutive batches. The number of threads
+ *  can be set by the TUDAT_APPLICATION_THREADS environment variable.
+ *
+ *  When the sweep is resumed (TUDAT_APPLICATION_RESUME set), the completed cells are skipped, and the propagations of the
+ *  cells that were interrupted are resumed from their last checkpoint (written every 10 minutes of wall-clock time). The
+ *  propagations with the multi-step integrators (k = 9 to 14) are not checkpointed, and are restarted.
  */
-
 template< typename StateScalarType = double >
 void runSimulations( )
 {
-    unsigned int numberOfIntegrators = 14;
+    unsigned int numberOfIntegrators = 15;
     unsigned int numberOfPropagators = 7;
     unsigned int numberOfTolerances = 6;
     bool performForwardsBackwardsIntegration = true;
 
     std::string outputDirectory = tudat_applications::getOutputPath( "NumericalIntegration/" );
+    boost::filesystem::create_directories( outputDirectory );
 
     bool useLongDoubles = false;
     double toleranceFactor = 1.0;
@@ -213,104 +487,45 @@ void runSimulations( )
         std::cout<<"USING DOUBLES"<<std::endl;
     }
 
-    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-    ///////////////////////     CREATE ENVIRONMENT AND VEHICLE       //////////////////////////////////////////////////////
-    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-
     // Load Spice kernels.
-    spice_interface::loadStandardSpiceKernels( );
-
-    // Create body objects.
-    std::vector< std::string > bodiesToCreate;
-    bodiesToCreate.push_back( "Earth" );
-    bodiesToCreate.push_back( "Moon" );
-    bodiesToCreate.push_back( "Sun" );
+    tudat_applications::loadSpiceKernelSet( tudat_applications::standard_spice_kernels );
 
     double simulationStartEpoch = 0.0;
-    double simulationEndEpoch = 7.0 * tudat::physical_constants::JULIAN_DAY;
-
-    std::map< std::string, std::shared_ptr< BodySettings > > bodySettings =
-            getDefaultBodySettings( bodiesToCreate, -1.0E8, 1.0E8 );
-
 
-    // Create Earth object
-    NamedBodyMap bodyMap = createBodies( bodySettings );
-
-    // Create spacecraft object.
-    bodyMap[ "Asterix" ] = std::make_shared< simulation_setup::Body >( );
-    bodyMap[ "Asterix" ]->setConstantBodyMass( 400.0 );
-
-    // Create aerodynamic coefficient interface settings.
-    double referenceArea = 4.0;
-    double aerodynamicCoefficient = 1.2;
-    std::shared_ptr< AerodynamicCoefficientSettings > aerodynamicCoefficientSettings =
-            std::make_shared< ConstantAerodynamicCoefficientSettings >(
-                referenceArea, aerodynamicCoefficient * Eigen::Vector3d::UnitX( ), 1, 1 );
-
-    // Create and set aerodynamic coefficients object
-    bodyMap[ "Asterix" ]->setAerodynamicCoefficientInterface(
-                createAerodynamicCoefficientInterface( aerodynamicCoefficientSettings, "Asterix" ) );
-
-    // Create radiation pressure settings
-    double referenceAreaRadiation = 4.0;
-    double radiationPressureCoefficient = 1.2;
-    std::vector< std::string > occultingBodies;
-    occultingBodies.push_back( "Earth" );
-    std::shared_ptr< RadiationPressureInterfaceSettings > asterixRadiationPressureSettings =
-            std::make_shared< CannonBallRadiationPressureInterfaceSettings >(
-                "Sun", referenceAreaRadiation, radiationPressureCoefficient, occultingBodies );
-
-    // Create and set radiation pressure settings
-    bodyMap[ "Asterix" ]->setRadiationPressureInterface(
-                "Sun", createRadiationPressureInterface(
-                    asterixRadiationPressureSettings, "Asterix", bodyMap ) );
-
-    // Finalize body creation.
-    setGlobalFrameBodyEphemerides( bodyMap, "Earth", "ECLIPJ2000" );
+    tudat_applications::SweepExecutor sweepExecutor;
+    std::cout<<"Running sweep on "<<sweepExecutor.getNumberOfThreads( )<<" threads"<<std::endl;
+
+    // Create single archive for output of all cells (entry keys are equal to the former file names, without extension),
+    // and journal of completed cells. When resuming an interrupted sweep (TUDAT_APPLICATION_RESUME set), completed cells
+    // are skipped, and the output of the remaining cells is appended to the existing archive.
+    const bool resumeSweep = tudat_applications::getSweepResumeSetting( );
+    tudat_applications::CampaignArchiveWriter campaignArchive(
+                "lunarOrbiterPropagatorIntegratorSettings" + fileSuffix + ".tca", outputDirectory, resumeSweep );
+    tudat_applications::SweepJournal sweepJournal(
+                "lunarOrbiterPropagatorIntegratorSettings" + fileSuffix + ".journal", outputDirectory, resumeSweep );
+
+    // Create directory for the checkpoints of the propagations in progress, from which the cells that were interrupted
+    // are resumed (checkpoints of a previous sweep are removed if the sweep is not resumed).
+    const std::string checkpointDirectory =
+            outputDirectory + "lunarOrbiterPropagatorIntegratorSettings" + fileSuffix + "_checkpoints/";
+    if( !resumeSweep )
+    {
+        boost::filesystem::remove_all( checkpointDirectory );
+    }
+    boost::filesystem::create_directories( checkpointDirectory );
 
     for( unsigned int accelerationCase = 0; accelerationCase < 1; accelerationCase++ )
     {
-        ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-        ///////////////////////            CREATE ACCELERATIONS          //////////////////////////////////////////////////////
-        ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+        // Create environment and acceleration models separately for each worker thread.
+        tudat_applications::PerWorkerResource< SweepEnvironment > sweepEnvironments(
+                    std::bind( &createSweepEnvironment, accelerationCase ), sweepExecutor.getNumberOfThreads( ) );
 
-        // Define propagator settings variables.
-        SelectedAccelerationMap accelerationMap;
         std::vector< std::string > bodiesToPropagate;
         std::vector< std::string > centralBodies;
 
         bodiesToPropagate.push_back( "Asterix" );
         centralBodies.push_back( "Earth" );
 
-        // Define propagation settings.
-        std::map< std::string, std::vector< std::shared_ptr< AccelerationSettings > > > accelerationsOfAsterix;
-
-        if( accelerationCase == 0 )
-        {
-            accelerationsOfAsterix[ "Earth" ].push_back( std::make_shared< AccelerationSettings >(
-                                                             basic_astrodynamics::central_gravity ) );
-        }
-        else if( accelerationCase == 1 )
-        {
-            accelerationsOfAsterix[ "Earth" ].push_back( std::make_shared< SphericalHarmonicAccelerationSettings >(
-                                                             5, 5 ) );
-            accelerationsOfAsterix[ "Moon" ].push_back( std::make_shared< AccelerationSettings >(
-                                                            basic_astrodynamics::central_gravity ) );
-            accelerationsOfAsterix[ "Sun" ].push_back( std::make_shared< AccelerationSettings >(
-                                                           basic_astrodynamics::central_gravity ) );
-            accelerationsOfAsterix[ "Sun" ].push_back( std::make_shared< AccelerationSettings >(
-                                                           basic_astrodynamics::cannon_ball_radiation_pressure ) );
-
-        }
-        accelerationMap[  "Asterix" ] = accelerationsOfAsterix;
-
-
-        // Create acceleration models and propagation settings.
-        basic_astrodynamics::AccelerationMap accelerationModelMap = createAccelerationModelsMap(
-                    bodyMap, accelerationMap, bodiesToPropagate, centralBodies );
-
-
-
         ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
         ///////////////////////             CREATE PROPAGATION SETTINGS            ////////////////////////////////////////////
         ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -325,367 +540,560 @@ void runSimulations( )
             eccentricities = { 0.01, 0.1, 0.5, 0.9 };
         }
 
+        // Benchmark results per (i, k, l), filled by the j = 0 cells.
+        std::vector< std::vector< std::vector< std::map< double, Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 > > > > >
+                benchmarkResult( eccentricities.size( ) );
         for( unsigned int i = 0; i < eccentricities.size( ); i++ )
         {
-            std::vector< std::vector< std::map< double, Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 > > > > benchmarkResult;
-            benchmarkResult.resize( numberOfIntegrators );
+            benchmarkResult[ i ].resize( numberOfIntegrators );
+            for( unsigned int k = 0; k < numberOfIntegrators; k++ )
+            {
+                benchmarkResult[ i ][ k ].resize( numberOfPropagators );
+            }
+        }
+
+        // Summary results per (i, j, k, l) cell, each of which is only written by the task running that cell.
+        std::vector< SweepCellResult, Eigen::aligned_allocator< SweepCellResult > > cellResults(
+                    eccentricities.size( ) * numberOfTolerances * numberOfIntegrators * numberOfPropagators );
+        auto getCellIndex = [ & ]( const unsigned int i, const unsigned int j, const unsigned int k, const unsigned int l )
+        {
+            return ( ( i * numberOfTolerances + j ) * numberOfIntegrators + k ) * numberOfPropagators + l;
+        };
 
-            for( unsigned int j = 0; j < numberOfTolerances; j++ )
+        // Define function to run a single (i, j, k, l) cell of the sweep.
+        auto runSweepCell = [ & ]( const unsigned int i, const unsigned int j, const unsigned int k, const unsigned int l,
+                const unsigned int workerIndex )
+        {
+            SweepCellResult& cellResult = cellResults[ getCellIndex( i, j, k, l ) ];
+
+            // Skip cells completed before the sweep was interrupted (benchmark cells are always run, as their results are
+            // used by the other cells).
+            const std::string journalKey = "accSett" + boost::lexical_cast< std::string >( accelerationCase ) +
+                    "_e_" + boost::lexical_cast< std::string >( i ) +
+                    "_intType" + boost::lexical_cast< std::string >( k ) +
+                    "_intSett" + boost::lexical_cast< std::string >( j ) +
+                    "_propSett" + boost::lexical_cast< std::string >( l );
+            const bool isBenchmarkCell = ( accelerationCase == 1 && j == 0 );
+            if( !isBenchmarkCell && sweepJournal.isCompleted( journalKey ) )
             {
-                std::vector< std::map< double, double > > functionEvaluationCounter;
-                std::vector< std::map< double, Eigen::Vector2d > > forwardBackwardError;
-                std::vector< std::map< double, Eigen::Vector7d > > propagatedEndStates;
+                cellResult.setValues( sweepJournal.getCompletedCaseValues( journalKey ) );
+                return;
+            }
 
-                functionEvaluationCounter.resize( numberOfPropagators);
-                forwardBackwardError.resize( numberOfPropagators);
-                propagatedEndStates.resize( numberOfPropagators);
-                for( unsigned int k = 0; k < numberOfIntegrators; k++ )
+            {
+                std::lock_guard< std::mutex > lock( tudat_applications::getConsoleOutputMutex( ) );
+                std::cout<<accelerationCase<<" "<<i<<" "<<j<<" "<<k<<" "<<l<<std::endl;
+            }
+
+            SweepEnvironment& sweepEnvironment = sweepEnvironments.get( workerIndex );
+            const NamedBodyMap& bodyMap = sweepEnvironment.bodyMap;
+            const basic_astrodynamics::AccelerationMap& accelerationModelMap = sweepEnvironment.accelerationModelMap;
+
+            // Set initial conditions for the Asterix satellite that will be propagated in this simulation.
+            // The initial conditions are given in Keplerian elements and later on converted to Cartesian
+            // elements.
+
+            // Set Keplerian elements for Asterix.
+            Eigen::Vector6d asterixInitialStateInKeplerianElements =
+                    getAsterixInitialStateInKeplerianElements( eccentricities.at( i ) );
+
+            // Convert Asterix state from Keplerian elements to Cartesian elements.
+            double earthGravitationalParameter = bodyMap.at( "Earth" )->getGravityFieldModel( )->getGravitationalParameter( );
+            Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 > systemInitialState = convertKeplerianToCartesianElements(
+                        asterixInitialStateInKeplerianElements,
+                        earthGravitationalParameter ).template cast< StateScalarType >( );
+
+
+            // Set simulation end epoch.
+            const double simulationEndEpoch = 7.0 * tudat::physical_constants::JULIAN_DAY;
+
+            TranslationalPropagatorType propagatorType = getPropagatorType( l );
+
+            std::shared_ptr< TranslationalStatePropagatorSettings< StateScalarType > > propagatorSettings =
+                    std::make_shared< TranslationalStatePropagatorSettings< StateScalarType > >
+                    ( centralBodies, accelerationModelMap, bodiesToPropagate, systemInitialState,
+                      std::make_shared< PropagationTimeTerminationSettings >( simulationEndEpoch, true ), propagatorType );
+
+            std::shared_ptr< IntegratorSettings< > > integratorSettings = getIntegratorSettings(
+                        j, k, simulationStartEpoch, toleranceFactor, 1.0 );
+
+            ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+            ///////////////////////             PROPAGATE ORBIT            ////////////////////////////////////////////////////////
+            ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+            // Create sinks computing the dense output of the propagation at the benchmark epochs during the
+            // propagation, with interpolation orders 8 and 6 (using the accelerations from the integrator where it
+            // provides them).
+            const bool isDenseOutputComputed = ( accelerationCase == 1 && j > 0 );
+            std::shared_ptr< tudat_applications::StoredStateHistorySink< StateScalarType > > denseOutputSink =
+                    std::make_shared< tudat_applications::StoredStateHistorySink< StateScalarType > >( );
+            std::shared_ptr< tudat_applications::StoredStateHistorySink< StateScalarType > > denseOutputSink2 =
+                    std::make_shared< tudat_applications::StoredStateHistorySink< StateScalarType > >( );
+            std::vector< std::shared_ptr< tudat_applications::StateHistorySink< StateScalarType > > > denseOutputSinks;
+            if( isDenseOutputComputed )
+            {
+                std::vector< double > benchmarkEpochs;
+                benchmarkEpochs.reserve( benchmarkResult[ i ][ k ][ l ].size( ) );
+                for( typename std::map< double, Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 > >::const_iterator it =
+                     benchmarkResult[ i ][ k ][ l ].begin( ); it != benchmarkResult[ i ][ k ][ l ].end( ); it++ )
+                {
+                    benchmarkEpochs.push_back( it->first );
+                }
+                denseOutputSinks.push_back(
+                            std::make_shared< tudat_applications::DenseOutputStateHistorySink< StateScalarType > >(
+                                benchmarkEpochs, denseOutputSink, 8 ) );
+                denseOutputSinks.push_back(
+                            std::make_shared< tudat_applications::DenseOutputStateHistorySink< StateScalarType > >(
+                                benchmarkEpochs, denseOutputSink2, 6 ) );
+            }
+
+            // Propagate dynamics.
+            std::map< double, Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 > > integrationResult =
+                    propagateSweepCell< StateScalarType >( bodyMap, integratorSettings, propagatorSettings,
+                                                           simulationEndEpoch, cellResult.numberOfFunctionEvaluations,
+                                                           denseOutputSinks,
+                                                           checkpointDirectory + journalKey + "_forward.chk" );
+            Eigen::Vector7d vectorToSave;
+            vectorToSave( 0 ) = integrationResult.rbegin( )->first ;
+            vectorToSave.segment( 1, 6 ) = integrationResult.rbegin( )->second.template cast< double >( );
+            cellResult.propagatedEndState = vectorToSave;
+
+//            // Write satellite propagation history to file.
+//            input_output::writeDataMapToTextFile( integrationResult,
+//                                                  "perturbedOrbit_e_" + boost::lexical_cast< std::string >( i ) +
+//                                                  "_intType"  + boost::lexical_cast< std::string >( k ) +
+//                                                  "_intSett"  + boost::lexical_cast< std::string >( j ) +
+//                                                  "_propSett"  + boost::lexical_cast< std::string >( l ) +
+//                                                  fileSuffix +
+//                                                  ".dat",
+//                                                  outputDirectory,
+//                                                  "",
+//                                                  std::numeric_limits< double >::digits10,
+//                                                  std::numeric_limits< double >::digits10,
+//                                                  "," );
+
+            // Define tag of current cell, used in output file names.
+            std::string cellTag = "e_" + boost::lexical_cast< std::string >( i ) +
+                    "_intType"  + boost::lexical_cast< std::string >( k ) +
+                    "_intSett"  + boost::lexical_cast< std::string >( j ) +
+                    "_propSett"  + boost::lexical_cast< std::string >( l ) +
+                    fileSuffix;
+
+            // Compute analytical solution in StateScalarType, so that long double runs are compared without truncation.
+            Eigen::Matrix< StateScalarType, 6, 1 > initialStateInKeplerianElements =
+                    asterixInitialStateInKeplerianElements.template cast< StateScalarType >( );
+
+            std::map< double, StateScalarType > integrationError;
+            if( accelerationCase == 0 )
+            {
+                // Compare propagated orbit against numerical result.
+                std::vector< double > outputEpochs;
+                outputEpochs.reserve( integrationResult.size( ) );
+                for( typename std::map< double, Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 > >::const_iterator
+                     resultIterator = integrationResult.begin( );
+                     resultIterator != integrationResult.end( ); resultIterator++ )
                 {
-                    unsigned int lmax = 1;
-                    if( accelerationCase != 0 )
+                    outputEpochs.push_back( resultIterator->first );
+                }
+
+                // Compute analytical solution at all output epochs in a single pass.
+                Eigen::Matrix< StateScalarType, Eigen::Dynamic, 6 > analyticalSolution =
+                        tudat_applications::computeKeplerOrbitCartesianStates< StateScalarType >(
+                            initialStateInKeplerianElements, outputEpochs, earthGravitationalParameter );
+
+                unsigned int epochIndex = 0;
+                for( typename std::map< double, Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 > >::const_iterator
+                     resultIterator = integrationResult.begin( );
+                     resultIterator != integrationResult.end( ); resultIterator++ )
+                {
+                    integrationError[ resultIterator->first ] =
+                            ( resultIterator->second.segment( 0, 3 ) -
+                              analyticalSolution.block( epochIndex, 0, 1, 3 ).transpose( ) ).norm( );
+                    epochIndex++;
+                }
+
+                // Write satellite propagation history to file.
+                campaignArchive.addDataMap( integrationError, "numericalKeplerOrbitError_" + cellTag );
+            }
+            else if ( accelerationCase == 1 && j == 0 )
+            {
+                benchmarkResult[ i ][ k ][ l ] = integrationResult;
+
+            }
+            else if( isDenseOutputComputed )
+            {
+                std::map< double, Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 > > interpolatedResult =
+                        denseOutputSink->getStateHistory( );
+                std::map< double, Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 > > interpolatedResult2 =
+                        denseOutputSink2->getStateHistory( );
+                for( typename std::map< double, Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 > >::iterator it =
+                     interpolatedResult.begin( ); it != interpolatedResult.end( ); it++ )
+                {
+                    it->second -= benchmarkResult[ i ][ k ][ l ].at( it->first );
+                    interpolatedResult2.at( it->first ) -= benchmarkResult[ i ][ k ][ l ].at( it->first );
+                }
+
+                // Write satellite propagation history to file.
+                campaignArchive.addDataMap( interpolatedResult, "interpolatedPerturbedOrbit_" + cellTag );
+                campaignArchive.addDataMap( interpolatedResult2, "interpolatedPerturbedOrbitB_" + cellTag );
+            }
+
+            ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+            ///////////////////////        PROPAGATE BACKWARDS IN TIME                   //////////////////////////////////////////
+            ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+            if( performForwardsBackwardsIntegration )
+            {
+                double propagationEndTime = integrationResult.rbegin( )->first;
+                Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 > propagationEndState = integrationResult.rbegin( )->second;
+                Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 > newSystemInitialState = propagationEndState;
+
+                integratorSettings = getIntegratorSettings(
+                            j, k, propagationEndTime, toleranceFactor, -1.0 );
+
+                propagatorSettings =
+                        std::make_shared< TranslationalStatePropagatorSettings< StateScalarType > >
+                        ( centralBodies, accelerationModelMap, bodiesToPropagate, newSystemInitialState,
+                          std::make_shared< PropagationTimeTerminationSettings >( simulationStartEpoch, true ), propagatorType );
+
+                // Propagate dynamics.
+                double numberOfFunctionEvaluations2 = 0.0;
+                std::map< double, Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 > > integrationResult2 =
+                        propagateSweepCell< StateScalarType >( bodyMap, integratorSettings, propagatorSettings,
+                                                               simulationStartEpoch, numberOfFunctionEvaluations2, { },
+                                                               checkpointDirectory + journalKey + "_backward.chk" );
+                cellResult.forwardBackwardError =
+                        ( Eigen::Vector2d( ) << integrationResult2.begin( )->first,
+                          ( integrationResult2.begin( )->second - integrationResult.begin( )->second ).segment( 0, 3 ).
+                          template cast< double >( ).norm( ) ).finished( );
+
+//                // Write satellite propagation history to file.
+//                input_output::writeDataMapToTextFile( integrationResult2,
+//                                                      "perturbedOrbitBackward_e_" + boost::lexical_cast< std::string >( i ) +
+//                                                      "_intType"  + boost::lexical_cast< std::string >( k ) +
+//                                                      "_intSett"  + boost::lexical_cast< std::string >( j ) +
+//                                                      "_propSett"  + boost::lexical_cast< std::string >( l ) +
+//                                                      fileSuffix +
+//                                                      ".dat",
+//                                                      outputDirectory,
+//                                                      "",
+//                                                      std::numeric_limits< double >::digits10,
+//                                                      std::numeric_limits< double >::digits10,
+//                                                      "," );
+
+                {
+                    std::lock_guard< std::mutex > lock( tudat_applications::getConsoleOutputMutex( ) );
+                    std::cout<<"Forward/backward "<<
+                               integrationResult.begin( )->first<<" "<<
+                               integrationResult2.begin( )->first<<" "<<
+                               propagationEndTime<<" "<<
+                               ( integrationResult2.begin( )->second - integrationResult.begin( )->second ).transpose( )<<" "<<
+                               ( integrationResult2.rbegin( )->second - integrationResult.rbegin( )->second ).transpose( )<<std::endl;
+                }
+
+                std::map< double, StateScalarType > integrationError2;
+
+                // Compare propagated orbit against numerical result.
+
+                if( accelerationCase == 0 )
+                {
+                    std::vector< double > outputEpochs;
+                    outputEpochs.reserve( integrationResult2.size( ) );
+                    for( typename std::map< double, Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 > >::const_iterator
+                         resultIterator = integrationResult2.begin( );
+                         resultIterator != integrationResult2.end( ); resultIterator++ )
                     {
-                        lmax = numberOfPropagators;
-                        benchmarkResult[ k ].resize( numberOfPropagators);
+                        outputEpochs.push_back( resultIterator->first );
                     }
-                    else
+
+                    // Compute analytical solution at all output epochs in a single pass.
+                    Eigen::Matrix< StateScalarType, Eigen::Dynamic, 6 > analyticalSolution =
+                            tudat_applications::computeKeplerOrbitCartesianStates< StateScalarType >(
+                                initialStateInKeplerianElements, outputEpochs, earthGravitationalParameter );
+
+                    unsigned int epochIndex = 0;
+                    for( typename std::map< double, Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 > >::const_iterator
+                         resultIterator = integrationResult2.begin( );
+                         resultIterator != integrationResult2.end( ); resultIterator++ )
                     {
-                        lmax = numberOfPropagators;
-                        benchmarkResult[ k ].resize( numberOfPropagators );
+                        integrationError2[ resultIterator->first ] =
+                                ( resultIterator->second.segment( 0, 3 ) -
+                                  analyticalSolution.block( epochIndex, 0, 1, 3 ).transpose( ) ).norm( );
+                        epochIndex++;
                     }
-                    for( unsigned int l = 0; l < lmax; l++ )
+
                     {
-                        std::cout<<accelerationCase<<" "<<i<<" "<<j<<" "<<k<<" "<<l<<std::endl;
-
-                        // Set initial conditions for the Asterix satellite that will be propagated in this simulation.
-                        // The initial conditions are given in Keplerian elements and later on converted to Cartesian
-                        // elements.
-
-                        // Set Keplerian elements for Asterix.
-                        Eigen::Vector6d asterixInitialStateInKeplerianElements;
-                        asterixInitialStateInKeplerianElements( semiMajorAxisIndex ) = 7500.0E3;
-                        asterixInitialStateInKeplerianElements( eccentricityIndex ) = eccentricities.at( i );
-                        asterixInitialStateInKeplerianElements( inclinationIndex ) = convertDegreesToRadians( 85.3 );
-                        asterixInitialStateInKeplerianElements( argumentOfPeriapsisIndex )
-                                = convertDegreesToRadians( 235.7 );
-                        asterixInitialStateInKeplerianElements( longitudeOfAscendingNodeIndex )
-                                = convertDegreesToRadians( 23.4 );
-                        asterixInitialStateInKeplerianElements( trueAnomalyIndex ) = convertDegreesToRadians( 139.87 );
-
-                        // Convert Asterix state from Keplerian elements to Cartesian elements.
-                        double earthGravitationalParameter = bodyMap.at( "Earth" )->getGravityFieldModel( )->getGravitationalParameter( );
-                        Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 > systemInitialState = convertKeplerianToCartesianElements(
-                                    asterixInitialStateInKeplerianElements,
-                                    earthGravitationalParameter ).template cast< StateScalarType >( );
-
-
-                        // Set simulation end epoch.
-                        if( accelerationCase == 1 )
-                        {
-                            simulationEndEpoch = 7.0 * tudat::physical_constants::JULIAN_DAY;
-                        }
-                        else
-                        {
-                            simulationEndEpoch = 7.0 * tudat::physical_constants::JULIAN_DAY;
-                        }
+                        std::lock_guard< std::mutex > lock( tudat_applications::getConsoleOutputMutex( ) );
+                        std::cout<<"Kepler orbit error "<<integrationError2.rbegin( )->second<<std::endl;
+                    }
 
-                        TranslationalPropagatorType propagatorType = cowell;
+                    // Write forward/backward error to file.
+                    campaignArchive.addDataMap( integrationError2, "numericalKeplerOrbitErrorBack_" + cellTag );
+                }
+            }
 
-                        if( l == 1 )
-                        {
-                            propagatorType = gauss_keplerian;
-                        }
-                        else if( l == 2 )
-                        {
-                            propagatorType = gauss_modified_equinoctial;
-                        }
-                        else if( l == 3 )
-                        {
-                            propagatorType = encke;
-                        }
-                        else if( l == 4 )
-                        {
-                            propagatorType = unified_state_model_quaternions;
-                        }
-                        else if( l == 5 )
-                        {
-                            propagatorType = unified_state_model_modified_rodrigues_parameters;
-                        }
-                        else if( l == 6 )
-                        {
-                            propagatorType = unified_state_model_exponential_map;
-                        }
+            if( !isBenchmarkCell )
+            {
+                sweepJournal.markCompleted( journalKey, cellResult.getValues( ) );
+            }
+        };
 
-                        std::shared_ptr< TranslationalStatePropagatorSettings< StateScalarType > > propagatorSettings =
-                                std::make_shared< TranslationalStatePropagatorSettings< StateScalarType > >
-                                ( centralBodies, accelerationModelMap, bodiesToPropagate, systemInitialState,
-                                  std::make_shared< PropagationTimeTerminationSettings >( simulationEndEpoch, true ), propagatorType );
-
-                        std::shared_ptr< IntegratorSettings< > > integratorSettings = getIntegratorSettings(
-                                    j, k, simulationStartEpoch, toleranceFactor, 1.0 );
-
-                        ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-                        ///////////////////////             PROPAGATE ORBIT            ////////////////////////////////////////////////////////
-                        ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-
-                        // Create simulation object and propagate dynamics.
-                        SingleArcDynamicsSimulator< StateScalarType > dynamicsSimulator(
-                                    bodyMap, integratorSettings, propagatorSettings );
-
-                        functionEvaluationCounter[ l ][ k ] =
-                                dynamicsSimulator.getDynamicsStateDerivative( )->getNumberOfFunctionEvaluations( );
-
-                        std::map< double, Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 > > integrationResult =
-                                dynamicsSimulator.getEquationsOfMotionNumericalSolution( );
-                        Eigen::Vector7d vectorToSave;
-                        vectorToSave( 0 ) = integrationResult.rbegin( )->first ;
-                        vectorToSave.segment( 1, 6 ) = integrationResult.rbegin( )->second.template cast< double >( );
-                        propagatedEndStates[ l ][ k ] = vectorToSave;
-
-//                        // Write satellite propagation history to file.
-//                        input_output::writeDataMapToTextFile( integrationResult,
-//                                                              "perturbedOrbit_e_" + boost::lexical_cast< std::string >( i ) +
-//                                                              "_intType"  + boost::lexical_cast< std::string >( k ) +
-//                                                              "_intSett"  + boost::lexical_cast< std::string >( j ) +
-//                                                              "_propSett"  + boost::lexical_cast< std::string >( l ) +
-//                                                              fileSuffix +
-//                                                              ".dat",
-//                                                              outputDirectory,
-//                                                              "",
-//                                                              std::numeric_limits< double >::digits10,
-//                                                              std::numeric_limits< double >::digits10,
-//                                                              "," );
-
-                        std::map< double, double > integrationError;
-                        if( accelerationCase == 0 )
+        // Create list of tasks, where the benchmark cells (if any) are run in a separate, first batch.
+        std::vector< tudat_applications::SweepExecutor::SweepTask > benchmarkTasks;
+        std::vector< tudat_applications::SweepExecutor::SweepTask > sweepTasks;
+        for( unsigned int i = 0; i < eccentricities.size( ); i++ )
+        {
+            for( unsigned int j = 0; j < numberOfTolerances; j++ )
+            {
+                for( unsigned int k = 0; k < numberOfIntegrators; k++ )
+                {
+                    for( unsigned int l = 0; l < numberOfPropagators; l++ )
+                    {
+                        if( !isIntegratorApplicable( k, l ) )
                         {
-                            // Compare propagated orbit against numerical result.
-                            Eigen::VectorXd analyticalSolution;
-                            for( typename std::map< double, Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 > >::const_iterator
-                                 resultIterator = integrationResult.begin( );
-                                 resultIterator != integrationResult.end( ); resultIterator++ )
-                            {
-                                analyticalSolution = convertKeplerianToCartesianElements( propagateKeplerOrbit(
-                                                                                              asterixInitialStateInKeplerianElements, resultIterator->first, earthGravitationalParameter ),
-                                                                                          earthGravitationalParameter );
-                                integrationError[ resultIterator->first ] = ( resultIterator->second.template cast< double >( ) -
-                                                                              analyticalSolution ).segment( 0, 3 ).norm( );
-                            }
-
-
-                            // Write satellite propagation history to file.
-                            input_output::writeDataMapToTextFile( integrationError,
-                                                                  "numericalKeplerOrbitError_e_" + boost::lexical_cast< std::string >( i ) +
-                                                                  "_intType"  + boost::lexical_cast< std::string >( k ) +
-                                                                  "_intSett"  + boost::lexical_cast< std::string >( j ) +
-                                                                  "_propSett"  + boost::lexical_cast< std::string >( l ) +
-                                                                  fileSuffix +
-                                                                  ".dat",
-                                                                  outputDirectory,
-                                                                  "",
-                                                                  std::numeric_limits< double >::digits10,
-                                                                  std::numeric_limits< double >::digits10,
-                                                                  "," );
+                            continue;
                         }
-                        else if ( accelerationCase == 1 && j == 0 )
-                        {
-                            benchmarkResult[ k ][ l ] = integrationResult;
 
+                        tudat_applications::SweepExecutor::SweepTask currentTask =
+                                std::bind( runSweepCell, i, j, k, l, std::placeholders::_1 );
+                        if( accelerationCase == 1 && j == 0 )
+                        {
+                            benchmarkTasks.push_back( currentTask );
                         }
-                        else if( accelerationCase == 1 && j > 0 )
+                        else
                         {
-
-                            std::shared_ptr< interpolators::OneDimensionalInterpolator<
-                                    double, Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 > > > stateInterpolator =
-                                    std::make_shared< interpolators::LagrangeInterpolator<
-                                    double, Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 > > >( integrationResult, 8 );
-
-                            std::shared_ptr< interpolators::OneDimensionalInterpolator<
-                                    double, Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 > > > stateInterpolator2 =
-                                    std::make_shared< interpolators::LagrangeInterpolator<
-                                    double, Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 > > >( integrationResult, 6 );
-
-                            std::map< double, Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 > > interpolatedResult;
-                            std::map< double, Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 > > interpolatedResult2;
-
-
-                            for( typename std::map< double, Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 > >::iterator it =
-                                 benchmarkResult[ k ][ l ].begin( ); it != benchmarkResult[ k ][ l ].end( ); it++ )
-                            {
-                                interpolatedResult[ it->first ] = stateInterpolator->interpolate(
-                                            it->first ) - it->second;
-                                interpolatedResult2[ it->first ] = stateInterpolator2->interpolate(
-                                            it->first ) - it->second;
-                            }
-
-                            // Write satellite propagation history to file.
-                            input_output::writeDataMapToTextFile( interpolatedResult,
-                                                                  "interpolatedPerturbedOrbit_e_" + boost::lexical_cast< std::string >( i ) +
-                                                                  "_intType"  + boost::lexical_cast< std::string >( k ) +
-                                                                  "_intSett"  + boost::lexical_cast< std::string >( j ) +
-                                                                  "_propSett"  + boost::lexical_cast< std::string >( l ) +
-                                                                  fileSuffix +
-                                                                  ".dat",
-                                                                  outputDirectory,
-                                                                  "",
-                                                                  std::numeric_limits< double >::digits10,
-                                                                  std::numeric_limits< double >::digits10,
-                                                                  "," );
-
-                            // Write satellite propagation history to file.
-                            input_output::writeDataMapToTextFile( interpolatedResult2,
-                                                                  "interpolatedPerturbedOrbitB_e_" + boost::lexical_cast< std::string >( i ) +
-                                                                  "_intType"  + boost::lexical_cast< std::string >( k ) +
-                                                                  "_intSett"  + boost::lexical_cast< std::string >( j ) +
-                                                                  "_propSett"  + boost::lexical_cast< std::string >( l ) +
-                                                                  fileSuffix +
-                                                                  ".dat",
-                                                                  outputDirectory,
-                                                                  "",
-                                                                  std::numeric_limits< double >::digits10,
-                                                                  std::numeric_limits< double >::digits10,
-                                                                  "," );
+                            sweepTasks.push_back( currentTask );
                         }
+                    }
+                }
+            }
+        }
 
-                        ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-                        ///////////////////////        PROPAGATE BACKWARDS IN TIME                   //////////////////////////////////////////
-                        ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+        sweepExecutor.executeTasks( benchmarkTasks );
+        sweepExecutor.executeTasks( sweepTasks );
 
-                        if( performForwardsBackwardsIntegration )
+        // Write summary files per (i, j, l).
+        for( unsigned int i = 0; i < eccentricities.size( ); i++ )
+        {
+            for( unsigned int j = 0; j < numberOfTolerances; j++ )
+            {
+                for( unsigned int l = 0; l < numberOfPropagators; l++ )
+                {
+                    std::map< double, double > functionEvaluationCounter;
+                    std::map< double, Eigen::Vector2d > forwardBackwardError;
+                    std::map< double, Eigen::Vector7d > propagatedEndStates;
+                    for( unsigned int k = 0; k < numberOfIntegrators; k++ )
+                    {
+                        if( !isIntegratorApplicable( k, l ) )
                         {
-                            double propagationEndTime = integrationResult.rbegin( )->first;
-                            Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 > propagationEndState = integrationResult.rbegin( )->second;
-                            Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 > newSystemInitialState = propagationEndState;
-
-                            integratorSettings = getIntegratorSettings(
-                                        j, k, propagationEndTime, toleranceFactor, -1.0 );
-
-                            propagatorSettings =
-                                    std::make_shared< TranslationalStatePropagatorSettings< StateScalarType > >
-                                    ( centralBodies, accelerationModelMap, bodiesToPropagate, newSystemInitialState,
-                                      std::make_shared< PropagationTimeTerminationSettings >( simulationStartEpoch, true ), propagatorType );
-
-                            // Create simulation object and propagate dynamics.
-                            SingleArcDynamicsSimulator< StateScalarType > dynamicsSimulator2(
-                                        bodyMap, integratorSettings, propagatorSettings );
-                            std::map< double, Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 > > integrationResult2 =
-                                    dynamicsSimulator2.getEquationsOfMotionNumericalSolution( );
-                            forwardBackwardError[ l ][ k ] =
-                                    ( Eigen::Vector2d( ) << integrationResult2.begin( )->first,
-                                      ( integrationResult2.begin( )->second - integrationResult.begin( )->second ).segment( 0, 3 ).
-                                      template cast< double >( ).norm( ) ).finished( );
-
-//                            // Write satellite propagation history to file.
-//                            input_output::writeDataMapToTextFile( integrationResult2,
-//                                                                  "perturbedOrbitBackward_e_" + boost::lexical_cast< std::string >( i ) +
-//                                                                  "_intType"  + boost::lexical_cast< std::string >( k ) +
-//                                                                  "_intSett"  + boost::lexical_cast< std::string >( j ) +
-//                                                                  "_propSett"  + boost::lexical_cast< std::string >( l ) +
-//                                                                  fileSuffix +
-//                                                                  ".dat",
-//                                                                  outputDirectory,
-//                                                                  "",
-//                                                                  std::numeric_limits< double >::digits10,
-//                                                                  std::numeric_limits< double >::digits10,
-//                                                                  "," );
-
-
-                            std::cout<<"Forward/backward "<<
-                                       integrationResult.begin( )->first<<" "<<
-                                       integrationResult2.begin( )->first<<" "<<
-                                       propagationEndTime<<" "<<
-                                       ( integrationResult2.begin( )->second - integrationResult.begin( )->second ).transpose( )<<" "<<
-                                       ( integrationResult2.rbegin( )->second - integrationResult.rbegin( )->second ).transpose( )<<std::endl;
-
-                            std::map< double, double > integrationError2;
-
-                            // Compare propagated orbit against numerical result.
-
-                            if( accelerationCase == 0 )
-                            {
-                                Eigen::VectorXd analyticalSolution;
-                                for( typename std::map< double, Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 > >::const_iterator
-                                     resultIterator = integrationResult2.begin( );
-                                     resultIterator != integrationResult2.end( ); resultIterator++ )
-                                {
-                                    analyticalSolution = convertKeplerianToCartesianElements(
-                                                propagateKeplerOrbit(
-                                                    asterixInitialStateInKeplerianElements, resultIterator->first, earthGravitationalParameter ),
-                                                earthGravitationalParameter );
-                                    integrationError2[ resultIterator->first ] = ( resultIterator->second.template cast< double >( ) -
-                                                                                   analyticalSolution ).segment( 0, 3 ).norm( );
-                                }
-
-                                std::cout<<"Kepler orbit error "<<integrationError2.rbegin( )->second<<std::endl;
-
-                                // Write forward/backward error to file.
-                                input_output::writeDataMapToTextFile( integrationError2,
-                                                                      "numericalKeplerOrbitErrorBack_e_" + boost::lexical_cast< std::string >( i ) +
-                                                                      "_intType"  + boost::lexical_cast< std::string >( k ) +
-                                                                      "_intSett"  + boost::lexical_cast< std::string >( j ) +
-                                                                      "_propSett"  + boost::lexical_cast< std::string >( l ) +
-                                                                      fileSuffix +
-                                                                      ".dat",
-                                                                      outputDirectory,
-                                                                      "",
-                                                                      std::numeric_limits< double >::digits10,
-                                                                      std::numeric_limits< double >::digits10,
-                                                                      "," );
-                            }
+                            continue;
                         }
+
+                        const SweepCellResult& cellResult = cellResults[ getCellIndex( i, j, k, l ) ];
+                        functionEvaluationCounter[ k ] = cellResult.numberOfFunctionEvaluations;
+                        forwardBackwardError[ k ] = cellResult.forwardBackwardError;
+                        propagatedEndStates[ k ] = cellResult.propagatedEndState;
                     }
-                }
 
+                    std::string summaryTag = "_e_" + boost::lexical_cast< std::string >( i ) +
+                            "_intSett"  + boost::lexical_cast< std::string >( j ) +
+                            "_propSett"  + boost::lexical_cast< std::string >( l ) +
+                            "_accSett"  + boost::lexical_cast< std::string >( accelerationCase ) +
+                            fileSuffix;
 
-                for( int l = 0; l < numberOfPropagators; l++ )
-                {
-                    input_output::writeDataMapToTextFile( functionEvaluationCounter[ l ] ,
-                                                          "functionEvaluations_e_" + boost::lexical_cast< std::string >( i ) +
-                                                          "_intSett"  + boost::lexical_cast< std::string >( j ) +
-                                                          "_propSett"  + boost::lexical_cast< std::string >( l ) +
-                                                          "_accSett"  + boost::lexical_cast< std::string >( accelerationCase ) +
-                                                          fileSuffix +
-                                                          ".dat",
-                                                          outputDirectory,
-                                                          "",
-                                                          std::numeric_limits< double >::digits10,
-                                                          std::numeric_limits< double >::digits10,
-                                                          "," );
+                    campaignArchive.addDataMap( functionEvaluationCounter, "functionEvaluations" + summaryTag );
                     if( performForwardsBackwardsIntegration )
                     {
-                        input_output::writeDataMapToTextFile( forwardBackwardError[ l ] ,
-                                                              "forwardBackwardError_e_" + boost::lexical_cast< std::string >( i ) +
-                                                              "_intSett"  + boost::lexical_cast< std::string >( j ) +
-                                                              "_propSett"  + boost::lexical_cast< std::string >( l ) +
-                                                              "_accSett"  + boost::lexical_cast< std::string >( accelerationCase ) +
-                                                              fileSuffix +
-                                                              ".dat",
-                                                              outputDirectory,
-                                                              "",
-                                                              std::numeric_limits< double >::digits10,
-                                                              std::numeric_limits< double >::digits10,
-                                                              "," );
-                        input_output::writeDataMapToTextFile( propagatedEndStates[ l ] ,
-                                                              "propagatedEndState_e_" + boost::lexical_cast< std::string >( i ) +
-                                                              "_intSett"  + boost::lexical_cast< std::string >( j ) +
-                                                              "_propSett"  + boost::lexical_cast< std::string >( l ) +
-                                                              "_accSett"  + boost::lexical_cast< std::string >( accelerationCase ) +
-                                                              fileSuffix +
-                                                              ".dat",
-                                                              outputDirectory,
-                                                              "",
-                                                              std::numeric_limits< double >::digits10,
-                                                              std::numeric_limits< double >::digits10,
-                                                              "," );
+                        campaignArchive.addDataMap( forwardBackwardError, "forwardBackwardError" + summaryTag );
+                        campaignArchive.addDataMap( propagatedEndStates, "propagatedEndState" + summaryTag );
                     }
                 }
             }
         }
     }
 
+    campaignArchive.finalize( );
+}
+
+//! Select the cheapest integrator and propagator meeting a required position accuracy, for each eccentricity of the sweep.
+/*!
+ *  This function selects, for each eccentricity of the perturbed case (accelerationCase 1 in runSimulations), the
+ *  integrator (k), tolerance/step-size setting (j, interpolated between the values of the sweep) and propagator (l) that
+ *  meet a required position accuracy with the lowest number of function evaluations, using an IntegratorAutotuner. The
+ *  probing campaign covers all integrators, settings and propagators of the sweep, over an arc of one day, and uses RKF7(8)
+ *  at the strictest tolerance as benchmark. The selections are cached per eccentricity and accuracy in a journal in the
+ *  output directory, so that a subsequent run (or a production run with the same orbit class) does not repeat the
+ *  campaign. The probing results (k, propagator, j, function evaluations, maximum position error, Pareto-optimality) are
+ *  written to a campaign archive, and the selected settings are used to propagate the full arc of seven days.
+ *  \param requiredPositionAccuracy Required maximum position error over the probing arc.
+ */
+template< typename StateScalarType = double >
+void runIntegratorAutotuning( const double requiredPositionAccuracy )
+{
+    unsigned int numberOfIntegrators = 15;
+    unsigned int numberOfPropagators = 7;
+    unsigned int numberOfTolerances = 6;
+    unsigned int accelerationCase = 1;
+
+    std::string outputDirectory = tudat_applications::getOutputPath( "NumericalIntegration/" );
+    boost::filesystem::create_directories( outputDirectory );
+
+    double toleranceFactor = 1.0;
+    std::string fileSuffix = "";
+    if( !( sizeof( StateScalarType ) == 8 ) )
+    {
+        fileSuffix = "_long";
+        toleranceFactor = 0.01;
+    }
+
+    // Load Spice kernels.
+    tudat_applications::loadSpiceKernelSet( tudat_applications::standard_spice_kernels );
+
+    double simulationStartEpoch = 0.0;
+    const double probingEndEpoch = simulationStartEpoch + tudat::physical_constants::JULIAN_DAY;
+    const double simulationEndEpoch = 7.0 * tudat::physical_constants::JULIAN_DAY;
+
+    // Create environment and acceleration models separately for each worker thread (used for the probing arcs), and for
+    // the main thread (used for the full arcs, in between the probing campaigns).
+    tudat_applications::SweepExecutor sweepExecutor;
+    tudat_applications::PerWorkerResource< SweepEnvironment > sweepEnvironments(
+                std::bind( &createSweepEnvironment, accelerationCase ), sweepExecutor.getNumberOfThreads( ) );
+    const std::shared_ptr< SweepEnvironment > mainEnvironment = createSweepEnvironment( accelerationCase );
+
+    std::vector< std::string > bodiesToPropagate;
+    std::vector< std::string > centralBodies;
+
+    bodiesToPropagate.push_back( "Asterix" );
+    centralBodies.push_back( "Earth" );
+
+    // Create autotuner for all integrators, settings and propagators of the sweep.
+    std::vector< std::string > integratorNames =
+    { "RK4", "RKF4(5)", "RKF5(6)", "RKF7(8)", "BS4", "BS6", "BS8", "BS10", "DOPRI8(7)",
+      "ABM", "ABM6", "ABM8", "ABM10", "ABM_fixed", "GJ8" };
+    std::vector< double > probingParameterValues;
+    for( unsigned int j = 0; j < numberOfTolerances; j++ )
+    {
+        probingParameterValues.push_back( j );
+    }
+
+    std::vector< tudat_applications::IntegratorTuningCandidate< > > integratorCandidates;
+    for( unsigned int k = 0; k < numberOfIntegrators; k++ )
+    {
+        std::vector< TranslationalPropagatorType > supportedPropagatorTypes;
+        for( unsigned int l = 0; l < numberOfPropagators; l++ )
+        {
+            if( isIntegratorApplicable( k, l ) )
+            {
+                supportedPropagatorTypes.push_back( getPropagatorType( l ) );
+            }
+        }
+
+        integratorCandidates.push_back(
+                    tudat_applications::IntegratorTuningCandidate< >(
+                        integratorNames.at( k ), std::bind( &getIntegratorSettings, std::placeholders::_1, k,
+                                                            std::placeholders::_2, toleranceFactor, 1.0 ),
+                        probingParameterValues, supportedPropagatorTypes ) );
+    }
+
+    std::vector< TranslationalPropagatorType > propagatorTypes;
+    for( unsigned int l = 0; l < numberOfPropagators; l++ )
+    {
+        propagatorTypes.push_back( getPropagatorType( l ) );
+    }
+
+    tudat_applications::IntegratorAutotuner< StateScalarType > integratorAutotuner(
+                integratorCandidates, propagatorTypes,
+                "lunarOrbiterIntegratorTuning" + fileSuffix + ".journal", outputDirectory );
+    tudat_applications::CampaignArchiveWriter campaignArchive(
+                "lunarOrbiterIntegratorTuning" + fileSuffix + ".tca", outputDirectory, true );
+
+    const double earthGravitationalParameter =
+            mainEnvironment->bodyMap.at( "Earth" )->getGravityFieldModel( )->getGravitationalParameter( );
+    std::vector< double > eccentricities = { 0.01, 0.1, 0.5, 0.9 };
+    for( unsigned int i = 0; i < eccentricities.size( ); i++ )
+    {
+        Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 > systemInitialState = convertKeplerianToCartesianElements(
+                    getAsterixInitialStateInKeplerianElements( eccentricities.at( i ) ),
+                    earthGravitationalParameter ).template cast< StateScalarType >( );
+
+        // Define function to propagate the probing arc on a given worker.
+        auto probingFunction = [ & ](
+                const std::shared_ptr< IntegratorSettings< > > integratorSettings,
+                const TranslationalPropagatorType propagatorType,
+                const std::vector< std::shared_ptr< tudat_applications::StateHistorySink< StateScalarType > > >&
+                stateHistorySinks,
+                const unsigned int workerIndex )
+        {
+            SweepEnvironment& sweepEnvironment = sweepEnvironments.get( workerIndex );
+            std::shared_ptr< TranslationalStatePropagatorSettings< StateScalarType > > propagatorSettings =
+                    std::make_shared< TranslationalStatePropagatorSettings< StateScalarType > >
+                    ( centralBodies, sweepEnvironment.accelerationModelMap, bodiesToPropagate, systemInitialState,
+                      std::make_shared< PropagationTimeTerminationSettings >( probingEndEpoch, true ), propagatorType );
+            return tudat_applications::propagateToStateHistorySinks< StateScalarType, double >(
+                        sweepEnvironment.bodyMap, integratorSettings, propagatorSettings, probingEndEpoch,
+                        stateHistorySinks );
+        };
+
+        // Retrieve cached selection, or run probing campaign.
+        const std::string orbitClassKey = "lunarOrbiter_accSett" + boost::lexical_cast< std::string >( accelerationCase ) +
+                "_e" + boost::lexical_cast< std::string >( eccentricities.at( i ) );
+        tudat_applications::IntegratorTuningResult tuningResult = integratorAutotuner.getTunedSettings(
+                    orbitClassKey, requiredPositionAccuracy, probingFunction,
+                    getIntegratorSettings( 0.0, 3, simulationStartEpoch, toleranceFactor ),
+                    getIntegratorSettings( 1.0, 3, simulationStartEpoch, toleranceFactor ), sweepExecutor );
+
+        const std::vector< tudat_applications::IntegratorProbingResult >& probingResults =
+                integratorAutotuner.getProbingResults( );
+        if( probingResults.size( ) > 0 )
+        {
+            std::map< double, Eigen::Vector6d > probingResultMap;
+            for( unsigned int m = 0; m < probingResults.size( ); m++ )
+            {
+                probingResultMap[ m ] = ( Eigen::Vector6d( ) <<
+                                          probingResults.at( m ).candidateIndex_,
+                                          static_cast< double >( probingResults.at( m ).propagatorType_ ),
+                                          probingResults.at( m ).parameterValue_,
+                                          probingResults.at( m ).numberOfFunctionEvaluations_,
+                                          probingResults.at( m ).maximumPositionError_,
+                                          probingResults.at( m ).isParetoOptimal_ ).finished( );
+            }
+            campaignArchive.addDataMap( probingResultMap, "probingResults_" + orbitClassKey + fileSuffix );
+        }
+
+        // Propagate full arc with selected settings.
+        std::shared_ptr< TranslationalStatePropagatorSettings< StateScalarType > > propagatorSettings =
+                std::make_shared< TranslationalStatePropagatorSettings< StateScalarType > >
+                ( centralBodies, mainEnvironment->accelerationModelMap, bodiesToPropagate, systemInitialState,
+                  std::make_shared< PropagationTimeTerminationSettings >( simulationEndEpoch, true ),
+                  tuningResult.propagatorType_ );
+        std::shared_ptr< tudat_applications::BoundaryStateHistorySink< StateScalarType > > boundaryStates =
+                std::make_shared< tudat_applications::BoundaryStateHistorySink< StateScalarType > >( );
+        unsigned int numberOfFunctionEvaluations = tudat_applications::propagateToStateHistorySinks< StateScalarType, double >(
+                    mainEnvironment->bodyMap,
+                    integratorAutotuner.createIntegratorSettings( tuningResult, simulationStartEpoch ),
+                    propagatorSettings, simulationEndEpoch, { boundaryStates } );
+
+        std::cout<<"Eccentricity "<<eccentricities.at( i )<<": "<<
+                   integratorAutotuner.getIntegratorName( tuningResult )<<", setting "<<tuningResult.parameterValue_<<
+                   ", propagator "<<tuningResult.propagatorType_<<", predicted evaluations (probing arc) "<<
+                   tuningResult.predictedNumberOfFunctionEvaluations_<<", evaluations (full arc) "<<
+                   numberOfFunctionEvaluations<<std::endl;
+    }
+
+    campaignArchive.finalize( );
 }
 
 int main()
 {
+    // Select integrator settings for a required position accuracy (in meters) if TUDAT_APPLICATION_AUTOTUNE_ACCURACY is
+    // set, and run the full sweep otherwise.
+    const double requiredPositionAccuracy = tudat_applications::getAutotuningAccuracySetting( );
+    if( requiredPositionAccuracy > 0.0 )
+    {
+        runIntegratorAutotuning< double >( requiredPositionAccuracy );
+        return EXIT_SUCCESS;
+    }
+
     //runSimulations< double >( );
     runSimulations< double >( );
 
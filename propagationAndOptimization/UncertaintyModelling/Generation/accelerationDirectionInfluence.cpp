@@ -11,6 +11,8 @@
 #include <Tudat/SimulationSetup/tudatSimulationHeader.h>
 
 #include "propagationAndOptimization/applicationOutput.h"
+#include "propagationAndOptimization/ephemerisTabulationCache.h"
+#include "propagationAndOptimization/spiceKernelPool.h"
 
 
 //! Execute propagation of orbit of LunarOrbiter around the Earth.
@@ -37,7 +39,7 @@ int main()
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
     // Load Spice kernels.
-    spice_interface::loadStandardSpiceKernels( );
+    tudat_applications::loadSpiceKernelSet( tudat_applications::standard_spice_kernels );
 
 
     // Create body objects.
@@ -54,7 +56,7 @@ int main()
             getDefaultBodySettings( bodiesToCreate, simulationStartEpoch - 3600.0, simulationEndEpoch + 3600.0 );
 
     // Create Earth object
-    NamedBodyMap bodyMap = createBodies( bodySettings );
+    NamedBodyMap bodyMap = tudat_applications::createBodiesWithCachedEphemerides( bodySettings );
 
     // Create spacecraft object.
     bodyMap[ "LunarOrbiter" ] = std::make_shared< simulation_setup::Body >( );
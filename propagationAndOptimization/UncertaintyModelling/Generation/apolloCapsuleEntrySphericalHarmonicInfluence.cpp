@@ -13,6 +13,10 @@
 #include <Tudat/Astrodynamics/Aerodynamics/UnitTests/testApolloCapsuleCoefficients.h>
 
 #include "propagationAndOptimization/applicationOutput.h"
+#include "propagationAndOptimization/campaignArchive.h"
+#include "propagationAndOptimization/ephemerisTabulationCache.h"
+#include "propagationAndOptimization/hermiteDenseOutput.h"
+#include "propagationAndOptimization/spiceKernelPool.h"
 
 
 //! Execute propagation of orbits of Apollo during entry.
@@ -43,9 +47,10 @@ int main( )
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
     // Load Spice kernels.
-    spice_interface::loadSpiceKernelInTudat( input_output::getSpiceKernelPath( ) + "pck00009.tpc" );
-    spice_interface::loadSpiceKernelInTudat( input_output::getSpiceKernelPath( ) + "de-403-masses.tpc" );
-    spice_interface::loadSpiceKernelInTudat( input_output::getSpiceKernelPath( ) + "de421.bsp" );
+    tudat_applications::loadSpiceKernelsOnce(
+    { input_output::getSpiceKernelPath( ) + "pck00009.tpc",
+      input_output::getSpiceKernelPath( ) + "de-403-masses.tpc",
+      input_output::getSpiceKernelPath( ) + "de421.bsp" } );
 
     // Set simulation start epoch.
     const double simulationStartEpoch = 0.0;
@@ -69,7 +74,7 @@ int main( )
     bodySettings[ "Earth" ]->rotationModelSettings->resetOriginalFrame( "J2000" );
 
     // Create Earth object
-    simulation_setup::NamedBodyMap bodyMap = simulation_setup::createBodies( bodySettings );
+    simulation_setup::NamedBodyMap bodyMap = tudat_applications::createBodiesWithCachedEphemerides( bodySettings );
 
     // Create vehicle objects.
     bodyMap[ "Apollo" ] = std::make_shared< simulation_setup::Body >( );
@@ -89,6 +94,9 @@ int main( )
 
     double angleStep = mathematical_constants::PI / 10.0;
 
+    // Create single archive for output of all cases (entry keys are equal to the former file names, without extension).
+    tudat_applications::CampaignArchiveWriter campaignArchive( "reEntrySphericalHarmonicCases.tca", outputPath );
+
     for( unsigned int simulationCase = 0; simulationCase < 1; simulationCase++ )
     {
         int latitudeCase = 0;
@@ -246,75 +254,51 @@ int main( )
 
                     std::map< double, Eigen::VectorXd > stateHistoryInertialFrame =
                             dynamicsSimulator.getEquationsOfMotionNumericalSolution( );
-                    std::map< double, Eigen::VectorXd > stateHistoryEarthFixedFrame;
-
-                    for( std::map< double, Eigen::VectorXd >::const_iterator stateIterator = stateHistoryInertialFrame.begin( );
-                         stateIterator != stateHistoryInertialFrame.end( ); stateIterator++ )
-                    {
-                        stateHistoryEarthFixedFrame[ stateIterator->first ] =
-                                transformStateToTargetFrame(
-                                    Eigen::Vector6d( stateIterator->second ), stateIterator->first, earthRotationalEphemeris );
-                    }
-
-                    std::shared_ptr< interpolators::OneDimensionalInterpolator< double, Eigen::VectorXd > > inertialInterpolator =
-                            std::make_shared< interpolators::LagrangeInterpolator< double, Eigen::VectorXd > >(
-                                stateHistoryInertialFrame, 8 );
-                    std::shared_ptr< interpolators::OneDimensionalInterpolator< double, Eigen::VectorXd > > bodyFixedInterpolator =
-                            std::make_shared< interpolators::LagrangeInterpolator< double, Eigen::VectorXd > >(
-                                stateHistoryEarthFixedFrame, 8 );
-
-
-                    std::map< double, Eigen::VectorXd > interpolatedStateHistoryInertialFrame;
-                    std::map< double, Eigen::VectorXd > interpolatedStateHistoryEarthFixedFrame;
 
+                    // Compute states at 1 s intervals by dense output of the inertial state, transforming each output
+                    // state to the body-fixed frame.
+                    std::vector< double > outputEpochs;
                     double currentTime = 0;
                     double endTime = stateHistoryInertialFrame.rbegin( )->first;
                     while( currentTime < endTime )
                     {
-                        interpolatedStateHistoryInertialFrame[ currentTime ] = inertialInterpolator->interpolate( currentTime );
-                        interpolatedStateHistoryEarthFixedFrame[ currentTime ] = bodyFixedInterpolator->interpolate( currentTime );
+                        outputEpochs.push_back( currentTime );
                         currentTime += 1.0;
                     }
 
+                    std::map< double, Eigen::VectorXd > interpolatedStateHistoryInertialFrame;
+                    std::map< double, Eigen::VectorXd > interpolatedStateHistoryEarthFixedFrame;
+                    std::shared_ptr< tudat_applications::FunctionStateHistorySink< > > outputSink =
+                            std::make_shared< tudat_applications::FunctionStateHistorySink< > >(
+                                [ & ]( const double outputTime, const Eigen::VectorXd& outputState )
+                    {
+                        interpolatedStateHistoryInertialFrame[ outputTime ] = outputState;
+                        interpolatedStateHistoryEarthFixedFrame[ outputTime ] = transformStateToTargetFrame(
+                                    Eigen::Vector6d( outputState ), outputTime, earthRotationalEphemeris );
+                    } );
+                    tudat_applications::processStateHistory< double, double >(
+                                stateHistoryInertialFrame,
+                                std::make_shared< tudat_applications::DenseOutputStateHistorySink< > >(
+                                    outputEpochs, outputSink ) );
+
                     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
                     ///////////////////////        PROVIDE OUTPUT TO FILE                        //////////////////////////////////////////
                     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 
                     // Write Apollo propagation history to file.
-                    writeDataMapToTextFile( interpolatedStateHistoryInertialFrame,
-                                            "stateReEntrySphericalHarmonicCases_" +
-                                            boost::lexical_cast< std::string >( latitudeCase ) + "_" +
-                                            boost::lexical_cast< std::string >( longitudeCase ) + "_" +
-                                            boost::lexical_cast< std::string >( headingCase ) + "_" +
-                                            boost::lexical_cast< std::string >( simulationCase ) +".dat",
-                                            outputPath,
-                                            "",
-                                            std::numeric_limits< double >::digits10,
-                                            std::numeric_limits< double >::digits10,
-                                            "," );
-                    writeDataMapToTextFile( interpolatedStateHistoryEarthFixedFrame,
-                                            "bodyFixedStateReEntrySphericalHarmonicCases_" +
-                                            boost::lexical_cast< std::string >( latitudeCase ) + "_" +
-                                            boost::lexical_cast< std::string >( longitudeCase ) + "_" +
-                                            boost::lexical_cast< std::string >( headingCase ) + "_" +
-                                            boost::lexical_cast< std::string >( simulationCase ) +".dat",
-                                            outputPath,
-                                            "",
-                                            std::numeric_limits< double >::digits10,
-                                            std::numeric_limits< double >::digits10,
-                                            "," );
-                    writeDataMapToTextFile( dynamicsSimulator.getDependentVariableHistory( ),
-                                            "dependentVariablesReEntrySphericalHarmonicCases_" +
-                                            boost::lexical_cast< std::string >( latitudeCase ) + "_" +
-                                            boost::lexical_cast< std::string >( longitudeCase ) + "_" +
-                                            boost::lexical_cast< std::string >( headingCase ) + "_" +
-                                            boost::lexical_cast< std::string >( simulationCase ) +".dat",
-                                            outputPath,
-                                            "",
-                                            std::numeric_limits< double >::digits10,
-                                            std::numeric_limits< double >::digits10,
-                                            "," );
+                    std::string caseTag =
+                            boost::lexical_cast< std::string >( latitudeCase ) + "_" +
+                            boost::lexical_cast< std::string >( longitudeCase ) + "_" +
+                            boost::lexical_cast< std::string >( headingCase ) + "_" +
+                            boost::lexical_cast< std::string >( simulationCase );
+                    campaignArchive.addDataMap(
+                                interpolatedStateHistoryInertialFrame, "stateReEntrySphericalHarmonicCases_" + caseTag );
+                    campaignArchive.addDataMap(
+                                interpolatedStateHistoryEarthFixedFrame, "bodyFixedStateReEntrySphericalHarmonicCases_" + caseTag );
+                    campaignArchive.addDataMap(
+                                dynamicsSimulator.getDependentVariableHistory( ),
+                                "dependentVariablesReEntrySphericalHarmonicCases_" + caseTag );
                     headingCase++;
                 }
                 longitudeCase++;
@@ -322,6 +306,8 @@ int main( )
             latitudeCase++;
         }
     }
+    campaignArchive.finalize( );
+
     // Final statement.
     // The exit code EXIT_SUCCESS indicates that the program was successfully executed.
     return EXIT_SUCCESS;
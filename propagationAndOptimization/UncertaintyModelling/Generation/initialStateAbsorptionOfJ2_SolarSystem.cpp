@@ -17,6 +17,7 @@
 #include <Tudat/SimulationSetup/EstimationSetup/determinePostFitParameterInfluence.h>
 
 #include "propagationAndOptimization/applicationOutput.h"
+#include "propagationAndOptimization/spiceKernelPool.h"
 
 int main( )
 {
@@ -38,7 +39,7 @@ int main( )
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
     // Load Spice kernels.
-    spice_interface::loadStandardSpiceKernels( );
+    tudat_applications::loadSpiceKernelSet( tudat_applications::standard_spice_kernels );
 
     double simulationStartEpoch = 0.0;
     double simulationEndEpoch = 25.0 * physical_constants::JULIAN_YEAR;
@@ -11,33 +11,193 @@
 #include <Tudat/SimulationSetup/tudatEstimationHeader.h>
 
 #include "propagationAndOptimization/applicationOutput.h"
+#include "propagationAndOptimization/environmentSnapshot.h"
+#include "propagationAndOptimization/flatStateHistory.h"
+#include "propagationAndOptimization/linearizedCovariancePropagation.h"
+#include "propagationAndOptimization/packedSphericalHarmonicsAcceleration.h"
+#include "propagationAndOptimization/spiceKernelPool.h"
+#include "propagationAndOptimization/stateHistorySink.h"
+#include "propagationAndOptimization/sweepExecutor.h"
+#include "propagationAndOptimization/uncertaintySampling.h"
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////            USING STATEMENTS              //////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+using namespace tudat;
+using namespace tudat::simulation_setup;
+using namespace tudat::propagators;
+using namespace tudat::numerical_integrators;
+using namespace tudat::orbital_element_conversions;
+using namespace tudat::basic_mathematics;
+using namespace tudat::gravitation;
+using namespace tudat::numerical_integrators;
+using namespace tudat::estimatable_parameters;
+using namespace tudat::ephemerides;
+using namespace tudat::statistics;
+
+//! Function to add a spacecraft with the properties of Asterix to the body map, under a given name.
+void addAsterixVehicleToBodyMap( NamedBodyMap& bodyMap, const std::string& vehicleName )
+{
+    // Create spacecraft object.
+    bodyMap[ vehicleName ] = std::make_shared< simulation_setup::Body >( );
+    bodyMap[ vehicleName ]->setConstantBodyMass( 400.0 );
+
+    bodyMap[ vehicleName ]->setEphemeris( std::make_shared< TabulatedCartesianEphemeris< > >(
+                                            std::shared_ptr< interpolators::OneDimensionalInterpolator
+                                            < double, Eigen::Vector6d > >( ), "Earth", "J2000" ) );
+
+    // Create aerodynamic coefficient interface settings.
+    double referenceArea = 4.0;
+    double aerodynamicCoefficient = 1.2;
+    std::shared_ptr< AerodynamicCoefficientSettings > aerodynamicCoefficientSettings =
+            std::make_shared< ConstantAerodynamicCoefficientSettings >(
+                referenceArea, aerodynamicCoefficient * Eigen::Vector3d::UnitX( ), 1, 1 );
+
+    // Create and set aerodynamic coefficients object
+    bodyMap[ vehicleName ]->setAerodynamicCoefficientInterface(
+                createAerodynamicCoefficientInterface( aerodynamicCoefficientSettings, vehicleName ) );
+
+    // Create radiation pressure settings
+    double referenceAreaRadiation = 4.0;
+    double radiationPressureCoefficient = 1.2;
+    std::vector< std::string > occultingBodies;
+    occultingBodies.push_back( "Earth" );
+    std::shared_ptr< RadiationPressureInterfaceSettings > asterixRadiationPressureSettings =
+            std::make_shared< CannonBallRadiationPressureInterfaceSettings >(
+                "Sun", referenceAreaRadiation, radiationPressureCoefficient, occultingBodies );
+
+    // Create and set radiation pressure settings
+    bodyMap[ vehicleName ]->setRadiationPressureInterface(
+                "Sun", createRadiationPressureInterface(
+                    asterixRadiationPressureSettings, vehicleName, bodyMap ) );
+}
 
-int main( )
+//! Function to add the Asterix spacecraft to the body map, and finalize its creation.
+void addAsterixToBodyMap( NamedBodyMap& bodyMap )
 {
-    std::string outputPath = tudat_applications::getOutputPath( "UncertaintyModelling/" );
+    addAsterixVehicleToBodyMap( bodyMap, "Asterix" );
 
-    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-    ///////////////////////            USING STATEMENTS              //////////////////////////////////////////////////////
-    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // Finalize body creation.
+    setGlobalFrameBodyEphemerides( bodyMap, "SSB", "J2000" );
+}
+
+//! Function to retrieve the name of a member of an ensemble of Asterix copies.
+std::string getAsterixEnsembleMemberName( const unsigned int memberIndex )
+{
+    return "Asterix_" + std::to_string( memberIndex );
+}
+
+//! Function to add an ensemble of copies of the Asterix spacecraft to the body map, and finalize its creation.
+void addAsterixEnsembleToBodyMap( NamedBodyMap& bodyMap, const unsigned int ensembleSize )
+{
+    for( unsigned int i = 0; i < ensembleSize; i++ )
+    {
+        addAsterixVehicleToBodyMap( bodyMap, getAsterixEnsembleMemberName( i ) );
+    }
+
+    // Finalize body creation.
+    setGlobalFrameBodyEphemerides( bodyMap, "SSB", "J2000" );
+}
+
+//! Function to create the acceleration models acting on Asterix (or on a list of copies of Asterix).
+/*!
+ *  Function to create the acceleration models acting on Asterix (or on a list of copies of Asterix). If requested, the
+ *  spherical harmonic acceleration is evaluated by a packed model, which computes the accelerations of all copies together
+ *  (this model does not support variational equations).
+ */
+basic_astrodynamics::AccelerationMap createAsterixAccelerationModels(
+        const NamedBodyMap& bodyMap, const std::vector< std::string >& vehicleNames = { "Asterix" },
+        const bool usePackedSphericalHarmonics = false )
+{
+    // Define propagator settings variables.
+    SelectedAccelerationMap accelerationMap;
+    std::vector< std::string > bodiesToPropagate;
+    std::vector< std::string > centralBodies;
+
+    // Define propagation settings.
+    std::map< std::string, std::vector< std::shared_ptr< AccelerationSettings > > > accelerationsOfAsterix;
+    if( usePackedSphericalHarmonics )
+    {
+        accelerationsOfAsterix[ "Earth" ].push_back(
+                    std::make_shared< tudat_applications::PackedSphericalHarmonicAccelerationSettings >( 4, 4 ) );
+    }
+    else
+    {
+        accelerationsOfAsterix[ "Earth" ].push_back( std::make_shared< SphericalHarmonicAccelerationSettings >( 4, 4 ) );
+    }
 
-    using namespace tudat;
-    using namespace tudat::simulation_setup;
-    using namespace tudat::propagators;
-    using namespace tudat::numerical_integrators;
-    using namespace tudat::orbital_element_conversions;
-    using namespace tudat::basic_mathematics;
-    using namespace tudat::gravitation;
-    using namespace tudat::numerical_integrators;
-    using namespace tudat::estimatable_parameters;
-    using namespace tudat::ephemerides;
-    using namespace tudat::statistics;
+    accelerationsOfAsterix[ "Sun" ].push_back( std::make_shared< AccelerationSettings >(
+                                                   basic_astrodynamics::central_gravity ) );
+    accelerationsOfAsterix[ "Moon" ].push_back( std::make_shared< AccelerationSettings >(
+                                                    basic_astrodynamics::central_gravity ) );
+    accelerationsOfAsterix[ "Mars" ].push_back( std::make_shared< AccelerationSettings >(
+                                                    basic_astrodynamics::central_gravity ) );
+    accelerationsOfAsterix[ "Venus" ].push_back( std::make_shared< AccelerationSettings >(
+                                                     basic_astrodynamics::central_gravity ) );
+    accelerationsOfAsterix[ "Sun" ].push_back( std::make_shared< AccelerationSettings >(
+                                                   basic_astrodynamics::cannon_ball_radiation_pressure ) );
+    accelerationsOfAsterix[ "Earth" ].push_back( std::make_shared< AccelerationSettings >(
+                                                     basic_astrodynamics::aerodynamic ) );
+
+    for( unsigned int i = 0; i < vehicleNames.size( ); i++ )
+    {
+        accelerationMap[ vehicleNames.at( i ) ] = accelerationsOfAsterix;
+        bodiesToPropagate.push_back( vehicleNames.at( i ) );
+        centralBodies.push_back( "Earth" );
+    }
+
+    return tudat_applications::createAccelerationModelsMapWithPackedSphericalHarmonics(
+                bodyMap, accelerationMap, bodiesToPropagate, centralBodies );
+}
+
+//! Function to create the settings of the uncertain model parameters of (a copy of) the Asterix vehicle.
+std::vector< std::shared_ptr< EstimatableParameterSettings > > getAsterixVehicleParameterNames(
+        const std::string& vehicleName = "Asterix" )
+{
+    std::vector< std::shared_ptr< EstimatableParameterSettings > > parameterNames;
+    parameterNames.push_back( std::make_shared< EstimatableParameterSettings >( vehicleName, radiation_pressure_coefficient ) );
+    parameterNames.push_back( std::make_shared< EstimatableParameterSettings >( vehicleName, constant_drag_coefficient ) );
+    return parameterNames;
+}
+
+//! Function to create the settings of the uncertain gravity field coefficients of the Earth.
+std::vector< std::shared_ptr< EstimatableParameterSettings > > getEarthGravityFieldParameterNames( )
+{
+    std::vector< std::shared_ptr< EstimatableParameterSettings > > parameterNames;
+    parameterNames.push_back( std::make_shared< SphericalHarmonicEstimatableParameterSettings >(
+                                  2, 0, 2, 2, "Earth", spherical_harmonics_cosine_coefficient_block ) );
+    parameterNames.push_back( std::make_shared< SphericalHarmonicEstimatableParameterSettings >(
+                                  2, 1, 2, 2, "Earth", spherical_harmonics_sine_coefficient_block ) );
+    return parameterNames;
+}
+
+//! Function to create the settings of the (non-initial state) model parameters of which the uncertainty is considered.
+std::vector< std::shared_ptr< EstimatableParameterSettings > > getAsterixModelParameterNames(
+        const std::string& vehicleName = "Asterix" )
+{
+    std::vector< std::shared_ptr< EstimatableParameterSettings > > parameterNames =
+            getAsterixVehicleParameterNames( vehicleName );
+    std::vector< std::shared_ptr< EstimatableParameterSettings > > gravityFieldParameterNames =
+            getEarthGravityFieldParameterNames( );
+    parameterNames.insert( parameterNames.end( ), gravityFieldParameterNames.begin( ), gravityFieldParameterNames.end( ) );
+    return parameterNames;
+}
+
+int main( )
+{
+    std::string outputPath = tudat_applications::getOutputPath( "UncertaintyModelling/" );
+    boost::filesystem::create_directories( outputPath );
 
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     ///////////////////////     CREATE ENVIRONMENT AND VEHICLE       //////////////////////////////////////////////////////
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
     // Load Spice kernels.
-    spice_interface::loadStandardSpiceKernels( );
+    tudat_applications::loadSpiceKernelSet( tudat_applications::standard_spice_kernels );
+
+    // Create executor for Monte Carlo runs (number of threads set by TUDAT_APPLICATION_THREADS environment variable).
+    tudat_applications::SweepExecutor sweepExecutor;
 
     for( int runCase = 0; runCase < 4; runCase++ )
     {
@@ -69,81 +229,21 @@ int main( )
             bodySettings[ bodiesToCreate.at( i ) ]->ephemerisSettings->resetFrameOrientation( "J2000" );
             bodySettings[ bodiesToCreate.at( i ) ]->rotationModelSettings->resetOriginalFrame( "J2000" );
         }
-        NamedBodyMap bodyMap = createBodies( bodySettings );
-
-        ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-        ///////////////////////             CREATE VEHICLE            /////////////////////////////////////////////////////////
-        ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-
-        // Create spacecraft object.
-        bodyMap[ "Asterix" ] = std::make_shared< simulation_setup::Body >( );
-        bodyMap[ "Asterix" ]->setConstantBodyMass( 400.0 );
-
-        bodyMap[ "Asterix" ]->setEphemeris( std::make_shared< TabulatedCartesianEphemeris< > >(
-                                                std::shared_ptr< interpolators::OneDimensionalInterpolator
-                                                < double, Eigen::Vector6d > >( ), "Earth", "J2000" ) );
-
-        // Create aerodynamic coefficient interface settings.
-        double referenceArea = 4.0;
-        double aerodynamicCoefficient = 1.2;
-        std::shared_ptr< AerodynamicCoefficientSettings > aerodynamicCoefficientSettings =
-                std::make_shared< ConstantAerodynamicCoefficientSettings >(
-                    referenceArea, aerodynamicCoefficient * Eigen::Vector3d::UnitX( ), 1, 1 );
-
-        // Create and set aerodynamic coefficients object
-        bodyMap[ "Asterix" ]->setAerodynamicCoefficientInterface(
-                    createAerodynamicCoefficientInterface( aerodynamicCoefficientSettings, "Asterix" ) );
-
-        // Create radiation pressure settings
-        double referenceAreaRadiation = 4.0;
-        double radiationPressureCoefficient = 1.2;
-        std::vector< std::string > occultingBodies;
-        occultingBodies.push_back( "Earth" );
-        std::shared_ptr< RadiationPressureInterfaceSettings > asterixRadiationPressureSettings =
-                std::make_shared< CannonBallRadiationPressureInterfaceSettings >(
-                    "Sun", referenceAreaRadiation, radiationPressureCoefficient, occultingBodies );
-
-        // Create and set radiation pressure settings
-        bodyMap[ "Asterix" ]->setRadiationPressureInterface(
-                    "Sun", createRadiationPressureInterface(
-                        asterixRadiationPressureSettings, "Asterix", bodyMap ) );
-
 
-        // Finalize body creation.
-        setGlobalFrameBodyEphemerides( bodyMap, "SSB", "J2000" );
+        // Create snapshot of environment, from which the nominal and per-thread environments are created.
+        tudat_applications::EnvironmentSnapshot environmentSnapshot( bodySettings, &addAsterixToBodyMap );
+        NamedBodyMap bodyMap = environmentSnapshot.createBodyMap( );
 
         ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
         ///////////////////////            CREATE ACCELERATIONS          //////////////////////////////////////////////////////
         ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-        // Define propagator settings variables.
-        SelectedAccelerationMap accelerationMap;
         std::vector< std::string > bodiesToPropagate;
         std::vector< std::string > centralBodies;
-
-        // Define propagation settings.
-        std::map< std::string, std::vector< std::shared_ptr< AccelerationSettings > > > accelerationsOfAsterix;
-        accelerationsOfAsterix[ "Earth" ].push_back( std::make_shared< SphericalHarmonicAccelerationSettings >( 4, 4 ) );
-
-        accelerationsOfAsterix[ "Sun" ].push_back( std::make_shared< AccelerationSettings >(
-                                                       basic_astrodynamics::central_gravity ) );
-        accelerationsOfAsterix[ "Moon" ].push_back( std::make_shared< AccelerationSettings >(
-                                                        basic_astrodynamics::central_gravity ) );
-        accelerationsOfAsterix[ "Mars" ].push_back( std::make_shared< AccelerationSettings >(
-                                                        basic_astrodynamics::central_gravity ) );
-        accelerationsOfAsterix[ "Venus" ].push_back( std::make_shared< AccelerationSettings >(
-                                                         basic_astrodynamics::central_gravity ) );
-        accelerationsOfAsterix[ "Sun" ].push_back( std::make_shared< AccelerationSettings >(
-                                                       basic_astrodynamics::cannon_ball_radiation_pressure ) );
-        accelerationsOfAsterix[ "Earth" ].push_back( std::make_shared< AccelerationSettings >(
-                                                         basic_astrodynamics::aerodynamic ) );
-
-        accelerationMap[ "Asterix" ] = accelerationsOfAsterix;
         bodiesToPropagate.push_back( "Asterix" );
         centralBodies.push_back( "Earth" );
 
-        basic_astrodynamics::AccelerationMap accelerationModelMap = createAccelerationModelsMap(
-                    bodyMap, accelerationMap, bodiesToPropagate, centralBodies );
+        basic_astrodynamics::AccelerationMap accelerationModelMap = createAsterixAccelerationModels( bodyMap );
 
         ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
         ///////////////////////             CREATE PROPAGATION SETTINGS            ////////////////////////////////////////////
@@ -178,12 +278,9 @@ int main( )
         std::vector< std::shared_ptr< EstimatableParameterSettings > > parameterNames;
         parameterNames.push_back( std::make_shared< InitialTranslationalStateEstimatableParameterSettings< double > >(
                                       "Asterix", asterixInitialState, "Earth" ) );
-        parameterNames.push_back( std::make_shared< EstimatableParameterSettings >( "Asterix", radiation_pressure_coefficient ) );
-        parameterNames.push_back( std::make_shared< EstimatableParameterSettings >( "Asterix", constant_drag_coefficient ) );
-        parameterNames.push_back( std::make_shared< SphericalHarmonicEstimatableParameterSettings >(
-                                      2, 0, 2, 2, "Earth", spherical_harmonics_cosine_coefficient_block ) );
-        parameterNames.push_back( std::make_shared< SphericalHarmonicEstimatableParameterSettings >(
-                                      2, 1, 2, 2, "Earth", spherical_harmonics_sine_coefficient_block ) );
+        std::vector< std::shared_ptr< EstimatableParameterSettings > > modelParameterNames =
+                getAsterixModelParameterNames( );
+        parameterNames.insert( parameterNames.end( ), modelParameterNames.begin( ), modelParameterNames.end( ) );
 
         // Create parameters
         std::shared_ptr< estimatable_parameters::EstimatableParameterSet< double > > parametersToEstimate =
@@ -212,6 +309,24 @@ int main( )
                     integrationResult, "monteCarloNominalResult_" + std::to_string( runCase ) + "_" +
                                                + ".dat", outputPath );
 
+        // Store nominal states, and partials of nominal states w.r.t. the sampled uncertainties (initial position and model
+        // parameters), as contiguous histories for (read-only) look-up during the Monte Carlo runs.
+        const int numberOfModelParameters = sensitivityResult.begin( )->second.cols( );
+        const int numberOfUncertainties = 3 + numberOfModelParameters;
+        tudat_applications::FlatStateHistory< > nominalStateHistory( integrationResult );
+        tudat_applications::FlatStateHistory< > nominalPartialsHistory( 6 * numberOfUncertainties );
+        nominalPartialsHistory.reserve( stateTransitionResult.size( ) );
+        for( auto stateTransitionIterator = stateTransitionResult.begin( );
+             stateTransitionIterator != stateTransitionResult.end( ); stateTransitionIterator++ )
+        {
+            Eigen::MatrixXd partials = Eigen::MatrixXd( 6, numberOfUncertainties );
+            partials.block( 0, 0, 6, 3 ) = stateTransitionIterator->second.block( 0, 0, 6, 3 );
+            partials.block( 0, 3, 6, numberOfModelParameters ) = sensitivityResult.at( stateTransitionIterator->first );
+            nominalPartialsHistory.push_back(
+                        stateTransitionIterator->first,
+                        Eigen::Map< Eigen::VectorXd >( partials.data( ), 6 * numberOfUncertainties ) );
+        }
+
         double errorMagnitude;
         if( runCase == 0 || runCase == 2 )
         {
@@ -221,56 +336,229 @@ int main( )
         {
             errorMagnitude = 1.0;
         }
-        std::function< double( ) > initialPositionErrorFunction = createBoostContinuousRandomVariableGeneratorFunction(
-                    normal_boost_distribution, { 0.0, errorMagnitude }, 0.0 );
 
-        Eigen::MatrixXd outputMap = Eigen::MatrixXd( 6, 4 );
-        for( unsigned int i = 0; i < 100; i++ )
+        ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+        ///////////////////////             PROPAGATE LINEARIZED COVARIANCE           /////////////////////////////////////////
+        ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+        // Set covariance of initial position, and a priori uncertainties of the (consider) parameters: radiation pressure
+        // and drag coefficients, C20, C21, C22, S21, S22 (all of which are sampled in the Monte Carlo runs).
+        Eigen::MatrixXd initialStateCovariance = Eigen::MatrixXd::Zero( 6, 6 );
+        initialStateCovariance.block( 0, 0, 3, 3 ) = errorMagnitude * errorMagnitude * Eigen::Matrix3d::Identity( );
+
+        Eigen::VectorXd parameterStandardDeviations = Eigen::VectorXd( 7 );
+        parameterStandardDeviations << 0.1, 0.1, 1.0E-10, 1.0E-10, 1.0E-10, 1.0E-10, 1.0E-10;
+        if( numberOfModelParameters != parameterStandardDeviations.rows( ) )
         {
-            std::cout<<"RUN: "<<i<<std::endl;
-            Eigen::Vector3d currentInitialPositionError;
-            currentInitialPositionError( 0 ) = initialPositionErrorFunction( );
-            currentInitialPositionError( 1 ) = initialPositionErrorFunction( );
-            currentInitialPositionError( 2 ) = initialPositionErrorFunction( );
-
-            Eigen::VectorXd perturbedInitialState = asterixInitialState;
-            perturbedInitialState.segment( 0, 3 ) += currentInitialPositionError;
-
-            std::shared_ptr< TranslationalStatePropagatorSettings< double > > perturbedPropagatorSettings =
-                    std::make_shared< TranslationalStatePropagatorSettings< double > >(
-                        centralBodies, accelerationModelMap, bodiesToPropagate, perturbedInitialState, simulationEndEpoch );
-
-            SingleArcDynamicsSimulator< > perturbedDynamicsSimulator( bodyMap, integratorSettings, perturbedPropagatorSettings );
-            std::map< double, Eigen::VectorXd > perturbedIntegrationResult =
-                    perturbedDynamicsSimulator.getEquationsOfMotionNumericalSolution( );
-            std::map< double, Eigen::VectorXd > linearizationError;
-            for( auto stateIterator : perturbedIntegrationResult )
+            throw std::runtime_error( "Error, number of parameter uncertainties is inconsistent with sensitivity matrix." );
+        }
+
+        // Propagate covariance, without and with parameter uncertainties.
+        tudat_applications::FlatStateHistory< > initialStateCovarianceHistory =
+                tudat_applications::propagateCovariance( initialStateCovariance, stateTransitionResult );
+        tudat_applications::FlatStateHistory< > fullCovarianceHistory =
+                tudat_applications::propagateCovariance(
+                    tudat_applications::createBlockDiagonalCovariance(
+                        initialStateCovariance, parameterStandardDeviations.cwiseAbs2( ).asDiagonal( ).toDenseMatrix( ) ),
+                    stateTransitionResult, sensitivityResult );
+
+        tudat_applications::writeDataMapToBinaryFile(
+                    initialStateCovarianceHistory, "linearizedCovariance_" + std::to_string( runCase ) + ".dat",
+                    outputPath, "initialStatePerturbationCloud" );
+        tudat_applications::writeDataMapToBinaryFile(
+                    fullCovarianceHistory, "linearizedCovarianceWithParameters_" + std::to_string( runCase ) + ".dat",
+                    outputPath, "initialStatePerturbationCloud" );
+        input_output::writeDataMapToTextFile(
+                    tudat_applications::computeFormalErrorHistory( fullCovarianceHistory ).toMap( ),
+                    "linearizedFormalErrorsWithParameters_" + std::to_string( runCase ) + ".dat", outputPath );
+
+        // Check linearity by sampling only if the linearized position spread (including the parameter uncertainties) is large
+        // enough for the linearization error to be relevant.
+        const double maximumPositionSpread =
+                tudat_applications::computeMaximumPositionStandardDeviation( fullCovarianceHistory );
+        const double linearityCheckThreshold = tudat_applications::getLinearityCheckThreshold( 1.0E3 );
+        std::cout<<"Maximum linearized position spread: "<<maximumPositionSpread<<" m"<<std::endl;
+        if( maximumPositionSpread < linearityCheckThreshold )
+        {
+            std::cout<<"Spread below linearity check threshold of "<<linearityCheckThreshold<<
+                       " m, skipping Monte Carlo runs"<<std::endl;
+            continue;
+        }
+
+        ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+        ///////////////////////          PROPAGATE PERTURBED ORBITS FOR LINEARITY CHECK       /////////////////////////////////
+        ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+        // Divide runs over ensembles, in which all members are propagated in lock-step in a single simulation. The
+        // environment (ephemerides, Earth rotation) is then updated once per function evaluation for all members of an
+        // ensemble, and only the state-dependent accelerations are computed per member. Since the integrator uses a fixed
+        // step, each member follows the same steps as a separate propagation, and its result differs from it only by
+        // rounding errors (see unitTestEnsemblePropagation.cpp). The members of an ensemble share the gravity field of the
+        // Earth, so that the gravity field coefficients are sampled per ensemble, and the initial position and vehicle
+        // parameters (radiation pressure and drag coefficients) per member.
+        const unsigned int numberOfEnsembles = 10;
+        const unsigned int ensembleSize = 10;
+        const unsigned int numberOfRuns = numberOfEnsembles * ensembleSize;
+        const int numberOfVehicleParameters = 2;
+        const int numberOfGravityFieldParameters = numberOfModelParameters - numberOfVehicleParameters;
+
+        // Draw all perturbations of the uncertain vector (initial position, followed by the model parameters, with the
+        // uncertainties of the linearized covariance) before starting the (parallel) runs, so that they do not depend on
+        // the number of threads. The perturbations are drawn from Sobol sequences (mapped to the normal distribution of
+        // each entry), which cover the distribution more evenly than independent pseudo-random draws: one for the
+        // gravity field coefficients of the ensembles, and one for the initial position and vehicle parameters of the
+        // members.
+        std::vector< std::shared_ptr< InvertibleContinuousProbabilityDistribution< double > > > memberDistributions(
+                    3, createBoostRandomVariable( normal_boost_distribution, { 0.0, errorMagnitude } ) );
+        std::vector< std::shared_ptr< InvertibleContinuousProbabilityDistribution< double > > > ensembleDistributions;
+        for( int i = 0; i < numberOfModelParameters; i++ )
+        {
+            std::shared_ptr< InvertibleContinuousProbabilityDistribution< double > > parameterDistribution =
+                    createBoostRandomVariable( normal_boost_distribution, { 0.0, parameterStandardDeviations( i ) } );
+            if( i < numberOfVehicleParameters )
             {
-                linearizationError[ stateIterator.first ] =
-                    perturbedIntegrationResult[ stateIterator.first ] - integrationResult[ stateIterator.first ] -
-                        stateTransitionResult[ stateIterator.first ].block( 0, 0, 6, 3 ) * currentInitialPositionError;
+                memberDistributions.push_back( parameterDistribution );
             }
+            else
+            {
+                ensembleDistributions.push_back( parameterDistribution );
+            }
+        }
+        std::function< Eigen::VectorXd( ) > ensembleSampleFunction =
+                tudat_applications::createVectorRandomVariableGeneratorFunction(
+                    ensembleDistributions, tudat_applications::sobol_sampling, numberOfEnsembles );
+        std::function< Eigen::VectorXd( ) > memberSampleFunction =
+                tudat_applications::createVectorRandomVariableGeneratorFunction(
+                    memberDistributions, tudat_applications::sobol_sampling, numberOfRuns );
+        std::vector< Eigen::VectorXd > uncertaintySamples( numberOfRuns );
+        for( unsigned int ensembleIndex = 0; ensembleIndex < numberOfEnsembles; ensembleIndex++ )
+        {
+            const Eigen::VectorXd ensembleSample = ensembleSampleFunction( );
+            for( unsigned int j = 0; j < ensembleSize; j++ )
+            {
+                Eigen::VectorXd& uncertaintySample = uncertaintySamples[ ensembleIndex * ensembleSize + j ];
+                uncertaintySample = Eigen::VectorXd( numberOfUncertainties );
+                uncertaintySample.segment( 0, 3 + numberOfVehicleParameters ) = memberSampleFunction( );
+                uncertaintySample.segment( 3 + numberOfVehicleParameters, numberOfGravityFieldParameters ) = ensembleSample;
+            }
+        }
+
+        tudat_applications::EnvironmentSnapshot ensembleEnvironmentSnapshot(
+                    bodySettings, std::bind( &addAsterixEnsembleToBodyMap, std::placeholders::_1, ensembleSize ) );
 
-            outputMap.block( 0, 0, 3, 1 ) = currentInitialPositionError;
-            outputMap.block( 0, 1, 6, 1 ) = stateTransitionResult.rbegin( )->second.block( 0, 0, 6, 3 ) * currentInitialPositionError;
-            outputMap.block( 0, 2, 6, 1 ) = perturbedIntegrationResult.rbegin( )->second - integrationResult.rbegin( )->second;
-            outputMap.block( 0, 3, 6, 1 ) = perturbedIntegrationResult.rbegin( )->second;
-
-            input_output::writeMatrixToFile(
-                        outputMap, "monteCarloInitialState_" +
-                        std::to_string( runCase ) + "_" +
-                        std::to_string( i ) + ".dat", 16, outputPath );
-
-            //        std::cout<<( stateTransitionResult.rbegin( )->second.block( 0, 0, 6, 3 ) * currentInitialPositionError ).transpose( )<<std::endl;
-            //        std::cout<<( perturbedIntegrationResult.rbegin( )->second - integrationResult.rbegin( )->second ).transpose( )<<std::endl;
-            //        std::cout<<( stateTransitionResult.rbegin( )->second.block( 0, 0, 6, 3 ) * currentInitialPositionError ).transpose( )  -
-            //                   ( perturbedIntegrationResult.rbegin( )->second - integrationResult.rbegin( )->second ).transpose( )<<std::endl<<std::endl;
-
-            input_output::writeDataMapToTextFile(
-                        linearizationError, "initialStateLinearizationError_" +
-                        std::to_string( runCase ) + "_" +
-                        std::to_string( i ) + ".dat", outputPath );
+        std::vector< tudat_applications::SweepExecutor::SweepTask > monteCarloTasks;
+        for( unsigned int ensembleIndex = 0; ensembleIndex < numberOfEnsembles; ensembleIndex++ )
+        {
+            monteCarloTasks.push_back( [ &, ensembleIndex ]( const unsigned int )
+            {
+                const unsigned int firstRun = ensembleIndex * ensembleSize;
+
+                {
+                    std::lock_guard< std::mutex > lock( tudat_applications::getConsoleOutputMutex( ) );
+                    std::cout<<"RUNS: "<<firstRun<<" to "<<firstRun + ensembleSize - 1<<std::endl;
+                }
+
+                // Create environment and acceleration models for ensemble (with the spherical harmonic accelerations of all
+                // members computed together).
+                NamedBodyMap ensembleBodyMap = ensembleEnvironmentSnapshot.createBodyMap( );
+                std::vector< std::string > ensembleMemberNames;
+                for( unsigned int j = 0; j < ensembleSize; j++ )
+                {
+                    ensembleMemberNames.push_back( getAsterixEnsembleMemberName( j ) );
+                }
+
+                // Perturb the gravity field coefficients shared by the ensemble, and the vehicle parameters of each member,
+                // before creating the acceleration models, which pack the spherical harmonic coefficients.
+                std::shared_ptr< estimatable_parameters::EstimatableParameterSet< double > > gravityFieldParameters =
+                        createParametersToEstimate( getEarthGravityFieldParameterNames( ), ensembleBodyMap );
+                gravityFieldParameters->resetParameterValues(
+                            Eigen::VectorXd( gravityFieldParameters->getFullParameterValues< double >( ) +
+                                             uncertaintySamples.at( firstRun ).segment(
+                                                 3 + numberOfVehicleParameters, numberOfGravityFieldParameters ) ) );
+                for( unsigned int j = 0; j < ensembleSize; j++ )
+                {
+                    std::shared_ptr< estimatable_parameters::EstimatableParameterSet< double > > vehicleParameters =
+                            createParametersToEstimate(
+                                getAsterixVehicleParameterNames( ensembleMemberNames.at( j ) ), ensembleBodyMap );
+                    vehicleParameters->resetParameterValues(
+                                Eigen::VectorXd( vehicleParameters->getFullParameterValues< double >( ) +
+                                                 uncertaintySamples.at( firstRun + j ).segment(
+                                                     3, numberOfVehicleParameters ) ) );
+                }
+
+                basic_astrodynamics::AccelerationMap ensembleAccelerationModelMap =
+                        createAsterixAccelerationModels( ensembleBodyMap, ensembleMemberNames, true );
+
+                // Define perturbed initial states, and sinks processing the state of each member.
+                Eigen::VectorXd ensembleInitialState = Eigen::VectorXd( 6 * ensembleSize );
+                std::vector< std::shared_ptr< tudat_applications::StateHistorySink< > > > ensembleSinks;
+                std::vector< std::shared_ptr< tudat_applications::BoundaryStateHistorySink< > > > perturbedBoundaryStates;
+                for( unsigned int j = 0; j < ensembleSize; j++ )
+                {
+                    const Eigen::VectorXd& currentUncertaintySample = uncertaintySamples.at( firstRun + j );
+
+                    ensembleInitialState.segment( 6 * j, 6 ) = asterixInitialState;
+                    ensembleInitialState.segment( 6 * j, 3 ) += currentUncertaintySample.segment( 0, 3 );
+
+                    // Define computation of linearization error w.r.t. nominal orbit, state transition and sensitivity
+                    // matrices.
+                    std::function< Eigen::VectorXd( const double, const Eigen::VectorXd& ) > computeLinearizationError =
+                            [ &, currentUncertaintySample ]( const double time, const Eigen::VectorXd& perturbedState )
+                    {
+                        return Eigen::VectorXd(
+                                    perturbedState - nominalStateHistory.at( time ) -
+                                    Eigen::Map< const Eigen::MatrixXd >(
+                                        nominalPartialsHistory.at( time ).data( ), 6, numberOfUncertainties ) *
+                                    currentUncertaintySample );
+                    };
+
+                    // Write the linearization error to file at each step, and retain only the final state.
+                    perturbedBoundaryStates.push_back(
+                                std::make_shared< tudat_applications::BoundaryStateHistorySink< > >( ) );
+                    ensembleSinks.push_back( tudat_applications::createEnsembleMemberSink< double, double >(
+                                                 j, 6, perturbedBoundaryStates.at( j ) ) );
+                    ensembleSinks.push_back( tudat_applications::createEnsembleMemberSink< double, double >(
+                                                 j, 6, std::make_shared< tudat_applications::TransformedStateHistorySink< > >(
+                                                     computeLinearizationError,
+                                                     std::make_shared< tudat_applications::TextFileStateHistorySink< > >(
+                                                         "initialStateLinearizationError_" + std::to_string( runCase ) +
+                                                         "_" + std::to_string( firstRun + j ) + ".dat", outputPath ) ) ) );
+                }
+
+                // Propagate all members of the ensemble together.
+                std::shared_ptr< TranslationalStatePropagatorSettings< double > > ensemblePropagatorSettings =
+                        std::make_shared< TranslationalStatePropagatorSettings< double > >(
+                            std::vector< std::string >( ensembleSize, "Earth" ), ensembleAccelerationModelMap,
+                            ensembleMemberNames, ensembleInitialState, simulationEndEpoch );
+                tudat_applications::propagateToStateHistorySinks< double, double >(
+                            ensembleBodyMap, integratorSettings, ensemblePropagatorSettings, simulationEndEpoch,
+                            ensembleSinks );
+
+                for( unsigned int j = 0; j < ensembleSize; j++ )
+                {
+                    const Eigen::VectorXd& currentUncertaintySample = uncertaintySamples.at( firstRun + j );
+                    const Eigen::VectorXd& perturbedFinalState = perturbedBoundaryStates.at( j )->getFinalState( );
+
+                    Eigen::MatrixXd outputMap = Eigen::MatrixXd::Zero( 6, 4 );
+                    outputMap.block( 0, 0, 3, 1 ) = currentUncertaintySample.segment( 0, 3 );
+                    outputMap.block( 0, 1, 6, 1 ) = Eigen::Map< const Eigen::MatrixXd >(
+                                nominalPartialsHistory.back( ).second.data( ), 6, numberOfUncertainties ) *
+                            currentUncertaintySample;
+                    outputMap.block( 0, 2, 6, 1 ) = perturbedFinalState - nominalStateHistory.back( ).second;
+                    outputMap.block( 0, 3, 6, 1 ) = perturbedFinalState;
+
+                    input_output::writeMatrixToFile(
+                                outputMap, "monteCarloInitialState_" +
+                                std::to_string( runCase ) + "_" +
+                                std::to_string( firstRun + j ) + ".dat", 16, outputPath );
+                    input_output::writeMatrixToFile(
+                                currentUncertaintySample, "monteCarloUncertaintySample_" +
+                                std::to_string( runCase ) + "_" +
+                                std::to_string( firstRun + j ) + ".dat", 16, outputPath );
+                }
+            } );
         }
+        sweepExecutor.executeTasks( monteCarloTasks );
     }
     //    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     //    ///////////////////////        PROVIDE OUTPUT TO CONSOLE AND FILES           //////////////////////////////////////////
@@ -0,0 +1,171 @@
+/*    Copyright (c) 2010-2018, Delft University of Technology
+ *    All rigths reserved
+ *
+ *    This file is part of the Tudat. Redistribution and use in source and
+ *    binary forms, with or without modification, are permitted exclusively
+ *    under the terms of the Modified BSD license. You should have received
+ *    a copy of the license with this file. If not, please or visit:
+ *    http://tudat.tudelft.nl/LICENSE.
+ */
+
+#define BOOST_TEST_MAIN
+
+#include <boost/test/unit_test.hpp>
+
+#include <Tudat/SimulationSetup/tudatSimulationHeader.h>
+
+#include "propagationAndOptimization/packedSphericalHarmonicsAcceleration.h"
+#include "propagationAndOptimization/spiceKernelPool.h"
+#include "propagationAndOptimization/stateHistorySink.h"
+
+namespace tudat
+{
+namespace unit_tests
+{
+
+using namespace tudat::simulation_setup;
+using namespace tudat::propagators;
+using namespace tudat::numerical_integrators;
+
+//! Function to create the environment of the test, with a vehicle for each given radiation pressure coefficient.
+NamedBodyMap createEnsembleTestBodyMap( const std::vector< std::string >& vehicleNames,
+                                        const std::vector< double >& radiationPressureCoefficients )
+{
+    std::vector< std::string > bodiesToCreate;
+    bodiesToCreate.push_back( "Sun" );
+    bodiesToCreate.push_back( "Earth" );
+    bodiesToCreate.push_back( "Moon" );
+
+    std::map< std::string, std::shared_ptr< BodySettings > > bodySettings =
+            getDefaultBodySettings( bodiesToCreate, -300.0, physical_constants::JULIAN_DAY + 300.0 );
+    for( unsigned int i = 0; i < bodiesToCreate.size( ); i++ )
+    {
+        bodySettings[ bodiesToCreate.at( i ) ]->ephemerisSettings->resetFrameOrientation( "J2000" );
+        bodySettings[ bodiesToCreate.at( i ) ]->rotationModelSettings->resetOriginalFrame( "J2000" );
+    }
+    NamedBodyMap bodyMap = createBodies( bodySettings );
+
+    std::vector< std::string > occultingBodies;
+    occultingBodies.push_back( "Earth" );
+    for( unsigned int i = 0; i < vehicleNames.size( ); i++ )
+    {
+        bodyMap[ vehicleNames.at( i ) ] = std::make_shared< Body >( );
+        bodyMap[ vehicleNames.at( i ) ]->setConstantBodyMass( 400.0 );
+        bodyMap[ vehicleNames.at( i ) ]->setRadiationPressureInterface(
+                    "Sun", createRadiationPressureInterface(
+                        std::make_shared< CannonBallRadiationPressureInterfaceSettings >(
+                            "Sun", 4.0, radiationPressureCoefficients.at( i ), occultingBodies ),
+                        vehicleNames.at( i ), bodyMap ) );
+    }
+
+    setGlobalFrameBodyEphemerides( bodyMap, "SSB", "J2000" );
+    return bodyMap;
+}
+
+//! Function to create the acceleration models of the test, acting on each given vehicle.
+basic_astrodynamics::AccelerationMap createEnsembleTestAccelerationModels(
+        const NamedBodyMap& bodyMap, const std::vector< std::string >& vehicleNames,
+        const bool usePackedSphericalHarmonics )
+{
+    std::map< std::string, std::vector< std::shared_ptr< AccelerationSettings > > > accelerationsOfVehicle;
+    if( usePackedSphericalHarmonics )
+    {
+        accelerationsOfVehicle[ "Earth" ].push_back(
+                    std::make_shared< tudat_applications::PackedSphericalHarmonicAccelerationSettings >( 4, 4 ) );
+    }
+    else
+    {
+        accelerationsOfVehicle[ "Earth" ].push_back( std::make_shared< SphericalHarmonicAccelerationSettings >( 4, 4 ) );
+    }
+    accelerationsOfVehicle[ "Sun" ].push_back( std::make_shared< AccelerationSettings >(
+                                                   basic_astrodynamics::central_gravity ) );
+    accelerationsOfVehicle[ "Moon" ].push_back( std::make_shared< AccelerationSettings >(
+                                                    basic_astrodynamics::central_gravity ) );
+    accelerationsOfVehicle[ "Sun" ].push_back( std::make_shared< AccelerationSettings >(
+                                                   basic_astrodynamics::cannon_ball_radiation_pressure ) );
+
+    SelectedAccelerationMap accelerationMap;
+    for( unsigned int i = 0; i < vehicleNames.size( ); i++ )
+    {
+        accelerationMap[ vehicleNames.at( i ) ] = accelerationsOfVehicle;
+    }
+
+    return tudat_applications::createAccelerationModelsMapWithPackedSphericalHarmonics(
+                bodyMap, accelerationMap, vehicleNames, std::vector< std::string >( vehicleNames.size( ), "Earth" ) );
+}
+
+BOOST_AUTO_TEST_SUITE( test_ensemble_propagation )
+
+//! Test whether members of a lock-step ensemble propagation (with shared environment updates and packed spherical harmonic
+//! accelerations) follow the same orbits as separate propagations of each member.
+BOOST_AUTO_TEST_CASE( testEnsembleEquivalenceToSeparatePropagations )
+{
+    tudat_applications::loadSpiceKernelSet( tudat_applications::standard_spice_kernels );
+
+    // Define members, which differ in initial state and radiation pressure coefficient.
+    const unsigned int ensembleSize = 3;
+    std::vector< std::string > memberNames;
+    std::vector< double > radiationPressureCoefficients;
+    std::vector< Eigen::Vector6d > memberInitialStates;
+    Eigen::Vector6d nominalInitialState;
+    nominalInitialState << 7000.0E3, 0.0, 0.0, 0.0, 5.0E3, 5.5E3;
+    for( unsigned int i = 0; i < ensembleSize; i++ )
+    {
+        memberNames.push_back( "Vehicle_" + std::to_string( i ) );
+        radiationPressureCoefficients.push_back( 1.0 + 0.25 * static_cast< double >( i ) );
+        memberInitialStates.push_back( nominalInitialState );
+        memberInitialStates.back( )( i ) += 1.0E3;
+    }
+
+    // Propagate with a fixed step that divides the propagation time, so that separate propagations end on the final time.
+    const double simulationEndEpoch = physical_constants::JULIAN_DAY;
+    std::shared_ptr< IntegratorSettings< > > integratorSettings =
+            std::make_shared< IntegratorSettings< > >( rungeKutta4, 0.0, 15.0 );
+
+    // Propagate all members together, retaining the final state of each member.
+    NamedBodyMap ensembleBodyMap = createEnsembleTestBodyMap( memberNames, radiationPressureCoefficients );
+    Eigen::VectorXd ensembleInitialState = Eigen::VectorXd( 6 * ensembleSize );
+    std::vector< std::shared_ptr< tudat_applications::StateHistorySink< > > > ensembleSinks;
+    std::vector< std::shared_ptr< tudat_applications::BoundaryStateHistorySink< > > > memberBoundaryStates;
+    for( unsigned int i = 0; i < ensembleSize; i++ )
+    {
+        ensembleInitialState.segment( 6 * i, 6 ) = memberInitialStates.at( i );
+        memberBoundaryStates.push_back( std::make_shared< tudat_applications::BoundaryStateHistorySink< > >( ) );
+        ensembleSinks.push_back( tudat_applications::createEnsembleMemberSink< double, double >(
+                                     i, 6, memberBoundaryStates.at( i ) ) );
+    }
+    std::shared_ptr< TranslationalStatePropagatorSettings< double > > ensemblePropagatorSettings =
+            std::make_shared< TranslationalStatePropagatorSettings< double > >(
+                std::vector< std::string >( ensembleSize, "Earth" ),
+                createEnsembleTestAccelerationModels( ensembleBodyMap, memberNames, true ),
+                memberNames, ensembleInitialState, simulationEndEpoch );
+    tudat_applications::propagateToStateHistorySinks< double, double >(
+                ensembleBodyMap, integratorSettings, ensemblePropagatorSettings, simulationEndEpoch, ensembleSinks );
+
+    // Propagate each member separately with the dynamics simulator of Tudat, and compare final states.
+    for( unsigned int i = 0; i < ensembleSize; i++ )
+    {
+        NamedBodyMap memberBodyMap = createEnsembleTestBodyMap(
+                    { memberNames.at( i ) }, { radiationPressureCoefficients.at( i ) } );
+        std::shared_ptr< TranslationalStatePropagatorSettings< double > > memberPropagatorSettings =
+                std::make_shared< TranslationalStatePropagatorSettings< double > >(
+                    std::vector< std::string >( 1, "Earth" ),
+                    createEnsembleTestAccelerationModels( memberBodyMap, { memberNames.at( i ) }, false ),
+                    std::vector< std::string >( 1, memberNames.at( i ) ), memberInitialStates.at( i ),
+                    simulationEndEpoch );
+        SingleArcDynamicsSimulator< > dynamicsSimulator( memberBodyMap, integratorSettings, memberPropagatorSettings );
+        const std::pair< double, Eigen::VectorXd > memberFinalState =
+                *dynamicsSimulator.getEquationsOfMotionNumericalSolution( ).rbegin( );
+
+        BOOST_CHECK_EQUAL( memberBoundaryStates.at( i )->getFinalTime( ), memberFinalState.first );
+        const Eigen::VectorXd stateDifference = memberBoundaryStates.at( i )->getFinalState( ) - memberFinalState.second;
+        BOOST_CHECK_SMALL( stateDifference.segment( 0, 3 ).norm( ), 1.0E-4 );
+        BOOST_CHECK_SMALL( stateDifference.segment( 3, 3 ).norm( ), 1.0E-7 );
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END( )
+
+} // namespace unit_tests
+
+} // namespace tudat
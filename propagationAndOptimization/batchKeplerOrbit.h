@@ -0,0 +1,217 @@
+/*    Copyright (c) 2010-2018, Delft University of Technology
+ *    All rigths reserved
+ *
+ *    This file is part of the Tudat. Redistribution and use in source and
+ *    binary forms, with or without modification, are permitted exclusively
+ *    under the terms of the Modified BSD license. You should have received
+ *    a copy of the license with this file. If not, please or visit:
+ *    http://tudat.tudelft.nl/LICENSE.
+ */
+
+#ifndef TUDAT_BATCHKEPLERORBIT_H
+#define TUDAT_BATCHKEPLERORBIT_H
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include <Tudat/Astrodynamics/BasicAstrodynamics/stateVectorIndices.h>
+
+namespace tudat_applications
+{
+
+//! Function to solve Kepler's equation for an elliptical orbit, starting from a given initial guess.
+/*!
+ *  Function to solve Kepler's equation (E - e sin E = M) for an elliptical orbit, starting from a given initial guess of the
+ *  eccentric anomaly. Newton iterations are used, safeguarded by bisection on the interval [ M - e, M + e ] (which always
+ *  contains the solution), so that the iteration converges for any initial guess and eccentricity below 1. For a good
+ *  initial guess (e.g. from the solution at a nearby epoch), only one or two iterations are required.
+ *  \param meanAnomaly Mean anomaly M.
+ *  \param eccentricity Eccentricity e of the orbit (0 <= e < 1).
+ *  \param initialGuess Initial guess of the eccentric anomaly.
+ *  \param tolerance Relative tolerance on the eccentric anomaly.
+ *  \param maximumNumberOfIterations Maximum number of iterations; an exception is thrown if exceeded.
+ *  \return Eccentric anomaly E.
+ */
+template< typename ScalarType >
+ScalarType solveEllipticalKeplerEquation(
+        const ScalarType meanAnomaly,
+        const ScalarType eccentricity,
+        const ScalarType initialGuess,
+        const ScalarType tolerance = 4.0 * std::numeric_limits< ScalarType >::epsilon( ),
+        const unsigned int maximumNumberOfIterations = 100 )
+{
+    ScalarType lowerBound = meanAnomaly - eccentricity;
+    ScalarType upperBound = meanAnomaly + eccentricity;
+
+    ScalarType eccentricAnomaly = initialGuess;
+    if( !( eccentricAnomaly >= lowerBound && eccentricAnomaly <= upperBound ) )
+    {
+        eccentricAnomaly = meanAnomaly;
+    }
+
+    for( unsigned int i = 0; i < maximumNumberOfIterations; i++ )
+    {
+        // Update bracket of solution (Kepler's equation is monotonically increasing in E).
+        ScalarType equationValue = eccentricAnomaly - eccentricity * std::sin( eccentricAnomaly ) - meanAnomaly;
+        if( equationValue > 0.0 )
+        {
+            upperBound = eccentricAnomaly;
+        }
+        else
+        {
+            lowerBound = eccentricAnomaly;
+        }
+
+        // Take Newton step, or bisection step if Newton step leaves bracket.
+        ScalarType newEccentricAnomaly =
+                eccentricAnomaly - equationValue / ( 1.0 - eccentricity * std::cos( eccentricAnomaly ) );
+        if( !( newEccentricAnomaly > lowerBound && newEccentricAnomaly < upperBound ) )
+        {
+            newEccentricAnomaly = ( lowerBound + upperBound ) / 2.0;
+        }
+
+        if( std::fabs( newEccentricAnomaly - eccentricAnomaly ) <= tolerance * ( 1.0 + std::fabs( eccentricAnomaly ) ) ||
+                upperBound - lowerBound <= tolerance * ( 1.0 + std::fabs( eccentricAnomaly ) ) )
+        {
+            return newEccentricAnomaly;
+        }
+        eccentricAnomaly = newEccentricAnomaly;
+    }
+
+    throw std::runtime_error( "Error, Kepler's equation did not converge when computing batch of Kepler orbit states." );
+}
+
+//! Function to compute the Cartesian states along an (unperturbed) elliptical Kepler orbit, at a list of epochs.
+/*!
+ *  Function to compute the Cartesian states along an (unperturbed) elliptical Kepler orbit, at a list of epochs. The result
+ *  is equal to calling convertKeplerianToCartesianElements( propagateKeplerOrbit( initialState, epoch, mu ), mu ) for each
+ *  epoch, but is computed much more efficiently for dense lists of epochs (such as the output of a numerical propagation):
+ *  Kepler's equation is solved for each epoch using the solution at the previous epoch as initial guess (first-order
+ *  extrapolation in mean anomaly), and the conversion from eccentric anomaly to Cartesian state is done in a single pass
+ *  over all epochs, using only the orbit's perifocal unit vectors, which are computed once. The epochs are not required to
+ *  be sorted, but the warm-start is only effective if consecutive epochs are close.
+ *  \param initialStateInKeplerianElements Keplerian elements of the orbit at epoch 0 (in Tudat element order).
+ *  \param epochs List of epochs (w.r.t. epoch of initial state) at which states are to be computed.
+ *  \param centralBodyGravitationalParameter Gravitational parameter of the central body.
+ *  \return Matrix with Cartesian states, in which row i contains the state at epochs.at( i ).
+ */
+template< typename ScalarType >
+Eigen::Matrix< ScalarType, Eigen::Dynamic, 6 > computeKeplerOrbitCartesianStates(
+        const Eigen::Matrix< ScalarType, 6, 1 >& initialStateInKeplerianElements,
+        const std::vector< double >& epochs,
+        const ScalarType centralBodyGravitationalParameter )
+{
+    using namespace tudat::orbital_element_conversions;
+
+    const ScalarType semiMajorAxis = initialStateInKeplerianElements( semiMajorAxisIndex );
+    const ScalarType eccentricity = initialStateInKeplerianElements( eccentricityIndex );
+    if( !( eccentricity >= 0.0 && eccentricity < 1.0 ) || !( semiMajorAxis > 0.0 ) )
+    {
+        throw std::runtime_error( "Error, batch Kepler orbit computation only supported for elliptical orbits." );
+    }
+
+    const ScalarType twoPi = 2.0 * std::acos( static_cast< ScalarType >( -1.0 ) );
+    const ScalarType meanMotion = std::sqrt( centralBodyGravitationalParameter /
+                                             ( semiMajorAxis * semiMajorAxis * semiMajorAxis ) );
+    const ScalarType semiLatusRectumFactor = std::sqrt( 1.0 - eccentricity * eccentricity );
+
+    // Compute mean anomaly at initial epoch.
+    const ScalarType halfTrueAnomaly = initialStateInKeplerianElements( trueAnomalyIndex ) / 2.0;
+    const ScalarType initialEccentricAnomaly = 2.0 * std::atan2(
+                std::sqrt( 1.0 - eccentricity ) * std::sin( halfTrueAnomaly ),
+                std::sqrt( 1.0 + eccentricity ) * std::cos( halfTrueAnomaly ) );
+    const ScalarType initialMeanAnomaly =
+            initialEccentricAnomaly - eccentricity * std::sin( initialEccentricAnomaly );
+
+    // Solve Kepler's equation at each epoch, warm-started from the previous epoch.
+    const unsigned int numberOfEpochs = epochs.size( );
+    Eigen::Array< ScalarType, Eigen::Dynamic, 1 > eccentricAnomalies( numberOfEpochs );
+    ScalarType previousMeanAnomaly = 0.0, previousEccentricAnomaly = 0.0;
+    for( unsigned int i = 0; i < numberOfEpochs; i++ )
+    {
+        ScalarType currentMeanAnomaly = std::fmod(
+                    initialMeanAnomaly + meanMotion * static_cast< ScalarType >( epochs[ i ] ), twoPi );
+        if( currentMeanAnomaly < 0.0 )
+        {
+            currentMeanAnomaly += twoPi;
+        }
+
+        ScalarType initialGuess;
+        if( i == 0 )
+        {
+            initialGuess = currentMeanAnomaly + eccentricity * std::sin( currentMeanAnomaly );
+        }
+        else
+        {
+            // Wrap change in mean anomaly to [-pi, pi), and extrapolate using dE/dM = 1 / ( 1 - e cos E ).
+            ScalarType meanAnomalyChange = currentMeanAnomaly - previousMeanAnomaly;
+            meanAnomalyChange -= twoPi * std::floor( meanAnomalyChange / twoPi + 0.5 );
+            initialGuess = currentMeanAnomaly + ( previousEccentricAnomaly - previousMeanAnomaly ) +
+                    meanAnomalyChange * eccentricity * std::cos( previousEccentricAnomaly ) /
+                    ( 1.0 - eccentricity * std::cos( previousEccentricAnomaly ) );
+        }
+
+        eccentricAnomalies( i ) = solveEllipticalKeplerEquation< ScalarType >(
+                    currentMeanAnomaly, eccentricity, initialGuess );
+        previousMeanAnomaly = currentMeanAnomaly;
+        previousEccentricAnomaly = eccentricAnomalies( i );
+    }
+
+    // Compute perifocal unit vectors P (towards periapsis) and Q (in orbital plane, 90 degrees ahead of P).
+    const ScalarType cosineArgumentOfPeriapsis = std::cos( initialStateInKeplerianElements( argumentOfPeriapsisIndex ) );
+    const ScalarType sineArgumentOfPeriapsis = std::sin( initialStateInKeplerianElements( argumentOfPeriapsisIndex ) );
+    const ScalarType cosineAscendingNode = std::cos( initialStateInKeplerianElements( longitudeOfAscendingNodeIndex ) );
+    const ScalarType sineAscendingNode = std::sin( initialStateInKeplerianElements( longitudeOfAscendingNodeIndex ) );
+    const ScalarType cosineInclination = std::cos( initialStateInKeplerianElements( inclinationIndex ) );
+    const ScalarType sineInclination = std::sin( initialStateInKeplerianElements( inclinationIndex ) );
+
+    Eigen::Matrix< ScalarType, 3, 1 > periapsisDirection;
+    periapsisDirection << cosineAscendingNode * cosineArgumentOfPeriapsis -
+                          sineAscendingNode * sineArgumentOfPeriapsis * cosineInclination,
+            sineAscendingNode * cosineArgumentOfPeriapsis +
+            cosineAscendingNode * sineArgumentOfPeriapsis * cosineInclination,
+            sineArgumentOfPeriapsis * sineInclination;
+
+    Eigen::Matrix< ScalarType, 3, 1 > perpendicularDirection;
+    perpendicularDirection << -cosineAscendingNode * sineArgumentOfPeriapsis -
+                              sineAscendingNode * cosineArgumentOfPeriapsis * cosineInclination,
+            -sineAscendingNode * sineArgumentOfPeriapsis +
+            cosineAscendingNode * cosineArgumentOfPeriapsis * cosineInclination,
+            cosineArgumentOfPeriapsis * sineInclination;
+
+    // Compute position and velocity in perifocal frame for all epochs as array operations (vectorized by Eigen for
+    // float/double), and rotate to inertial frame.
+    const Eigen::Array< ScalarType, Eigen::Dynamic, 1 > cosineEccentricAnomalies = eccentricAnomalies.cos( );
+    const Eigen::Array< ScalarType, Eigen::Dynamic, 1 > sineEccentricAnomalies = eccentricAnomalies.sin( );
+    const Eigen::Array< ScalarType, Eigen::Dynamic, 1 > velocityFactors =
+            std::sqrt( centralBodyGravitationalParameter * semiMajorAxis ) /
+            ( semiMajorAxis * ( 1.0 - eccentricity * cosineEccentricAnomalies ) );
+
+    const Eigen::Array< ScalarType, Eigen::Dynamic, 1 > perifocalPositionX =
+            semiMajorAxis * ( cosineEccentricAnomalies - eccentricity );
+    const Eigen::Array< ScalarType, Eigen::Dynamic, 1 > perifocalPositionY =
+            semiMajorAxis * semiLatusRectumFactor * sineEccentricAnomalies;
+    const Eigen::Array< ScalarType, Eigen::Dynamic, 1 > perifocalVelocityX =
+            -velocityFactors * sineEccentricAnomalies;
+    const Eigen::Array< ScalarType, Eigen::Dynamic, 1 > perifocalVelocityY =
+            velocityFactors * semiLatusRectumFactor * cosineEccentricAnomalies;
+
+    Eigen::Matrix< ScalarType, Eigen::Dynamic, 6 > cartesianStates( numberOfEpochs, 6 );
+    for( unsigned int j = 0; j < 3; j++ )
+    {
+        cartesianStates.col( j ).array( ) =
+                perifocalPositionX * periapsisDirection( j ) + perifocalPositionY * perpendicularDirection( j );
+        cartesianStates.col( j + 3 ).array( ) =
+                perifocalVelocityX * periapsisDirection( j ) + perifocalVelocityY * perpendicularDirection( j );
+    }
+
+    return cartesianStates;
+}
+
+}
+
+#endif // TUDAT_BATCHKEPLERORBIT_H
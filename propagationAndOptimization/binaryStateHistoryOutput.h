@@ -0,0 +1,420 @@
+/*    Copyright (c) 2010-2018, Delft University of Technology
+ *    All rigths reserved
+ *
+ *    This file is part of the Tudat. Redistribution and use in source and
+ *    binary forms, with or without modification, are permitted exclusively
+ *    under the terms of the Modified BSD license. You should have received
+ *    a copy of the license with this file. If not, please or visit:
+ *    http://tudat.tudelft.nl/LICENSE.
+ */
+
+#ifndef TUDAT_BINARYSTATEHISTORYOUTPUT_H
+#define TUDAT_BINARYSTATEHISTORYOUTPUT_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include <Eigen/Core>
+
+namespace tudat_applications
+{
+
+//! Identifiers of the scalar types that can be stored in a binary state history file.
+enum BinaryScalarType
+{
+    float32_scalar = 1,
+    float64_scalar = 2,
+    x87_extended_scalar = 3,
+    float128_scalar = 4
+};
+
+//! Function to retrieve the identifier of the binary representation of a floating point type.
+/*!
+ *  Function to retrieve the identifier of the binary representation of a floating point type. For long double, the
+ *  identifier depends on the platform: it is equal to that of double if the two types are identical (e.g. MSVC), it is
+ *  the 80-bit x87 extended format on x86 (stored with zero padding to sizeof( long double ) bytes), and IEEE quadruple
+ *  precision on e.g. aarch64.
+ *  \return Identifier of binary representation of ScalarType.
+ */
+template< typename ScalarType >
+BinaryScalarType getBinaryScalarType( )
+{
+    static_assert( std::is_floating_point< ScalarType >::value,
+                   "Error, binary state history output only supports floating point types." );
+    switch( std::numeric_limits< ScalarType >::digits )
+    {
+    case 24:
+        return float32_scalar;
+    case 53:
+        return float64_scalar;
+    case 64:
+        return x87_extended_scalar;
+    case 113:
+        return float128_scalar;
+    default:
+        throw std::runtime_error( "Error, floating point representation not supported in binary state history output." );
+    }
+}
+
+//! Function to retrieve the number of significant bytes in the binary representation of a floating point type.
+/*!
+ *  Function to retrieve the number of significant bytes in the binary representation of a floating point type, which is
+ *  smaller than its size for the x87 extended format (10 significant bytes, padded to 12 or 16 bytes).
+ *  \return Number of significant bytes in binary representation of ScalarType.
+ */
+template< typename ScalarType >
+std::size_t getBinaryScalarSignificantSize( )
+{
+    return ( getBinaryScalarType< ScalarType >( ) == x87_extended_scalar ) ? 10 : sizeof( ScalarType );
+}
+
+//! Function to write a list of floating point values to a binary stream, with any padding bytes set to zero.
+/*!
+ *  Function to write a list of floating point values to a binary stream, with sizeof( ScalarType ) bytes per value. The
+ *  padding bytes of the x87 extended format are not initialized in memory, so that these values are copied to a
+ *  zero-initialized buffer before being written, to make the output identical for identical values.
+ *  \param outputStream Stream to which the values are to be written (opened in binary mode).
+ *  \param values List of values that is to be written.
+ */
+template< typename ScalarType >
+void writeScalarsToBinaryStream( std::ostream& outputStream, const std::vector< ScalarType >& values )
+{
+    const std::size_t significantSize = getBinaryScalarSignificantSize< ScalarType >( );
+    if( significantSize == sizeof( ScalarType ) )
+    {
+        outputStream.write( reinterpret_cast< const char* >( values.data( ) ), values.size( ) * sizeof( ScalarType ) );
+        return;
+    }
+
+    // Write values in blocks, only the significant bytes of each value are copied to the buffer.
+    const std::size_t maximumBlockSize = 4096;
+    std::vector< char > buffer( std::min( values.size( ), maximumBlockSize ) * sizeof( ScalarType ), 0 );
+    for( std::size_t blockStart = 0; blockStart < values.size( ); blockStart += maximumBlockSize )
+    {
+        const std::size_t blockSize = std::min( values.size( ) - blockStart, maximumBlockSize );
+        for( std::size_t i = 0; i < blockSize; i++ )
+        {
+            std::memcpy( &buffer[ i * sizeof( ScalarType ) ], &values[ blockStart + i ], significantSize );
+        }
+        outputStream.write( buffer.data( ), blockSize * sizeof( ScalarType ) );
+    }
+}
+
+//! Fixed-size (256 byte) header of a binary state history file.
+/*!
+ *  Fixed-size (256 byte) header of a binary state history file. The header is followed by the epoch column
+ *  (numberOfEpochs values, starting at epochColumnOffset), and the state columns (stateSize consecutive columns of
+ *  numberOfEpochs values each, starting at stateColumnsOffset, which is aligned to 16 bytes). All values are stored in the
+ *  native byte order of the writing machine, which can be checked using byteOrderMark. Since all columns are stored
+ *  contiguously, the file can be memory-mapped directly (e.g. using memmapfile in MATLAB, see readBinaryStateHistory.m).
+ */
+struct BinaryStateHistoryHeader
+{
+    //! File identifier, equal to "TUDATSH" (null-terminated).
+    char fileIdentifier[ 8 ];
+
+    //! Version of the file format.
+    std::uint32_t formatVersion;
+
+    //! Size of this header, in bytes.
+    std::uint32_t headerSize;
+
+    //! Value 0x01020304, as written in the byte order of the writing machine.
+    std::uint32_t byteOrderMark;
+
+    //! Scalar type (see BinaryScalarType) of the epochs.
+    std::uint32_t epochScalarType;
+
+    //! Size in bytes of each epoch value.
+    std::uint32_t epochScalarSize;
+
+    //! Scalar type (see BinaryScalarType) of the state entries.
+    std::uint32_t stateScalarType;
+
+    //! Size in bytes of each state entry (including zero padding, e.g. 16 bytes for x87 extended on x86_64).
+    std::uint32_t stateScalarSize;
+
+    //! Reserved, set to zero.
+    std::uint32_t reserved;
+
+    //! Number of epochs (rows) in the file.
+    std::uint64_t numberOfEpochs;
+
+    //! Number of state entries per epoch (state columns).
+    std::uint64_t stateSize;
+
+    //! Offset (in bytes, w.r.t. start of file) of the epoch column.
+    std::uint64_t epochColumnOffset;
+
+    //! Offset (in bytes, w.r.t. start of file) of the first state column.
+    std::uint64_t stateColumnsOffset;
+
+    //! Tag identifying the simulation case (e.g. loop indices) from which the data was produced (null-padded).
+    char caseTag[ 184 ];
+};
+
+static_assert( sizeof( BinaryStateHistoryHeader ) == 256, "Error, unexpected size of binary state history header." );
+
+//! Current version of the binary state history file format.
+static const std::uint32_t BINARY_STATE_HISTORY_FORMAT_VERSION = 1;
+
+//! Function to compute the size (in bytes) of a binary state history, excluding the header.
+inline std::uint64_t getBinaryStateHistoryDataSize( const BinaryStateHistoryHeader& header )
+{
+    return header.stateColumnsOffset - header.headerSize +
+            header.numberOfEpochs * header.stateSize * header.stateScalarSize;
+}
+
+//! Function to write a columnar state history (epochs and column-major states) to a binary stream.
+/*!
+ *  Function to write a columnar state history (epochs and column-major states) to a binary stream, including the header.
+ *  \param outputStream Stream to which the state history is to be written (opened in binary mode).
+ *  \param epochs List of epochs.
+ *  \param stateColumns Column-major matrix of state entries, with epochs.size( ) rows, and stateSize columns.
+ *  \param stateSize Number of state entries per epoch.
+ *  \param caseTag Tag identifying the simulation case (truncated to 183 characters).
+ *  \return Total number of bytes written to the stream.
+ */
+template< typename EpochType, typename ScalarType >
+std::uint64_t writeColumnarStateHistoryToBinaryStream(
+        std::ostream& outputStream,
+        const std::vector< EpochType >& epochs,
+        const std::vector< ScalarType >& stateColumns,
+        const unsigned int stateSize,
+        const std::string& caseTag )
+{
+    BinaryStateHistoryHeader header;
+    std::memset( &header, 0, sizeof( header ) );
+    std::strncpy( header.fileIdentifier, "TUDATSH", sizeof( header.fileIdentifier ) );
+    std::strncpy( header.caseTag, caseTag.c_str( ), sizeof( header.caseTag ) - 1 );
+    header.formatVersion = BINARY_STATE_HISTORY_FORMAT_VERSION;
+    header.headerSize = sizeof( BinaryStateHistoryHeader );
+    header.byteOrderMark = 0x01020304;
+    header.epochScalarType = getBinaryScalarType< EpochType >( );
+    header.epochScalarSize = sizeof( EpochType );
+    header.stateScalarType = getBinaryScalarType< ScalarType >( );
+    header.stateScalarSize = sizeof( ScalarType );
+    header.numberOfEpochs = epochs.size( );
+    header.stateSize = stateSize;
+    header.epochColumnOffset = header.headerSize;
+
+    // Align state columns to 16 bytes, so that long double columns can be mapped directly.
+    std::uint64_t epochColumnEnd = header.epochColumnOffset + header.numberOfEpochs * header.epochScalarSize;
+    header.stateColumnsOffset = ( ( epochColumnEnd + 15 ) / 16 ) * 16;
+
+    const char padding[ 16 ] = { };
+    outputStream.write( reinterpret_cast< const char* >( &header ), sizeof( header ) );
+    writeScalarsToBinaryStream( outputStream, epochs );
+    outputStream.write( padding, header.stateColumnsOffset - epochColumnEnd );
+    writeScalarsToBinaryStream( outputStream, stateColumns );
+
+    if( !outputStream )
+    {
+        throw std::runtime_error( "Error when writing binary state history " + caseTag + ", stream write failed." );
+    }
+
+    return header.headerSize + getBinaryStateHistoryDataSize( header );
+}
+
+//! Function to write a state history (map of epoch to state vector) to a binary stream.
+/*!
+ *  Function to write a state history (map of epoch to state vector) to a binary stream, with the values stored exactly as
+ *  they are in memory (so that long double histories are written without loss of precision).
+ *  \param outputStream Stream to which the state history is to be written (opened in binary mode).
+ *  \param dataMap State history that is to be written; all states must have the same size.
+ *  \param caseTag Tag identifying the simulation case (truncated to 183 characters).
+ *  \return Total number of bytes written to the stream.
+ */
+template< typename EpochType, typename ScalarType, int NumberOfRows >
+std::uint64_t writeDataMapToBinaryStream(
+        std::ostream& outputStream,
+        const std::map< EpochType, Eigen::Matrix< ScalarType, NumberOfRows, 1 > >& dataMap,
+        const std::string& caseTag = "" )
+{
+    unsigned int stateSize = ( dataMap.size( ) > 0 ) ? dataMap.begin( )->second.rows( ) : 0;
+    std::vector< EpochType > epochs;
+    epochs.reserve( dataMap.size( ) );
+    std::vector< ScalarType > stateColumns( dataMap.size( ) * stateSize );
+
+    unsigned int rowIndex = 0;
+    for( auto dataIterator = dataMap.begin( ); dataIterator != dataMap.end( ); dataIterator++ )
+    {
+        if( dataIterator->second.rows( ) != stateSize )
+        {
+            throw std::runtime_error( "Error when writing binary state history " + caseTag +
+                                      ", state size is not constant." );
+        }
+
+        epochs.push_back( dataIterator->first );
+        for( unsigned int j = 0; j < stateSize; j++ )
+        {
+            stateColumns[ j * dataMap.size( ) + rowIndex ] = dataIterator->second( j );
+        }
+        rowIndex++;
+    }
+
+    return writeColumnarStateHistoryToBinaryStream( outputStream, epochs, stateColumns, stateSize, caseTag );
+}
+
+//! Function to write a scalar history (map of epoch to scalar) to a binary stream.
+/*!
+ *  Function to write a scalar history (map of epoch to scalar) to a binary stream, as a state history with a single column.
+ *  \param outputStream Stream to which the history is to be written (opened in binary mode).
+ *  \param dataMap History that is to be written.
+ *  \param caseTag Tag identifying the simulation case (truncated to 183 characters).
+ *  \return Total number of bytes written to the stream.
+ */
+template< typename EpochType, typename ScalarType >
+std::uint64_t writeDataMapToBinaryStream(
+        std::ostream& outputStream,
+        const std::map< EpochType, ScalarType >& dataMap,
+        const std::string& caseTag = "" )
+{
+    std::vector< EpochType > epochs;
+    std::vector< ScalarType > stateColumn;
+    epochs.reserve( dataMap.size( ) );
+    stateColumn.reserve( dataMap.size( ) );
+    for( auto dataIterator = dataMap.begin( ); dataIterator != dataMap.end( ); dataIterator++ )
+    {
+        epochs.push_back( dataIterator->first );
+        stateColumn.push_back( dataIterator->second );
+    }
+
+    return writeColumnarStateHistoryToBinaryStream( outputStream, epochs, stateColumn, 1, caseTag );
+}
+
+//! Function to write a state or scalar history to a binary file.
+/*!
+ *  Function to write a state or scalar history to a binary file, in the format described by BinaryStateHistoryHeader. This
+ *  function is the binary counterpart of input_output::writeDataMapToTextFile, and creates the output directory if it does
+ *  not exist.
+ *  \param dataMap History that is to be written (map of epoch to state vector, or map of epoch to scalar).
+ *  \param fileName Name of the file that is to be written.
+ *  \param outputDirectory Directory to which the file is to be written.
+ *  \param caseTag Tag identifying the simulation case (truncated to 183 characters).
+ */
+template< typename DataMapType >
+void writeDataMapToBinaryFile( const DataMapType& dataMap,
+                               const std::string& fileName,
+                               const std::string& outputDirectory,
+                               const std::string& caseTag = "" )
+{
+    boost::filesystem::path outputPath( outputDirectory );
+    if( !outputDirectory.empty( ) && !boost::filesystem::exists( outputPath ) )
+    {
+        boost::filesystem::create_directories( outputPath );
+    }
+
+    std::ofstream outputFile( ( outputPath / fileName ).string( ), std::ios::binary | std::ios::trunc );
+    if( !outputFile.is_open( ) )
+    {
+        throw std::runtime_error( "Error, could not open binary output file " + ( outputPath / fileName ).string( ) );
+    }
+    writeDataMapToBinaryStream( outputFile, dataMap, caseTag );
+}
+
+//! Function to read and check the header of a binary state history from a stream.
+/*!
+ *  Function to read and check the header of a binary state history from a stream, leaving the stream positioned at the
+ *  start of the epoch column.
+ *  \param inputStream Stream from which the header is to be read (opened in binary mode).
+ *  \return Header of the binary state history.
+ */
+inline BinaryStateHistoryHeader readBinaryStateHistoryHeader( std::istream& inputStream )
+{
+    BinaryStateHistoryHeader header;
+    inputStream.read( reinterpret_cast< char* >( &header ), sizeof( header ) );
+    if( !inputStream || std::strncmp( header.fileIdentifier, "TUDATSH", sizeof( header.fileIdentifier ) ) != 0 )
+    {
+        throw std::runtime_error( "Error when reading binary state history, no valid header found." );
+    }
+    else if( header.byteOrderMark != 0x01020304 )
+    {
+        throw std::runtime_error( "Error when reading binary state history, file was written with different byte order." );
+    }
+    else if( header.formatVersion > BINARY_STATE_HISTORY_FORMAT_VERSION )
+    {
+        throw std::runtime_error( "Error when reading binary state history, file format version not supported." );
+    }
+    inputStream.ignore( header.epochColumnOffset - sizeof( header ) );
+    return header;
+}
+
+//! Function to read a binary state history from a stream.
+/*!
+ *  Function to read a binary state history from a stream, starting at a header written by writeDataMapToBinaryStream.
+ *  \param inputStream Stream from which the state history is to be read (opened in binary mode).
+ *  \param caseTag Tag of the simulation case stored in the file (returned by reference).
+ *  \return State history read from the stream.
+ */
+template< typename EpochType = double, typename ScalarType = double >
+std::map< EpochType, Eigen::Matrix< ScalarType, Eigen::Dynamic, 1 > > readDataMapFromBinaryStream(
+        std::istream& inputStream, std::string& caseTag )
+{
+    BinaryStateHistoryHeader header = readBinaryStateHistoryHeader( inputStream );
+    if( header.epochScalarType != static_cast< std::uint32_t >( getBinaryScalarType< EpochType >( ) ) ||
+            header.epochScalarSize != sizeof( EpochType ) ||
+            header.stateScalarType != static_cast< std::uint32_t >( getBinaryScalarType< ScalarType >( ) ) ||
+            header.stateScalarSize != sizeof( ScalarType ) )
+    {
+        throw std::runtime_error( "Error when reading binary state history, requested scalar types do not match file." );
+    }
+    header.caseTag[ sizeof( header.caseTag ) - 1 ] = '\0';
+    caseTag = std::string( header.caseTag );
+
+    std::vector< EpochType > epochs( header.numberOfEpochs );
+    std::vector< ScalarType > stateColumns( header.numberOfEpochs * header.stateSize );
+    inputStream.read( reinterpret_cast< char* >( epochs.data( ) ), epochs.size( ) * sizeof( EpochType ) );
+    inputStream.ignore( header.stateColumnsOffset - header.epochColumnOffset - epochs.size( ) * sizeof( EpochType ) );
+    inputStream.read( reinterpret_cast< char* >( stateColumns.data( ) ), stateColumns.size( ) * sizeof( ScalarType ) );
+    if( !inputStream )
+    {
+        throw std::runtime_error( "Error when reading binary state history " + caseTag + ", file is truncated." );
+    }
+
+    std::map< EpochType, Eigen::Matrix< ScalarType, Eigen::Dynamic, 1 > > dataMap;
+    for( unsigned int i = 0; i < header.numberOfEpochs; i++ )
+    {
+        Eigen::Matrix< ScalarType, Eigen::Dynamic, 1 > currentState( header.stateSize );
+        for( unsigned int j = 0; j < header.stateSize; j++ )
+        {
+            currentState( j ) = stateColumns[ j * header.numberOfEpochs + i ];
+        }
+        dataMap[ epochs[ i ] ] = currentState;
+    }
+    return dataMap;
+}
+
+//! Function to read a binary state history from a file.
+/*!
+ *  Function to read a binary state history from a file written by writeDataMapToBinaryFile.
+ *  \param filePath Path of file that is to be read.
+ *  \return State history read from the file.
+ */
+template< typename EpochType = double, typename ScalarType = double >
+std::map< EpochType, Eigen::Matrix< ScalarType, Eigen::Dynamic, 1 > > readDataMapFromBinaryFile(
+        const std::string& filePath )
+{
+    std::ifstream inputFile( filePath, std::ios::binary );
+    if( !inputFile.is_open( ) )
+    {
+        throw std::runtime_error( "Error, could not open binary state history file " + filePath );
+    }
+
+    std::string caseTag;
+    return readDataMapFromBinaryStream< EpochType, ScalarType >( inputFile, caseTag );
+}
+
+}
+
+#endif // TUDAT_BINARYSTATEHISTORYOUTPUT_H
@@ -0,0 +1,739 @@
+/*    Copyright (c) 2010-2018, Delft University of Technology
+ *    All rigths reserved
+ *
+ *    This file is part of the Tudat. Redistribution and use in source and
+ *    binary forms, with or without modification, are permitted exclusively
+ *    under the terms of the Modified BSD license. You should have received
+ *    a copy of the license with this file. If not, please or visit:
+ *    http://tudat.tudelft.nl/LICENSE.
+ */
+
+#ifndef TUDAT_BUTCHERTABLEAUINTEGRATOR_H
+#define TUDAT_BUTCHERTABLEAUINTEGRATOR_H
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+
+#include <Tudat/SimulationSetup/tudatSimulationHeader.h>
+
+#include "propagationAndOptimization/integrationStepAllocationCheck.h"
+
+namespace tudat_applications
+{
+
+// Coefficients of the Butcher tableaus (entry [ i ][ j ] of a matrix is a_ij, stages numbered from 0).
+
+//! Coefficients of the classical fourth-order Runge-Kutta method.
+constexpr double rungeKutta4ACoefficients[ 4 ][ 4 ] =
+{ { 0.0 }, { 1.0 / 2.0 }, { 0.0, 1.0 / 2.0 }, { 0.0, 0.0, 1.0 } };
+constexpr double rungeKutta4CCoefficients[ 4 ] = { 0.0, 1.0 / 2.0, 1.0 / 2.0, 1.0 };
+constexpr double rungeKutta4BCoefficients[ 4 ] = { 1.0 / 6.0, 1.0 / 3.0, 1.0 / 3.0, 1.0 / 6.0 };
+
+//! Coefficients of the Runge-Kutta-Fehlberg 4(5) method.
+constexpr double rungeKuttaFehlberg45ACoefficients[ 6 ][ 6 ] =
+{ { 0.0 },
+  { 1.0 / 4.0 },
+  { 3.0 / 32.0, 9.0 / 32.0 },
+  { 1932.0 / 2197.0, -7200.0 / 2197.0, 7296.0 / 2197.0 },
+  { 439.0 / 216.0, -8.0, 3680.0 / 513.0, -845.0 / 4104.0 },
+  { -8.0 / 27.0, 2.0, -3544.0 / 2565.0, 1859.0 / 4104.0, -11.0 / 40.0 } };
+constexpr double rungeKuttaFehlberg45CCoefficients[ 6 ] = { 0.0, 1.0 / 4.0, 3.0 / 8.0, 12.0 / 13.0, 1.0, 1.0 / 2.0 };
+constexpr double rungeKuttaFehlberg45LowerOrderBCoefficients[ 6 ] =
+{ 25.0 / 216.0, 0.0, 1408.0 / 2565.0, 2197.0 / 4104.0, -1.0 / 5.0, 0.0 };
+constexpr double rungeKuttaFehlberg45HigherOrderBCoefficients[ 6 ] =
+{ 16.0 / 135.0, 0.0, 6656.0 / 12825.0, 28561.0 / 56430.0, -9.0 / 50.0, 2.0 / 55.0 };
+
+//! Coefficients of the Runge-Kutta-Fehlberg 5(6) method.
+constexpr double rungeKuttaFehlberg56ACoefficients[ 8 ][ 8 ] =
+{ { 0.0 },
+  { 1.0 / 6.0 },
+  { 4.0 / 75.0, 16.0 / 75.0 },
+  { 5.0 / 6.0, -8.0 / 3.0, 5.0 / 2.0 },
+  { -8.0 / 5.0, 144.0 / 25.0, -4.0, 16.0 / 25.0 },
+  { 361.0 / 320.0, -18.0 / 5.0, 407.0 / 128.0, -11.0 / 80.0, 55.0 / 128.0 },
+  { -11.0 / 640.0, 0.0, 11.0 / 256.0, -11.0 / 160.0, 11.0 / 256.0, 0.0 },
+  { 93.0 / 640.0, -18.0 / 5.0, 803.0 / 256.0, -11.0 / 160.0, 99.0 / 256.0, 0.0, 1.0 } };
+constexpr double rungeKuttaFehlberg56CCoefficients[ 8 ] =
+{ 0.0, 1.0 / 6.0, 4.0 / 15.0, 2.0 / 3.0, 4.0 / 5.0, 1.0, 0.0, 1.0 };
+constexpr double rungeKuttaFehlberg56LowerOrderBCoefficients[ 8 ] =
+{ 31.0 / 384.0, 0.0, 1125.0 / 2816.0, 9.0 / 32.0, 125.0 / 768.0, 5.0 / 66.0, 0.0, 0.0 };
+constexpr double rungeKuttaFehlberg56HigherOrderBCoefficients[ 8 ] =
+{ 7.0 / 1408.0, 0.0, 1125.0 / 2816.0, 9.0 / 32.0, 125.0 / 768.0, 0.0, 5.0 / 66.0, 5.0 / 66.0 };
+
+//! Coefficients of the Runge-Kutta-Fehlberg 7(8) method.
+constexpr double rungeKuttaFehlberg78ACoefficients[ 13 ][ 13 ] =
+{ { 0.0 },
+  { 2.0 / 27.0 },
+  { 1.0 / 36.0, 1.0 / 12.0 },
+  { 1.0 / 24.0, 0.0, 1.0 / 8.0 },
+  { 5.0 / 12.0, 0.0, -25.0 / 16.0, 25.0 / 16.0 },
+  { 1.0 / 20.0, 0.0, 0.0, 1.0 / 4.0, 1.0 / 5.0 },
+  { -25.0 / 108.0, 0.0, 0.0, 125.0 / 108.0, -65.0 / 27.0, 125.0 / 54.0 },
+  { 31.0 / 300.0, 0.0, 0.0, 0.0, 61.0 / 225.0, -2.0 / 9.0, 13.0 / 900.0 },
+  { 2.0, 0.0, 0.0, -53.0 / 6.0, 704.0 / 45.0, -107.0 / 9.0, 67.0 / 90.0, 3.0 },
+  { -91.0 / 108.0, 0.0, 0.0, 23.0 / 108.0, -976.0 / 135.0, 311.0 / 54.0, -19.0 / 60.0, 17.0 / 6.0, -1.0 / 12.0 },
+  { 2383.0 / 4100.0, 0.0, 0.0, -341.0 / 164.0, 4496.0 / 1025.0, -301.0 / 82.0, 2133.0 / 4100.0, 45.0 / 82.0,
+    45.0 / 164.0, 18.0 / 41.0 },
+  { 3.0 / 205.0, 0.0, 0.0, 0.0, 0.0, -6.0 / 41.0, -3.0 / 205.0, -3.0 / 41.0, 3.0 / 41.0, 6.0 / 41.0, 0.0 },
+  { -1777.0 / 4100.0, 0.0, 0.0, -341.0 / 164.0, 4496.0 / 1025.0, -289.0 / 82.0, 2193.0 / 4100.0, 51.0 / 82.0,
+    33.0 / 164.0, 12.0 / 41.0, 0.0, 1.0 } };
+constexpr double rungeKuttaFehlberg78CCoefficients[ 13 ] =
+{ 0.0, 2.0 / 27.0, 1.0 / 9.0, 1.0 / 6.0, 5.0 / 12.0, 1.0 / 2.0, 5.0 / 6.0, 1.0 / 6.0, 2.0 / 3.0, 1.0 / 3.0, 1.0, 0.0, 1.0 };
+constexpr double rungeKuttaFehlberg78LowerOrderBCoefficients[ 13 ] =
+{ 41.0 / 840.0, 0.0, 0.0, 0.0, 0.0, 34.0 / 105.0, 9.0 / 35.0, 9.0 / 35.0, 9.0 / 280.0, 9.0 / 280.0, 41.0 / 840.0, 0.0, 0.0 };
+constexpr double rungeKuttaFehlberg78HigherOrderBCoefficients[ 13 ] =
+{ 0.0, 0.0, 0.0, 0.0, 0.0, 34.0 / 105.0, 9.0 / 35.0, 9.0 / 35.0, 9.0 / 280.0, 9.0 / 280.0, 0.0, 41.0 / 840.0, 41.0 / 840.0 };
+
+//! Coefficients of the Runge-Kutta 8(7) method of Dormand and Prince.
+constexpr double rungeKutta87DormandPrinceACoefficients[ 13 ][ 13 ] =
+{ { 0.0 },
+  { 1.0 / 18.0 },
+  { 1.0 / 48.0, 1.0 / 16.0 },
+  { 1.0 / 32.0, 0.0, 3.0 / 32.0 },
+  { 5.0 / 16.0, 0.0, -75.0 / 64.0, 75.0 / 64.0 },
+  { 3.0 / 80.0, 0.0, 0.0, 3.0 / 16.0, 3.0 / 20.0 },
+  { 29443841.0 / 614563906.0, 0.0, 0.0, 77736538.0 / 692538347.0, -28693883.0 / 1125000000.0,
+    23124283.0 / 1800000000.0 },
+  { 16016141.0 / 946692911.0, 0.0, 0.0, 61564180.0 / 158732637.0, 22789713.0 / 633445777.0,
+    545815736.0 / 2771057229.0, -180193667.0 / 1043307555.0 },
+  { 39632708.0 / 573591083.0, 0.0, 0.0, -433636366.0 / 683701615.0, -421739975.0 / 2616292301.0,
+    100302831.0 / 723423059.0, 790204164.0 / 839813087.0, 800635310.0 / 3783071287.0 },
+  { 246121993.0 / 1340847787.0, 0.0, 0.0, -37695042795.0 / 15268766246.0, -309121744.0 / 1061227803.0,
+    -12992083.0 / 490766935.0, 6005943493.0 / 2108947869.0, 393006217.0 / 1396673457.0, 123872331.0 / 1001029789.0 },
+  { -1028468189.0 / 846180014.0, 0.0, 0.0, 8478235783.0 / 508512852.0, 1311729495.0 / 1432422823.0,
+    -10304129995.0 / 1701304382.0, -48777925059.0 / 3047939560.0, 15336726248.0 / 1032824649.0,
+    -45442868181.0 / 3398467696.0, 3065993473.0 / 597172653.0 },
+  { 185892177.0 / 718116043.0, 0.0, 0.0, -3185094517.0 / 667107341.0, -477755414.0 / 1098053517.0,
+    -703635378.0 / 230739211.0, 5731566787.0 / 1027545527.0, 5232866602.0 / 850066563.0,
+    -4093664535.0 / 808688257.0, 3962137247.0 / 1805957418.0, 65686358.0 / 487910083.0 },
+  { 403863854.0 / 491063109.0, 0.0, 0.0, -5068492393.0 / 434740067.0, -411421997.0 / 543043805.0,
+    652783627.0 / 914296604.0, 11173962825.0 / 925320556.0, -13158990841.0 / 6184727034.0,
+    3936647629.0 / 1978049680.0, -160528059.0 / 685178525.0, 248638103.0 / 1413531060.0, 0.0 } };
+constexpr double rungeKutta87DormandPrinceCCoefficients[ 13 ] =
+{ 0.0, 1.0 / 18.0, 1.0 / 12.0, 1.0 / 8.0, 5.0 / 16.0, 3.0 / 8.0, 59.0 / 400.0, 93.0 / 200.0,
+  5490023248.0 / 9719169821.0, 13.0 / 20.0, 1201146811.0 / 1299019798.0, 1.0, 1.0 };
+constexpr double rungeKutta87DormandPrinceLowerOrderBCoefficients[ 13 ] =
+{ 13451932.0 / 455176623.0, 0.0, 0.0, 0.0, 0.0, -808719846.0 / 976000145.0, 1757004468.0 / 5645159321.0,
+  656045339.0 / 265891186.0, -3867574721.0 / 1518517206.0, 465885868.0 / 322736535.0, 53011238.0 / 667516719.0,
+  2.0 / 45.0, 0.0 };
+constexpr double rungeKutta87DormandPrinceHigherOrderBCoefficients[ 13 ] =
+{ 14005451.0 / 335480064.0, 0.0, 0.0, 0.0, 0.0, -59238493.0 / 1068277825.0, 181606767.0 / 758867731.0,
+  561292985.0 / 797845732.0, -1041891430.0 / 1371343529.0, 760417239.0 / 1151165299.0, 118820643.0 / 751138087.0,
+  -528747749.0 / 2220607170.0, 1.0 / 4.0 };
+
+//! Butcher tableau of the classical fourth-order Runge-Kutta method (fixed step size, no error estimate).
+struct RungeKutta4Tableau
+{
+    static constexpr int numberOfStages = 4;
+    static constexpr int lowerOrder = 4;
+    static constexpr int higherOrder = 4;
+    static constexpr bool isEmbedded = false;
+    static constexpr bool isHigherOrderPropagated = false;
+
+    static constexpr double a( const int i, const int j ){ return rungeKutta4ACoefficients[ i ][ j ]; }
+    static constexpr double c( const int i ){ return rungeKutta4CCoefficients[ i ]; }
+    static constexpr double lowerOrderB( const int i ){ return rungeKutta4BCoefficients[ i ]; }
+    static constexpr double higherOrderB( const int i ){ return rungeKutta4BCoefficients[ i ]; }
+};
+
+//! Butcher tableau of the Runge-Kutta-Fehlberg 4(5) method (lower order propagated, as in Tudat).
+struct RungeKuttaFehlberg45Tableau
+{
+    static constexpr int numberOfStages = 6;
+    static constexpr int lowerOrder = 4;
+    static constexpr int higherOrder = 5;
+    static constexpr bool isEmbedded = true;
+    static constexpr bool isHigherOrderPropagated = false;
+
+    static constexpr double a( const int i, const int j ){ return rungeKuttaFehlberg45ACoefficients[ i ][ j ]; }
+    static constexpr double c( const int i ){ return rungeKuttaFehlberg45CCoefficients[ i ]; }
+    static constexpr double lowerOrderB( const int i ){ return rungeKuttaFehlberg45LowerOrderBCoefficients[ i ]; }
+    static constexpr double higherOrderB( const int i ){ return rungeKuttaFehlberg45HigherOrderBCoefficients[ i ]; }
+};
+
+//! Butcher tableau of the Runge-Kutta-Fehlberg 5(6) method (lower order propagated, as in Tudat).
+struct RungeKuttaFehlberg56Tableau
+{
+    static constexpr int numberOfStages = 8;
+    static constexpr int lowerOrder = 5;
+    static constexpr int higherOrder = 6;
+    static constexpr bool isEmbedded = true;
+    static constexpr bool isHigherOrderPropagated = false;
+
+    static constexpr double a( const int i, const int j ){ return rungeKuttaFehlberg56ACoefficients[ i ][ j ]; }
+    static constexpr double c( const int i ){ return rungeKuttaFehlberg56CCoefficients[ i ]; }
+    static constexpr double lowerOrderB( const int i ){ return rungeKuttaFehlberg56LowerOrderBCoefficients[ i ]; }
+    static constexpr double higherOrderB( const int i ){ return rungeKuttaFehlberg56HigherOrderBCoefficients[ i ]; }
+};
+
+//! Butcher tableau of the Runge-Kutta-Fehlberg 7(8) method (lower order propagated, as in Tudat).
+struct RungeKuttaFehlberg78Tableau
+{
+    static constexpr int numberOfStages = 13;
+    static constexpr int lowerOrder = 7;
+    static constexpr int higherOrder = 8;
+    static constexpr bool isEmbedded = true;
+    static constexpr bool isHigherOrderPropagated = false;
+
+    static constexpr double a( const int i, const int j ){ return rungeKuttaFehlberg78ACoefficients[ i ][ j ]; }
+    static constexpr double c( const int i ){ return rungeKuttaFehlberg78CCoefficients[ i ]; }
+    static constexpr double lowerOrderB( const int i ){ return rungeKuttaFehlberg78LowerOrderBCoefficients[ i ]; }
+    static constexpr double higherOrderB( const int i ){ return rungeKuttaFehlberg78HigherOrderBCoefficients[ i ]; }
+};
+
+//! Butcher tableau of the Runge-Kutta 8(7) method of Dormand and Prince (higher order propagated, as in Tudat).
+struct RungeKutta87DormandPrinceTableau
+{
+    static constexpr int numberOfStages = 13;
+    static constexpr int lowerOrder = 7;
+    static constexpr int higherOrder = 8;
+    static constexpr bool isEmbedded = true;
+    static constexpr bool isHigherOrderPropagated = true;
+
+    static constexpr double a( const int i, const int j ){ return rungeKutta87DormandPrinceACoefficients[ i ][ j ]; }
+    static constexpr double c( const int i ){ return rungeKutta87DormandPrinceCCoefficients[ i ]; }
+    static constexpr double lowerOrderB( const int i ){ return rungeKutta87DormandPrinceLowerOrderBCoefficients[ i ]; }
+    static constexpr double higherOrderB( const int i ){ return rungeKutta87DormandPrinceHigherOrderBCoefficients[ i ]; }
+};
+
+//! Coefficients a_ij (for j < i) with which the stage derivatives are combined into the state at stage i.
+template< typename Tableau, int Stage >
+struct StageStateCoefficients
+{
+    static constexpr double get( const int j ){ return Tableau::a( Stage, j ); }
+};
+
+//! Weights with which the stage derivatives are combined into the propagated state.
+template< typename Tableau >
+struct PropagatedStateWeights
+{
+    static constexpr double get( const int j )
+    {
+        return Tableau::isHigherOrderPropagated ? Tableau::higherOrderB( j ) : Tableau::lowerOrderB( j );
+    }
+};
+
+//! Weights with which the stage derivatives are combined into the difference between the higher- and lower-order states.
+template< typename Tableau >
+struct ErrorEstimateWeights
+{
+    static constexpr double get( const int j ){ return Tableau::higherOrderB( j ) - Tableau::lowerOrderB( j ); }
+};
+
+//! Function object adding a stage derivative with a given (non-zero) coefficient to a state.
+template< bool IsCoefficientNonZero >
+struct StageDerivativeAddition
+{
+    template< typename StateType, typename ScalarType >
+    static void add( StateType& state, const ScalarType scaledCoefficient, const StateType& stageDerivative )
+    {
+        state.noalias( ) += scaledCoefficient * stageDerivative;
+    }
+};
+
+//! Function object for a stage derivative with a zero coefficient, for which nothing is computed.
+template< >
+struct StageDerivativeAddition< false >
+{
+    template< typename StateType, typename ScalarType >
+    static void add( StateType&, const ScalarType, const StateType& ){ }
+};
+
+//! Unrolled linear combination of stage derivatives, from the given term up to (excluding) the given number of terms.
+/*!
+ *  Unrolled linear combination of stage derivatives, from the given term up to (excluding) the given number of terms. The
+ *  coefficients are compile-time constants (see StageStateCoefficients, PropagatedStateWeights and ErrorEstimateWeights), so
+ *  that terms with a zero coefficient do not generate any code.
+ */
+template< typename Coefficients, int Term, int NumberOfTerms >
+struct UnrolledStageDerivativeCombination
+{
+    template< typename StateType, typename TimeStepType >
+    static void add( StateType& state, const TimeStepType stepSize, const StateType* stageDerivatives )
+    {
+        typedef typename StateType::Scalar ScalarType;
+        StageDerivativeAddition< ( Coefficients::get( Term ) != 0.0 ) >::add(
+                    state, static_cast< ScalarType >( stepSize ) * static_cast< ScalarType >( Coefficients::get( Term ) ),
+                    stageDerivatives[ Term ] );
+        UnrolledStageDerivativeCombination< Coefficients, Term + 1, NumberOfTerms >::add(
+                    state, stepSize, stageDerivatives );
+    }
+};
+
+//! Termination of the unrolled linear combination of stage derivatives.
+template< typename Coefficients, int NumberOfTerms >
+struct UnrolledStageDerivativeCombination< Coefficients, NumberOfTerms, NumberOfTerms >
+{
+    template< typename StateType, typename TimeStepType >
+    static void add( StateType&, const TimeStepType, const StateType* ){ }
+};
+
+//! Interface of integrators that retain the state derivative at the start of the last step.
+/*!
+ *  Interface of integrators that retain the state derivative at the start of the last step as part of their stage data
+ *  (e.g. the first stage of a Runge-Kutta step), so that it can be used for dense output without additional evaluations of
+ *  the dynamics (see DenseOutputStateHistorySink).
+ */
+template< typename StateType, typename TimeType >
+class StepStartStateDerivativeInterface
+{
+public:
+
+    //! Destructor
+    virtual ~StepStartStateDerivativeInterface( ){ }
+
+    //! Function to get the state derivative at the start of the last step (i.e. at getPreviousIndependentVariable).
+    virtual const StateType& getPreviousStateDerivative( ) const = 0;
+};
+
+//! Runge-Kutta integrator with a compile-time Butcher tableau.
+/*!
+ *  Runge-Kutta integrator with a compile-time Butcher tableau (e.g. RungeKuttaFehlberg78Tableau). The loops over the stages
+ *  and over the coefficients of each stage are unrolled at compile time, and terms with a zero coefficient are skipped, so
+ *  that each step is evaluated as straight-line code, without the loops over the (mostly zero) coefficient matrices of the
+ *  runtime tableaus in Tudat. The stage derivatives and intermediate states are stored in a workspace that is allocated at
+ *  construction, so that no memory is allocated per step other than by the state derivative function (and for the state
+ *  that is returned). This is asserted in each step if EIGEN_RUNTIME_NO_MALLOC is defined (see ScopedEigenAllocationCheck).
+ *
+ *  For embedded methods, the step size is controlled as in the RungeKuttaVariableStepSizeIntegrator in Tudat: the relative
+ *  truncation error is the maximum over the state entries of the difference between the higher- and lower-order estimates,
+ *  divided by the relative error tolerance times the magnitude of the higher-order estimate plus the absolute error
+ *  tolerance. A step is rejected (and retaken with a smaller step size) if this error exceeds one. The next step size is
+ *  the current one times the safety factor times the inverse error to the power 1 / (lower order + 1), limited by the
+ *  maximum increase and minimum decrease factors and by the maximum step size. For methods that are not embedded (e.g.
+ *  RungeKutta4Tableau) the step size is fixed.
+ *
+ *  The derivative at the first stage of the last step (the state derivative at the start of that step) is retained, and
+ *  can be retrieved through the StepStartStateDerivativeInterface.
+ */
+template< typename Tableau, typename StateType = Eigen::VectorXd, typename TimeType = double >
+class ButcherTableauRungeKuttaIntegrator:
+        public tudat::numerical_integrators::NumericalIntegrator< TimeType, StateType, StateType, TimeType >,
+        public StepStartStateDerivativeInterface< StateType, TimeType >
+{
+public:
+
+    typedef tudat::numerical_integrators::NumericalIntegrator< TimeType, StateType, StateType, TimeType > Base;
+
+    typedef typename StateType::Scalar StateScalarType;
+
+    //! Constructor for fixed step size (or to use the default step-size control settings of Tudat).
+    /*!
+     *  Constructor for fixed step size (or to use the default step-size control settings of Tudat, without limits on the
+     *  step size).
+     *  \param stateDerivativeFunction State derivative function.
+     *  \param initialTime Initial time of the integration.
+     *  \param initialState Initial state.
+     *  \param relativeErrorTolerance Relative error tolerance (not used if the method is not embedded).
+     *  \param absoluteErrorTolerance Absolute error tolerance (not used if the method is not embedded).
+     *  \param minimumStepSize Minimum step size (not used if the method is not embedded).
+     *  \param maximumStepSize Maximum step size (not used if the method is not embedded).
+     *  \param safetyFactorForNextStepSize Safety factor for the next step size (not used if the method is not embedded).
+     *  \param maximumFactorIncreaseForNextStepSize Maximum factor by which the step size increases in a step (not used if
+     *  the method is not embedded).
+     *  \param minimumFactorDecreaseForNextStepSize Minimum factor by which the step size decreases in a step (not used if
+     *  the method is not embedded).
+     */
+    ButcherTableauRungeKuttaIntegrator(
+            const typename Base::StateDerivativeFunction& stateDerivativeFunction,
+            const TimeType initialTime,
+            const StateType& initialState,
+            const TimeType relativeErrorTolerance = 1.0E-12,
+            const TimeType absoluteErrorTolerance = 1.0E-12,
+            const TimeType minimumStepSize = 0.0,
+            const TimeType maximumStepSize = std::numeric_limits< TimeType >::infinity( ),
+            const TimeType safetyFactorForNextStepSize = 0.8,
+            const TimeType maximumFactorIncreaseForNextStepSize = 4.0,
+            const TimeType minimumFactorDecreaseForNextStepSize = 0.1 ):
+        Base( stateDerivativeFunction ),
+        currentTime_( initialTime ), currentState_( initialState ),
+        previousTime_( initialTime ), isRollbackAllowed_( false ),
+        relativeErrorTolerance_( relativeErrorTolerance ), absoluteErrorTolerance_( absoluteErrorTolerance ),
+        minimumStepSize_( minimumStepSize ), maximumStepSize_( maximumStepSize ),
+        safetyFactorForNextStepSize_( safetyFactorForNextStepSize ),
+        maximumFactorIncreaseForNextStepSize_( maximumFactorIncreaseForNextStepSize ),
+        minimumFactorDecreaseForNextStepSize_( minimumFactorDecreaseForNextStepSize ),
+        lastStepSize_( 0.0 ), nextStepSize_( 0.0 )
+    {
+        // Allocate workspace.
+        for( int i = 0; i < Tableau::numberOfStages; i++ )
+        {
+            stageDerivatives_[ i ] = initialState;
+        }
+        stageState_ = initialState;
+        proposedState_ = initialState;
+        errorEstimate_ = initialState;
+        previousState_ = initialState;
+    }
+
+    //! Destructor
+    ~ButcherTableauRungeKuttaIntegrator( ){ }
+
+    //! Function to perform a single step, reducing the step size as long as the step is rejected.
+    /*!
+     *  Function to perform a single step, reducing the step size as long as the step is rejected (see class description).
+     *  The step size that was actually taken is given by getCurrentIndependentVariable minus the previous time.
+     *  \param stepSize Step size to attempt.
+     *  \return State at the end of the step.
+     */
+    StateType performIntegrationStep( const TimeType stepSize )
+    {
+        {
+            ScopedEigenAllocationCheck allocationCheck;
+
+            TimeType currentStepSize = stepSize;
+            while( !attemptIntegrationStep( currentStepSize ) )
+            {
+                currentStepSize = nextStepSize_;
+            }
+
+            previousTime_ = currentTime_;
+            previousState_.swap( currentState_ );
+            currentState_.swap( proposedState_ );
+            currentTime_ += currentStepSize;
+            lastStepSize_ = currentStepSize;
+            isRollbackAllowed_ = true;
+        }
+        return currentState_;
+    }
+
+    //! Function to get the step size for the next step.
+    TimeType getNextStepSize( ) const { return nextStepSize_; }
+
+    //! Function to get the current state.
+    StateType getCurrentState( ) const { return currentState_; }
+
+    //! Function to get the current time.
+    TimeType getCurrentIndependentVariable( ) const { return currentTime_; }
+
+    //! Function to get the time at the start of the last step.
+    TimeType getPreviousIndependentVariable( ) { return previousTime_; }
+
+    //! Function to get the state at the start of the last step.
+    StateType getPreviousState( ) { return previousState_; }
+
+    //! Function to roll back the last step (possible only once per step).
+    /*!
+     *  Function to roll back the last step (possible only once per step, and not after the state has been modified without
+     *  allowing a rollback).
+     *  \return True if the last step was rolled back.
+     */
+    bool rollbackToPreviousState( )
+    {
+        if( !isRollbackAllowed_ )
+        {
+            return false;
+        }
+
+        currentTime_ = previousTime_;
+        currentState_.swap( previousState_ );
+        isRollbackAllowed_ = false;
+        return true;
+    }
+
+    //! Function to modify the current state (e.g. after an impulsive maneuver).
+    /*!
+     *  Function to modify the current state (e.g. after an impulsive maneuver).
+     *  \param newState New current state.
+     *  \param allowRollback Boolean denoting whether the last step may still be rolled back.
+     */
+    void modifyCurrentState( const StateType& newState, const bool allowRollback )
+    {
+        currentState_ = newState;
+        isRollbackAllowed_ = isRollbackAllowed_ && allowRollback;
+    }
+
+    //! Function to modify the current state, after which the last step can no longer be rolled back.
+    void modifyCurrentState( const StateType& newState )
+    {
+        modifyCurrentState( newState, false );
+    }
+
+    //! Function to get the size of the last step that was taken.
+    TimeType getLastStepSize( ) const { return lastStepSize_; }
+
+    //! Function to get the state derivative at the start of the last step (the derivative at its first stage).
+    const StateType& getPreviousStateDerivative( ) const { return stageDerivatives_[ 0 ]; }
+
+private:
+
+    //! Function to evaluate the derivatives at all stages from the given stage onwards (unrolled through recursion).
+    template< int Stage >
+    void evaluateStages( const TimeType stepSize, std::integral_constant< int, Stage > )
+    {
+        if( Stage > 0 )
+        {
+            stageState_ = currentState_;
+            UnrolledStageDerivativeCombination< StageStateCoefficients< Tableau, Stage >, 0, Stage >::add(
+                        stageState_, stepSize, stageDerivatives_ );
+        }
+
+        // Evaluate state derivative (which may allocate memory, as it is not part of the integrator).
+        {
+            ScopedEigenAllocationCheck stateDerivativeAllocationCheck( true );
+            stageDerivatives_[ Stage ] = this->stateDerivativeFunction_(
+                        currentTime_ + static_cast< TimeType >( Tableau::c( Stage ) ) * stepSize,
+                        ( Stage == 0 ) ? currentState_ : stageState_ );
+        }
+        evaluateStages( stepSize, std::integral_constant< int, Stage + 1 >( ) );
+    }
+
+    //! Termination of the evaluation of the stage derivatives.
+    void evaluateStages( const TimeType, std::integral_constant< int, Tableau::numberOfStages > ){ }
+
+    //! Function to attempt a step from the current state, setting the proposed state and the next step size.
+    /*!
+     *  Function to attempt a step from the current state, setting the proposed state and the next step size.
+     *  \param stepSize Step size to attempt.
+     *  \return True if the step is accepted (always the case for methods that are not embedded).
+     */
+    bool attemptIntegrationStep( const TimeType stepSize )
+    {
+        evaluateStages( stepSize, std::integral_constant< int, 0 >( ) );
+
+        proposedState_ = currentState_;
+        UnrolledStageDerivativeCombination< PropagatedStateWeights< Tableau >, 0, Tableau::numberOfStages >::add(
+                    proposedState_, stepSize, stageDerivatives_ );
+
+        return computeNextStepSize( stepSize, std::integral_constant< bool, Tableau::isEmbedded >( ) );
+    }
+
+    //! Function to set the next step size for a method that is not embedded (equal to the current step size).
+    bool computeNextStepSize( const TimeType stepSize, std::false_type )
+    {
+        nextStepSize_ = stepSize;
+        return true;
+    }
+
+    //! Function to set the next step size for an embedded method, from the error estimate of the attempted step.
+    /*!
+     *  Function to set the next step size for an embedded method, from the error estimate of the attempted step.
+     *  \param stepSize Step size that was attempted.
+     *  \return True if the step is accepted.
+     */
+    bool computeNextStepSize( const TimeType stepSize, std::true_type )
+    {
+        // Compute difference between higher- and lower-order estimates.
+        errorEstimate_.setZero( );
+        UnrolledStageDerivativeCombination< ErrorEstimateWeights< Tableau >, 0, Tableau::numberOfStages >::add(
+                    errorEstimate_, stepSize, stageDerivatives_ );
+
+        // Compute maximum relative truncation error.
+        TimeType maximumErrorInState = 0.0;
+        for( int i = 0; i < errorEstimate_.size( ); i++ )
+        {
+            const StateScalarType higherOrderEstimate = Tableau::isHigherOrderPropagated ?
+                        proposedState_( i ) : proposedState_( i ) + errorEstimate_( i );
+            const TimeType relativeError = static_cast< TimeType >(
+                        std::fabs( errorEstimate_( i ) ) / ( std::fabs( higherOrderEstimate ) * relativeErrorTolerance_ +
+                                                             absoluteErrorTolerance_ ) );
+            if( !( relativeError <= maximumErrorInState ) )
+            {
+                maximumErrorInState = relativeError;
+            }
+        }
+
+        // Compute next step size.
+        const TimeType timeStepRatio = safetyFactorForNextStepSize_ * std::pow(
+                    1.0 / maximumErrorInState, 1.0 / ( static_cast< double >( Tableau::lowerOrder ) + 1.0 ) );
+        if( timeStepRatio > maximumFactorIncreaseForNextStepSize_ )
+        {
+            nextStepSize_ = stepSize * maximumFactorIncreaseForNextStepSize_;
+        }
+        else if( !( timeStepRatio >= minimumFactorDecreaseForNextStepSize_ ) )
+        {
+            nextStepSize_ = stepSize * minimumFactorDecreaseForNextStepSize_;
+        }
+        else
+        {
+            nextStepSize_ = stepSize * timeStepRatio;
+        }
+
+        if( std::fabs( nextStepSize_ ) > maximumStepSize_ )
+        {
+            nextStepSize_ = ( nextStepSize_ > 0.0 ) ? maximumStepSize_ : -maximumStepSize_;
+        }
+
+        const bool isStepAccepted = ( maximumErrorInState <= 1.0 );
+        if( std::fabs( nextStepSize_ ) < minimumStepSize_ )
+        {
+            if( !isStepAccepted )
+            {
+                throw std::runtime_error( "Error in Runge-Kutta step-size control, minimum step size exceeded." );
+            }
+            nextStepSize_ = ( nextStepSize_ > 0.0 ) ? minimumStepSize_ : -minimumStepSize_;
+        }
+
+        return isStepAccepted;
+    }
+
+    //! Current time.
+    TimeType currentTime_;
+
+    //! Current state.
+    StateType currentState_;
+
+    //! Time at the start of the last step.
+    TimeType previousTime_;
+
+    //! State at the start of the last step.
+    StateType previousState_;
+
+    //! Boolean denoting whether the last step can be rolled back.
+    bool isRollbackAllowed_;
+
+    //! Derivatives at the stages of the current step.
+    StateType stageDerivatives_[ Tableau::numberOfStages ];
+
+    //! State at the stage that is currently evaluated.
+    StateType stageState_;
+
+    //! State at the end of the step that is currently attempted.
+    StateType proposedState_;
+
+    //! Difference between the higher- and lower-order estimates of the state at the end of the step that is attempted.
+    StateType errorEstimate_;
+
+    //! Relative error tolerance.
+    TimeType relativeErrorTolerance_;
+
+    //! Absolute error tolerance.
+    TimeType absoluteErrorTolerance_;
+
+    //! Minimum step size.
+    TimeType minimumStepSize_;
+
+    //! Maximum step size.
+    TimeType maximumStepSize_;
+
+    //! Safety factor for the next step size.
+    TimeType safetyFactorForNextStepSize_;
+
+    //! Maximum factor by which the step size increases in a step.
+    TimeType maximumFactorIncreaseForNextStepSize_;
+
+    //! Minimum factor by which the step size decreases in a step.
+    TimeType minimumFactorDecreaseForNextStepSize_;
+
+    //! Size of the last step that was taken.
+    TimeType lastStepSize_;
+
+    //! Step size for the next step.
+    TimeType nextStepSize_;
+
+public:
+
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+//! Function to create an embedded Runge-Kutta integrator with a compile-time Butcher tableau from the integrator settings.
+template< typename Tableau, typename TimeType, typename StateType >
+std::shared_ptr< tudat::numerical_integrators::NumericalIntegrator< TimeType, StateType, StateType, TimeType > >
+createButcherTableauRungeKuttaIntegrator(
+        const std::function< StateType( const TimeType, const StateType& ) >& stateDerivativeFunction,
+        const StateType& initialState,
+        const std::shared_ptr< tudat::numerical_integrators::RungeKuttaVariableStepSizeSettings< TimeType > >
+        variableStepSizeSettings )
+{
+    return std::shared_ptr< ButcherTableauRungeKuttaIntegrator< Tableau, StateType, TimeType > >(
+                new ButcherTableauRungeKuttaIntegrator< Tableau, StateType, TimeType >(
+                    stateDerivativeFunction, variableStepSizeSettings->initialTime_, initialState,
+                    variableStepSizeSettings->relativeErrorTolerance_, variableStepSizeSettings->absoluteErrorTolerance_,
+                    variableStepSizeSettings->minimumStepSize_, variableStepSizeSettings->maximumStepSize_,
+                    variableStepSizeSettings->safetyFactorForNextStepSize_,
+                    variableStepSizeSettings->maximumFactorIncreaseForNextStepSize_,
+                    variableStepSizeSettings->minimumFactorDecreaseForNextStepSize_ ) );
+}
+
+//! Function to create a Runge-Kutta integrator with a compile-time Butcher tableau, if available for the settings.
+/*!
+ *  Function to create a ButcherTableauRungeKuttaIntegrator from the integrator settings, for the fourth-order Runge-Kutta
+ *  method and for the Runge-Kutta-Fehlberg 4(5), 5(6) and 7(8) and Dormand-Prince 8(7) variable step-size methods. The
+ *  state may be of any (dynamic or fixed-size) Eigen type.
+ *  \param stateDerivativeFunction State derivative function.
+ *  \param initialState Initial state.
+ *  \param integratorSettings Settings for the numerical integrator.
+ *  \return Numerical integrator (nullptr if no compile-time Butcher tableau is available for the settings).
+ */
+template< typename TimeType, typename StateType >
+std::shared_ptr< tudat::numerical_integrators::NumericalIntegrator< TimeType, StateType, StateType, TimeType > >
+createButcherTableauIntegrator(
+        const std::function< StateType( const TimeType, const StateType& ) >& stateDerivativeFunction,
+        const StateType& initialState,
+        const std::shared_ptr< tudat::numerical_integrators::IntegratorSettings< TimeType > > integratorSettings )
+{
+    using namespace tudat::numerical_integrators;
+
+    if( integratorSettings->integratorType_ == rungeKutta4 )
+    {
+        return std::shared_ptr< ButcherTableauRungeKuttaIntegrator< RungeKutta4Tableau, StateType, TimeType > >(
+                    new ButcherTableauRungeKuttaIntegrator< RungeKutta4Tableau, StateType, TimeType >(
+                        stateDerivativeFunction, integratorSettings->initialTime_, initialState ) );
+    }
+    else if( integratorSettings->integratorType_ == rungeKuttaVariableStepSize )
+    {
+        std::shared_ptr< RungeKuttaVariableStepSizeSettings< TimeType > > variableStepSizeSettings =
+                std::dynamic_pointer_cast< RungeKuttaVariableStepSizeSettings< TimeType > >( integratorSettings );
+        if( variableStepSizeSettings == nullptr )
+        {
+            throw std::runtime_error( "Error, type of integrator settings not compatible with selected integrator." );
+        }
+
+        switch( variableStepSizeSettings->coefficientSet_ )
+        {
+        case RungeKuttaCoefficients::rungeKuttaFehlberg45:
+            return createButcherTableauRungeKuttaIntegrator< RungeKuttaFehlberg45Tableau >(
+                        stateDerivativeFunction, initialState, variableStepSizeSettings );
+        case RungeKuttaCoefficients::rungeKuttaFehlberg56:
+            return createButcherTableauRungeKuttaIntegrator< RungeKuttaFehlberg56Tableau >(
+                        stateDerivativeFunction, initialState, variableStepSizeSettings );
+        case RungeKuttaCoefficients::rungeKuttaFehlberg78:
+            return createButcherTableauRungeKuttaIntegrator< RungeKuttaFehlberg78Tableau >(
+                        stateDerivativeFunction, initialState, variableStepSizeSettings );
+        case RungeKuttaCoefficients::rungeKutta87DormandPrince:
+            return createButcherTableauRungeKuttaIntegrator< RungeKutta87DormandPrinceTableau >(
+                        stateDerivativeFunction, initialState, variableStepSizeSettings );
+        default:
+            break;
+        }
+    }
+
+    return nullptr;
+}
+
+//! Function to create a numerical integrator, using a compile-time Butcher tableau where available.
+/*!
+ *  Function to create a numerical integrator from the integrator settings, as the createIntegrator function in Tudat, but
+ *  using a ButcherTableauRungeKuttaIntegrator where available (see createButcherTableauIntegrator). For all other settings,
+ *  the integrator of Tudat is created.
+ *  \param stateDerivativeFunction State derivative function.
+ *  \param initialState Initial state.
+ *  \param integratorSettings Settings for the numerical integrator.
+ *  \return Numerical integrator.
+ */
+template< typename TimeType, typename StateType >
+std::shared_ptr< tudat::numerical_integrators::NumericalIntegrator< TimeType, StateType, StateType, TimeType > >
+createIntegratorWithButcherTableaus(
+        const std::function< StateType( const TimeType, const StateType& ) >& stateDerivativeFunction,
+        const StateType& initialState,
+        const std::shared_ptr< tudat::numerical_integrators::IntegratorSettings< TimeType > > integratorSettings )
+{
+    std::shared_ptr< tudat::numerical_integrators::NumericalIntegrator< TimeType, StateType, StateType, TimeType > >
+            integrator = createButcherTableauIntegrator< TimeType, StateType >(
+                stateDerivativeFunction, initialState, integratorSettings );
+    if( integrator == nullptr )
+    {
+        integrator = tudat::numerical_integrators::createIntegrator< TimeType, StateType >(
+                    stateDerivativeFunction, initialState, integratorSettings );
+    }
+    return integrator;
+}
+
+}
+
+#endif // TUDAT_BUTCHERTABLEAUINTEGRATOR_H
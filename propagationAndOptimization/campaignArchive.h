@@ -0,0 +1,465 @@
+/*    Copyright (c) 2010-2018, Delft University of Technology
+ *    All rigths reserved
+ *
+ *    This file is part of the Tudat. Redistribution and use in source and
+ *    binary forms, with or without modification, are permitted exclusively
+ *    under the terms of the Modified BSD license. You should have received
+ *    a copy of the license with this file. If not, please or visit:
+ *    http://tudat.tudelft.nl/LICENSE.
+ */
+
+#ifndef TUDAT_CAMPAIGNARCHIVE_H
+#define TUDAT_CAMPAIGNARCHIVE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "propagationAndOptimization/binaryStateHistoryOutput.h"
+
+namespace tudat_applications
+{
+
+//! Fixed-size (32 byte) trailer at the end of a finalized campaign archive, locating the index.
+struct CampaignArchiveTrailer
+{
+    //! Offset (in bytes, w.r.t. start of file) of the index.
+    std::uint64_t indexOffset;
+
+    //! Number of entries in the index.
+    std::uint64_t numberOfEntries;
+
+    //! Format version of the archive.
+    std::uint32_t formatVersion;
+
+    //! Reserved, set to zero.
+    std::uint32_t reserved;
+
+    //! Trailer identifier, equal to "TUDATCAI" (not null-terminated).
+    char trailerIdentifier[ 8 ];
+};
+
+static_assert( sizeof( CampaignArchiveTrailer ) == 32, "Error, unexpected size of campaign archive trailer." );
+
+//! Current version of the campaign archive format.
+static const std::uint32_t CAMPAIGN_ARCHIVE_FORMAT_VERSION = 1;
+
+//! Size (in bytes) of the identifier at the start of a campaign archive.
+static const std::uint64_t CAMPAIGN_ARCHIVE_HEADER_SIZE = 16;
+
+//! Location of a single entry in a campaign archive.
+struct CampaignArchiveEntry
+{
+    //! Offset (in bytes, w.r.t. start of file) of the binary state history of the entry.
+    std::uint64_t offset;
+
+    //! Size (in bytes) of the binary state history of the entry.
+    std::uint64_t size;
+};
+
+//! Class to write the output of all cases of a simulation campaign to a single, indexed, file.
+/*!
+ *  Class to write the output of all cases of a simulation campaign to a single, indexed, file. Each history is stored as a
+ *  binary state history (see binaryStateHistoryOutput.h, with the case key as case tag), appended to the file at a
+ *  16-byte aligned offset. When the archive is finalized (explicitly, or on destruction), an index of all entries (case
+ *  key, offset and size) is appended, followed by a fixed-size trailer (see CampaignArchiveTrailer) locating the index,
+ *  so that any entry can be retrieved (or memory-mapped) without scanning the file. If the writing program is aborted
+ *  before the index is written, the entries can still be recovered by scanning the file (see CampaignArchiveReader).
+ *
+ *  The case key typically contains the name of the history and the indices of the case, and is constructed in the same
+ *  manner as the file names of text output (e.g. "numericalKeplerOrbitError_e_0_intType3_intSett1_propSett0"). Entries
+ *  may be added concurrently from multiple threads: the data are serialized on the calling thread, and only appending
+ *  to the file is done under a lock.
+ */
+class CampaignArchiveWriter
+{
+public:
+
+    //! Constructor, creates the archive file (overwriting any existing file), or reopens an existing archive.
+    /*!
+     *  Constructor, creates the archive file (overwriting any existing file), or reopens an existing archive (to which
+     *  entries are then appended) when resuming an interrupted campaign. When reopening, the index of a finalized archive
+     *  is removed (and rewritten on finalization), and any incomplete entry at the end of a non-finalized archive is
+     *  discarded. Entries of a reopened archive may be added again (e.g. for a case that was interrupted after some of
+     *  its output was written), in which case the index refers to the latest entry.
+     *  \param fileName Name of the archive file.
+     *  \param outputDirectory Directory in which the archive is to be created (created if it does not exist).
+     *  \param appendToExistingArchive Boolean denoting whether an existing archive is to be reopened (a new archive is
+     *  created if the file does not exist).
+     */
+    CampaignArchiveWriter( const std::string& fileName, const std::string& outputDirectory,
+                           const bool appendToExistingArchive = false ):
+        isFinalized_( false ), allowEntryReplacement_( false )
+    {
+        boost::filesystem::path outputPath( outputDirectory );
+        if( !outputDirectory.empty( ) && !boost::filesystem::exists( outputPath ) )
+        {
+            boost::filesystem::create_directories( outputPath );
+        }
+        filePath_ = ( outputPath / fileName ).string( );
+
+        if( appendToExistingArchive && boost::filesystem::exists( filePath_ ) )
+        {
+            reopenArchive( );
+            return;
+        }
+
+        archiveFile_.open( filePath_, std::ios::binary | std::ios::trunc );
+        if( !archiveFile_.is_open( ) )
+        {
+            throw std::runtime_error( "Error, could not open campaign archive " + filePath_ );
+        }
+
+        char archiveHeader[ CAMPAIGN_ARCHIVE_HEADER_SIZE ] = { };
+        std::strncpy( archiveHeader, "TUDATCA", 8 );
+        std::memcpy( archiveHeader + 8, &CAMPAIGN_ARCHIVE_FORMAT_VERSION, sizeof( CAMPAIGN_ARCHIVE_FORMAT_VERSION ) );
+        archiveFile_.write( archiveHeader, CAMPAIGN_ARCHIVE_HEADER_SIZE );
+        currentOffset_ = CAMPAIGN_ARCHIVE_HEADER_SIZE;
+    }
+
+    //! Destructor, finalizes the archive if this has not yet been done.
+    ~CampaignArchiveWriter( )
+    {
+        try
+        {
+            finalize( );
+        }
+        catch( std::exception& caughtException )
+        {
+            std::cerr<<"Error when finalizing campaign archive "<<filePath_<<": "<<caughtException.what( )<<std::endl;
+        }
+    }
+
+    //! Function to add a history (map of epoch to state vector, or of epoch to scalar) to the archive.
+    /*!
+     *  Function to add a history (map of epoch to state vector, or of epoch to scalar) to the archive. This function may be
+     *  called concurrently from multiple threads.
+     *  \param dataMap History that is to be added.
+     *  \param caseKey Unique key of the history in the archive (at most 183 characters).
+     */
+    template< typename DataMapType >
+    void addDataMap( const DataMapType& dataMap, const std::string& caseKey )
+    {
+        if( caseKey.size( ) >= sizeof( BinaryStateHistoryHeader( ).caseTag ) )
+        {
+            throw std::runtime_error( "Error when adding " + caseKey + " to campaign archive, key is too long." );
+        }
+
+        // Serialize history outside of lock.
+        std::ostringstream serializedEntry( std::ios::binary );
+        std::uint64_t entrySize = writeDataMapToBinaryStream( serializedEntry, dataMap, caseKey );
+        std::string entryData = serializedEntry.str( );
+
+        std::lock_guard< std::mutex > lock( archiveMutex_ );
+        if( isFinalized_ )
+        {
+            throw std::runtime_error( "Error when adding " + caseKey + " to campaign archive, archive is finalized." );
+        }
+        else if( archiveIndex_.count( caseKey ) > 0 && !allowEntryReplacement_ )
+        {
+            throw std::runtime_error( "Error when adding " + caseKey + " to campaign archive, key already exists." );
+        }
+
+        archiveFile_.write( entryData.data( ), entrySize );
+        archiveIndex_[ caseKey ] = CampaignArchiveEntry{ currentOffset_, entrySize };
+        currentOffset_ += entrySize;
+        writePadding( );
+
+        // Flush entry, so that it is complete on disk when the case is subsequently marked as completed (see SweepJournal).
+        archiveFile_.flush( );
+
+        if( !archiveFile_ )
+        {
+            throw std::runtime_error( "Error when adding " + caseKey + " to campaign archive, write failed." );
+        }
+    }
+
+    //! Function to write the index and trailer, and close the archive. Subsequent calls have no effect.
+    void finalize( )
+    {
+        std::lock_guard< std::mutex > lock( archiveMutex_ );
+        if( isFinalized_ )
+        {
+            return;
+        }
+        isFinalized_ = true;
+
+        CampaignArchiveTrailer trailer;
+        std::memset( &trailer, 0, sizeof( trailer ) );
+        trailer.indexOffset = currentOffset_;
+        trailer.numberOfEntries = archiveIndex_.size( );
+        trailer.formatVersion = CAMPAIGN_ARCHIVE_FORMAT_VERSION;
+        std::memcpy( trailer.trailerIdentifier, "TUDATCAI", sizeof( trailer.trailerIdentifier ) );
+
+        // Write index as list of (key length, key, offset, size).
+        for( auto indexIterator : archiveIndex_ )
+        {
+            std::uint32_t keyLength = indexIterator.first.size( );
+            archiveFile_.write( reinterpret_cast< const char* >( &keyLength ), sizeof( keyLength ) );
+            archiveFile_.write( indexIterator.first.data( ), keyLength );
+            archiveFile_.write( reinterpret_cast< const char* >( &indexIterator.second.offset ), sizeof( std::uint64_t ) );
+            archiveFile_.write( reinterpret_cast< const char* >( &indexIterator.second.size ), sizeof( std::uint64_t ) );
+        }
+        archiveFile_.write( reinterpret_cast< const char* >( &trailer ), sizeof( trailer ) );
+        archiveFile_.close( );
+
+        if( !archiveFile_ )
+        {
+            throw std::runtime_error( "Error when writing index of campaign archive " + filePath_ );
+        }
+    }
+
+private:
+
+    //! Function to reopen an existing archive, reading its index and truncating it after the last complete entry.
+    void reopenArchive( );
+
+    //! Function to pad the file to a 16-byte boundary, so that the next entry can be memory-mapped.
+    void writePadding( )
+    {
+        const char padding[ 16 ] = { };
+        std::uint64_t paddingSize = ( 16 - currentOffset_ % 16 ) % 16;
+        archiveFile_.write( padding, paddingSize );
+        currentOffset_ += paddingSize;
+    }
+
+    //! Path of the archive file.
+    std::string filePath_;
+
+    //! Stream to which the archive is written.
+    std::ofstream archiveFile_;
+
+    //! Current size of the archive file.
+    std::uint64_t currentOffset_;
+
+    //! Location of each entry in the archive, per case key.
+    std::map< std::string, CampaignArchiveEntry > archiveIndex_;
+
+    //! Boolean denoting whether the index has been written.
+    bool isFinalized_;
+
+    //! Boolean denoting whether an entry may be added with the key of an existing entry (only for reopened archives).
+    bool allowEntryReplacement_;
+
+    //! Mutex protecting the file and index.
+    std::mutex archiveMutex_;
+};
+
+//! Class to read entries from a campaign archive written by CampaignArchiveWriter.
+/*!
+ *  Class to read entries from a campaign archive written by CampaignArchiveWriter. On construction, the index is read
+ *  from the end of the file. If the archive was not finalized (e.g. the writing program was aborted), the index is
+ *  reconstructed by scanning the entries, discarding any incomplete entry at the end of the file.
+ */
+class CampaignArchiveReader
+{
+public:
+
+    //! Constructor, reads (or reconstructs) the index of the archive.
+    /*!
+     *  Constructor, reads (or reconstructs) the index of the archive.
+     *  \param filePath Path of the archive file.
+     */
+    CampaignArchiveReader( const std::string& filePath ):
+        filePath_( filePath ), isFinalized_( false )
+    {
+        archiveFile_.open( filePath_, std::ios::binary );
+        if( !archiveFile_.is_open( ) )
+        {
+            throw std::runtime_error( "Error, could not open campaign archive " + filePath_ );
+        }
+
+        char archiveHeader[ CAMPAIGN_ARCHIVE_HEADER_SIZE ];
+        archiveFile_.read( archiveHeader, CAMPAIGN_ARCHIVE_HEADER_SIZE );
+        if( !archiveFile_ || std::strncmp( archiveHeader, "TUDATCA", 8 ) != 0 )
+        {
+            throw std::runtime_error( "Error, " + filePath_ + " is not a campaign archive." );
+        }
+
+        archiveFile_.seekg( 0, std::ios::end );
+        std::uint64_t fileSize = archiveFile_.tellg( );
+
+        if( !readIndex( fileSize ) )
+        {
+            reconstructIndex( fileSize );
+        }
+    }
+
+    //! Function to retrieve whether the archive was finalized (i.e. the index was read from file, not reconstructed).
+    bool isFinalized( ) const
+    {
+        return isFinalized_;
+    }
+
+    //! Function to retrieve the case keys of all entries in the archive.
+    std::vector< std::string > getCaseKeys( ) const
+    {
+        std::vector< std::string > caseKeys;
+        for( auto indexIterator : archiveIndex_ )
+        {
+            caseKeys.push_back( indexIterator.first );
+        }
+        return caseKeys;
+    }
+
+    //! Function to check whether an entry with a given case key exists in the archive.
+    bool hasEntry( const std::string& caseKey ) const
+    {
+        return archiveIndex_.count( caseKey ) > 0;
+    }
+
+    //! Function to retrieve the location of an entry in the archive.
+    CampaignArchiveEntry getEntry( const std::string& caseKey ) const
+    {
+        if( archiveIndex_.count( caseKey ) == 0 )
+        {
+            throw std::runtime_error( "Error, " + caseKey + " not found in campaign archive " + filePath_ );
+        }
+        return archiveIndex_.at( caseKey );
+    }
+
+    //! Function to read a single history from the archive.
+    /*!
+     *  Function to read a single history from the archive, without reading any other entries.
+     *  \param caseKey Key of the history that is to be read.
+     *  \return History with given key.
+     */
+    template< typename EpochType = double, typename ScalarType = double >
+    std::map< EpochType, Eigen::Matrix< ScalarType, Eigen::Dynamic, 1 > > readDataMap( const std::string& caseKey )
+    {
+        archiveFile_.clear( );
+        archiveFile_.seekg( getEntry( caseKey ).offset );
+
+        std::string caseTag;
+        return readDataMapFromBinaryStream< EpochType, ScalarType >( archiveFile_, caseTag );
+    }
+
+private:
+
+    //! Function to read the index from the end of the file, returns false if no valid trailer is found.
+    bool readIndex( const std::uint64_t fileSize )
+    {
+        if( fileSize < CAMPAIGN_ARCHIVE_HEADER_SIZE + sizeof( CampaignArchiveTrailer ) )
+        {
+            return false;
+        }
+
+        CampaignArchiveTrailer trailer;
+        archiveFile_.seekg( fileSize - sizeof( CampaignArchiveTrailer ) );
+        archiveFile_.read( reinterpret_cast< char* >( &trailer ), sizeof( trailer ) );
+        if( !archiveFile_ || std::strncmp( trailer.trailerIdentifier, "TUDATCAI", 8 ) != 0 )
+        {
+            archiveFile_.clear( );
+            return false;
+        }
+        else if( trailer.formatVersion > CAMPAIGN_ARCHIVE_FORMAT_VERSION )
+        {
+            throw std::runtime_error( "Error, format version of campaign archive " + filePath_ + " not supported." );
+        }
+
+        archiveFile_.seekg( trailer.indexOffset );
+        for( unsigned int i = 0; i < trailer.numberOfEntries; i++ )
+        {
+            std::uint32_t keyLength;
+            CampaignArchiveEntry currentEntry;
+            archiveFile_.read( reinterpret_cast< char* >( &keyLength ), sizeof( keyLength ) );
+            std::string caseKey( keyLength, ' ' );
+            archiveFile_.read( &caseKey[ 0 ], keyLength );
+            archiveFile_.read( reinterpret_cast< char* >( &currentEntry.offset ), sizeof( std::uint64_t ) );
+            archiveFile_.read( reinterpret_cast< char* >( &currentEntry.size ), sizeof( std::uint64_t ) );
+            archiveIndex_[ caseKey ] = currentEntry;
+        }
+
+        if( !archiveFile_ )
+        {
+            throw std::runtime_error( "Error, index of campaign archive " + filePath_ + " is corrupt." );
+        }
+        isFinalized_ = true;
+        return true;
+    }
+
+    //! Function to reconstruct the index by scanning all (complete) entries in the file.
+    void reconstructIndex( const std::uint64_t fileSize )
+    {
+        std::uint64_t currentOffset = CAMPAIGN_ARCHIVE_HEADER_SIZE;
+        while( currentOffset + sizeof( BinaryStateHistoryHeader ) <= fileSize )
+        {
+            archiveFile_.seekg( currentOffset );
+            BinaryStateHistoryHeader entryHeader;
+            try
+            {
+                entryHeader = readBinaryStateHistoryHeader( archiveFile_ );
+            }
+            catch( std::runtime_error& )
+            {
+                break;
+            }
+
+            std::uint64_t entrySize = entryHeader.headerSize + getBinaryStateHistoryDataSize( entryHeader );
+            if( currentOffset + entrySize > fileSize )
+            {
+                break;
+            }
+
+            entryHeader.caseTag[ sizeof( entryHeader.caseTag ) - 1 ] = '\0';
+            archiveIndex_[ std::string( entryHeader.caseTag ) ] = CampaignArchiveEntry{ currentOffset, entrySize };
+            currentOffset += entrySize;
+            currentOffset += ( 16 - currentOffset % 16 ) % 16;
+        }
+        archiveFile_.clear( );
+    }
+
+    //! Path of the archive file.
+    std::string filePath_;
+
+    //! Stream from which the archive is read.
+    std::ifstream archiveFile_;
+
+    //! Location of each entry in the archive, per case key.
+    std::map< std::string, CampaignArchiveEntry > archiveIndex_;
+
+    //! Boolean denoting whether the index was read from file.
+    bool isFinalized_;
+};
+
+inline void CampaignArchiveWriter::reopenArchive( )
+{
+    // Read (or reconstruct) index of existing entries, and determine end of last complete entry.
+    std::uint64_t endOffset = CAMPAIGN_ARCHIVE_HEADER_SIZE;
+    {
+        CampaignArchiveReader archiveReader( filePath_ );
+        std::vector< std::string > caseKeys = archiveReader.getCaseKeys( );
+        for( unsigned int i = 0; i < caseKeys.size( ); i++ )
+        {
+            CampaignArchiveEntry currentEntry = archiveReader.getEntry( caseKeys.at( i ) );
+            archiveIndex_[ caseKeys.at( i ) ] = currentEntry;
+            endOffset = std::max( endOffset, currentEntry.offset + currentEntry.size );
+        }
+    }
+    endOffset += ( 16 - endOffset % 16 ) % 16;
+
+    // Remove index and trailer (or incomplete entry), and continue writing at end of last complete entry.
+    boost::filesystem::resize_file( filePath_, endOffset );
+    archiveFile_.open( filePath_, std::ios::binary | std::ios::in | std::ios::out );
+    if( !archiveFile_.is_open( ) )
+    {
+        throw std::runtime_error( "Error, could not reopen campaign archive " + filePath_ );
+    }
+    archiveFile_.seekp( endOffset );
+    currentOffset_ = endOffset;
+    allowEntryReplacement_ = true;
+}
+
+}
+
+#endif // TUDAT_CAMPAIGNARCHIVE_H
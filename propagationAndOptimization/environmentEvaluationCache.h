@@ -0,0 +1,318 @@
+/*    Copyright (c) 2010-2018, Delft University of Technology
+ *    All rigths reserved
+ *
+ *    This file is part of the Tudat. Redistribution and use in source and
+ *    binary forms, with or without modification, are permitted exclusively
+ *    under the terms of the Modified BSD license. You should have received
+ *    a copy of the license with this file. If not, please or visit:
+ *    http://tudat.tudelft.nl/LICENSE.
+ */
+
+#ifndef TUDAT_ENVIRONMENTEVALUATIONCACHE_H
+#define TUDAT_ENVIRONMENTEVALUATIONCACHE_H
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+#include <Eigen/StdVector>
+
+#include <Tudat/SimulationSetup/tudatSimulationHeader.h>
+
+namespace tudat_applications
+{
+
+//! Cache of values computed at the most recent epochs, used to avoid re-evaluating the environment at the same epoch.
+/*!
+ *  Cache of values computed at the most recent epochs, used to avoid re-evaluating the environment at the same epoch. The
+ *  cache is a ring buffer of fixed size, in which a look-up is a linear search (from the most recent entry backward) on
+ *  the exact epoch. This is efficient for numerical integrators, in which the same epoch recurs within a few evaluations
+ *  (e.g. stages 2 and 3 of an RK4 step, or the end of a step and the start of the next one), but not at random.
+ */
+template< typename ValueType >
+class EpochValueCache
+{
+public:
+
+    //! Constructor
+    /*!
+     *  Constructor
+     *  \param numberOfCachedEpochs Number of most recent epochs for which the value is retained.
+     */
+    EpochValueCache( const unsigned int numberOfCachedEpochs ):
+        epochs_( numberOfCachedEpochs ), values_( numberOfCachedEpochs ), numberOfEntries_( 0 ), lastEntry_( 0 )
+    {
+        if( numberOfCachedEpochs == 0 )
+        {
+            throw std::runtime_error( "Error, number of cached epochs must be positive." );
+        }
+    }
+
+    //! Function to retrieve a pointer to the value cached for an epoch (nullptr if the epoch is not in the cache).
+    ValueType* find( const double epoch )
+    {
+        unsigned int currentEntry = lastEntry_;
+        for( unsigned int i = 0; i < numberOfEntries_; i++ )
+        {
+            if( epochs_[ currentEntry ] == epoch )
+            {
+                return &values_[ currentEntry ];
+            }
+            currentEntry = ( currentEntry == 0 ) ? ( epochs_.size( ) - 1 ) : ( currentEntry - 1 );
+        }
+        return nullptr;
+    }
+
+    //! Function to add the value at an epoch to the cache (replacing the value at the oldest epoch if the cache is full).
+    ValueType& insert( const double epoch, const ValueType& value )
+    {
+        if( numberOfEntries_ > 0 )
+        {
+            lastEntry_ = ( lastEntry_ + 1 ) % epochs_.size( );
+        }
+        if( numberOfEntries_ < epochs_.size( ) )
+        {
+            numberOfEntries_++;
+        }
+        epochs_[ lastEntry_ ] = epoch;
+        values_[ lastEntry_ ] = value;
+        return values_[ lastEntry_ ];
+    }
+
+private:
+
+    //! Cached epochs.
+    std::vector< double > epochs_;
+
+    //! Values at cached epochs.
+    std::vector< ValueType, Eigen::aligned_allocator< ValueType > > values_;
+
+    //! Number of filled entries.
+    unsigned int numberOfEntries_;
+
+    //! Index of most recently added entry.
+    unsigned int lastEntry_;
+};
+
+//! Ephemeris retaining the states computed by another ephemeris at the most recent epochs.
+/*!
+ *  Ephemeris retaining the states computed by another ephemeris at the most recent epochs (see EpochValueCache), so that
+ *  the states of the environment are computed only once when the state derivative is evaluated repeatedly at the same
+ *  epoch. The returned states are identical to those of the wrapped ephemeris. Like the Body objects using it, it must not
+ *  be used concurrently from multiple threads.
+ */
+class EpochCachedEphemeris: public tudat::ephemerides::Ephemeris
+{
+public:
+
+    //! Constructor
+    /*!
+     *  Constructor
+     *  \param ephemeris Ephemeris of which the states are cached.
+     *  \param numberOfCachedEpochs Number of most recent epochs for which the state is retained.
+     */
+    EpochCachedEphemeris( const std::shared_ptr< tudat::ephemerides::Ephemeris > ephemeris,
+                          const unsigned int numberOfCachedEpochs = 16 ):
+        tudat::ephemerides::Ephemeris( ephemeris->getReferenceFrameOrigin( ), ephemeris->getReferenceFrameOrientation( ) ),
+        ephemeris_( ephemeris ), stateCache_( numberOfCachedEpochs ){ }
+
+    //! Function to retrieve the state at a given epoch (from the cache, if available).
+    Eigen::Vector6d getCartesianState( const double secondsSinceEpoch )
+    {
+        Eigen::Vector6d* cachedState = stateCache_.find( secondsSinceEpoch );
+        if( cachedState == nullptr )
+        {
+            cachedState = &stateCache_.insert( secondsSinceEpoch, ephemeris_->getCartesianState( secondsSinceEpoch ) );
+        }
+        return *cachedState;
+    }
+
+    //! Function to retrieve the state at a given epoch in long double precision (not cached).
+    Eigen::Matrix< long double, 6, 1 > getCartesianLongState( const double secondsSinceEpoch )
+    {
+        return ephemeris_->getCartesianLongState( secondsSinceEpoch );
+    }
+
+    //! Function to retrieve the state at a given extended-precision epoch (not cached).
+    Eigen::Vector6d getCartesianStateFromExtendedTime( const tudat::Time& currentTime )
+    {
+        return ephemeris_->getCartesianStateFromExtendedTime( currentTime );
+    }
+
+    //! Function to retrieve the state at a given extended-precision epoch in long double precision (not cached).
+    Eigen::Matrix< long double, 6, 1 > getCartesianLongStateFromExtendedTime( const tudat::Time& currentTime )
+    {
+        return ephemeris_->getCartesianLongStateFromExtendedTime( currentTime );
+    }
+
+    //! Function to retrieve the ephemeris of which the states are cached.
+    std::shared_ptr< tudat::ephemerides::Ephemeris > getWrappedEphemeris( ) { return ephemeris_; }
+
+private:
+
+    //! Ephemeris of which the states are cached.
+    std::shared_ptr< tudat::ephemerides::Ephemeris > ephemeris_;
+
+    //! States at the most recent epochs.
+    EpochValueCache< Eigen::Vector6d > stateCache_;
+};
+
+//! Rotational state of a body at a single epoch, as retained by an EpochCachedRotationalEphemeris.
+struct CachedRotationalState
+{
+    //! Rotation from base to target (body-fixed) frame.
+    Eigen::Quaterniond rotationToTargetFrame;
+
+    //! Time derivative of rotation matrix from base to target frame.
+    Eigen::Matrix3d derivativeOfRotationToTargetFrame;
+
+    //! Angular velocity vector of target frame, expressed in base frame.
+    Eigen::Vector3d rotationalVelocityVectorInBaseFrame;
+};
+
+//! Rotational ephemeris retaining the rotational states computed by another model at the most recent epochs.
+/*!
+ *  Rotational ephemeris retaining the rotational states computed by another model at the most recent epochs (see
+ *  EpochValueCache and EpochCachedEphemeris). For expensive rotation models (e.g. the IAU 2006 GCRS to ITRS model), this
+ *  avoids re-evaluating the precession-nutation and polar motion models at the same epoch. The full rotational state is
+ *  computed and cached when any of its quantities is requested for an epoch that is not in the cache; the rotation to the
+ *  base frame and its derivative are obtained from those to the target frame by transposition.
+ */
+class EpochCachedRotationalEphemeris: public tudat::ephemerides::RotationalEphemeris
+{
+public:
+
+    //! Constructor
+    /*!
+     *  Constructor
+     *  \param rotationalEphemeris Rotation model of which the rotational states are cached.
+     *  \param numberOfCachedEpochs Number of most recent epochs for which the rotational state is retained.
+     */
+    EpochCachedRotationalEphemeris(
+            const std::shared_ptr< tudat::ephemerides::RotationalEphemeris > rotationalEphemeris,
+            const unsigned int numberOfCachedEpochs = 16 ):
+        tudat::ephemerides::RotationalEphemeris( rotationalEphemeris->getBaseFrameOrientation( ),
+                                                 rotationalEphemeris->getTargetFrameOrientation( ) ),
+        rotationalEphemeris_( rotationalEphemeris ), rotationalStateCache_( numberOfCachedEpochs ){ }
+
+    //! Function to retrieve the rotation from target to base frame.
+    Eigen::Quaterniond getRotationToBaseFrame( const double secondsSinceEpoch )
+    {
+        return getRotationalState( secondsSinceEpoch ).rotationToTargetFrame.inverse( );
+    }
+
+    //! Function to retrieve the rotation from base to target frame.
+    Eigen::Quaterniond getRotationToTargetFrame( const double secondsSinceEpoch )
+    {
+        return getRotationalState( secondsSinceEpoch ).rotationToTargetFrame;
+    }
+
+    //! Function to retrieve the time derivative of the rotation matrix from target to base frame.
+    Eigen::Matrix3d getDerivativeOfRotationToBaseFrame( const double secondsSinceEpoch )
+    {
+        return getRotationalState( secondsSinceEpoch ).derivativeOfRotationToTargetFrame.transpose( );
+    }
+
+    //! Function to retrieve the time derivative of the rotation matrix from base to target frame.
+    Eigen::Matrix3d getDerivativeOfRotationToTargetFrame( const double secondsSinceEpoch )
+    {
+        return getRotationalState( secondsSinceEpoch ).derivativeOfRotationToTargetFrame;
+    }
+
+    //! Function to retrieve the angular velocity vector of the target frame, expressed in the base frame.
+    Eigen::Vector3d getRotationalVelocityVectorInBaseFrame( const double secondsSinceEpoch )
+    {
+        return getRotationalState( secondsSinceEpoch ).rotationalVelocityVectorInBaseFrame;
+    }
+
+    //! Function to retrieve the angular velocity vector of the target frame, expressed in the target frame.
+    Eigen::Vector3d getRotationalVelocityVectorInTargetFrame( const double secondsSinceEpoch )
+    {
+        const CachedRotationalState& rotationalState = getRotationalState( secondsSinceEpoch );
+        return rotationalState.rotationToTargetFrame * rotationalState.rotationalVelocityVectorInBaseFrame;
+    }
+
+    //! Function to retrieve the full rotational state (as used to update the rotational state of a Body).
+    void getFullRotationalQuantitiesToTargetFrame(
+            Eigen::Quaterniond& currentRotationToLocalFrame,
+            Eigen::Matrix3d& currentRotationToLocalFrameDerivative,
+            Eigen::Vector3d& currentAngularVelocityVectorInGlobalFrame,
+            const double secondsSinceEpoch )
+    {
+        const CachedRotationalState& rotationalState = getRotationalState( secondsSinceEpoch );
+        currentRotationToLocalFrame = rotationalState.rotationToTargetFrame;
+        currentRotationToLocalFrameDerivative = rotationalState.derivativeOfRotationToTargetFrame;
+        currentAngularVelocityVectorInGlobalFrame = rotationalState.rotationalVelocityVectorInBaseFrame;
+    }
+
+    //! Function to retrieve the rotation model of which the rotational states are cached.
+    std::shared_ptr< tudat::ephemerides::RotationalEphemeris > getWrappedRotationalEphemeris( )
+    {
+        return rotationalEphemeris_;
+    }
+
+private:
+
+    //! Function to retrieve the rotational state at a given epoch (computed and cached if not available).
+    const CachedRotationalState& getRotationalState( const double secondsSinceEpoch )
+    {
+        CachedRotationalState* cachedRotationalState = rotationalStateCache_.find( secondsSinceEpoch );
+        if( cachedRotationalState == nullptr )
+        {
+            CachedRotationalState rotationalState;
+            rotationalEphemeris_->getFullRotationalQuantitiesToTargetFrame(
+                        rotationalState.rotationToTargetFrame, rotationalState.derivativeOfRotationToTargetFrame,
+                        rotationalState.rotationalVelocityVectorInBaseFrame, secondsSinceEpoch );
+            cachedRotationalState = &rotationalStateCache_.insert( secondsSinceEpoch, rotationalState );
+        }
+        return *cachedRotationalState;
+    }
+
+    //! Rotation model of which the rotational states are cached.
+    std::shared_ptr< tudat::ephemerides::RotationalEphemeris > rotationalEphemeris_;
+
+    //! Rotational states at the most recent epochs.
+    EpochValueCache< CachedRotationalState > rotationalStateCache_;
+};
+
+//! Function to add per-epoch caches to the ephemerides and rotation models of all bodies.
+/*!
+ *  Function to add per-epoch caches to the ephemerides and rotation models of all bodies (see EpochCachedEphemeris and
+ *  EpochCachedRotationalEphemeris), so that each is evaluated once per epoch, rather than once per evaluation of the state
+ *  derivative. With an RK4 integrator, this halves the number of environment evaluations (the middle stages, and the end of
+ *  each step and start of the next, share their epoch); with an RKF7(8) integrator, 4 of every 13 evaluations are saved.
+ *  The function must be called after the bodies are created, and before the acceleration models are created. It should not
+ *  be used for bodies of which the rotation model is estimated, as estimation requires the original model type.
+ *  \param bodyMap List of bodies in the environment.
+ *  \param numberOfCachedEpochs Number of most recent epochs for which the states are retained.
+ */
+inline void addEnvironmentEvaluationCaches( const tudat::simulation_setup::NamedBodyMap& bodyMap,
+                                            const unsigned int numberOfCachedEpochs = 16 )
+{
+    using namespace tudat::ephemerides;
+
+    for( auto bodyIterator = bodyMap.begin( ); bodyIterator != bodyMap.end( ); bodyIterator++ )
+    {
+        std::shared_ptr< Ephemeris > ephemeris = bodyIterator->second->getEphemeris( );
+        if( ephemeris != nullptr && std::dynamic_pointer_cast< EpochCachedEphemeris >( ephemeris ) == nullptr )
+        {
+            bodyIterator->second->setEphemeris(
+                        std::make_shared< EpochCachedEphemeris >( ephemeris, numberOfCachedEpochs ) );
+        }
+
+        std::shared_ptr< RotationalEphemeris > rotationalEphemeris = bodyIterator->second->getRotationalEphemeris( );
+        if( rotationalEphemeris != nullptr &&
+                std::dynamic_pointer_cast< EpochCachedRotationalEphemeris >( rotationalEphemeris ) == nullptr )
+        {
+            bodyIterator->second->setRotationalEphemeris(
+                        std::make_shared< EpochCachedRotationalEphemeris >( rotationalEphemeris, numberOfCachedEpochs ) );
+        }
+    }
+}
+
+}
+
+#endif // TUDAT_ENVIRONMENTEVALUATIONCACHE_H
@@ -0,0 +1,184 @@
+/*    Copyright (c) 2010-2018, Delft University of Technology
+ *    All rigths reserved
+ *
+ *    This file is part of the Tudat. Redistribution and use in source and
+ *    binary forms, with or without modification, are permitted exclusively
+ *    under the terms of the Modified BSD license. You should have received
+ *    a copy of the license with this file. If not, please or visit:
+ *    http://tudat.tudelft.nl/LICENSE.
+ */
+
+#ifndef TUDAT_ENVIRONMENTSNAPSHOT_H
+#define TUDAT_ENVIRONMENTSNAPSHOT_H
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+#include <Tudat/SimulationSetup/tudatSimulationHeader.h>
+
+#include "propagationAndOptimization/ephemerisTabulationCache.h"
+#include "propagationAndOptimization/sweepExecutor.h"
+
+namespace tudat_applications
+{
+
+//! Environment and acceleration models used by a single worker thread.
+struct WorkerEnvironment
+{
+    //! List of bodies in the environment.
+    tudat::simulation_setup::NamedBodyMap bodyMap;
+
+    //! Acceleration models acting on the propagated bodies.
+    tudat::basic_astrodynamics::AccelerationMap accelerationModelMap;
+};
+
+//! Class holding a SPICE-free description of an environment, from which independent body maps can be created.
+/*!
+ *  Class holding a SPICE-free description of an environment, from which independent body maps can be created. A body map
+ *  cannot be shared between concurrent propagations, since each Body caches its current state and rotation while the
+ *  state derivative is evaluated. Creating a body map per thread from default body settings is slow however, and queries
+ *  SPICE, which is not thread-safe.
+ *
+ *  This class resolves all SPICE-dependent body settings once, on construction: interpolated SPICE ephemerides are
+ *  tabulated using the same epochs as Tudat uses when creating them (reusing cached tabulations, see
+ *  getTabulatedSpiceStates). Each call to createBodyMap then creates new Body objects (and therefore new mutable per-epoch
+ *  caches) from the resolved settings, without any SPICE calls or file access, so that it can be used concurrently from
+ *  multiple threads. Each body map has its own ephemeris interpolators, which hold a copy of the tabulated states, since
+ *  the interpolators of Tudat keep mutable look-up state; the memory use of the tabulated ephemerides therefore grows
+ *  with the number of body maps (e.g. with the number of sweep workers). Coefficients read from file (e.g. gravity field
+ *  coefficients) are stored in the body settings, and are likewise not re-read per body map.
+ *
+ *  Direct SPICE ephemerides and SPICE rotation models are evaluated through SPICE during propagation, and are therefore
+ *  rejected. Note that the NRLMSISE-00 atmosphere library stores global state, so that body maps using it may be created
+ *  concurrently, but should not be propagated concurrently.
+ */
+class EnvironmentSnapshot
+{
+public:
+
+    //! Typedef for function adding (e.g. vehicle) bodies and interfaces to a newly created body map, and finalizing it.
+    typedef std::function< void( tudat::simulation_setup::NamedBodyMap& ) > BodyMapFinalizationFunction;
+
+    //! Constructor
+    /*!
+     *  Constructor, resolves all SPICE-dependent settings in the provided body settings (which are not modified).
+     *  \param bodySettings Settings for the bodies that are to be created (typically from getDefaultBodySettings).
+     *  \param finalizeBodyMap Function that is called on each newly created body map, which is to add any vehicles and
+     *  interfaces, and call setGlobalFrameBodyEphemerides.
+     */
+    EnvironmentSnapshot(
+            const std::map< std::string, std::shared_ptr< tudat::simulation_setup::BodySettings > >& bodySettings,
+            const BodyMapFinalizationFunction finalizeBodyMap ):
+        finalizeBodyMap_( finalizeBodyMap )
+    {
+        using namespace tudat::simulation_setup;
+
+        std::lock_guard< std::recursive_mutex > lock( getSpiceInterfaceMutex( ) );
+
+        for( auto bodySettingsIterator : bodySettings )
+        {
+            const std::string& bodyName = bodySettingsIterator.first;
+            std::shared_ptr< BodySettings > resolvedSettings =
+                    std::make_shared< BodySettings >( *bodySettingsIterator.second );
+
+            if( std::dynamic_pointer_cast< InterpolatedSpiceEphemerisSettings >(
+                        resolvedSettings->ephemerisSettings ) != nullptr )
+            {
+                std::shared_ptr< InterpolatedSpiceEphemerisSettings > spiceEphemerisSettings =
+                        std::dynamic_pointer_cast< InterpolatedSpiceEphemerisSettings >( resolvedSettings->ephemerisSettings );
+
+                // Retrieve states tabulated in the same manner as when creating the interpolated SPICE ephemeris.
+                std::shared_ptr< const std::map< double, Eigen::Vector6d > > tabulatedStates =
+                        getTabulatedSpiceStates( bodyName, spiceEphemerisSettings );
+
+                TabulatedBodyEphemeris tabulatedEphemeris;
+                tabulatedEphemeris.stateHistory = tabulatedStates;
+                tabulatedEphemeris.interpolatorSettings = spiceEphemerisSettings->getInterpolatorSettings( );
+                tabulatedEphemeris.frameOrigin = spiceEphemerisSettings->getFrameOrigin( );
+                tabulatedEphemeris.frameOrientation = spiceEphemerisSettings->getFrameOrientation( );
+                tabulatedEphemerides_[ bodyName ] = tabulatedEphemeris;
+
+                // Set placeholder ephemeris, replaced by tabulated ephemeris after body creation.
+                resolvedSettings->ephemerisSettings = std::make_shared< ConstantEphemerisSettings >(
+                            Eigen::Vector6d::Zero( ), tabulatedEphemeris.frameOrigin, tabulatedEphemeris.frameOrientation );
+            }
+            else if( resolvedSettings->ephemerisSettings != nullptr &&
+                     resolvedSettings->ephemerisSettings->getEphemerisType( ) == direct_spice_ephemeris )
+            {
+                throw std::runtime_error(
+                            "Error when creating environment snapshot, direct SPICE ephemeris of " + bodyName +
+                            " is not thread-safe; provide a time interval to getDefaultBodySettings." );
+            }
+
+            if( resolvedSettings->rotationModelSettings != nullptr &&
+                    resolvedSettings->rotationModelSettings->getRotationType( ) == spice_rotation_model )
+            {
+                throw std::runtime_error(
+                            "Error when creating environment snapshot, SPICE rotation model of " + bodyName +
+                            " is not thread-safe." );
+            }
+
+            resolvedBodySettings_[ bodyName ] = resolvedSettings;
+        }
+    }
+
+    //! Function to create a new body map from the snapshot.
+    /*!
+     *  Function to create a new body map from the snapshot. This function does not call SPICE, and may be called
+     *  concurrently from multiple threads.
+     *  \return New body map, with tabulated ephemerides set, on which the finalization function has been called.
+     */
+    tudat::simulation_setup::NamedBodyMap createBodyMap( ) const
+    {
+        using namespace tudat;
+
+        simulation_setup::NamedBodyMap bodyMap = simulation_setup::createBodies( resolvedBodySettings_ );
+        for( auto ephemerisIterator : tabulatedEphemerides_ )
+        {
+            const TabulatedBodyEphemeris& tabulatedEphemeris = ephemerisIterator.second;
+            bodyMap.at( ephemerisIterator.first )->setEphemeris(
+                        std::make_shared< ephemerides::TabulatedCartesianEphemeris< > >(
+                            interpolators::createOneDimensionalInterpolator(
+                                *tabulatedEphemeris.stateHistory, tabulatedEphemeris.interpolatorSettings ),
+                            tabulatedEphemeris.frameOrigin, tabulatedEphemeris.frameOrientation ) );
+        }
+
+        finalizeBodyMap_( bodyMap );
+        return bodyMap;
+    }
+
+private:
+
+    //! Tabulated ephemeris data of a single body, from which the ephemeris of each created body map is interpolated.
+    struct TabulatedBodyEphemeris
+    {
+        //! Tabulated Cartesian states.
+        std::shared_ptr< const std::map< double, Eigen::Vector6d > > stateHistory;
+
+        //! Settings for interpolator used for the tabulated states.
+        std::shared_ptr< tudat::interpolators::InterpolatorSettings > interpolatorSettings;
+
+        //! Origin of frame in which states are defined.
+        std::string frameOrigin;
+
+        //! Orientation of frame in which states are defined.
+        std::string frameOrientation;
+    };
+
+    //! Body settings with all SPICE-dependent settings resolved.
+    std::map< std::string, std::shared_ptr< tudat::simulation_setup::BodySettings > > resolvedBodySettings_;
+
+    //! Tabulated ephemerides, per body name, that are to be set after body creation.
+    std::map< std::string, TabulatedBodyEphemeris > tabulatedEphemerides_;
+
+    //! Function that is called on each newly created body map.
+    BodyMapFinalizationFunction finalizeBodyMap_;
+};
+
+}
+
+#endif // TUDAT_ENVIRONMENTSNAPSHOT_H
@@ -0,0 +1,161 @@
+/*    Copyright (c) 2010-2018, Delft University of Technology
+ *    All rigths reserved
+ *
+ *    This file is part of the Tudat. Redistribution and use in source and
+ *    binary forms, with or without modification, are permitted exclusively
+ *    under the terms of the Modified BSD license. You should have received
+ *    a copy of the license with this file. If not, please or visit:
+ *    http://tudat.tudelft.nl/LICENSE.
+ */
+
+#ifndef TUDAT_EPHEMERISBATCHEVALUATION_H
+#define TUDAT_EPHEMERISBATCHEVALUATION_H
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include <Tudat/SimulationSetup/tudatSimulationHeader.h>
+
+namespace tudat_applications
+{
+
+//! Typedef for a list of Cartesian states or Keplerian elements, with one row per epoch.
+typedef Eigen::Matrix< double, Eigen::Dynamic, 6 > StateBatch;
+
+//! Function to evaluate an ephemeris at a list of epochs.
+/*!
+ *  Function to evaluate an ephemeris at a list of epochs, storing the results in a single pre-allocated matrix. The
+ *  ephemeris is evaluated in order of increasing epoch (regardless of the order of the input list), which lets CSPICE reuse
+ *  its buffered ephemeris segment for consecutive epochs, and lets the look-up of tabulated ephemerides continue from the
+ *  previous interval.
+ *  \param ephemeris Ephemeris that is to be evaluated.
+ *  \param epochs List of epochs at which the ephemeris is to be evaluated.
+ *  \param cartesianStates Cartesian states, in which row i is the state at epochs.at( i ) (returned by reference).
+ */
+inline void getCartesianStates( const std::shared_ptr< tudat::ephemerides::Ephemeris > ephemeris,
+                                const std::vector< double >& epochs,
+                                StateBatch& cartesianStates )
+{
+    cartesianStates.resize( epochs.size( ), 6 );
+
+    std::vector< unsigned int > evaluationOrder( epochs.size( ) );
+    for( unsigned int i = 0; i < epochs.size( ); i++ )
+    {
+        evaluationOrder[ i ] = i;
+    }
+    if( !std::is_sorted( epochs.begin( ), epochs.end( ) ) )
+    {
+        std::stable_sort( evaluationOrder.begin( ), evaluationOrder.end( ),
+                          [ & ]( const unsigned int first, const unsigned int second )
+        {
+            return epochs[ first ] < epochs[ second ];
+        } );
+    }
+
+    for( unsigned int i = 0; i < evaluationOrder.size( ); i++ )
+    {
+        cartesianStates.row( evaluationOrder[ i ] ) =
+                ephemeris->getCartesianState( epochs[ evaluationOrder[ i ] ] ).transpose( );
+    }
+}
+
+//! Function to convert a list of Cartesian states to Keplerian elements.
+/*!
+ *  Function to convert a list of Cartesian states to Keplerian elements (in the order and ranges used by
+ *  orbital_element_conversions::convertCartesianToKeplerianElements). The conversion for non-singular orbits is done for
+ *  all states at once, using array operations on the columns of the input (which Eigen vectorizes). States for which the
+ *  orbit is (near-)circular, (near-)equatorial or (near-)parabolic are converted one by one using Tudat, which handles
+ *  the conventions for these singular cases.
+ *  \param cartesianStates Cartesian states, with one row per state.
+ *  \param centralBodyGravitationalParameter Gravitational parameter of the central body.
+ *  \return Keplerian elements, where row i contains the elements of the state in row i of the input.
+ */
+inline StateBatch convertCartesianStatesToKeplerianElements(
+        const StateBatch& cartesianStates, const double centralBodyGravitationalParameter )
+{
+    using namespace tudat::orbital_element_conversions;
+
+    typedef Eigen::Array< double, Eigen::Dynamic, 1 > ColumnArray;
+
+    const double twoPi = 2.0 * tudat::mathematical_constants::PI;
+    const double singularityTolerance = 1.0E-10;
+
+    const ColumnArray positionX = cartesianStates.col( 0 ).array( );
+    const ColumnArray positionY = cartesianStates.col( 1 ).array( );
+    const ColumnArray positionZ = cartesianStates.col( 2 ).array( );
+    const ColumnArray velocityX = cartesianStates.col( 3 ).array( );
+    const ColumnArray velocityY = cartesianStates.col( 4 ).array( );
+    const ColumnArray velocityZ = cartesianStates.col( 5 ).array( );
+
+    const ColumnArray radius = ( positionX.square( ) + positionY.square( ) + positionZ.square( ) ).sqrt( );
+    const ColumnArray speedSquared = velocityX.square( ) + velocityY.square( ) + velocityZ.square( );
+    const ColumnArray radialVelocityProduct = positionX * velocityX + positionY * velocityY + positionZ * velocityZ;
+
+    // Angular momentum and ascending node vectors (node vector is z-axis cross angular momentum).
+    const ColumnArray angularMomentumX = positionY * velocityZ - positionZ * velocityY;
+    const ColumnArray angularMomentumY = positionZ * velocityX - positionX * velocityZ;
+    const ColumnArray angularMomentumZ = positionX * velocityY - positionY * velocityX;
+    const ColumnArray angularMomentum =
+            ( angularMomentumX.square( ) + angularMomentumY.square( ) + angularMomentumZ.square( ) ).sqrt( );
+    const ColumnArray nodeX = -angularMomentumY;
+    const ColumnArray nodeY = angularMomentumX;
+    const ColumnArray nodeNorm = ( nodeX.square( ) + nodeY.square( ) ).sqrt( );
+
+    // Eccentricity vector.
+    const ColumnArray positionFactor =
+            ( speedSquared - centralBodyGravitationalParameter / radius ) / centralBodyGravitationalParameter;
+    const ColumnArray velocityFactor = radialVelocityProduct / centralBodyGravitationalParameter;
+    const ColumnArray eccentricityX = positionFactor * positionX - velocityFactor * velocityX;
+    const ColumnArray eccentricityY = positionFactor * positionY - velocityFactor * velocityY;
+    const ColumnArray eccentricityZ = positionFactor * positionZ - velocityFactor * velocityZ;
+    const ColumnArray eccentricity =
+            ( eccentricityX.square( ) + eccentricityY.square( ) + eccentricityZ.square( ) ).sqrt( );
+
+    const ColumnArray specificEnergy = speedSquared / 2.0 - centralBodyGravitationalParameter / radius;
+
+    StateBatch keplerianElements( cartesianStates.rows( ), 6 );
+    keplerianElements.col( semiMajorAxisIndex ).array( ) = -centralBodyGravitationalParameter / ( 2.0 * specificEnergy );
+    keplerianElements.col( eccentricityIndex ).array( ) = eccentricity;
+    keplerianElements.col( inclinationIndex ).array( ) = ( angularMomentumZ / angularMomentum ).min( 1.0 ).max( -1.0 ).acos( );
+
+    // Longitude of ascending node in [0, 2 pi).
+    ColumnArray ascendingNodeLongitude = nodeY.binaryExpr(
+                nodeX, [ ]( const double y, const double x ){ return std::atan2( y, x ); } );
+    ascendingNodeLongitude = ( ascendingNodeLongitude < 0.0 ).select( ascendingNodeLongitude + twoPi, ascendingNodeLongitude );
+    keplerianElements.col( longitudeOfAscendingNodeIndex ).array( ) = ascendingNodeLongitude;
+
+    // Argument of periapsis in [0, 2 pi), larger than pi if periapsis is below equator.
+    const ColumnArray argumentOfPeriapsisCosine =
+            ( ( nodeX * eccentricityX + nodeY * eccentricityY ) / ( nodeNorm * eccentricity ) ).min( 1.0 ).max( -1.0 );
+    keplerianElements.col( argumentOfPeriapsisIndex ).array( ) =
+            ( eccentricityZ < 0.0 ).select( twoPi - argumentOfPeriapsisCosine.acos( ), argumentOfPeriapsisCosine.acos( ) );
+
+    // True anomaly in [0, 2 pi), larger than pi if moving towards periapsis.
+    const ColumnArray trueAnomalyCosine =
+            ( ( eccentricityX * positionX + eccentricityY * positionY + eccentricityZ * positionZ ) /
+              ( eccentricity * radius ) ).min( 1.0 ).max( -1.0 );
+    keplerianElements.col( trueAnomalyIndex ).array( ) =
+            ( radialVelocityProduct < 0.0 ).select( twoPi - trueAnomalyCosine.acos( ), trueAnomalyCosine.acos( ) );
+
+    // Convert states in (near-)singular cases using Tudat.
+    for( int i = 0; i < cartesianStates.rows( ); i++ )
+    {
+        if( eccentricity( i ) < singularityTolerance || std::fabs( eccentricity( i ) - 1.0 ) < singularityTolerance ||
+                nodeNorm( i ) < singularityTolerance * angularMomentum( i ) )
+        {
+            keplerianElements.row( i ) = convertCartesianToKeplerianElements< double >(
+                        Eigen::Vector6d( cartesianStates.row( i ).transpose( ) ),
+                        centralBodyGravitationalParameter ).transpose( );
+        }
+    }
+
+    return keplerianElements;
+}
+
+}
+
+#endif // TUDAT_EPHEMERISBATCHEVALUATION_H
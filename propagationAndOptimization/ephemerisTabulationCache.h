@@ -0,0 +1,298 @@
+/*    Copyright (c) 2010-2018, Delft University of Technology
+ *    All rigths reserved
+ *
+ *    This file is part of the Tudat. Redistribution and use in source and
+ *    binary forms, with or without modification, are permitted exclusively
+ *    under the terms of the Modified BSD license. You should have received
+ *    a copy of the license with this file. If not, please or visit:
+ *    http://tudat.tudelft.nl/LICENSE.
+ */
+
+#ifndef TUDAT_EPHEMERISTABULATIONCACHE_H
+#define TUDAT_EPHEMERISTABULATIONCACHE_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include <Tudat/SimulationSetup/tudatSimulationHeader.h>
+
+#include "propagationAndOptimization/applicationOutput.h"
+#include "propagationAndOptimization/binaryStateHistoryOutput.h"
+#include "propagationAndOptimization/spiceKernelPool.h"
+#include "propagationAndOptimization/sweepExecutor.h"
+
+namespace tudat_applications
+{
+
+//! Get directory in which tabulated ephemerides are cached.
+/*!
+ *  Get directory in which tabulated ephemerides are cached. The directory is read from the environment variable
+ *  TUDAT_APPLICATION_EPHEMERIS_CACHE if it is set (an empty value disables the on-disk cache), and is the EphemerisCache
+ *  subdirectory of the application output directory otherwise.
+ *  \return Cache directory (empty if on-disk caching is disabled).
+ */
+inline std::string getEphemerisTabulationCacheDirectory( )
+{
+    const char* cacheDirectorySetting = std::getenv( "TUDAT_APPLICATION_EPHEMERIS_CACHE" );
+    if( cacheDirectorySetting != NULL )
+    {
+        return std::string( cacheDirectorySetting );
+    }
+    return getOutputPath( "EphemerisCache/" );
+}
+
+//! Function to compute the 64-bit FNV-1a hash of a string (used to create cache file names).
+inline std::uint64_t computeFnv1aHash( const std::string& hashInput )
+{
+    std::uint64_t hash = 14695981039346656037ULL;
+    for( unsigned int i = 0; i < hashInput.size( ); i++ )
+    {
+        hash ^= static_cast< unsigned char >( hashInput[ i ] );
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+//! Get identifier of the SPICE kernels that have been loaded through loadSpiceKernelsOnce.
+/*!
+ *  Get identifier of the SPICE kernels that have been loaded through loadSpiceKernelsOnce, consisting of the name, size
+ *  and modification time of each kernel, so that cached tabulations are not reused when different (or updated) kernels
+ *  are loaded.
+ *  \return Identifier of loaded kernels.
+ */
+inline std::string getLoadedSpiceKernelsIdentifier( )
+{
+    std::lock_guard< std::recursive_mutex > lock( getSpiceInterfaceMutex( ) );
+
+    std::ostringstream identifierStream;
+    const std::vector< std::string >& loadedKernelFiles = getLoadedSpiceKernelFiles( );
+    for( unsigned int i = 0; i < loadedKernelFiles.size( ); i++ )
+    {
+        boost::system::error_code errorCode;
+        boost::filesystem::path kernelPath( loadedKernelFiles.at( i ) );
+        std::uintmax_t fileSize = boost::filesystem::file_size( kernelPath, errorCode );
+        std::time_t modificationTime = boost::filesystem::last_write_time( kernelPath, errorCode );
+        identifierStream << loadedKernelFiles.at( i ) << ";" << fileSize << ";" << modificationTime << ";";
+    }
+    return identifierStream.str( );
+}
+
+//! Function to retrieve the Cartesian states of a body, tabulated from SPICE, using a (memory and on-disk) cache.
+/*!
+ *  Function to retrieve the Cartesian states of a body, tabulated from SPICE at the same epochs as Tudat uses when creating
+ *  an interpolated SPICE ephemeris (from initialTime, with constant timeStep, up to but excluding finalTime). The first
+ *  request for a given body, frame, time window and set of loaded kernels tabulates the states through SPICE, and stores
+ *  them in memory, and in a binary state history file in the cache directory (see getEphemerisTabulationCacheDirectory).
+ *  Later requests in the same process return the stored tabulation, and later requests in other processes read it from
+ *  the cache file, without calling SPICE. Since the file stores the states in binary form, the tabulation (and therefore
+ *  the interpolated ephemeris) is bit-identical to the one created from SPICE.
+ *
+ *  Files are written to a temporary name and then renamed, so that processes running concurrently in the same cache
+ *  directory never read a partially written file. The function may be called from any thread, as it locks the SPICE
+ *  interface mutex.
+ *  \param spiceBodyName Name of body in SPICE.
+ *  \param frameOrigin Origin of frame in which states are to be tabulated.
+ *  \param frameOrientation Orientation of frame in which states are to be tabulated.
+ *  \param initialTime First epoch of tabulation.
+ *  \param finalTime End of tabulation (excluded).
+ *  \param timeStep Time step of tabulation.
+ *  \return Tabulated states (shared, read-only; an interpolator created from them copies the states).
+ */
+inline std::shared_ptr< const std::map< double, Eigen::Vector6d > > getTabulatedSpiceStates(
+        const std::string& spiceBodyName,
+        const std::string& frameOrigin,
+        const std::string& frameOrientation,
+        const double initialTime,
+        const double finalTime,
+        const double timeStep )
+{
+    static std::map< std::string, std::shared_ptr< const std::map< double, Eigen::Vector6d > > > tabulationCache;
+
+    std::lock_guard< std::recursive_mutex > lock( getSpiceInterfaceMutex( ) );
+
+    // Create key of tabulation, and name of (and tag in) cache file.
+    std::ostringstream keyStream;
+    keyStream << std::setprecision( std::numeric_limits< double >::max_digits10 )
+              << spiceBodyName << ";" << frameOrigin << ";" << frameOrientation << ";"
+              << initialTime << ";" << finalTime << ";" << timeStep << ";" << getLoadedSpiceKernelsIdentifier( );
+    std::string tabulationKey = keyStream.str( );
+
+    std::ostringstream hashStream;
+    hashStream << std::hex << std::setw( 16 ) << std::setfill( '0' ) << computeFnv1aHash( tabulationKey );
+    std::string cacheFileName = "ephemeris_" + spiceBodyName + "_" + hashStream.str( ) + ".tsh";
+    std::string cacheFileTag = hashStream.str( ) + ";" + spiceBodyName + ";" + frameOrigin + ";" + frameOrientation;
+
+    if( tabulationCache.count( tabulationKey ) > 0 )
+    {
+        return tabulationCache.at( tabulationKey );
+    }
+
+    std::shared_ptr< std::map< double, Eigen::Vector6d > > tabulatedStates =
+            std::make_shared< std::map< double, Eigen::Vector6d > >( );
+
+    // Read tabulation from cache file, if it exists (and is valid).
+    std::string cacheDirectory = getEphemerisTabulationCacheDirectory( );
+    boost::filesystem::path cacheFilePath = boost::filesystem::path( cacheDirectory ) / cacheFileName;
+    if( cacheDirectory != "" && boost::filesystem::exists( cacheFilePath ) )
+    {
+        try
+        {
+            std::ifstream cacheFile( cacheFilePath.string( ), std::ios::binary );
+            std::string storedTag;
+            std::map< double, Eigen::VectorXd > storedStates =
+                    readDataMapFromBinaryStream< double, double >( cacheFile, storedTag );
+            if( storedTag == cacheFileTag )
+            {
+                for( auto stateIterator = storedStates.begin( ); stateIterator != storedStates.end( ); stateIterator++ )
+                {
+                    if( stateIterator->second.rows( ) != 6 )
+                    {
+                        throw std::runtime_error( "Error, inconsistent state size in ephemeris cache file." );
+                    }
+                    tabulatedStates->insert( tabulatedStates->end( ), std::make_pair(
+                                                 stateIterator->first, Eigen::Vector6d( stateIterator->second ) ) );
+                }
+            }
+        }
+        catch( std::runtime_error& )
+        {
+            tabulatedStates->clear( );
+        }
+    }
+
+    // Tabulate states from SPICE, and write them to cache file.
+    if( tabulatedStates->empty( ) )
+    {
+        double currentTime = initialTime;
+        while( currentTime < finalTime )
+        {
+            ( *tabulatedStates )[ currentTime ] = tudat::spice_interface::getBodyCartesianStateAtEpoch(
+                        spiceBodyName, frameOrigin, frameOrientation, "None", currentTime );
+            currentTime += timeStep;
+        }
+
+        if( cacheDirectory != "" )
+        {
+            try
+            {
+                std::ostringstream temporaryFileName;
+                temporaryFileName << cacheFileName << ".tmp" << std::random_device( )( );
+                writeDataMapToBinaryFile( *tabulatedStates, temporaryFileName.str( ), cacheDirectory, cacheFileTag );
+                boost::filesystem::rename( boost::filesystem::path( cacheDirectory ) / temporaryFileName.str( ),
+                                           cacheFilePath );
+            }
+            catch( std::exception& caughtException )
+            {
+                std::cerr << "Warning, could not write ephemeris cache file " << cacheFilePath.string( ) << ": "
+                          << caughtException.what( ) << std::endl;
+            }
+        }
+    }
+
+    tabulationCache[ tabulationKey ] = tabulatedStates;
+    return tabulatedStates;
+}
+
+//! Function to retrieve the tabulated states for interpolated SPICE ephemeris settings (see getTabulatedSpiceStates).
+/*!
+ *  Function to retrieve the tabulated states for interpolated SPICE ephemeris settings (see getTabulatedSpiceStates).
+ *  \param bodyName Name of body for which the settings are defined.
+ *  \param ephemerisSettings Interpolated SPICE ephemeris settings.
+ *  \return Tabulated states (shared, read-only).
+ */
+inline std::shared_ptr< const std::map< double, Eigen::Vector6d > > getTabulatedSpiceStates(
+        const std::string& bodyName,
+        const std::shared_ptr< tudat::simulation_setup::InterpolatedSpiceEphemerisSettings > ephemerisSettings )
+{
+    return getTabulatedSpiceStates(
+                ephemerisSettings->getBodyNameOverride( ) == "" ? bodyName : ephemerisSettings->getBodyNameOverride( ),
+                ephemerisSettings->getFrameOrigin( ), ephemerisSettings->getFrameOrientation( ),
+                ephemerisSettings->getInitialTime( ), ephemerisSettings->getFinalTime( ),
+                ephemerisSettings->getTimeStep( ) );
+}
+
+//! Function to create bodies, using cached tabulations for all interpolated SPICE ephemerides.
+/*!
+ *  Function to create bodies, as simulation_setup::createBodies, but using cached tabulations (see
+ *  getTabulatedSpiceStates) for all interpolated SPICE ephemerides, so that repeated creation of the same environment
+ *  (within a single run or over runs of a campaign) does not re-query SPICE. The resulting ephemerides are identical to
+ *  those created by createBodies. All other settings are used as provided.
+ *
+ *  Only the tabulation is shared between calls: each created ephemeris has its own interpolator, which holds a copy of the
+ *  tabulated states, since the interpolators of Tudat keep mutable look-up state (and may therefore not be shared by body
+ *  maps that are propagated concurrently). The memory use therefore grows with the number of created body maps (e.g. with
+ *  the number of sweep workers).
+ *  \param bodySettings Settings for the bodies that are to be created (typically from getDefaultBodySettings).
+ *  \return Created bodies.
+ */
+inline tudat::simulation_setup::NamedBodyMap createBodiesWithCachedEphemerides(
+        const std::map< std::string, std::shared_ptr< tudat::simulation_setup::BodySettings > >& bodySettings )
+{
+    using namespace tudat;
+    using namespace tudat::simulation_setup;
+
+    std::lock_guard< std::recursive_mutex > lock( getSpiceInterfaceMutex( ) );
+
+    // Replace interpolated SPICE ephemerides by placeholders, and retrieve tabulations.
+    std::map< std::string, std::shared_ptr< BodySettings > > resolvedBodySettings;
+    std::map< std::string, std::shared_ptr< InterpolatedSpiceEphemerisSettings > > tabulatedEphemerisSettings;
+    std::map< std::string, std::shared_ptr< const std::map< double, Eigen::Vector6d > > > tabulatedStates;
+    for( auto bodySettingsIterator = bodySettings.begin( ); bodySettingsIterator != bodySettings.end( );
+         bodySettingsIterator++ )
+    {
+        const std::string& bodyName = bodySettingsIterator->first;
+        std::shared_ptr< InterpolatedSpiceEphemerisSettings > spiceEphemerisSettings =
+                std::dynamic_pointer_cast< InterpolatedSpiceEphemerisSettings >(
+                    bodySettingsIterator->second->ephemerisSettings );
+        if( spiceEphemerisSettings != nullptr )
+        {
+            tabulatedEphemerisSettings[ bodyName ] = spiceEphemerisSettings;
+            tabulatedStates[ bodyName ] = getTabulatedSpiceStates( bodyName, spiceEphemerisSettings );
+
+            std::shared_ptr< BodySettings > resolvedSettings =
+                    std::make_shared< BodySettings >( *bodySettingsIterator->second );
+            resolvedSettings->ephemerisSettings = std::make_shared< ConstantEphemerisSettings >(
+                        Eigen::Vector6d::Zero( ), spiceEphemerisSettings->getFrameOrigin( ),
+                        spiceEphemerisSettings->getFrameOrientation( ) );
+            resolvedBodySettings[ bodyName ] = resolvedSettings;
+        }
+        else
+        {
+            resolvedBodySettings[ bodyName ] = bodySettingsIterator->second;
+        }
+    }
+
+    // Create bodies, and set tabulated ephemerides.
+    NamedBodyMap bodyMap = createBodies( resolvedBodySettings );
+    for( auto ephemerisIterator = tabulatedEphemerisSettings.begin( );
+         ephemerisIterator != tabulatedEphemerisSettings.end( ); ephemerisIterator++ )
+    {
+        bodyMap.at( ephemerisIterator->first )->setEphemeris(
+                    std::make_shared< ephemerides::TabulatedCartesianEphemeris< > >(
+                        interpolators::createOneDimensionalInterpolator(
+                            *tabulatedStates.at( ephemerisIterator->first ),
+                            ephemerisIterator->second->getInterpolatorSettings( ) ),
+                        ephemerisIterator->second->getFrameOrigin( ),
+                        ephemerisIterator->second->getFrameOrientation( ) ) );
+    }
+    return bodyMap;
+}
+
+}
+
+#endif // TUDAT_EPHEMERISTABULATIONCACHE_H
@@ -0,0 +1,195 @@
+/*    Copyright (c) 2010-2018, Delft University of Technology
+ *    All rigths reserved
+ *
+ *    This file is part of the Tudat. Redistribution and use in source and
+ *    binary forms, with or without modification, are permitted exclusively
+ *    under the terms of the Modified BSD license. You should have received
+ *    a copy of the license with this file. If not, please or visit:
+ *    http://tudat.tudelft.nl/LICENSE.
+ */
+
+#ifndef TUDAT_FIXEDSIZECOWELLSTATEDERIVATIVE_H
+#define TUDAT_FIXEDSIZECOWELLSTATEDERIVATIVE_H
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <Tudat/SimulationSetup/tudatSimulationHeader.h>
+
+namespace tudat_applications
+{
+
+//! Cowell state derivative of a single propagated body, using fixed-size (6-element) state vectors.
+/*!
+ *  Cowell state derivative of a single propagated body, using fixed-size (6-element) state vectors, as an alternative to
+ *  the DynamicsStateDerivativeModel in Tudat (which uses dynamic-size vectors, allocated on the heap, for each evaluation).
+ *  Each evaluation is equivalent to that of Tudat: the acceleration models are reset, the global state of the propagated
+ *  body (relative state plus state of the central body from its ephemeris) is set in the environment, the environment is
+ *  updated by the environment updater of the dynamics simulator, and the accelerations are summed. The global state passed
+ *  to the environment updater is stored in a preallocated vector, so that no memory is allocated by this class per
+ *  evaluation (memory allocated by the environment models themselves is unaffected). As in Tudat, a central body named
+ *  "SSB" denotes the global frame origin, the state of which is zero.
+ *
+ *  Only the Cartesian state of a single body is supported: other propagators (e.g. the unified state model, with its
+ *  7-element state), multiple propagated bodies and variational equations (state transition matrices) use the dynamic-size
+ *  state derivative model of Tudat (see createFixedSizeCowellStateDerivative).
+ */
+template< typename StateScalarType = double, typename TimeType = double >
+class FixedSizeCowellStateDerivative
+{
+public:
+
+    //! Typedef for fixed-size Cartesian state.
+    typedef Eigen::Matrix< StateScalarType, 6, 1 > StateType;
+
+    //! Constructor
+    /*!
+     *  Constructor
+     *  \param bodyMap List of bodies in the environment.
+     *  \param centralBody Name of the central body w.r.t. which the state is propagated ("SSB" for the global frame origin).
+     *  \param accelerationModels List of all acceleration models acting on the propagated body.
+     *  \param environmentUpdater Environment updater used to update the environment at each evaluation.
+     */
+    FixedSizeCowellStateDerivative(
+            const tudat::simulation_setup::NamedBodyMap& bodyMap,
+            const std::string& centralBody,
+            const std::vector< std::shared_ptr< tudat::basic_astrodynamics::AccelerationModel3d > >& accelerationModels,
+            const std::shared_ptr< tudat::propagators::EnvironmentUpdater< StateScalarType, TimeType > >
+            environmentUpdater ):
+        accelerationModels_( accelerationModels ), environmentUpdater_( environmentUpdater ),
+        numberOfFunctionEvaluations_( 0 )
+    {
+        if( centralBody != "SSB" )
+        {
+            if( bodyMap.count( centralBody ) == 0 )
+            {
+                throw std::runtime_error( "Error, central body " + centralBody + " of fixed-size Cowell state derivative "
+                                          "not found in body map." );
+            }
+            centralBody_ = bodyMap.at( centralBody );
+        }
+
+        integratedStatesToSet_[ tudat::propagators::translational_state ] =
+                Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 >::Zero( 6 );
+        globalState_ = &integratedStatesToSet_.at( tudat::propagators::translational_state );
+    }
+
+    //! Function to compute the state derivative.
+    /*!
+     *  Function to compute the state derivative.
+     *  \param time Time at which the state derivative is to be computed.
+     *  \param state Cartesian state of the propagated body w.r.t. the central body.
+     *  \return Cartesian state derivative of the propagated body.
+     */
+    StateType computeStateDerivative( const TimeType time, const StateType& state )
+    {
+        numberOfFunctionEvaluations_++;
+
+        for( unsigned int i = 0; i < accelerationModels_.size( ); i++ )
+        {
+            accelerationModels_[ i ]->resetTime( TUDAT_NAN );
+        }
+
+        // Set global state of propagated body, and update environment.
+        if( centralBody_ != nullptr )
+        {
+            globalState_->noalias( ) =
+                    state + centralBody_->template getStateInBaseFrameFromEphemeris< StateScalarType, TimeType >( time );
+        }
+        else
+        {
+            *globalState_ = state;
+        }
+        environmentUpdater_->updateEnvironment( time, integratedStatesToSet_ );
+
+        // Sum accelerations.
+        Eigen::Vector3d totalAcceleration = Eigen::Vector3d::Zero( );
+        for( unsigned int i = 0; i < accelerationModels_.size( ); i++ )
+        {
+            accelerationModels_[ i ]->updateMembers( static_cast< double >( time ) );
+            totalAcceleration += accelerationModels_[ i ]->getAcceleration( );
+        }
+
+        StateType stateDerivative;
+        stateDerivative.template head< 3 >( ) = state.template tail< 3 >( );
+        stateDerivative.template tail< 3 >( ) = totalAcceleration.template cast< StateScalarType >( );
+        return stateDerivative;
+    }
+
+    //! Function to get the number of state derivative evaluations.
+    unsigned int getNumberOfFunctionEvaluations( ) const { return numberOfFunctionEvaluations_; }
+
+    //! Function to reset the number of state derivative evaluations to zero.
+    void resetFunctionEvaluationCounter( ) { numberOfFunctionEvaluations_ = 0; }
+
+private:
+
+    //! Central body w.r.t. which the state is propagated (nullptr for the global frame origin).
+    std::shared_ptr< tudat::simulation_setup::Body > centralBody_;
+
+    //! List of all acceleration models acting on the propagated body.
+    std::vector< std::shared_ptr< tudat::basic_astrodynamics::AccelerationModel3d > > accelerationModels_;
+
+    //! Environment updater used to update the environment at each evaluation.
+    std::shared_ptr< tudat::propagators::EnvironmentUpdater< StateScalarType, TimeType > > environmentUpdater_;
+
+    //! Integrated states that are set in the environment (only the global translational state of the propagated body).
+    std::unordered_map< tudat::propagators::IntegratedStateType, Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 > >
+    integratedStatesToSet_;
+
+    //! Global translational state of the propagated body (entry of integratedStatesToSet_).
+    Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 >* globalState_;
+
+    //! Number of state derivative evaluations.
+    unsigned int numberOfFunctionEvaluations_;
+};
+
+//! Function to create a fixed-size Cowell state derivative, if the propagator settings allow it.
+/*!
+ *  Function to create a fixed-size Cowell state derivative (see FixedSizeCowellStateDerivative), if the propagator settings
+ *  are for the translational dynamics of a single body with the Cowell propagator, so that the size of the propagated state
+ *  is known to be 6. For all other propagator settings (including the unified state model), nullptr is returned, and the
+ *  dynamic-size state derivative model of Tudat is to be used instead.
+ *  \param bodyMap List of bodies in the environment.
+ *  \param propagatorSettings Settings for the propagator.
+ *  \param environmentUpdater Environment updater of the dynamics simulator created for the propagator settings.
+ *  \return Fixed-size Cowell state derivative (nullptr if the propagator settings do not allow it).
+ */
+template< typename StateScalarType = double, typename TimeType = double >
+std::shared_ptr< FixedSizeCowellStateDerivative< StateScalarType, TimeType > > createFixedSizeCowellStateDerivative(
+        const tudat::simulation_setup::NamedBodyMap& bodyMap,
+        const std::shared_ptr< tudat::propagators::SingleArcPropagatorSettings< StateScalarType > > propagatorSettings,
+        const std::shared_ptr< tudat::propagators::EnvironmentUpdater< StateScalarType, TimeType > > environmentUpdater )
+{
+    using namespace tudat::propagators;
+
+    std::shared_ptr< TranslationalStatePropagatorSettings< StateScalarType > > translationalPropagatorSettings =
+            std::dynamic_pointer_cast< TranslationalStatePropagatorSettings< StateScalarType > >( propagatorSettings );
+    if( translationalPropagatorSettings == nullptr || translationalPropagatorSettings->propagator_ != cowell ||
+            translationalPropagatorSettings->bodiesToIntegrate_.size( ) != 1 )
+    {
+        return nullptr;
+    }
+
+    const std::string propagatedBody = translationalPropagatorSettings->bodiesToIntegrate_.at( 0 );
+    std::vector< std::shared_ptr< tudat::basic_astrodynamics::AccelerationModel3d > > accelerationModels;
+    if( translationalPropagatorSettings->accelerationsMap_.count( propagatedBody ) > 0 )
+    {
+        for( auto accelerationIterator : translationalPropagatorSettings->accelerationsMap_.at( propagatedBody ) )
+        {
+            accelerationModels.insert( accelerationModels.end( ), accelerationIterator.second.begin( ),
+                                       accelerationIterator.second.end( ) );
+        }
+    }
+
+    return std::make_shared< FixedSizeCowellStateDerivative< StateScalarType, TimeType > >(
+                bodyMap, translationalPropagatorSettings->centralBodies_.at( 0 ), accelerationModels,
+                environmentUpdater );
+}
+
+}
+
+#endif // TUDAT_FIXEDSIZECOWELLSTATEDERIVATIVE_H
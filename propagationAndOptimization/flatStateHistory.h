@@ -0,0 +1,330 @@
+/*    Copyright (c) 2010-2018, Delft University of Technology
+ *    All rigths reserved
+ *
+ *    This file is part of the Tudat. Redistribution and use in source and
+ *    binary forms, with or without modification, are permitted exclusively
+ *    under the terms of the Modified BSD license. You should have received
+ *    a copy of the license with this file. If not, please or visit:
+ *    http://tudat.tudelft.nl/LICENSE.
+ */
+
+#ifndef TUDAT_FLATSTATEHISTORY_H
+#define TUDAT_FLATSTATEHISTORY_H
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include "propagationAndOptimization/binaryStateHistoryOutput.h"
+
+namespace tudat_applications
+{
+
+//! Time series of fixed-size states, stored as a sorted epoch array and a contiguous row-major block of states.
+/*!
+ *  Time series of fixed-size states, stored as a sorted epoch array and a contiguous row-major block of states (one row
+ *  per epoch). This class is a replacement for the std::map< TimeType, Eigen::Matrix< StateScalarType, Dynamic, 1 > >
+ *  that is used for state histories, which requires two heap allocations per epoch and has poor memory locality when
+ *  iterated. Look-up by epoch (find, at, count) is done by binary search, and iteration yields (epoch, state) pairs in
+ *  the same manner as for a map, where the state is an Eigen::Map into the contiguous block (so that no copies are made).
+ *  Operations over all epochs can be written as vectorizable operations on the full block (see getStateBlock).
+ *
+ *  Epochs must be added in strictly increasing order, which is the case when recording the steps of a propagation (see
+ *  FlatStateHistorySink), or when converting from a map.
+ */
+template< typename StateScalarType = double, typename TimeType = double >
+class FlatStateHistory
+{
+public:
+
+    //! Typedef for a single state.
+    typedef Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 > StateType;
+
+    //! Typedef for a read-only view of a single state in the history.
+    typedef Eigen::Map< const StateType > ConstStateMap;
+
+    //! Typedef for a modifiable view of a single state in the history.
+    typedef Eigen::Map< StateType > StateMap;
+
+    //! Typedef for a read-only view of all states in the history, as a matrix with one row per epoch.
+    typedef Eigen::Map< const Eigen::Matrix< StateScalarType, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor > >
+    ConstStateBlockMap;
+
+    //! Single entry of the history, with the same member names as a std::pair (and thus map iterator).
+    struct Entry
+    {
+        Entry( const TimeType epoch, const StateScalarType* stateData, const unsigned int stateSize ):
+            first( epoch ), second( stateData, stateSize ){ }
+
+        //! Epoch of the entry.
+        TimeType first;
+
+        //! State at the epoch.
+        ConstStateMap second;
+    };
+
+    //! Iterator over the entries of the history, in order of increasing epoch.
+    class const_iterator
+    {
+    public:
+
+        typedef std::bidirectional_iterator_tag iterator_category;
+        typedef Entry value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const Entry* pointer;
+        typedef Entry reference;
+
+        //! Helper type to allow iterator->first and iterator->second.
+        struct ArrowProxy
+        {
+            Entry entry;
+            const Entry* operator->( ) const { return &entry; }
+        };
+
+        const_iterator( const FlatStateHistory* stateHistory, const unsigned int index ):
+            stateHistory_( stateHistory ), index_( index ){ }
+
+        Entry operator*( ) const
+        {
+            return stateHistory_->getEntry( index_ );
+        }
+
+        ArrowProxy operator->( ) const
+        {
+            return ArrowProxy{ stateHistory_->getEntry( index_ ) };
+        }
+
+        const_iterator& operator++( ){ index_++; return *this; }
+        const_iterator operator++( int ){ const_iterator previous = *this; index_++; return previous; }
+        const_iterator& operator--( ){ index_--; return *this; }
+        const_iterator operator--( int ){ const_iterator previous = *this; index_--; return previous; }
+
+        bool operator==( const const_iterator& other ) const
+        {
+            return stateHistory_ == other.stateHistory_ && index_ == other.index_;
+        }
+
+        bool operator!=( const const_iterator& other ) const
+        {
+            return !( *this == other );
+        }
+
+        //! Function to retrieve the index of the entry in the history.
+        unsigned int getIndex( ) const { return index_; }
+
+    private:
+
+        //! History over which the iterator runs.
+        const FlatStateHistory* stateHistory_;
+
+        //! Index of the current entry.
+        unsigned int index_;
+    };
+
+    //! Constructor for empty history.
+    /*!
+     *  Constructor for empty history.
+     *  \param stateSize Size of each state in the history.
+     */
+    FlatStateHistory( const unsigned int stateSize = 0 ): stateSize_( stateSize ){ }
+
+    //! Constructor from a map of epoch to state.
+    /*!
+     *  Constructor from a map of epoch to state (e.g. the output of getEquationsOfMotionNumericalSolution).
+     *  \param stateMap Map from which the history is to be created; all states must have the same size.
+     */
+    template< int NumberOfRows >
+    explicit FlatStateHistory( const std::map< TimeType, Eigen::Matrix< StateScalarType, NumberOfRows, 1 > >& stateMap ):
+        stateSize_( stateMap.size( ) > 0 ? stateMap.begin( )->second.rows( ) : 0 )
+    {
+        reserve( stateMap.size( ) );
+        for( auto mapIterator = stateMap.begin( ); mapIterator != stateMap.end( ); mapIterator++ )
+        {
+            push_back( mapIterator->first, mapIterator->second );
+        }
+    }
+
+    //! Function to reserve memory for a given number of epochs.
+    void reserve( const unsigned int numberOfEpochs )
+    {
+        epochs_.reserve( numberOfEpochs );
+        states_.reserve( numberOfEpochs * stateSize_ );
+    }
+
+    //! Function to add a state at the end of the history.
+    /*!
+     *  Function to add a state at the end of the history.
+     *  \param epoch Epoch of the state, which must be larger than the last epoch in the history.
+     *  \param state State that is to be added, of size getStateSize( ).
+     */
+    template< typename Derived >
+    void push_back( const TimeType epoch, const Eigen::MatrixBase< Derived >& state )
+    {
+        if( static_cast< unsigned int >( state.size( ) ) != stateSize_ )
+        {
+            throw std::runtime_error( "Error when adding state to flat state history, state size is inconsistent." );
+        }
+        else if( !epochs_.empty( ) && !( epochs_.back( ) < epoch ) )
+        {
+            throw std::runtime_error( "Error when adding state to flat state history, epochs must be increasing." );
+        }
+
+        epochs_.push_back( epoch );
+        states_.resize( states_.size( ) + stateSize_ );
+        StateMap( states_.data( ) + states_.size( ) - stateSize_, stateSize_ ) = state;
+    }
+
+    //! Function to remove all entries from the history.
+    void clear( )
+    {
+        epochs_.clear( );
+        states_.clear( );
+    }
+
+    //! Function to retrieve the number of epochs in the history.
+    unsigned int size( ) const { return epochs_.size( ); }
+
+    //! Function to check whether the history is empty.
+    bool empty( ) const { return epochs_.empty( ); }
+
+    //! Function to retrieve the size of each state in the history.
+    unsigned int getStateSize( ) const { return stateSize_; }
+
+    //! Function to retrieve the (sorted) list of epochs.
+    const std::vector< TimeType >& getEpochs( ) const { return epochs_; }
+
+    //! Function to retrieve the epoch at a given index.
+    TimeType getEpoch( const unsigned int index ) const { return epochs_[ index ]; }
+
+    //! Function to retrieve the state at a given index.
+    ConstStateMap getState( const unsigned int index ) const
+    {
+        return ConstStateMap( states_.data( ) + index * stateSize_, stateSize_ );
+    }
+
+    //! Function to retrieve the (modifiable) state at a given index.
+    StateMap getState( const unsigned int index )
+    {
+        return StateMap( states_.data( ) + index * stateSize_, stateSize_ );
+    }
+
+    //! Function to retrieve the epoch and state at a given index.
+    Entry getEntry( const unsigned int index ) const
+    {
+        return Entry( epochs_[ index ], states_.data( ) + index * stateSize_, stateSize_ );
+    }
+
+    //! Function to retrieve all states as a matrix, with one row per epoch.
+    ConstStateBlockMap getStateBlock( ) const
+    {
+        return ConstStateBlockMap( states_.data( ), epochs_.size( ), stateSize_ );
+    }
+
+    //! Function to retrieve pointer to the contiguous (row-major) block of states.
+    const StateScalarType* data( ) const { return states_.data( ); }
+
+    //! Function to find the index of a given epoch, returns -1 if the epoch is not in the history.
+    int findIndex( const TimeType epoch ) const
+    {
+        typename std::vector< TimeType >::const_iterator epochIterator =
+                std::lower_bound( epochs_.begin( ), epochs_.end( ), epoch );
+        if( epochIterator == epochs_.end( ) || *epochIterator != epoch )
+        {
+            return -1;
+        }
+        return static_cast< int >( epochIterator - epochs_.begin( ) );
+    }
+
+    //! Function to find the entry at a given epoch, returns end( ) if the epoch is not in the history.
+    const_iterator find( const TimeType epoch ) const
+    {
+        int index = findIndex( epoch );
+        return ( index < 0 ) ? end( ) : const_iterator( this, index );
+    }
+
+    //! Function to check whether a given epoch is in the history (returns 0 or 1, as for a map).
+    unsigned int count( const TimeType epoch ) const
+    {
+        return ( findIndex( epoch ) < 0 ) ? 0 : 1;
+    }
+
+    //! Function to retrieve the state at a given epoch, throws std::out_of_range if the epoch is not in the history.
+    ConstStateMap at( const TimeType epoch ) const
+    {
+        int index = findIndex( epoch );
+        if( index < 0 )
+        {
+            throw std::out_of_range( "Error, epoch not found in flat state history." );
+        }
+        return getState( index );
+    }
+
+    //! Function to retrieve iterator to the first entry.
+    const_iterator begin( ) const { return const_iterator( this, 0 ); }
+
+    //! Function to retrieve iterator past the last entry.
+    const_iterator end( ) const { return const_iterator( this, epochs_.size( ) ); }
+
+    //! Function to retrieve the first entry (history must not be empty).
+    Entry front( ) const { return getEntry( 0 ); }
+
+    //! Function to retrieve the last entry (history must not be empty).
+    Entry back( ) const { return getEntry( epochs_.size( ) - 1 ); }
+
+    //! Function to convert the history to a map (e.g. for use with interpolators or text output).
+    std::map< TimeType, StateType > toMap( ) const
+    {
+        std::map< TimeType, StateType > stateMap;
+        for( unsigned int i = 0; i < epochs_.size( ); i++ )
+        {
+            stateMap.insert( stateMap.end( ), std::make_pair( epochs_[ i ], StateType( getState( i ) ) ) );
+        }
+        return stateMap;
+    }
+
+private:
+
+    //! Size of each state in the history.
+    unsigned int stateSize_;
+
+    //! Sorted list of epochs.
+    std::vector< TimeType > epochs_;
+
+    //! Contiguous block of states, with stateSize_ consecutive entries per epoch.
+    std::vector< StateScalarType > states_;
+};
+
+//! Function to write a flat state history to a binary stream (see writeDataMapToBinaryStream).
+/*!
+ *  Function to write a flat state history to a binary stream, in the same format as the corresponding map of epoch to
+ *  state (see writeDataMapToBinaryStream), so that it can be written to file and added to a campaign archive.
+ *  \param outputStream Stream to which the state history is to be written (opened in binary mode).
+ *  \param stateHistory State history that is to be written.
+ *  \param caseTag Tag identifying the simulation case (truncated to 183 characters).
+ *  \return Total number of bytes written to the stream.
+ */
+template< typename StateScalarType, typename TimeType >
+std::uint64_t writeDataMapToBinaryStream(
+        std::ostream& outputStream,
+        const FlatStateHistory< StateScalarType, TimeType >& stateHistory,
+        const std::string& caseTag = "" )
+{
+    // Transpose row-major state block to column-major output.
+    std::vector< StateScalarType > stateColumns( stateHistory.size( ) * stateHistory.getStateSize( ) );
+    Eigen::Map< Eigen::Matrix< StateScalarType, Eigen::Dynamic, Eigen::Dynamic > >(
+                stateColumns.data( ), stateHistory.size( ), stateHistory.getStateSize( ) ) = stateHistory.getStateBlock( );
+
+    return writeColumnarStateHistoryToBinaryStream(
+                outputStream, stateHistory.getEpochs( ), stateColumns, stateHistory.getStateSize( ), caseTag );
+}
+
+}
+
+#endif // TUDAT_FLATSTATEHISTORY_H
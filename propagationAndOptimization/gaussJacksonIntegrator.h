@@ -0,0 +1,670 @@
+/*    Copyright (c) 2010-2018, Delft University of Technology
+ *    All rigths reserved
+ *
+ *    This file is part of the Tudat. Redistribution and use in source and
+ *    binary forms, with or without modification, are permitted exclusively
+ *    under the terms of the Modified BSD license. You should have received
+ *    a copy of the license with this file. If not, please or visit:
+ *    http://tudat.tudelft.nl/LICENSE.
+ */
+
+#ifndef TUDAT_GAUSSJACKSONINTEGRATOR_H
+#define TUDAT_GAUSSJACKSONINTEGRATOR_H
+
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include <Tudat/SimulationSetup/tudatSimulationHeader.h>
+
+#include "propagationAndOptimization/butcherTableauIntegrator.h"
+#include "propagationAndOptimization/integrationStepAllocationCheck.h"
+
+namespace tudat_applications
+{
+
+// Coefficients of the eighth-order Gauss-Jackson (position) and summed Adams (velocity) methods, in ordinate form (entry
+// [ j ][ k ] is the coefficient of the acceleration at node k - 4 for the state at node j - 4, relative to the central node
+// of a window of nine nodes; row 9 is the predictor for the node following the window). See Berry, M.M. and Healy, L.M.,
+// Implementation of Gauss-Jackson integration for orbit propagation, J. Astronaut. Sci. 52(3), 2004.
+
+//! Denominator of the Gauss-Jackson coefficients.
+constexpr double gaussJacksonPositionDenominator = 3628800.0;
+
+//! Numerators of the Gauss-Jackson coefficients.
+constexpr double gaussJacksonPositionCoefficients[ 10 ][ 9 ] =
+{ { 221570.0, 364875.0, -792474.0, 1100909.0, -1045620.0, 672885.0, -281170.0, 68979.0, -7554.0 },
+  { -7554.0, 289556.0, 92931.0, -157938.0, 149105.0, -93816.0, 38349.0, -9226.0, 993.0 },
+  { 993.0, -16491.0, 325304.0, 9519.0, -32820.0, 23987.0, -10404.0, 2601.0, -289.0 },
+  { -289.0, 3594.0, -26895.0, 349580.0, -26895.0, 3594.0, -289.0, 0.0, 0.0 },
+  { 0.0, -289.0, 3594.0, -26895.0, 349580.0, -26895.0, 3594.0, -289.0, 0.0 },
+  { 0.0, 0.0, -289.0, 3594.0, -26895.0, 349580.0, -26895.0, 3594.0, -289.0 },
+  { -289.0, 2601.0, -10404.0, 23987.0, -32820.0, 9519.0, 325304.0, -16491.0, 993.0 },
+  { 993.0, -9226.0, 38349.0, -93816.0, 149105.0, -157938.0, 92931.0, 289556.0, -7554.0 },
+  { -7554.0, 68979.0, -281170.0, 672885.0, -1045620.0, 1100909.0, -792474.0, 364875.0, 221570.0 },
+  { 221570.0, -2001684.0, 8045499.0, -18893050.0, 28590705.0, -28963440.0, 19712789.0, -8768994.0, 2359005.0 } };
+
+//! Denominator of the summed Adams coefficients.
+constexpr double gaussJacksonVelocityDenominator = 7257600.0;
+
+//! Numerators of the summed Adams coefficients.
+constexpr double gaussJacksonVelocityCoefficients[ 10 ][ 9 ] =
+{ { 1546047.0, -4274870.0, 6996434.0, -9005886.0, 8277760.0, -5232322.0, 2161710.0, -526154.0, 57281.0 },
+  { 57281.0, 1030518.0, -2212754.0, 2184830.0, -1788480.0, 1060354.0, -420718.0, 99594.0, -10625.0 },
+  { -10625.0, 152906.0, 648018.0, -1320254.0, 846080.0, -449730.0, 167854.0, -38218.0, 3969.0 },
+  { 3969.0, -46346.0, 295790.0, 314622.0, -820160.0, 345986.0, -116334.0, 24970.0, -2497.0 },
+  { -2497.0, 26442.0, -136238.0, 505538.0, 0.0, -505538.0, 136238.0, -26442.0, 2497.0 },
+  { 2497.0, -24970.0, 116334.0, -345986.0, 820160.0, -314622.0, -295790.0, 46346.0, -3969.0 },
+  { -3969.0, 38218.0, -167854.0, 449730.0, -846080.0, 1320254.0, -648018.0, -152906.0, 10625.0 },
+  { 10625.0, -99594.0, 420718.0, -1060354.0, 1788480.0, -2184830.0, 2212754.0, -1030518.0, -57281.0 },
+  { -57281.0, 526154.0, -2161710.0, 5232322.0, -8277760.0, 9005886.0, -6996434.0, 4274870.0, -1546047.0 },
+  { 2082753.0, -18802058.0, 75505262.0, -177112962.0, 267659200.0, -270704638.0, 183957138.0, -81975542.0, 23019647.0 } };
+
+//! Integrator type of the Gauss-Jackson integrator settings.
+/*!
+ *  Integrator type of the Gauss-Jackson integrator settings. Tudat has no integrator type for this method, so a value that
+ *  is not an integrator type of Tudat is used (the largest value of the range of AvailableIntegrators, which has five
+ *  integrator types), so that the createIntegrator function of Tudat rejects the settings instead of misinterpreting them.
+ */
+const tudat::numerical_integrators::AvailableIntegrators gaussJacksonIntegratorType =
+        static_cast< tudat::numerical_integrators::AvailableIntegrators >( 7 );
+
+//! Settings for the Gauss-Jackson integrator.
+/*!
+ *  Settings for the eighth-order Gauss-Jackson integrator (see GaussJacksonIntegrator), with the integrator type
+ *  gaussJacksonIntegratorType. The settings are only supported by propagateToStateHistorySinks, which does not pass them
+ *  to Tudat; they are rejected by the createIntegrator function of Tudat (and hence by a SingleArcDynamicsSimulator that
+ *  integrates the equations of motion).
+ */
+template< typename TimeType = double >
+class GaussJacksonIntegratorSettings: public tudat::numerical_integrators::IntegratorSettings< TimeType >
+{
+public:
+
+    //! Constructor
+    /*!
+     *  Constructor
+     *  \param initialTime Initial time of the integration.
+     *  \param stepSize Fixed step size (negative for backward integration).
+     *  \param numberOfCorrectorEvaluations Number of evaluations of the corrected state per step (0 for a PEC scheme, 1 for
+     *  PECE, etc.).
+     *  \param starterErrorTolerance Relative and absolute error tolerance of the Runge-Kutta-Fehlberg 7(8) starter.
+     *  \param startupConvergenceTolerance Relative change in the states of the startup iteration at which it is converged.
+     *  \param maximumNumberOfStartupIterations Maximum number of startup iterations.
+     */
+    GaussJacksonIntegratorSettings( const TimeType initialTime,
+                                    const TimeType stepSize,
+                                    const unsigned int numberOfCorrectorEvaluations = 1,
+                                    const TimeType starterErrorTolerance = 1.0E-13,
+                                    const double startupConvergenceTolerance = 1.0E-14,
+                                    const unsigned int maximumNumberOfStartupIterations = 10 ):
+        tudat::numerical_integrators::IntegratorSettings< TimeType >(
+            gaussJacksonIntegratorType, initialTime, stepSize ),
+        numberOfCorrectorEvaluations_( numberOfCorrectorEvaluations ), starterErrorTolerance_( starterErrorTolerance ),
+        startupConvergenceTolerance_( startupConvergenceTolerance ),
+        maximumNumberOfStartupIterations_( maximumNumberOfStartupIterations ){ }
+
+    //! Destructor
+    ~GaussJacksonIntegratorSettings( ){ }
+
+    //! Number of evaluations of the corrected state per step.
+    unsigned int numberOfCorrectorEvaluations_;
+
+    //! Relative and absolute error tolerance of the Runge-Kutta-Fehlberg 7(8) starter.
+    TimeType starterErrorTolerance_;
+
+    //! Relative change in the states of the startup iteration at which it is converged.
+    double startupConvergenceTolerance_;
+
+    //! Maximum number of startup iterations.
+    unsigned int maximumNumberOfStartupIterations_;
+};
+
+//! Eighth-order Gauss-Jackson integrator for (Cowell) translational dynamics.
+/*!
+ *  Eighth-order Gauss-Jackson integrator, which integrates the second-order equations of motion of (Cowell) translational
+ *  dynamics directly, instead of as a first-order system: the positions are obtained from a double sum of the accelerations
+ *  (Gauss-Jackson) and the velocities from a single sum (summed Adams), corrected by a weighted sum of the accelerations at
+ *  nine nodes, following Berry and Healy (2004). The state consists of the Cartesian states (position and velocity) of
+ *  one or more bodies, concatenated, so that only the acceleration entries of the state derivative are used. Velocity-
+ *  dependent accelerations are evaluated with the summed Adams velocities.
+ *
+ *  The step size is fixed. The integration is started by propagating eight steps with a Runge-Kutta-Fehlberg 7(8)
+ *  integrator with tight tolerances, after which the starting states are iterated with the Gauss-Jackson corrector until
+ *  they are consistent with the method (each iteration costs eight evaluations). Each subsequent step consists of a
+ *  prediction, an evaluation, and a correction followed by the set number of evaluations and corrections (PECE by
+ *  default, i.e. two evaluations per step).
+ *
+ *  The steps are taken on a grid with the fixed step size from the initial time. A step to a time that is not on the grid
+ *  (e.g. to an output epoch or the final time) is computed by integrating the polynomial through the accelerations on the
+ *  last nine grid points, starting from the preceding grid point, without additional evaluations and without moving the
+ *  grid; getNextStepSize returns the step size to the next grid point. After the current state is modified, the
+ *  integration is restarted from the modified state.
+ */
+template< typename StateType = Eigen::VectorXd, typename TimeType = double >
+class GaussJacksonIntegrator:
+        public tudat::numerical_integrators::NumericalIntegrator< TimeType, StateType, StateType, TimeType >
+{
+public:
+
+    typedef tudat::numerical_integrators::NumericalIntegrator< TimeType, StateType, StateType, TimeType > Base;
+
+    typedef typename StateType::Scalar StateScalarType;
+
+    //! Typedef for the Cartesian components (one column per body) of the positions, velocities or accelerations.
+    typedef Eigen::Matrix< StateScalarType, 3, Eigen::Dynamic > ComponentMatrix;
+
+    //! Typedef for a view of the position or velocity components of a state.
+    typedef Eigen::Map< ComponentMatrix, 0, Eigen::OuterStride< 6 > > ComponentMap;
+
+    //! Typedef for a constant view of the position or velocity components of a state (or derivative).
+    typedef Eigen::Map< const ComponentMatrix, 0, Eigen::OuterStride< 6 > > ConstComponentMap;
+
+    //! Constructor
+    /*!
+     *  Constructor
+     *  \param stateDerivativeFunction State derivative function.
+     *  \param initialTime Initial time of the integration.
+     *  \param initialState Initial state (concatenated Cartesian states).
+     *  \param stepSize Fixed step size (negative for backward integration).
+     *  \param numberOfCorrectorEvaluations Number of evaluations of the corrected state per step.
+     *  \param starterErrorTolerance Relative and absolute error tolerance of the starter.
+     *  \param startupConvergenceTolerance Relative change in the states of the startup iteration at which it is converged.
+     *  \param maximumNumberOfStartupIterations Maximum number of startup iterations.
+     */
+    GaussJacksonIntegrator( const typename Base::StateDerivativeFunction& stateDerivativeFunction,
+                            const TimeType initialTime,
+                            const StateType& initialState,
+                            const TimeType stepSize,
+                            const unsigned int numberOfCorrectorEvaluations = 1,
+                            const TimeType starterErrorTolerance = 1.0E-13,
+                            const double startupConvergenceTolerance = 1.0E-14,
+                            const unsigned int maximumNumberOfStartupIterations = 10 ):
+        Base( stateDerivativeFunction ),
+        stepSize_( stepSize ), numberOfCorrectorEvaluations_( numberOfCorrectorEvaluations ),
+        starterErrorTolerance_( starterErrorTolerance ), startupConvergenceTolerance_( startupConvergenceTolerance ),
+        maximumNumberOfStartupIterations_( maximumNumberOfStartupIterations ),
+        numberOfBodies_( initialState.rows( ) / 6 ),
+        gridStartTime_( initialTime ), gridIndex_( 0 ), isStarted_( false ),
+        currentTime_( initialTime ), currentState_( initialState ),
+        previousTime_( initialTime ), previousState_( initialState ), isRollbackAllowed_( false )
+    {
+        if( initialState.rows( ) % 6 != 0 || initialState.cols( ) != 1 )
+        {
+            throw std::runtime_error( "Error, Gauss-Jackson integrator requires concatenated Cartesian states." );
+        }
+        if( !( stepSize != 0.0 ) )
+        {
+            throw std::runtime_error( "Error, Gauss-Jackson integrator requires a non-zero step size." );
+        }
+
+        // Allocate workspace.
+        gridStates_.resize( 9, initialState );
+        accelerations_.resize( 10, ComponentMatrix::Zero( 3, numberOfBodies_ ) );
+        firstSum_ = ComponentMatrix::Zero( 3, numberOfBodies_ );
+        secondSum_ = ComponentMatrix::Zero( 3, numberOfBodies_ );
+        nextFirstSum_ = firstSum_;
+        nextSecondSum_ = secondSum_;
+        positionCorrection_ = firstSum_;
+        velocityCorrection_ = firstSum_;
+        stateDerivative_ = initialState;
+        predictedState_ = initialState;
+    }
+
+    //! Destructor
+    ~GaussJacksonIntegrator( ){ }
+
+    //! Function to perform a step to the current time plus the step size (see class description).
+    /*!
+     *  Function to perform a step to the current time plus the step size, taking the required steps on the grid, and
+     *  interpolating if the requested time is not on the grid (see class description).
+     *  \param stepSize Step size to take.
+     *  \return State at the end of the step.
+     */
+    StateType performIntegrationStep( const TimeType stepSize )
+    {
+        if( !isStarted_ )
+        {
+            startIntegration( );
+        }
+
+        {
+            ScopedEigenAllocationCheck allocationCheck;
+
+            previousTime_ = currentTime_;
+            previousState_ = currentState_;
+            const TimeType targetTime = currentTime_ + stepSize;
+
+            // Take steps on the grid until it reaches the requested time.
+            while( ( targetTime - getGridTime( gridIndex_ ) ) / stepSize_ > gridTimeTolerance( ) )
+            {
+                performGridStep( );
+            }
+
+            // Retrieve state at grid point, or interpolate within window.
+            const double windowPosition =
+                    static_cast< double >( ( targetTime - getGridTime( gridIndex_ - 8 ) ) / stepSize_ );
+            const double nearestNode = std::floor( windowPosition + 0.5 );
+            if( windowPosition < -gridTimeTolerance( ) )
+            {
+                throw std::runtime_error( "Error, Gauss-Jackson integrator cannot step back beyond its previous nodes." );
+            }
+            else if( std::fabs( windowPosition - nearestNode ) <= gridTimeTolerance( ) )
+            {
+                currentTime_ = getGridTime( gridIndex_ - 8 + static_cast< int >( nearestNode ) );
+                currentState_ = gridStates_[ static_cast< int >( nearestNode ) ];
+            }
+            else
+            {
+                const int node = std::min( static_cast< int >( std::floor( windowPosition ) ), 7 );
+                interpolateState( node, windowPosition - static_cast< double >( node ), currentState_ );
+                currentTime_ = targetTime;
+            }
+            isRollbackAllowed_ = true;
+        }
+        return currentState_;
+    }
+
+    //! Function to get the step size for the next step (to the next grid point).
+    TimeType getNextStepSize( ) const
+    {
+        if( !isStarted_ )
+        {
+            return stepSize_;
+        }
+        const double gridPosition = static_cast< double >( ( currentTime_ - gridStartTime_ ) / stepSize_ );
+        return getGridTime( static_cast< int >( std::floor( gridPosition + gridTimeTolerance( ) ) ) + 1 ) - currentTime_;
+    }
+
+    //! Function to get the current state.
+    StateType getCurrentState( ) const { return currentState_; }
+
+    //! Function to get the current time.
+    TimeType getCurrentIndependentVariable( ) const { return currentTime_; }
+
+    //! Function to get the time at the start of the last step.
+    TimeType getPreviousIndependentVariable( ) { return previousTime_; }
+
+    //! Function to get the state at the start of the last step.
+    StateType getPreviousState( ) { return previousState_; }
+
+    //! Function to roll back the last step (possible only once per step).
+    /*!
+     *  Function to roll back the last step (possible only once per step, and not after the state has been modified without
+     *  allowing a rollback). The steps on the grid are retained, as they remain valid.
+     *  \return True if the last step was rolled back.
+     */
+    bool rollbackToPreviousState( )
+    {
+        if( !isRollbackAllowed_ )
+        {
+            return false;
+        }
+
+        currentTime_ = previousTime_;
+        currentState_ = previousState_;
+        isRollbackAllowed_ = false;
+        return true;
+    }
+
+    //! Function to modify the current state (e.g. after an impulsive maneuver), restarting the integration.
+    /*!
+     *  Function to modify the current state (e.g. after an impulsive maneuver), after which the integration is restarted
+     *  from the current time at the next step.
+     *  \param newState New current state.
+     *  \param allowRollback Boolean denoting whether the last step may still be rolled back (not supported, as the
+     *  integration is restarted).
+     */
+    void modifyCurrentState( const StateType& newState, const bool allowRollback )
+    {
+        static_cast< void >( allowRollback );
+        currentState_ = newState;
+        gridStartTime_ = currentTime_;
+        gridIndex_ = 0;
+        isStarted_ = false;
+        isRollbackAllowed_ = false;
+    }
+
+    //! Function to modify the current state, restarting the integration.
+    void modifyCurrentState( const StateType& newState )
+    {
+        modifyCurrentState( newState, false );
+    }
+
+private:
+
+    //! Tolerance (in step sizes) within which a time is considered to be on the grid.
+    static double gridTimeTolerance( ) { return 1.0E-9; }
+
+    //! Function to get the time of a grid point.
+    TimeType getGridTime( const int index ) const
+    {
+        return gridStartTime_ + static_cast< TimeType >( index ) * stepSize_;
+    }
+
+    //! Function to evaluate the accelerations in a state.
+    void evaluateAccelerations( const TimeType time, const StateType& state, ComponentMatrix& accelerations )
+    {
+        {
+            ScopedEigenAllocationCheck stateDerivativeAllocationCheck( true );
+            stateDerivative_ = this->stateDerivativeFunction_( time, state );
+        }
+        accelerations = ConstComponentMap( stateDerivative_.data( ) + 3, 3, numberOfBodies_ );
+    }
+
+    //! Function to compute the position and velocity corrections of a row of coefficients (see coefficient tables).
+    void computeCorrections( const int row, const int firstAccelerationIndex )
+    {
+        positionCorrection_.setZero( );
+        velocityCorrection_.setZero( );
+        for( int k = 0; k < 9; k++ )
+        {
+            positionCorrection_ += static_cast< StateScalarType >(
+                        gaussJacksonPositionCoefficients[ row ][ k ] / gaussJacksonPositionDenominator ) *
+                    accelerations_[ firstAccelerationIndex + k ];
+            velocityCorrection_ += static_cast< StateScalarType >(
+                        gaussJacksonVelocityCoefficients[ row ][ k ] / gaussJacksonVelocityDenominator ) *
+                    accelerations_[ firstAccelerationIndex + k ];
+        }
+    }
+
+    //! Function to set the state from the sums and corrections.
+    void setState( const ComponentMatrix& secondSum, const ComponentMatrix& firstSum, StateType& state )
+    {
+        const StateScalarType stepSize = static_cast< StateScalarType >( stepSize_ );
+        ComponentMap( state.data( ), 3, numberOfBodies_ ) = ( stepSize * stepSize ) * ( secondSum + positionCorrection_ );
+        ComponentMap( state.data( ) + 3, 3, numberOfBodies_ ) = stepSize * ( firstSum + velocityCorrection_ );
+    }
+
+    //! Function to compute the sums at all nodes of the window from the state at the first node.
+    void computeStartupSums( std::vector< ComponentMatrix >& firstSums, std::vector< ComponentMatrix >& secondSums )
+    {
+        const StateScalarType stepSize = static_cast< StateScalarType >( stepSize_ );
+        computeCorrections( 0, 0 );
+        firstSums[ 0 ] = ConstComponentMap( gridStates_[ 0 ].data( ) + 3, 3, numberOfBodies_ ) / stepSize -
+                velocityCorrection_;
+        secondSums[ 0 ] = ConstComponentMap( gridStates_[ 0 ].data( ), 3, numberOfBodies_ ) / ( stepSize * stepSize ) -
+                positionCorrection_;
+        for( int i = 1; i < 9; i++ )
+        {
+            firstSums[ i ] = firstSums[ i - 1 ] + 0.5 * ( accelerations_[ i - 1 ] + accelerations_[ i ] );
+            secondSums[ i ] = secondSums[ i - 1 ] + firstSums[ i - 1 ] + 0.5 * accelerations_[ i - 1 ];
+        }
+    }
+
+    //! Function to start the integration from the current state (see class description).
+    void startIntegration( )
+    {
+        // Propagate starting states with Runge-Kutta-Fehlberg 7(8) integrator.
+        ButcherTableauRungeKuttaIntegrator< RungeKuttaFehlberg78Tableau, StateType, TimeType > starter(
+                    this->stateDerivativeFunction_, currentTime_, currentState_,
+                    starterErrorTolerance_, starterErrorTolerance_ );
+        gridStartTime_ = currentTime_;
+        gridIndex_ = 8;
+        gridStates_[ 0 ] = currentState_;
+        TimeType starterStepSize = stepSize_;
+        for( int i = 1; i < 9; i++ )
+        {
+            while( ( getGridTime( i ) - starter.getCurrentIndependentVariable( ) ) / stepSize_ > gridTimeTolerance( ) )
+            {
+                const TimeType remainingTime = getGridTime( i ) - starter.getCurrentIndependentVariable( );
+                starter.performIntegrationStep(
+                            ( remainingTime / starterStepSize < 1.0 ) ? remainingTime : starterStepSize );
+                starterStepSize = starter.getNextStepSize( );
+            }
+            gridStates_[ i ] = starter.getCurrentState( );
+        }
+
+        for( int i = 0; i < 9; i++ )
+        {
+            evaluateAccelerations( getGridTime( i ), gridStates_[ i ], accelerations_[ i ] );
+        }
+
+        // Iterate starting states until consistent with the corrector.
+        std::vector< ComponentMatrix > firstSums( 9, firstSum_ ), secondSums( 9, secondSum_ );
+        for( unsigned int iteration = 0; iteration < maximumNumberOfStartupIterations_; iteration++ )
+        {
+            computeStartupSums( firstSums, secondSums );
+
+            StateScalarType maximumStateChange = 0.0;
+            StateScalarType maximumState = 0.0;
+            for( int i = 1; i < 9; i++ )
+            {
+                computeCorrections( i, 0 );
+                predictedState_ = gridStates_[ i ];
+                setState( secondSums[ i ], firstSums[ i ], gridStates_[ i ] );
+                maximumStateChange = std::max( maximumStateChange,
+                                               ( gridStates_[ i ] - predictedState_ ).cwiseAbs( ).maxCoeff( ) );
+                maximumState = std::max( maximumState, gridStates_[ i ].cwiseAbs( ).maxCoeff( ) );
+                evaluateAccelerations( getGridTime( i ), gridStates_[ i ], accelerations_[ i ] );
+            }
+
+            if( maximumStateChange <= static_cast< StateScalarType >( startupConvergenceTolerance_ ) * maximumState )
+            {
+                break;
+            }
+        }
+        computeStartupSums( firstSums, secondSums );
+        firstSum_ = firstSums[ 8 ];
+        secondSum_ = secondSums[ 8 ];
+
+        isStarted_ = true;
+    }
+
+    //! Function to take a single step on the grid (predict, evaluate, and correct/evaluate).
+    void performGridStep( )
+    {
+        const TimeType nextGridTime = getGridTime( gridIndex_ + 1 );
+
+        // Predict state at next grid point from window of previous accelerations.
+        nextSecondSum_ = secondSum_ + firstSum_ + 0.5 * accelerations_[ 8 ];
+        computeCorrections( 9, 0 );
+        nextFirstSum_ = firstSum_ + 0.5 * accelerations_[ 8 ];
+        setState( nextSecondSum_, nextFirstSum_, predictedState_ );
+        evaluateAccelerations( nextGridTime, predictedState_, accelerations_[ 9 ] );
+
+        // Correct state, using window including new acceleration, and re-evaluate.
+        nextFirstSum_ = firstSum_ + 0.5 * ( accelerations_[ 8 ] + accelerations_[ 9 ] );
+        for( unsigned int i = 0; i <= numberOfCorrectorEvaluations_; i++ )
+        {
+            computeCorrections( 8, 1 );
+            setState( nextSecondSum_, nextFirstSum_, predictedState_ );
+            if( i < numberOfCorrectorEvaluations_ )
+            {
+                evaluateAccelerations( nextGridTime, predictedState_, accelerations_[ 9 ] );
+                nextFirstSum_ = firstSum_ + 0.5 * ( accelerations_[ 8 ] + accelerations_[ 9 ] );
+            }
+        }
+
+        // Shift window.
+        for( int i = 0; i < 9; i++ )
+        {
+            accelerations_[ i ].swap( accelerations_[ i + 1 ] );
+        }
+        for( int i = 0; i < 8; i++ )
+        {
+            gridStates_[ i ].swap( gridStates_[ i + 1 ] );
+        }
+        gridStates_[ 8 ].swap( predictedState_ );
+        firstSum_.swap( nextFirstSum_ );
+        secondSum_.swap( nextSecondSum_ );
+        gridIndex_++;
+    }
+
+    //! Function to interpolate the state between two nodes of the window.
+    /*!
+     *  Function to interpolate the state between two nodes of the window, by integrating the polynomial through the
+     *  accelerations at all nodes of the window from the state at the preceding node.
+     *  \param node Index of the preceding node in the window (0 to 7).
+     *  \param fraction Fraction of the step size from the preceding node.
+     *  \param interpolatedState Interpolated state (returned by reference).
+     */
+    void interpolateState( const int node, const double fraction, StateType& interpolatedState )
+    {
+        positionCorrection_.setZero( );
+        velocityCorrection_.setZero( );
+        for( int k = 0; k < 9; k++ )
+        {
+            // Compute coefficients of Lagrange polynomial of node k, with time in step sizes from the preceding node.
+            double polynomialCoefficients[ 9 ] = { 1.0 };
+            int degree = 0;
+            for( int i = 0; i < 9; i++ )
+            {
+                if( i != k )
+                {
+                    const double nodeTime = static_cast< double >( i - node );
+                    const double scaling = 1.0 / static_cast< double >( k - i );
+                    degree++;
+                    for( int m = degree; m >= 0; m-- )
+                    {
+                        polynomialCoefficients[ m ] = scaling * ( ( m > 0 ? polynomialCoefficients[ m - 1 ] : 0.0 ) -
+                                                                  nodeTime * polynomialCoefficients[ m ] );
+                    }
+                }
+            }
+
+            // Integrate polynomial once and twice from the preceding node.
+            double firstIntegral = 0.0, secondIntegral = 0.0;
+            double fractionPower = fraction;
+            for( int m = 0; m < 9; m++ )
+            {
+                firstIntegral += polynomialCoefficients[ m ] * fractionPower / static_cast< double >( m + 1 );
+                secondIntegral += polynomialCoefficients[ m ] * fractionPower * fraction /
+                        static_cast< double >( ( m + 1 ) * ( m + 2 ) );
+                fractionPower *= fraction;
+            }
+            positionCorrection_ += static_cast< StateScalarType >( secondIntegral ) * accelerations_[ k ];
+            velocityCorrection_ += static_cast< StateScalarType >( firstIntegral ) * accelerations_[ k ];
+        }
+
+        const StateScalarType stepSize = static_cast< StateScalarType >( stepSize_ );
+        const StateScalarType timeFromNode = stepSize * static_cast< StateScalarType >( fraction );
+        ConstComponentMap nodePositions( gridStates_[ node ].data( ), 3, numberOfBodies_ );
+        ConstComponentMap nodeVelocities( gridStates_[ node ].data( ) + 3, 3, numberOfBodies_ );
+        ComponentMap( interpolatedState.data( ), 3, numberOfBodies_ ) =
+                nodePositions + timeFromNode * nodeVelocities + ( stepSize * stepSize ) * positionCorrection_;
+        ComponentMap( interpolatedState.data( ) + 3, 3, numberOfBodies_ ) =
+                nodeVelocities + stepSize * velocityCorrection_;
+    }
+
+    //! Fixed step size.
+    TimeType stepSize_;
+
+    //! Number of evaluations of the corrected state per step.
+    unsigned int numberOfCorrectorEvaluations_;
+
+    //! Relative and absolute error tolerance of the starter.
+    TimeType starterErrorTolerance_;
+
+    //! Relative change in the states of the startup iteration at which it is converged.
+    double startupConvergenceTolerance_;
+
+    //! Maximum number of startup iterations.
+    unsigned int maximumNumberOfStartupIterations_;
+
+    //! Number of bodies of which the Cartesian states are integrated.
+    int numberOfBodies_;
+
+    //! Time of the first grid point.
+    TimeType gridStartTime_;
+
+    //! Index of the last grid point that was computed.
+    int gridIndex_;
+
+    //! Boolean denoting whether the integration has been started from the current state.
+    bool isStarted_;
+
+    //! States at the last nine grid points.
+    std::vector< StateType > gridStates_;
+
+    //! Accelerations at the last nine grid points (and at the next grid point, while it is computed).
+    std::vector< ComponentMatrix > accelerations_;
+
+    //! First (summed Adams) sum of the accelerations at the last grid point.
+    ComponentMatrix firstSum_;
+
+    //! Second (Gauss-Jackson) sum of the accelerations at the last grid point.
+    ComponentMatrix secondSum_;
+
+    //! First sum of the accelerations at the next grid point, while it is computed.
+    ComponentMatrix nextFirstSum_;
+
+    //! Second sum of the accelerations at the next grid point, while it is computed.
+    ComponentMatrix nextSecondSum_;
+
+    //! Weighted sum of the accelerations that is added to the second sum (position correction).
+    ComponentMatrix positionCorrection_;
+
+    //! Weighted sum of the accelerations that is added to the first sum (velocity correction).
+    ComponentMatrix velocityCorrection_;
+
+    //! Last evaluated state derivative.
+    StateType stateDerivative_;
+
+    //! State at the next grid point, while it is computed.
+    StateType predictedState_;
+
+    //! Current time.
+    TimeType currentTime_;
+
+    //! Current state.
+    StateType currentState_;
+
+    //! Time at the start of the last step.
+    TimeType previousTime_;
+
+    //! State at the start of the last step.
+    StateType previousState_;
+
+    //! Boolean denoting whether the last step may be rolled back.
+    bool isRollbackAllowed_;
+
+public:
+
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+//! Function to create a Gauss-Jackson integrator, if the integrator settings are for this integrator.
+/*!
+ *  Function to create a GaussJacksonIntegrator, if the integrator type is gaussJacksonIntegratorType. The state
+ *  must consist of concatenated Cartesian states, as propagated by the Cowell propagator.
+ *  \param stateDerivativeFunction State derivative function.
+ *  \param initialState Initial state.
+ *  \param integratorSettings Settings for the numerical integrator.
+ *  \return Numerical integrator (nullptr if the settings are not for the Gauss-Jackson integrator).
+ */
+template< typename TimeType, typename StateType >
+std::shared_ptr< tudat::numerical_integrators::NumericalIntegrator< TimeType, StateType, StateType, TimeType > >
+createGaussJacksonIntegrator(
+        const std::function< StateType( const TimeType, const StateType& ) >& stateDerivativeFunction,
+        const StateType& initialState,
+        const std::shared_ptr< tudat::numerical_integrators::IntegratorSettings< TimeType > > integratorSettings )
+{
+    if( integratorSettings->integratorType_ != gaussJacksonIntegratorType )
+    {
+        return nullptr;
+    }
+
+    std::shared_ptr< GaussJacksonIntegratorSettings< TimeType > > gaussJacksonSettings =
+            std::dynamic_pointer_cast< GaussJacksonIntegratorSettings< TimeType > >( integratorSettings );
+    if( gaussJacksonSettings == nullptr )
+    {
+        throw std::runtime_error( "Error, type of integrator settings not compatible with selected integrator." );
+    }
+
+    return std::shared_ptr< GaussJacksonIntegrator< StateType, TimeType > >(
+                new GaussJacksonIntegrator< StateType, TimeType >(
+                    stateDerivativeFunction, gaussJacksonSettings->initialTime_, initialState,
+                    gaussJacksonSettings->initialTimeStep_, gaussJacksonSettings->numberOfCorrectorEvaluations_,
+                    gaussJacksonSettings->starterErrorTolerance_, gaussJacksonSettings->startupConvergenceTolerance_,
+                    gaussJacksonSettings->maximumNumberOfStartupIterations_ ) );
+}
+
+}
+
+#endif // TUDAT_GAUSSJACKSONINTEGRATOR_H
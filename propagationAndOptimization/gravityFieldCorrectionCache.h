@@ -0,0 +1,392 @@
+/*    Copyright (c) 2010-2018, Delft University of Technology
+ *    All rigths reserved
+ *
+ *    This file is part of the Tudat. Redistribution and use in source and
+ *    binary forms, with or without modification, are permitted exclusively
+ *    under the terms of the Modified BSD license. You should have received
+ *    a copy of the license with this file. If not, please or visit:
+ *    http://tudat.tudelft.nl/LICENSE.
+ */
+
+#ifndef TUDAT_GRAVITYFIELDCORRECTIONCACHE_H
+#define TUDAT_GRAVITYFIELDCORRECTIONCACHE_H
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include <Tudat/SimulationSetup/tudatSimulationHeader.h>
+
+#include "propagationAndOptimization/environmentEvaluationCache.h"
+
+namespace tudat_applications
+{
+
+//! Spherical harmonic coefficient corrections (cosine and sine), as computed by a gravity field variation model.
+typedef std::pair< Eigen::MatrixXd, Eigen::MatrixXd > SphericalHarmonicCorrections;
+
+//! Basic solid body tide gravity field variations, recomputed at a fixed cadence and interpolated in between.
+/*!
+ *  Basic solid body tide gravity field variations (IERS Conventions 2010, Eq. 6.6), equal to those of the Tudat
+ *  BasicSolidBodyTideGravityFieldVariations, but recomputed only on a grid of epochs with a fixed interval (the correction
+ *  update interval), and interpolated in between (cubic Lagrange interpolation, using the two grid epochs on either side).
+ *  Since the tidal corrections vary with the (diurnal and semi-diurnal) periods of the rotation of the deformed body w.r.t.
+ *  the deforming bodies, an update interval of several minutes retains the corrections to a relative accuracy well below
+ *  that of the model itself, while the corrections are no longer recomputed (from the states of the bodies and rotation of
+ *  the deformed body) at each evaluation of the state derivative. The corrections at the grid epochs are computed directly
+ *  from the ephemerides and rotation model, rather than from the current states of the bodies, as the grid epochs generally
+ *  differ from the epoch to which the environment is updated. If the update interval is zero, the corrections are
+ *  recomputed at each (new) epoch.
+ *
+ *  Optionally, the corrections at each epoch at which they are evaluated during the propagation are retained (see
+ *  getCorrectionHistory), so that these need not be recomputed after the propagation (as each saved epoch of the
+ *  propagation is also an epoch at which the state derivative, and therefore the corrections, are evaluated).
+ */
+class CadencedSolidBodyTideGravityFieldVariations: public tudat::gravitation::GravityFieldVariations
+{
+public:
+
+    //! Constructor
+    /*!
+     *  Constructor
+     *  \param deformedBody Body of which the gravity field is deformed.
+     *  \param deformingBodies Bodies causing the tidal deformation.
+     *  \param deformingBodyNames Names of the bodies causing the tidal deformation.
+     *  \param loveNumbers Love numbers, per degree (starting at degree 2), per order (starting at order 0).
+     *  \param referenceRadius Reference radius of the spherical harmonic expansion of the deformed body.
+     *  \param correctionUpdateInterval Interval between the grid epochs at which the corrections are computed (corrections
+     *  are recomputed at each epoch if zero).
+     *  \param referenceEpoch Epoch of the grid (e.g. the initial epoch of the propagation).
+     *  \param isCorrectionHistoryRetained Boolean denoting whether the corrections at each evaluated epoch are retained.
+     */
+    CadencedSolidBodyTideGravityFieldVariations(
+            const std::shared_ptr< tudat::simulation_setup::Body > deformedBody,
+            const std::vector< std::shared_ptr< tudat::simulation_setup::Body > >& deformingBodies,
+            const std::vector< std::string >& deformingBodyNames,
+            const std::vector< std::vector< std::complex< double > > >& loveNumbers,
+            const double referenceRadius,
+            const double correctionUpdateInterval,
+            const double referenceEpoch = 0.0,
+            const bool isCorrectionHistoryRetained = true ):
+        tudat::gravitation::GravityFieldVariations(
+            2, 0, static_cast< int >( loveNumbers.size( ) ) + 1, static_cast< int >( loveNumbers.size( ) ) + 1 ),
+        deformedBody_( deformedBody ), deformingBodies_( deformingBodies ), deformingBodyNames_( deformingBodyNames ),
+        loveNumbers_( loveNumbers ),
+        referenceRadius_( referenceRadius ), correctionUpdateInterval_( correctionUpdateInterval ),
+        referenceEpoch_( referenceEpoch ), isCorrectionHistoryRetained_( isCorrectionHistoryRetained ),
+        gridCorrections_( 8 ), evaluatedCorrections_( 4 )
+    {
+        if( loveNumbers_.size( ) == 0 )
+        {
+            throw std::runtime_error( "Error, no Love numbers provided for solid body tide gravity field variations." );
+        }
+        for( unsigned int i = 0; i < loveNumbers_.size( ); i++ )
+        {
+            if( loveNumbers_.at( i ).size( ) != i + 3 )
+            {
+                throw std::runtime_error( "Error, Love numbers of degree " + std::to_string( i + 2 ) +
+                                          " not provided for all orders." );
+            }
+        }
+        if( correctionUpdateInterval_ < 0.0 )
+        {
+            throw std::runtime_error( "Error, correction update interval of gravity field variations must be non-negative." );
+        }
+    }
+
+    //! Function to compute the corrections to the spherical harmonic coefficients at a given epoch.
+    /*!
+     *  Function to compute the corrections to the spherical harmonic coefficients at a given epoch, from the cached or
+     *  interpolated grid values (see class description).
+     *  \param time Epoch at which the corrections are to be computed.
+     *  \return Corrections to the cosine and sine coefficients, from the minimum to the maximum degree and order.
+     */
+    std::pair< Eigen::MatrixXd, Eigen::MatrixXd > calculateSphericalHarmonicsCorrections( const double time )
+    {
+        SphericalHarmonicCorrections* cachedCorrections = evaluatedCorrections_.find( time );
+        if( cachedCorrections != nullptr )
+        {
+            return *cachedCorrections;
+        }
+
+        SphericalHarmonicCorrections currentCorrections;
+        if( correctionUpdateInterval_ == 0.0 )
+        {
+            currentCorrections = computeTidalCorrections( time );
+        }
+        else
+        {
+            // Interpolate from the two grid epochs on either side of the current epoch.
+            const double intervalsSinceReferenceEpoch = ( time - referenceEpoch_ ) / correctionUpdateInterval_;
+            const double gridIndex = std::floor( intervalsSinceReferenceEpoch );
+            const double s = intervalsSinceReferenceEpoch - gridIndex;
+            const double interpolationWeights[ 4 ] =
+            {
+                -s * ( s - 1.0 ) * ( s - 2.0 ) / 6.0,
+                ( s + 1.0 ) * ( s - 1.0 ) * ( s - 2.0 ) / 2.0,
+                -( s + 1.0 ) * s * ( s - 2.0 ) / 2.0,
+                ( s + 1.0 ) * s * ( s - 1.0 ) / 6.0
+            };
+
+            currentCorrections.first = Eigen::MatrixXd::Zero( numberOfDegrees_, numberOfOrders_ );
+            currentCorrections.second = Eigen::MatrixXd::Zero( numberOfDegrees_, numberOfOrders_ );
+            for( int i = 0; i < 4; i++ )
+            {
+                const SphericalHarmonicCorrections& gridCorrections =
+                        getGridCorrections( referenceEpoch_ + ( gridIndex + static_cast< double >( i - 1 ) ) *
+                                            correctionUpdateInterval_ );
+                currentCorrections.first += interpolationWeights[ i ] * gridCorrections.first;
+                currentCorrections.second += interpolationWeights[ i ] * gridCorrections.second;
+            }
+        }
+
+        if( isCorrectionHistoryRetained_ )
+        {
+            correctionHistory_[ time ] = currentCorrections;
+        }
+        return evaluatedCorrections_.insert( time, currentCorrections );
+    }
+
+    //! Function to retrieve the corrections at each epoch at which these were evaluated (if retained).
+    const std::map< double, SphericalHarmonicCorrections >& getCorrectionHistory( ) const
+    {
+        return correctionHistory_;
+    }
+
+    //! Function to clear the retained corrections (e.g. before a new propagation).
+    void clearCorrectionHistory( )
+    {
+        correctionHistory_.clear( );
+    }
+
+    //! Function to retrieve the identifier of the variation (concatenated names of the bodies causing the deformation).
+    std::string getVariationIdentifier( ) const
+    {
+        std::string variationIdentifier;
+        for( unsigned int i = 0; i < deformingBodyNames_.size( ); i++ )
+        {
+            variationIdentifier += deformingBodyNames_.at( i );
+        }
+        return variationIdentifier;
+    }
+
+private:
+
+    //! Function to retrieve the corrections at a grid epoch (computed if not yet cached).
+    const SphericalHarmonicCorrections& getGridCorrections( const double gridEpoch )
+    {
+        SphericalHarmonicCorrections* cachedCorrections = gridCorrections_.find( gridEpoch );
+        if( cachedCorrections != nullptr )
+        {
+            return *cachedCorrections;
+        }
+        return gridCorrections_.insert( gridEpoch, computeTidalCorrections( gridEpoch ) );
+    }
+
+    //! Function to compute the tidal corrections at a given epoch, from the ephemerides and rotation model.
+    SphericalHarmonicCorrections computeTidalCorrections( const double time )
+    {
+        const Eigen::Quaterniond rotationToBodyFixedFrame =
+                deformedBody_->getRotationalEphemeris( )->getRotationToTargetFrame( time );
+        const Eigen::Vector3d positionOfDeformedBody =
+                deformedBody_->getStateInBaseFrameFromEphemeris< double, double >( time ).segment( 0, 3 );
+        const double gravitationalParameterOfDeformedBody =
+                deformedBody_->getGravityFieldModel( )->getGravitationalParameter( );
+
+        SphericalHarmonicCorrections tidalCorrections;
+        tidalCorrections.first = Eigen::MatrixXd::Zero( numberOfDegrees_, numberOfOrders_ );
+        tidalCorrections.second = Eigen::MatrixXd::Zero( numberOfDegrees_, numberOfOrders_ );
+        for( unsigned int j = 0; j < deformingBodies_.size( ); j++ )
+        {
+            // Compute body-fixed spherical position of deforming body.
+            const Eigen::Vector3d relativePosition = rotationToBodyFixedFrame * (
+                        deformingBodies_.at( j )->getStateInBaseFrameFromEphemeris< double, double >( time ).segment( 0, 3 ) -
+                        positionOfDeformedBody );
+            const double distance = relativePosition.norm( );
+            const double sineOfLatitude = relativePosition.z( ) / distance;
+            const double longitude = std::atan2( relativePosition.y( ), relativePosition.x( ) );
+            const double massRatio = deformingBodies_.at( j )->getGravityFieldModel( )->getGravitationalParameter( ) /
+                    gravitationalParameterOfDeformedBody;
+
+            double radiusRatioPower = ( referenceRadius_ / distance ) * ( referenceRadius_ / distance );
+            for( unsigned int i = 0; i < loveNumbers_.size( ); i++ )
+            {
+                const int degree = static_cast< int >( i ) + 2;
+                radiusRatioPower *= referenceRadius_ / distance;
+                for( int order = 0; order <= degree; order++ )
+                {
+                    const std::complex< double > correction =
+                            loveNumbers_.at( i ).at( order ) / static_cast< double >( 2 * degree + 1 ) * massRatio *
+                            radiusRatioPower *
+                            tudat::basic_mathematics::computeGeodesyLegendrePolynomial( degree, order, sineOfLatitude ) *
+                            std::complex< double >( std::cos( order * longitude ), -std::sin( order * longitude ) );
+                    tidalCorrections.first( i, order ) += correction.real( );
+                    tidalCorrections.second( i, order ) -= correction.imag( );
+                }
+            }
+        }
+        return tidalCorrections;
+    }
+
+    //! Body of which the gravity field is deformed.
+    std::shared_ptr< tudat::simulation_setup::Body > deformedBody_;
+
+    //! Bodies causing the tidal deformation.
+    std::vector< std::shared_ptr< tudat::simulation_setup::Body > > deformingBodies_;
+
+    //! Names of the bodies causing the tidal deformation.
+    std::vector< std::string > deformingBodyNames_;
+
+    //! Love numbers, per degree (starting at degree 2), per order (starting at order 0).
+    std::vector< std::vector< std::complex< double > > > loveNumbers_;
+
+    //! Reference radius of the spherical harmonic expansion of the deformed body.
+    double referenceRadius_;
+
+    //! Interval between the grid epochs at which the corrections are computed (zero if recomputed at each epoch).
+    double correctionUpdateInterval_;
+
+    //! Epoch of the grid.
+    double referenceEpoch_;
+
+    //! Boolean denoting whether the corrections at each evaluated epoch are retained.
+    bool isCorrectionHistoryRetained_;
+
+    //! Corrections at the most recent grid epochs.
+    EpochValueCache< SphericalHarmonicCorrections > gridCorrections_;
+
+    //! Corrections at the most recently evaluated epochs.
+    EpochValueCache< SphericalHarmonicCorrections > evaluatedCorrections_;
+
+    //! Corrections at each evaluated epoch (if retained).
+    std::map< double, SphericalHarmonicCorrections > correctionHistory_;
+};
+
+//! Function to replace the gravity field variations of a body by cadenced basic solid body tide variations.
+/*!
+ *  Function to replace the gravity field variations of a body (which must have a time-dependent spherical harmonic gravity
+ *  field, i.e. have been created with gravity field variation settings) by cadenced basic solid body tide variations (see
+ *  CadencedSolidBodyTideGravityFieldVariations), one per entry of deformingBodiesPerVariation, identified in the same manner
+ *  as the Tudat basic solid body variations (so that the associated dependent variables can still be saved).
+ *  \param bodyMap List of body objects.
+ *  \param deformedBody Name of the body of which the gravity field is deformed.
+ *  \param deformingBodiesPerVariation Names of the bodies causing the deformation, per variation.
+ *  \param loveNumbers Love numbers, per degree (starting at degree 2), per order (starting at order 0).
+ *  \param referenceRadius Reference radius of the spherical harmonic expansion of the deformed body.
+ *  \param correctionUpdateInterval Interval between the grid epochs at which the corrections are computed.
+ *  \param referenceEpoch Epoch of the grid (e.g. the initial epoch of the propagation).
+ *  \return Created variation objects (from which the corrections history can be retrieved).
+ */
+inline std::vector< std::shared_ptr< CadencedSolidBodyTideGravityFieldVariations > >
+setCadencedSolidBodyTideGravityFieldVariations(
+        const tudat::simulation_setup::NamedBodyMap& bodyMap,
+        const std::string& deformedBody,
+        const std::vector< std::vector< std::string > >& deformingBodiesPerVariation,
+        const std::vector< std::vector< std::complex< double > > >& loveNumbers,
+        const double referenceRadius,
+        const double correctionUpdateInterval,
+        const double referenceEpoch = 0.0 )
+{
+    using namespace tudat::gravitation;
+
+    std::shared_ptr< TimeDependentSphericalHarmonicsGravityField > gravityField =
+            std::dynamic_pointer_cast< TimeDependentSphericalHarmonicsGravityField >(
+                bodyMap.at( deformedBody )->getGravityFieldModel( ) );
+    if( gravityField == nullptr )
+    {
+        throw std::runtime_error( "Error, gravity field of " + deformedBody + " is not time-dependent; cannot set "
+                                  "cadenced gravity field variations." );
+    }
+
+    std::vector< std::shared_ptr< CadencedSolidBodyTideGravityFieldVariations > > cadencedVariations;
+    std::vector< std::shared_ptr< GravityFieldVariations > > variationObjects;
+    std::vector< BodyDeformationTypes > variationTypes;
+    std::vector< std::string > variationIdentifiers;
+    for( unsigned int i = 0; i < deformingBodiesPerVariation.size( ); i++ )
+    {
+        std::vector< std::shared_ptr< tudat::simulation_setup::Body > > deformingBodies;
+        for( unsigned int j = 0; j < deformingBodiesPerVariation.at( i ).size( ); j++ )
+        {
+            deformingBodies.push_back( bodyMap.at( deformingBodiesPerVariation.at( i ).at( j ) ) );
+        }
+
+        std::shared_ptr< CadencedSolidBodyTideGravityFieldVariations > currentVariation =
+                std::make_shared< CadencedSolidBodyTideGravityFieldVariations >(
+                    bodyMap.at( deformedBody ), deformingBodies, deformingBodiesPerVariation.at( i ), loveNumbers,
+                    referenceRadius, correctionUpdateInterval, referenceEpoch );
+
+        cadencedVariations.push_back( currentVariation );
+        variationObjects.push_back( currentVariation );
+        variationTypes.push_back( basic_solid_body );
+        variationIdentifiers.push_back( currentVariation->getVariationIdentifier( ) );
+    }
+
+    gravityField->setFieldVariationSettings(
+                std::make_shared< GravityFieldVariationsSet >( variationObjects, variationTypes, variationIdentifiers ) );
+    return cadencedVariations;
+}
+
+//! Function to compute the history of the total corrections of a set of cadenced gravity field variations.
+/*!
+ *  Function to compute the history of the total corrections of a set of cadenced gravity field variations, at given
+ *  epochs, from the corrections retained during the propagation (each epoch must have been evaluated by all variations).
+ *  \param variations Gravity field variations of which the corrections are summed.
+ *  \param epochs Epochs at which the total corrections are retrieved.
+ *  \param maximumDegree Maximum degree of the returned corrections.
+ *  \param maximumOrder Maximum order of the returned corrections.
+ *  \return Total corrections (from degree and order 0 to the maximum degree and order), per epoch.
+ */
+inline std::map< double, SphericalHarmonicCorrections > getTotalCorrectionHistory(
+        const std::vector< std::shared_ptr< CadencedSolidBodyTideGravityFieldVariations > >& variations,
+        const std::vector< double >& epochs,
+        const int maximumDegree,
+        const int maximumOrder )
+{
+    std::map< double, SphericalHarmonicCorrections > totalCorrectionHistory;
+    for( unsigned int i = 0; i < epochs.size( ); i++ )
+    {
+        SphericalHarmonicCorrections totalCorrections = std::make_pair(
+                    Eigen::MatrixXd::Zero( maximumDegree + 1, maximumOrder + 1 ),
+                    Eigen::MatrixXd::Zero( maximumDegree + 1, maximumOrder + 1 ) );
+        for( unsigned int j = 0; j < variations.size( ); j++ )
+        {
+            const std::map< double, SphericalHarmonicCorrections >& correctionHistory =
+                    variations.at( j )->getCorrectionHistory( );
+            auto correctionIterator = correctionHistory.find( epochs.at( i ) );
+            if( correctionIterator == correctionHistory.end( ) )
+            {
+                throw std::runtime_error( "Error, gravity field corrections not retained at epoch " +
+                                          std::to_string( epochs.at( i ) ) + "." );
+            }
+
+            // Add the overlapping part of the corrections.
+            const int minimumDegree = variations.at( j )->getMinimumDegree( );
+            const int minimumOrder = variations.at( j )->getMinimumOrder( );
+            const int numberOfDegrees = std::min(
+                        static_cast< int >( correctionIterator->second.first.rows( ) ), maximumDegree - minimumDegree + 1 );
+            const int numberOfOrders = std::min(
+                        static_cast< int >( correctionIterator->second.first.cols( ) ), maximumOrder - minimumOrder + 1 );
+            if( numberOfDegrees > 0 && numberOfOrders > 0 )
+            {
+                totalCorrections.first.block( minimumDegree, minimumOrder, numberOfDegrees, numberOfOrders ) +=
+                        correctionIterator->second.first.block( 0, 0, numberOfDegrees, numberOfOrders );
+                totalCorrections.second.block( minimumDegree, minimumOrder, numberOfDegrees, numberOfOrders ) +=
+                        correctionIterator->second.second.block( 0, 0, numberOfDegrees, numberOfOrders );
+            }
+        }
+        totalCorrectionHistory[ epochs.at( i ) ] = totalCorrections;
+    }
+    return totalCorrectionHistory;
+}
+
+}
+
+#endif // TUDAT_GRAVITYFIELDCORRECTIONCACHE_H
@@ -0,0 +1,554 @@
+/*    Copyright (c) 2010-2018, Delft University of Technology
+ *    All rigths reserved
+ *
+ *    This file is part of the Tudat. Redistribution and use in source and
+ *    binary forms, with or without modification, are permitted exclusively
+ *    under the terms of the Modified BSD license. You should have received
+ *    a copy of the license with this file. If not, please or visit:
+ *    http://tudat.tudelft.nl/LICENSE.
+ */
+
+#ifndef TUDAT_HERMITEDENSEOUTPUT_H
+#define TUDAT_HERMITEDENSEOUTPUT_H
+
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include "propagationAndOptimization/flatStateHistory.h"
+#include "propagationAndOptimization/stateHistorySink.h"
+
+namespace tudat_applications
+{
+
+//! Function to interpolate Cartesian states using Hermite interpolation of the positions, with a condition count per node.
+/*!
+ *  Function to interpolate Cartesian states using Hermite interpolation of the positions, in which the interpolating
+ *  polynomial matches, at each node, the position (one condition), the position and velocity (two conditions), or the
+ *  position, velocity and acceleration (three conditions). The velocity is obtained from the derivative of the polynomial.
+ *  For a total of N conditions, the polynomial is of degree N - 1, as for a Lagrange interpolation on N nodes (i.e. of
+ *  order N, in the convention of LagrangeInterpolator), without any additional evaluations of the dynamics. The states may
+ *  contain the Cartesian states of several bodies, concatenated (as in the conventional output of a translational
+ *  propagation).
+ *  \param nodeEpochs Epochs of the nodes (distinct).
+ *  \param nodeStates States at the nodes, as a list of consecutive states (row-major block).
+ *  \param nodeStateDerivatives State derivatives at the nodes (velocities and accelerations), in the same layout as the
+ *  states (only used for nodes with three conditions, may be nullptr if there are none).
+ *  \param numberOfConditionsPerNode Number of conditions (1, 2 or 3) at each node.
+ *  \param numberOfNodes Number of nodes.
+ *  \param stateSize Size of each state (multiple of 6).
+ *  \param epoch Epoch at which the state is to be interpolated.
+ *  \param interpolatedState Interpolated state (returned by reference, resized if needed).
+ */
+template< typename StateScalarType, typename TimeType >
+void interpolateCartesianStateHermite( const TimeType* nodeEpochs,
+                                       const StateScalarType* nodeStates,
+                                       const StateScalarType* nodeStateDerivatives,
+                                       const unsigned int* numberOfConditionsPerNode,
+                                       const unsigned int numberOfNodes,
+                                       const unsigned int stateSize,
+                                       const TimeType epoch,
+                                       Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 >& interpolatedState )
+{
+    typedef Eigen::Array< StateScalarType, 3, Eigen::Dynamic > ComponentArray;
+    typedef Eigen::Map< const Eigen::Array< StateScalarType, 6, Eigen::Dynamic > > ConstStateArrayMap;
+
+    if( stateSize % 6 != 0 )
+    {
+        throw std::runtime_error( "Error, Hermite interpolation of Cartesian states requires a state size multiple of 6." );
+    }
+    const unsigned int numberOfBodies = stateSize / 6;
+
+    // Set repeated nodes (relative to first node, for conditioning), and the node and derivative order of each coefficient.
+    std::vector< StateScalarType > repeatedNodes;
+    std::vector< unsigned int > coefficientNodeIndices;
+    std::vector< ComponentArray > dividedDifferences;
+    for( unsigned int i = 0; i < numberOfNodes; i++ )
+    {
+        if( numberOfConditionsPerNode[ i ] < 1 || numberOfConditionsPerNode[ i ] > 3 ||
+                ( numberOfConditionsPerNode[ i ] == 3 && nodeStateDerivatives == nullptr ) )
+        {
+            throw std::runtime_error( "Error, Hermite interpolation requires one to three conditions per node, with state "
+                                      "derivatives for three conditions." );
+        }
+        for( unsigned int j = 0; j < numberOfConditionsPerNode[ i ]; j++ )
+        {
+            repeatedNodes.push_back( static_cast< StateScalarType >( nodeEpochs[ i ] - nodeEpochs[ 0 ] ) );
+            coefficientNodeIndices.push_back( i );
+            dividedDifferences.push_back(
+                        ConstStateArrayMap( nodeStates + i * stateSize, 6, numberOfBodies ).template topRows< 3 >( ) );
+        }
+    }
+    const unsigned int numberOfCoefficients = repeatedNodes.size( );
+
+    // Compute Newton divided differences in place (differences at repeated nodes are the velocity, or half the
+    // acceleration).
+    for( unsigned int j = 1; j < numberOfCoefficients; j++ )
+    {
+        for( unsigned int i = numberOfCoefficients - 1; i >= j; i-- )
+        {
+            const unsigned int nodeIndex = coefficientNodeIndices[ i ];
+            if( nodeIndex == coefficientNodeIndices[ i - j ] && j == 1 )
+            {
+                dividedDifferences[ i ] =
+                        ConstStateArrayMap( nodeStates + nodeIndex * stateSize, 6, numberOfBodies ).template bottomRows< 3 >( );
+            }
+            else if( nodeIndex == coefficientNodeIndices[ i - j ] )
+            {
+                dividedDifferences[ i ] = 0.5 * ConstStateArrayMap(
+                            nodeStateDerivatives + nodeIndex * stateSize, 6, numberOfBodies ).template bottomRows< 3 >( );
+            }
+            else
+            {
+                dividedDifferences[ i ] = ( dividedDifferences[ i ] - dividedDifferences[ i - 1 ] ) /
+                        ( repeatedNodes[ i ] - repeatedNodes[ i - j ] );
+            }
+        }
+    }
+
+    // Evaluate polynomial and its derivative using Horner's scheme.
+    const StateScalarType relativeEpoch = static_cast< StateScalarType >( epoch - nodeEpochs[ 0 ] );
+    ComponentArray position = dividedDifferences[ numberOfCoefficients - 1 ];
+    ComponentArray velocity = ComponentArray::Zero( 3, numberOfBodies );
+    for( int j = numberOfCoefficients - 2; j >= 0; j-- )
+    {
+        const StateScalarType nodeOffset = relativeEpoch - repeatedNodes[ j ];
+        velocity = velocity * nodeOffset + position;
+        position = position * nodeOffset + dividedDifferences[ j ];
+    }
+
+    interpolatedState.resize( stateSize );
+    Eigen::Map< Eigen::Array< StateScalarType, 6, Eigen::Dynamic > > outputState(
+                interpolatedState.data( ), 6, numberOfBodies );
+    outputState.template topRows< 3 >( ) = position;
+    outputState.template bottomRows< 3 >( ) = velocity;
+}
+
+//! Function to interpolate Cartesian states using Hermite interpolation of the positions, matching the velocities.
+/*!
+ *  Function to interpolate Cartesian states using Hermite interpolation of the positions, in which the interpolating
+ *  polynomial matches both the position and the velocity at each node (see the overload above). For n nodes, the polynomial
+ *  is of degree 2n - 1, so that four nodes give an interpolation of the same order as an eighth-order Lagrange
+ *  interpolation on eight nodes.
+ *  \param nodeEpochs Epochs of the nodes (distinct).
+ *  \param nodeStates States at the nodes, as a list of consecutive states (row-major block).
+ *  \param numberOfNodes Number of nodes.
+ *  \param stateSize Size of each state (multiple of 6).
+ *  \param epoch Epoch at which the state is to be interpolated.
+ *  \param interpolatedState Interpolated state (returned by reference, resized if needed).
+ */
+template< typename StateScalarType, typename TimeType >
+void interpolateCartesianStateHermite( const TimeType* nodeEpochs,
+                                       const StateScalarType* nodeStates,
+                                       const unsigned int numberOfNodes,
+                                       const unsigned int stateSize,
+                                       const TimeType epoch,
+                                       Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 >& interpolatedState )
+{
+    const std::vector< unsigned int > numberOfConditionsPerNode( numberOfNodes, 2 );
+    interpolateCartesianStateHermite< StateScalarType, TimeType >(
+                nodeEpochs, nodeStates, nullptr, numberOfConditionsPerNode.data( ), numberOfNodes, stateSize, epoch,
+                interpolatedState );
+}
+
+//! Interpolator of a Cartesian state history, using Hermite interpolation on a sliding set of nodes.
+/*!
+ *  Interpolator of a Cartesian state history, using Hermite interpolation (see interpolateCartesianStateHermite) on a
+ *  set of nodes centered on the interval containing the requested epoch. This class is a replacement for a
+ *  LagrangeInterpolator on the same history, with higher accuracy for the same number of nodes (as the velocities are
+ *  used), and without the reduced accuracy of the Lagrange interpolator near the ends of the history.
+ */
+template< typename StateScalarType = double, typename TimeType = double >
+class CartesianHermiteInterpolator
+{
+public:
+
+    //! Constructor
+    /*!
+     *  Constructor
+     *  \param stateHistory History of Cartesian states that is to be interpolated (at least two epochs).
+     *  \param numberOfNodes Number of nodes used for each interpolation.
+     */
+    template< int NumberOfRows >
+    CartesianHermiteInterpolator(
+            const std::map< TimeType, Eigen::Matrix< StateScalarType, NumberOfRows, 1 > >& stateHistory,
+            const unsigned int numberOfNodes = 4 ):
+        stateHistory_( stateHistory ), numberOfNodes_( std::min< unsigned int >( numberOfNodes, stateHistory.size( ) ) )
+    {
+        if( stateHistory_.size( ) < 2 || numberOfNodes_ < 2 )
+        {
+            throw std::runtime_error( "Error, Hermite interpolation requires at least two nodes." );
+        }
+    }
+
+    //! Function to interpolate the state at a given epoch (extrapolated from the first or last nodes if out of range).
+    Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 > interpolate( const TimeType epoch )
+    {
+        const std::vector< TimeType >& epochs = stateHistory_.getEpochs( );
+
+        // Find interval containing epoch, and first node of set centered on interval.
+        int intervalIndex = static_cast< int >(
+                    std::upper_bound( epochs.begin( ), epochs.end( ), epoch ) - epochs.begin( ) ) - 1;
+        int firstNode = intervalIndex - static_cast< int >( numberOfNodes_ - 1 ) / 2;
+        firstNode = std::max( 0, std::min( firstNode, static_cast< int >( epochs.size( ) - numberOfNodes_ ) ) );
+
+        Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 > interpolatedState;
+        interpolateCartesianStateHermite(
+                    epochs.data( ) + firstNode, stateHistory_.data( ) + firstNode * stateHistory_.getStateSize( ),
+                    numberOfNodes_, stateHistory_.getStateSize( ), epoch, interpolatedState );
+        return interpolatedState;
+    }
+
+private:
+
+    //! History of Cartesian states that is interpolated.
+    FlatStateHistory< StateScalarType, TimeType > stateHistory_;
+
+    //! Number of nodes used for each interpolation.
+    unsigned int numberOfNodes_;
+};
+
+//! Sink passing the state at a list of output epochs to a target sink, interpolating between integration steps.
+/*!
+ *  Sink passing the state at a list of output epochs to a target sink, interpolating between integration steps (dense
+ *  output). Each output state is computed by Hermite interpolation (see interpolateCartesianStateHermite) on the steps
+ *  around the output epoch, as soon as the required steps have been taken, so that output at arbitrary epochs is
+ *  produced during the propagation without storing the state history, and without additional evaluations of the dynamics.
+ *  The interpolation matches the position and velocity at each step, and also the acceleration where the integrator
+ *  provides the state derivative from its stage data (see StateHistorySink::processStateDerivative), so that fewer steps
+ *  are needed for the same interpolation order. The steps are added alternately before and after the interval containing
+ *  the output epoch until the number of conditions equals the interpolation order (the polynomial degree plus one, as the
+ *  number of nodes of a LagrangeInterpolator), so that the interpolation order does not depend on the integrator. The sink
+ *  can be used for any integrator and propagator (the states it receives are in conventional, Cartesian, form). Output
+ *  epochs outside the propagated interval are ignored. The propagation may be forward or backward in time.
+ */
+template< typename StateScalarType = double, typename TimeType = double >
+class DenseOutputStateHistorySink: public StateHistorySink< StateScalarType, TimeType >
+{
+public:
+
+    //! Constructor
+    /*!
+     *  Constructor
+     *  \param outputEpochs Epochs at which the state is to be passed to the target sink (in any order).
+     *  \param targetSink Sink to which the interpolated states are passed.
+     *  \param interpolationOrder Number of conditions (positions, velocities and accelerations at the steps) used for
+     *  each interpolation, equal to the degree of the interpolating polynomial plus one.
+     */
+    DenseOutputStateHistorySink( const std::vector< TimeType >& outputEpochs,
+                                 const std::shared_ptr< StateHistorySink< StateScalarType, TimeType > > targetSink,
+                                 const unsigned int interpolationOrder = 8 ):
+        outputEpochs_( outputEpochs ), targetSink_( targetSink ), interpolationOrder_( interpolationOrder ),
+        nextOutputIndex_( 0 ), isDirectionSet_( false ), isPropagationForward_( true ),
+        isStateDerivativeProvided_( false ), stateSize_( 0 )
+    {
+        if( interpolationOrder_ < 2 )
+        {
+            throw std::runtime_error( "Error, Hermite dense output requires an interpolation order of at least two." );
+        }
+        std::sort( outputEpochs_.begin( ), outputEpochs_.end( ) );
+    }
+
+    //! Function to process the state at a single integration step, passing all output states that can be computed.
+    void processState( const TimeType time, const Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 >& state )
+    {
+        if( nodeEpochs_.empty( ) )
+        {
+            stateSize_ = state.rows( );
+            firstEpoch_ = time;
+        }
+        else if( !isDirectionSet_ )
+        {
+            isPropagationForward_ = ( time > nodeEpochs_.back( ) );
+            if( !isPropagationForward_ )
+            {
+                std::reverse( outputEpochs_.begin( ), outputEpochs_.end( ) );
+            }
+            isDirectionSet_ = true;
+        }
+
+        nodeEpochs_.push_back( time );
+        nodeStates_.insert( nodeStates_.end( ), state.data( ), state.data( ) + stateSize_ );
+        nodeStateDerivatives_.insert( nodeStateDerivatives_.end( ), stateSize_, 0.0 );
+        isNodeStateDerivativeSet_.push_back( false );
+
+        // If state derivatives are provided, wait for the derivative at this step before using it.
+        if( !isStateDerivativeProvided_ )
+        {
+            processOutputEpochs( false );
+        }
+
+        // Retain only the steps that may be needed for subsequent output epochs.
+        while( nodeEpochs_.size( ) > 2 * interpolationOrder_ )
+        {
+            nodeEpochs_.pop_front( );
+            nodeStates_.erase( nodeStates_.begin( ), nodeStates_.begin( ) + stateSize_ );
+            nodeStateDerivatives_.erase( nodeStateDerivatives_.begin( ), nodeStateDerivatives_.begin( ) + stateSize_ );
+            isNodeStateDerivativeSet_.pop_front( );
+        }
+    }
+
+    //! Function to process the state derivative at the last step, passing all output states that can be computed.
+    void processStateDerivative( const TimeType time,
+                                 const Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 >& stateDerivative )
+    {
+        if( nodeEpochs_.empty( ) || nodeEpochs_.back( ) != time ||
+                stateDerivative.rows( ) != static_cast< int >( stateSize_ ) )
+        {
+            throw std::runtime_error( "Error, state derivative for dense output is not consistent with the last state." );
+        }
+
+        std::copy( stateDerivative.data( ), stateDerivative.data( ) + stateSize_,
+                   nodeStateDerivatives_.end( ) - stateSize_ );
+        isNodeStateDerivativeSet_.back( ) = true;
+        isStateDerivativeProvided_ = true;
+
+        processOutputEpochs( false );
+    }
+
+    //! Function called after the last step, passing the remaining output states (up to the final step).
+    void finalize( )
+    {
+        processOutputEpochs( true );
+        targetSink_->finalize( );
+    }
+
+    //! Function to check whether the sink (and its target sink) can be resumed from a propagation checkpoint.
+    bool isCheckpointSupported( ) const { return targetSink_->isCheckpointSupported( ); }
+
+    //! Function to write the retained steps and output progress (and the data of the target sink) to a checkpoint.
+    void writeCheckpointData( std::ostream& checkpointStream )
+    {
+        writeCheckpointValue( checkpointStream, nextOutputIndex_ );
+        writeCheckpointValue( checkpointStream, isDirectionSet_ );
+        writeCheckpointValue( checkpointStream, isPropagationForward_ );
+        writeCheckpointValue( checkpointStream, isStateDerivativeProvided_ );
+        writeCheckpointValue( checkpointStream, stateSize_ );
+        writeCheckpointValue( checkpointStream, static_cast< std::uint64_t >( nodeEpochs_.size( ) ) );
+        if( !nodeEpochs_.empty( ) )
+        {
+            writeCheckpointValue( checkpointStream, firstEpoch_ );
+        }
+        for( unsigned int i = 0; i < nodeEpochs_.size( ); i++ )
+        {
+            writeCheckpointValue( checkpointStream, nodeEpochs_.at( i ) );
+            writeCheckpointValue( checkpointStream, static_cast< bool >( isNodeStateDerivativeSet_.at( i ) ) );
+        }
+        checkpointStream.write( reinterpret_cast< const char* >( nodeStates_.data( ) ),
+                                nodeStates_.size( ) * sizeof( StateScalarType ) );
+        checkpointStream.write( reinterpret_cast< const char* >( nodeStateDerivatives_.data( ) ),
+                                nodeStateDerivatives_.size( ) * sizeof( StateScalarType ) );
+        targetSink_->writeCheckpointData( checkpointStream );
+    }
+
+    //! Function to resume the sink (and its target sink) from checkpoint data.
+    void readCheckpointData( std::istream& checkpointStream )
+    {
+        std::uint64_t numberOfNodes = 0;
+        readCheckpointValue( checkpointStream, nextOutputIndex_ );
+        readCheckpointValue( checkpointStream, isDirectionSet_ );
+        readCheckpointValue( checkpointStream, isPropagationForward_ );
+        readCheckpointValue( checkpointStream, isStateDerivativeProvided_ );
+        readCheckpointValue( checkpointStream, stateSize_ );
+        readCheckpointValue( checkpointStream, numberOfNodes );
+        if( numberOfNodes > 0 )
+        {
+            readCheckpointValue( checkpointStream, firstEpoch_ );
+        }
+        nodeEpochs_.resize( numberOfNodes );
+        isNodeStateDerivativeSet_.resize( numberOfNodes );
+        for( unsigned int i = 0; i < numberOfNodes; i++ )
+        {
+            bool isNodeStateDerivativeSet = false;
+            readCheckpointValue( checkpointStream, nodeEpochs_.at( i ) );
+            readCheckpointValue( checkpointStream, isNodeStateDerivativeSet );
+            isNodeStateDerivativeSet_.at( i ) = isNodeStateDerivativeSet;
+        }
+        nodeStates_.resize( numberOfNodes * stateSize_ );
+        nodeStateDerivatives_.resize( numberOfNodes * stateSize_ );
+        checkpointStream.read( reinterpret_cast< char* >( nodeStates_.data( ) ),
+                               nodeStates_.size( ) * sizeof( StateScalarType ) );
+        checkpointStream.read( reinterpret_cast< char* >( nodeStateDerivatives_.data( ) ),
+                               nodeStateDerivatives_.size( ) * sizeof( StateScalarType ) );
+
+        // Restore order of output epochs (sorted on construction) for backward propagation.
+        if( isDirectionSet_ && !isPropagationForward_ )
+        {
+            std::reverse( outputEpochs_.begin( ), outputEpochs_.end( ) );
+        }
+        targetSink_->readCheckpointData( checkpointStream );
+    }
+
+private:
+
+    //! Function to check whether epoch lies before another epoch, in the direction of propagation.
+    bool isBefore( const TimeType firstEpoch, const TimeType secondEpoch ) const
+    {
+        return isPropagationForward_ ? ( firstEpoch < secondEpoch ) : ( firstEpoch > secondEpoch );
+    }
+
+    //! Function to pass the states at all output epochs for which the required steps are available.
+    void processOutputEpochs( const bool isFinalStep )
+    {
+        const int numberOfStoredNodes = nodeEpochs_.size( );
+        if( numberOfStoredNodes < 2 )
+        {
+            return;
+        }
+
+        while( nextOutputIndex_ < outputEpochs_.size( ) )
+        {
+            const TimeType outputEpoch = outputEpochs_.at( nextOutputIndex_ );
+            if( isBefore( outputEpoch, firstEpoch_ ) )
+            {
+                nextOutputIndex_++;
+                continue;
+            }
+            else if( isBefore( nodeEpochs_.back( ), outputEpoch ) )
+            {
+                break;
+            }
+
+            // Find interval containing output epoch.
+            int intervalIndex = numberOfStoredNodes - 2;
+            while( intervalIndex > 0 && isBefore( outputEpoch, nodeEpochs_.at( intervalIndex ) ) )
+            {
+                intervalIndex--;
+            }
+
+            // Add steps alternately before and after the interval, until the interpolation order is reached (waiting for
+            // subsequent steps if needed).
+            std::deque< int > addedNodes = { intervalIndex + 1, intervalIndex };
+            int numberOfConditions = getNumberOfNodeConditions( intervalIndex ) +
+                    getNumberOfNodeConditions( intervalIndex + 1 );
+            bool isNodeAddedBefore = true;
+            bool isNodeSetComplete = true;
+            while( numberOfConditions < static_cast< int >( interpolationOrder_ ) )
+            {
+                const int firstNode = *std::min_element( addedNodes.begin( ), addedNodes.end( ) );
+                const int lastNode = *std::max_element( addedNodes.begin( ), addedNodes.end( ) );
+                int nodeToAdd = -1;
+                if( ( isNodeAddedBefore || ( lastNode + 1 == numberOfStoredNodes && isFinalStep ) ) && firstNode > 0 )
+                {
+                    nodeToAdd = firstNode - 1;
+                }
+                else if( lastNode + 1 < numberOfStoredNodes )
+                {
+                    nodeToAdd = lastNode + 1;
+                }
+                else if( !isFinalStep )
+                {
+                    isNodeSetComplete = false;
+                    break;
+                }
+                else
+                {
+                    break;
+                }
+                addedNodes.push_front( nodeToAdd );
+                numberOfConditions += getNumberOfNodeConditions( nodeToAdd );
+                isNodeAddedBefore = !isNodeAddedBefore;
+            }
+            if( !isNodeSetComplete )
+            {
+                break;
+            }
+
+            // Set number of conditions per node, removing the excess from the steps that were added last.
+            const int firstNode = *std::min_element( addedNodes.begin( ), addedNodes.end( ) );
+            const int numberOfUsedNodes = addedNodes.size( );
+            std::vector< unsigned int > numberOfConditionsPerNode( numberOfUsedNodes );
+            for( int i = 0; i < numberOfUsedNodes; i++ )
+            {
+                numberOfConditionsPerNode[ i ] = getNumberOfNodeConditions( firstNode + i );
+            }
+            for( unsigned int i = 0; i < addedNodes.size( ) &&
+                 numberOfConditions > static_cast< int >( interpolationOrder_ ); i++ )
+            {
+                unsigned int& nodeConditions = numberOfConditionsPerNode[ addedNodes.at( i ) - firstNode ];
+                const int numberOfRemovedConditions = std::min< int >(
+                            nodeConditions - 1, numberOfConditions - static_cast< int >( interpolationOrder_ ) );
+                nodeConditions -= numberOfRemovedConditions;
+                numberOfConditions -= numberOfRemovedConditions;
+            }
+
+            std::vector< TimeType > currentNodeEpochs(
+                        nodeEpochs_.begin( ) + firstNode, nodeEpochs_.begin( ) + firstNode + numberOfUsedNodes );
+            interpolateCartesianStateHermite(
+                        currentNodeEpochs.data( ), nodeStates_.data( ) + firstNode * stateSize_,
+                        nodeStateDerivatives_.data( ) + firstNode * stateSize_, numberOfConditionsPerNode.data( ),
+                        numberOfUsedNodes, stateSize_, outputEpoch, interpolatedState_ );
+            targetSink_->processState( outputEpoch, interpolatedState_ );
+            nextOutputIndex_++;
+        }
+    }
+
+    //! Function to get the number of conditions available at a stored step (three if the state derivative is known).
+    int getNumberOfNodeConditions( const int nodeIndex ) const
+    {
+        return isNodeStateDerivativeSet_.at( nodeIndex ) ? 3 : 2;
+    }
+
+    //! Epochs at which the state is to be passed to the target sink, in order of propagation.
+    std::vector< TimeType > outputEpochs_;
+
+    //! Sink to which the interpolated states are passed.
+    std::shared_ptr< StateHistorySink< StateScalarType, TimeType > > targetSink_;
+
+    //! Number of conditions used for each interpolation.
+    unsigned int interpolationOrder_;
+
+    //! Index of the next output epoch that is to be processed.
+    unsigned int nextOutputIndex_;
+
+    //! Boolean denoting whether the direction of propagation has been determined.
+    bool isDirectionSet_;
+
+    //! Boolean denoting whether the propagation is forward in time.
+    bool isPropagationForward_;
+
+    //! Boolean denoting whether state derivatives are provided (so that the last step is used once its derivative is set).
+    bool isStateDerivativeProvided_;
+
+    //! Size of the propagated state.
+    unsigned int stateSize_;
+
+    //! Epoch of the first step.
+    TimeType firstEpoch_;
+
+    //! Epochs of the most recent integration steps.
+    std::deque< TimeType > nodeEpochs_;
+
+    //! States at the most recent integration steps (consecutive, stateSize_ entries per step).
+    std::vector< StateScalarType > nodeStates_;
+
+    //! State derivatives at the most recent integration steps (same layout as nodeStates_, zero where not provided).
+    std::vector< StateScalarType > nodeStateDerivatives_;
+
+    //! Booleans denoting whether the state derivative at each of the most recent integration steps is provided.
+    std::deque< bool > isNodeStateDerivativeSet_;
+
+    //! Pre-allocated interpolated state.
+    Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 > interpolatedState_;
+};
+
+//! Function to pass a stored state history to a sink (e.g. to compute dense output from the result of a propagation).
+template< typename StateScalarType, typename TimeType, int NumberOfRows >
+void processStateHistory( const std::map< TimeType, Eigen::Matrix< StateScalarType, NumberOfRows, 1 > >& stateHistory,
+                          const std::shared_ptr< StateHistorySink< StateScalarType, TimeType > > sink )
+{
+    for( auto stateIterator = stateHistory.begin( ); stateIterator != stateHistory.end( ); stateIterator++ )
+    {
+        sink->processState( stateIterator->first, stateIterator->second );
+    }
+    sink->finalize( );
+}
+
+}
+
+#endif // TUDAT_HERMITEDENSEOUTPUT_H
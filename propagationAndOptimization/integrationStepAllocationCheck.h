@@ -0,0 +1,82 @@
+/*    Copyright (c) 2010-2018, Delft University of Technology
+ *    All rigths reserved
+ *
+ *    This file is part of the Tudat. Redistribution and use in source and
+ *    binary forms, with or without modification, are permitted exclusively
+ *    under the terms of the Modified BSD license. You should have received
+ *    a copy of the license with this file. If not, please or visit:
+ *    http://tudat.tudelft.nl/LICENSE.
+ */
+
+#ifndef TUDAT_INTEGRATIONSTEPALLOCATIONCHECK_H
+#define TUDAT_INTEGRATIONSTEPALLOCATIONCHECK_H
+
+#include <Eigen/Core>
+
+namespace tudat_applications
+{
+
+//! Scoped check that no heap memory is allocated by Eigen objects, e.g. within an integration step.
+/*!
+ *  Scoped check that no heap memory is allocated by Eigen objects, used to verify that the integrators reuse their
+ *  preallocated workspace in each step. If EIGEN_RUNTIME_NO_MALLOC is defined (see the CHECK_INTEGRATION_STEP_ALLOCATIONS
+ *  build option), any heap allocation by an Eigen object during the lifetime of an object of this class fails an
+ *  assertion (in debug builds). Allocations are allowed again within the scope of a nested object created with
+ *  isAllocationAllowed set to true (e.g. around the evaluation of the state derivative function, which is not part of the
+ *  integrator). If EIGEN_RUNTIME_NO_MALLOC is not defined, objects of this class have no effect.
+ *
+ *  The check is only applied by the integrators of this repository that use a preallocated workspace: the Runge-Kutta
+ *  integrators with a compile-time Butcher tableau (RK4, RKF4(5), RKF5(6), RKF7(8) and DOPRI8(7), see
+ *  ButcherTableauRungeKuttaIntegrator) and the Gauss-Jackson integrator. The Bulirsch-Stoer and Adams-Bashforth-Moulton
+ *  integrators are those of Tudat, which have no preallocated workspace and are not checked. In the sweeps, the check
+ *  applies to the cells propagated with propagateToStateHistorySinks using one of the former integrators.
+ *
+ *  Note that Eigen only provides a single, process-wide flag denoting whether allocations are allowed, so that the check
+ *  is only valid if a single thread uses Eigen: with concurrent threads, the scope of one thread changes the flag for the
+ *  others, which gives both false assertions and missed allocations. Therefore, the SweepExecutor runs all tasks serially
+ *  if EIGEN_RUNTIME_NO_MALLOC is defined.
+ */
+class ScopedEigenAllocationCheck
+{
+public:
+
+    //! Constructor, disallowing (or allowing) heap allocations by Eigen objects until destruction.
+    /*!
+     *  Constructor, disallowing (or allowing) heap allocations by Eigen objects until destruction.
+     *  \param isAllocationAllowed Boolean denoting whether allocations are allowed within the scope of this object.
+     */
+    explicit ScopedEigenAllocationCheck( const bool isAllocationAllowed = false )
+    {
+#ifdef EIGEN_RUNTIME_NO_MALLOC
+        wasAllocationAllowed_ = Eigen::internal::is_malloc_allowed( );
+        Eigen::internal::set_is_malloc_allowed( isAllocationAllowed );
+#else
+        static_cast< void >( isAllocationAllowed );
+#endif
+    }
+
+    //! Destructor, restoring whether heap allocations by Eigen objects are allowed to the state before construction.
+    ~ScopedEigenAllocationCheck( )
+    {
+#ifdef EIGEN_RUNTIME_NO_MALLOC
+        Eigen::internal::set_is_malloc_allowed( wasAllocationAllowed_ );
+#endif
+    }
+
+private:
+
+    //! Copy constructor (not allowed, since the check is tied to a scope).
+    ScopedEigenAllocationCheck( const ScopedEigenAllocationCheck& );
+
+    //! Assignment operator (not allowed, since the check is tied to a scope).
+    ScopedEigenAllocationCheck& operator=( const ScopedEigenAllocationCheck& );
+
+#ifdef EIGEN_RUNTIME_NO_MALLOC
+    //! Boolean denoting whether allocations were allowed before construction.
+    bool wasAllocationAllowed_;
+#endif
+};
+
+}
+
+#endif // TUDAT_INTEGRATIONSTEPALLOCATIONCHECK_H
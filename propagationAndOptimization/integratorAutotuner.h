@@ -0,0 +1,559 @@
+/*    Copyright (c) 2010-2018, Delft University of Technology
+ *    All rigths reserved
+ *
+ *    This file is part of the Tudat. Redistribution and use in source and
+ *    binary forms, with or without modification, are permitted exclusively
+ *    under the terms of the Modified BSD license. You should have received
+ *    a copy of the license with this file. If not, please or visit:
+ *    http://tudat.tudelft.nl/LICENSE.
+ */
+
+#ifndef TUDAT_INTEGRATORAUTOTUNER_H
+#define TUDAT_INTEGRATORAUTOTUNER_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <Tudat/SimulationSetup/tudatSimulationHeader.h>
+
+#include "propagationAndOptimization/hermiteDenseOutput.h"
+#include "propagationAndOptimization/stateHistorySink.h"
+#include "propagationAndOptimization/sweepExecutor.h"
+#include "propagationAndOptimization/sweepJournal.h"
+
+namespace tudat_applications
+{
+
+//! Get position accuracy for which the integrator settings of an application are to be tuned.
+/*!
+ *  Get position accuracy (in meters) for which the integrator settings of an application are to be tuned (see
+ *  IntegratorAutotuner). The value is read from the environment variable TUDAT_APPLICATION_AUTOTUNE_ACCURACY; if it is not
+ *  set, zero is returned, and the application is run without autotuning.
+ *  \return Required position accuracy (zero if no autotuning is to be performed).
+ */
+inline double getAutotuningAccuracySetting( )
+{
+    const char* accuracySetting = std::getenv( "TUDAT_APPLICATION_AUTOTUNE_ACCURACY" );
+    if( accuracySetting != NULL && std::string( accuracySetting ) != "" )
+    {
+        return std::atof( accuracySetting );
+    }
+    return 0.0;
+}
+
+//! Integrator considered by the IntegratorAutotuner, with a single parameter setting its tolerance or step size.
+template< typename TimeType = double >
+struct IntegratorTuningCandidate
+{
+    //! Typedef for function creating the integrator settings from the tuning parameter and the initial time.
+    typedef std::function< std::shared_ptr< tudat::numerical_integrators::IntegratorSettings< TimeType > >(
+            const double, const TimeType ) > IntegratorSettingsFunction;
+
+    //! Constructor
+    /*!
+     *  Constructor
+     *  \param name Name of the integrator (used in output only).
+     *  \param createIntegratorSettings Function creating the integrator settings from the tuning parameter and the initial
+     *  time. The parameter must be proportional to the logarithm of the tolerance or step size (e.g. its exponent), with
+     *  larger values for larger tolerances/step sizes, since the autotuner interpolates the parameter linearly between
+     *  probed values.
+     *  \param probingParameterValues Values of the tuning parameter with which the integrator is probed.
+     *  \param supportedPropagatorTypes Propagators with which the integrator can be used (all propagators if empty).
+     */
+    IntegratorTuningCandidate( const std::string& name,
+                               const IntegratorSettingsFunction createIntegratorSettings,
+                               const std::vector< double >& probingParameterValues,
+                               const std::vector< tudat::propagators::TranslationalPropagatorType >&
+                               supportedPropagatorTypes = std::vector< tudat::propagators::TranslationalPropagatorType >( ) ):
+        name_( name ), createIntegratorSettings_( createIntegratorSettings ),
+        probingParameterValues_( probingParameterValues ), supportedPropagatorTypes_( supportedPropagatorTypes )
+    {
+        std::sort( probingParameterValues_.begin( ), probingParameterValues_.end( ) );
+    }
+
+    //! Name of the integrator (used in output only).
+    std::string name_;
+
+    //! Function creating the integrator settings from the tuning parameter and the initial time.
+    IntegratorSettingsFunction createIntegratorSettings_;
+
+    //! Values of the tuning parameter with which the integrator is probed (in ascending order).
+    std::vector< double > probingParameterValues_;
+
+    //! Propagators with which the integrator can be used (all propagators if empty).
+    std::vector< tudat::propagators::TranslationalPropagatorType > supportedPropagatorTypes_;
+
+    //! Function to check whether the integrator can be used with a given propagator.
+    bool isPropagatorTypeSupported( const tudat::propagators::TranslationalPropagatorType propagatorType ) const
+    {
+        return ( supportedPropagatorTypes_.size( ) == 0 ||
+                 std::find( supportedPropagatorTypes_.begin( ), supportedPropagatorTypes_.end( ), propagatorType ) !=
+                 supportedPropagatorTypes_.end( ) );
+    }
+};
+
+//! Result of a single probing propagation of the IntegratorAutotuner.
+struct IntegratorProbingResult
+{
+    //! Index of the integrator candidate.
+    unsigned int candidateIndex_;
+
+    //! Translational propagator that was used.
+    tudat::propagators::TranslationalPropagatorType propagatorType_;
+
+    //! Value of the tuning parameter that was used.
+    double parameterValue_;
+
+    //! Number of function evaluations of the propagation.
+    double numberOfFunctionEvaluations_;
+
+    //! Maximum position error w.r.t. the benchmark (infinity if the propagation failed).
+    double maximumPositionError_;
+
+    //! Boolean denoting whether the result is on the Pareto front (no other result has both fewer evaluations and a
+    //! smaller error).
+    bool isParetoOptimal_;
+};
+
+//! Integrator and propagator selected by the IntegratorAutotuner for a given orbit class and accuracy.
+struct IntegratorTuningResult
+{
+    //! Index of the selected integrator candidate.
+    unsigned int candidateIndex_;
+
+    //! Selected translational propagator.
+    tudat::propagators::TranslationalPropagatorType propagatorType_;
+
+    //! Selected value of the tuning parameter.
+    double parameterValue_;
+
+    //! Number of function evaluations over the probing arc predicted for the selected settings.
+    double predictedNumberOfFunctionEvaluations_;
+
+    //! Maximum position error over the probing arc predicted for the selected settings.
+    double predictedPositionError_;
+};
+
+//! Class to select the integrator settings and propagator that meet a position accuracy at the lowest cost.
+/*!
+ *  Class to select the integrator settings and propagator that meet a required position accuracy with the lowest number of
+ *  function evaluations, for a given orbit class, as an automated version of the integrator/propagator sweeps (e.g.
+ *  lunarOrbiterPropagatorIntegratorSettings) that are otherwise analyzed by hand. A tuning run consists of a short probing
+ *  campaign over a representative arc:
+ *
+ *  - A benchmark is propagated with tightened settings, and compared to a second benchmark with looser settings; the
+ *    campaign is aborted if the difference does not leave sufficient margin w.r.t. the required accuracy.
+ *  - Each integrator candidate is propagated with each of its probing parameter values, for each propagator that it
+ *    supports (see IntegratorTuningCandidate), and the maximum position error w.r.t. the (interpolated) benchmark and the
+ *    number of function evaluations are recorded.
+ *    These propagations are run in parallel by a SweepExecutor. A propagation that fails (e.g. as the minimum step size
+ *    is reached) is recorded with an infinite error.
+ *  - For each integrator and propagator, the error-versus-cost curve is fitted by piecewise-linear interpolation of the
+ *    logarithms of the error and of the number of evaluations, as a function of the tuning parameter. The parameter value
+ *    at which the error equals the required accuracy (divided by a safety factor) is found between the loosest probed value
+ *    that meets it and the next, looser, value (if any), and the cost at that value is predicted from the fit. Probed
+ *    values beyond the first looser value that exceeds the required accuracy are not used, and the fit is not
+ *    extrapolated below the strictest values, where the error levels off due to rounding (or due to the benchmark).
+ *  - The integrator, propagator and parameter value with the lowest predicted cost are selected.
+ *
+ *  The selection is cached per orbit class and required accuracy in a journal file (see SweepJournal), so that production
+ *  runs retrieve it without repeating the campaign. The orbit class key must identify the dynamical model, the orbit and
+ *  the list of candidates (a cached selection with a candidate index beyond the current list is discarded).
+ *
+ *  The accuracy applies to the probing arc; the safety factor must account for the growth of the error over a longer
+ *  production arc, as well as for the interpolation of the fit.
+ */
+template< typename StateScalarType = double, typename TimeType = double >
+class IntegratorAutotuner
+{
+public:
+
+    //! Typedef for the function propagating the probing arc (or benchmark) with given settings.
+    /*!
+     *  Typedef for the function propagating the probing arc (or benchmark) with given integrator settings and propagator,
+     *  passing the Cartesian state at each step to a list of sinks, and returning the number of function evaluations (e.g.
+     *  using propagateToStateHistorySinks). The last argument is the index of the worker thread on which the function is
+     *  called (see SweepExecutor), which is used to select the environment of the worker.
+     */
+    typedef std::function< unsigned int(
+            const std::shared_ptr< tudat::numerical_integrators::IntegratorSettings< TimeType > >,
+            const tudat::propagators::TranslationalPropagatorType,
+            const std::vector< std::shared_ptr< StateHistorySink< StateScalarType, TimeType > > >&,
+            const unsigned int ) > ProbingFunction;
+
+    //! Constructor
+    /*!
+     *  Constructor
+     *  \param integratorCandidates List of integrators that are considered.
+     *  \param propagatorTypes List of propagators that are considered.
+     *  \param cacheFileName Name of the file in which the selections are cached.
+     *  \param cacheDirectory Directory in which the cache file is stored.
+     *  \param safetyFactor Factor by which the required accuracy is divided before selecting settings.
+     */
+    IntegratorAutotuner( const std::vector< IntegratorTuningCandidate< TimeType > >& integratorCandidates,
+                         const std::vector< tudat::propagators::TranslationalPropagatorType >& propagatorTypes,
+                         const std::string& cacheFileName,
+                         const std::string& cacheDirectory,
+                         const double safetyFactor = 10.0 ):
+        integratorCandidates_( integratorCandidates ), propagatorTypes_( propagatorTypes ),
+        tuningCache_( cacheFileName, cacheDirectory, true ), safetyFactor_( safetyFactor ), benchmarkError_( TUDAT_NAN )
+    {
+        if( integratorCandidates_.size( ) == 0 || propagatorTypes_.size( ) == 0 )
+        {
+            throw std::runtime_error( "Error, integrator autotuner requires at least one integrator and propagator." );
+        }
+    }
+
+    //! Function to retrieve the cached selection for an orbit class and accuracy, tuning the settings if it is not cached.
+    /*!
+     *  Function to retrieve the cached selection for an orbit class and accuracy, running the probing campaign (see class
+     *  description) and caching its selection if it is not cached.
+     *  \param orbitClassKey Key identifying the orbit class, dynamical model and candidates (may not contain whitespace).
+     *  \param requiredPositionAccuracy Required maximum position error over the probing arc.
+     *  \param probingFunction Function propagating the probing arc.
+     *  \param benchmarkIntegratorSettings Integrator settings of the benchmark (propagated with the Cowell propagator).
+     *  \param benchmarkCheckIntegratorSettings Looser integrator settings used to estimate the error of the benchmark.
+     *  \param sweepExecutor Executor running the probing propagations.
+     *  \return Selected integrator, propagator and tuning parameter.
+     */
+    IntegratorTuningResult getTunedSettings(
+            const std::string& orbitClassKey,
+            const double requiredPositionAccuracy,
+            const ProbingFunction& probingFunction,
+            const std::shared_ptr< tudat::numerical_integrators::IntegratorSettings< TimeType > >
+            benchmarkIntegratorSettings,
+            const std::shared_ptr< tudat::numerical_integrators::IntegratorSettings< TimeType > >
+            benchmarkCheckIntegratorSettings,
+            SweepExecutor& sweepExecutor )
+    {
+        probingResults_.clear( );
+        benchmarkError_ = TUDAT_NAN;
+
+        IntegratorTuningResult tuningResult;
+        const std::string cacheKey = getCacheKey( orbitClassKey, requiredPositionAccuracy );
+        if( getCachedSettings( cacheKey, tuningResult ) )
+        {
+            return tuningResult;
+        }
+
+        runProbingCampaign( probingFunction, benchmarkIntegratorSettings, benchmarkCheckIntegratorSettings,
+                            requiredPositionAccuracy, sweepExecutor );
+        tuningResult = selectSettings( requiredPositionAccuracy );
+
+        std::vector< double > cachedValues;
+        cachedValues.push_back( tuningResult.candidateIndex_ );
+        cachedValues.push_back( static_cast< double >( tuningResult.propagatorType_ ) );
+        cachedValues.push_back( tuningResult.parameterValue_ );
+        cachedValues.push_back( tuningResult.predictedNumberOfFunctionEvaluations_ );
+        cachedValues.push_back( tuningResult.predictedPositionError_ );
+        tuningCache_.markCompleted( cacheKey, cachedValues );
+
+        return tuningResult;
+    }
+
+    //! Function to create the integrator settings of a selection.
+    /*!
+     *  Function to create the integrator settings of a selection.
+     *  \param tuningResult Selection returned by getTunedSettings.
+     *  \param initialTime Initial time of the propagation.
+     *  \return Integrator settings.
+     */
+    std::shared_ptr< tudat::numerical_integrators::IntegratorSettings< TimeType > > createIntegratorSettings(
+            const IntegratorTuningResult& tuningResult, const TimeType initialTime ) const
+    {
+        return integratorCandidates_.at( tuningResult.candidateIndex_ ).createIntegratorSettings_(
+                    tuningResult.parameterValue_, initialTime );
+    }
+
+    //! Function to retrieve the name of the integrator of a selection.
+    std::string getIntegratorName( const IntegratorTuningResult& tuningResult ) const
+    {
+        return integratorCandidates_.at( tuningResult.candidateIndex_ ).name_;
+    }
+
+    //! Function to retrieve the results of the last probing campaign (empty if the last selection was cached).
+    const std::vector< IntegratorProbingResult >& getProbingResults( ) const
+    {
+        return probingResults_;
+    }
+
+    //! Function to retrieve the estimated error of the benchmark in the last probing campaign (NaN if it was cached).
+    double getBenchmarkError( ) const
+    {
+        return benchmarkError_;
+    }
+
+private:
+
+    //! Function to create the cache key for an orbit class and accuracy.
+    static std::string getCacheKey( const std::string& orbitClassKey, const double requiredPositionAccuracy )
+    {
+        std::ostringstream keyStream;
+        keyStream<<orbitClassKey<<"_posAcc"<<std::setprecision( 6 )<<requiredPositionAccuracy;
+        return keyStream.str( );
+    }
+
+    //! Function to retrieve a cached selection (returns false if there is no valid cached selection).
+    bool getCachedSettings( const std::string& cacheKey, IntegratorTuningResult& tuningResult )
+    {
+        if( !tuningCache_.isCompleted( cacheKey ) )
+        {
+            return false;
+        }
+
+        const std::vector< double > cachedValues = tuningCache_.getCompletedCaseValues( cacheKey );
+        if( cachedValues.size( ) != 5 || cachedValues.at( 0 ) < 0.0 ||
+                cachedValues.at( 0 ) >= static_cast< double >( integratorCandidates_.size( ) ) )
+        {
+            return false;
+        }
+
+        tuningResult.candidateIndex_ = static_cast< unsigned int >( cachedValues.at( 0 ) );
+        tuningResult.propagatorType_ =
+                static_cast< tudat::propagators::TranslationalPropagatorType >( static_cast< int >( cachedValues.at( 1 ) ) );
+        tuningResult.parameterValue_ = cachedValues.at( 2 );
+        tuningResult.predictedNumberOfFunctionEvaluations_ = cachedValues.at( 3 );
+        tuningResult.predictedPositionError_ = cachedValues.at( 4 );
+        return true;
+    }
+
+    //! Function to run the benchmark and all probing propagations.
+    void runProbingCampaign(
+            const ProbingFunction& probingFunction,
+            const std::shared_ptr< tudat::numerical_integrators::IntegratorSettings< TimeType > >
+            benchmarkIntegratorSettings,
+            const std::shared_ptr< tudat::numerical_integrators::IntegratorSettings< TimeType > >
+            benchmarkCheckIntegratorSettings,
+            const double requiredPositionAccuracy,
+            SweepExecutor& sweepExecutor )
+    {
+        typedef std::vector< std::shared_ptr< StateHistorySink< StateScalarType, TimeType > > > SinkList;
+
+        // Propagate benchmark, and estimate its error from the difference w.r.t. a propagation with looser settings.
+        std::shared_ptr< StoredStateHistorySink< StateScalarType, TimeType > > benchmarkSink =
+                std::make_shared< StoredStateHistorySink< StateScalarType, TimeType > >( );
+        probingFunction( benchmarkIntegratorSettings, tudat::propagators::cowell, SinkList( 1, benchmarkSink ), 0 );
+        CartesianHermiteInterpolator< StateScalarType, TimeType > benchmarkInterpolator(
+                    benchmarkSink->getStateHistory( ) );
+
+        benchmarkError_ = 0.0;
+        SinkList benchmarkCheckSinks( 1, createErrorSink( benchmarkInterpolator, benchmarkError_ ) );
+        probingFunction( benchmarkCheckIntegratorSettings, tudat::propagators::cowell, benchmarkCheckSinks, 0 );
+        if( !( benchmarkError_ < requiredPositionAccuracy / safetyFactor_ ) )
+        {
+            std::ostringstream errorStream;
+            errorStream<<"Error, benchmark error estimate "<<benchmarkError_<<
+                         " is too large for the required accuracy "<<requiredPositionAccuracy;
+            throw std::runtime_error( errorStream.str( ) );
+        }
+
+        // Create list of probing propagations (for the propagators supported by each integrator).
+        for( unsigned int i = 0; i < integratorCandidates_.size( ); i++ )
+        {
+            for( unsigned int l = 0; l < propagatorTypes_.size( ); l++ )
+            {
+                if( !integratorCandidates_.at( i ).isPropagatorTypeSupported( propagatorTypes_.at( l ) ) )
+                {
+                    continue;
+                }
+
+                for( unsigned int j = 0; j < integratorCandidates_.at( i ).probingParameterValues_.size( ); j++ )
+                {
+                    IntegratorProbingResult probingResult;
+                    probingResult.candidateIndex_ = i;
+                    probingResult.propagatorType_ = propagatorTypes_.at( l );
+                    probingResult.parameterValue_ = integratorCandidates_.at( i ).probingParameterValues_.at( j );
+                    probingResult.numberOfFunctionEvaluations_ = 0.0;
+                    probingResult.maximumPositionError_ = std::numeric_limits< double >::infinity( );
+                    probingResult.isParetoOptimal_ = false;
+                    probingResults_.push_back( probingResult );
+                }
+            }
+        }
+
+        // Run probing propagations (each task only writes to its own result).
+        std::vector< SweepExecutor::SweepTask > probingTasks;
+        for( unsigned int i = 0; i < probingResults_.size( ); i++ )
+        {
+            probingTasks.push_back( [ &, i ]( const unsigned int workerIndex )
+            {
+                IntegratorProbingResult& probingResult = probingResults_.at( i );
+                double maximumPositionError = 0.0;
+                try
+                {
+                    probingResult.numberOfFunctionEvaluations_ = probingFunction(
+                                integratorCandidates_.at( probingResult.candidateIndex_ ).createIntegratorSettings_(
+                                    probingResult.parameterValue_, benchmarkIntegratorSettings->initialTime_ ),
+                                probingResult.propagatorType_,
+                                SinkList( 1, createErrorSink( benchmarkInterpolator, maximumPositionError ) ),
+                                workerIndex );
+                    probingResult.maximumPositionError_ = maximumPositionError;
+                }
+                catch( const std::exception& caughtException )
+                {
+                    std::lock_guard< std::mutex > lock( getConsoleOutputMutex( ) );
+                    std::cerr<<"Probing propagation with "<<
+                               integratorCandidates_.at( probingResult.candidateIndex_ ).name_<<", parameter "<<
+                               probingResult.parameterValue_<<" failed: "<<caughtException.what( )<<std::endl;
+                }
+            } );
+        }
+        sweepExecutor.executeTasks( probingTasks );
+
+        // Determine Pareto front of all probing results.
+        for( unsigned int i = 0; i < probingResults_.size( ); i++ )
+        {
+            IntegratorProbingResult& probingResult = probingResults_.at( i );
+            probingResult.isParetoOptimal_ = std::isfinite( probingResult.maximumPositionError_ );
+            for( unsigned int j = 0; j < probingResults_.size( ) && probingResult.isParetoOptimal_; j++ )
+            {
+                const IntegratorProbingResult& otherResult = probingResults_.at( j );
+                if( otherResult.numberOfFunctionEvaluations_ <= probingResult.numberOfFunctionEvaluations_ &&
+                        otherResult.maximumPositionError_ <= probingResult.maximumPositionError_ &&
+                        ( otherResult.numberOfFunctionEvaluations_ < probingResult.numberOfFunctionEvaluations_ ||
+                          otherResult.maximumPositionError_ < probingResult.maximumPositionError_ ) )
+                {
+                    probingResult.isParetoOptimal_ = false;
+                }
+            }
+        }
+    }
+
+    //! Function to create a sink computing the maximum position error w.r.t. the benchmark.
+    std::shared_ptr< StateHistorySink< StateScalarType, TimeType > > createErrorSink(
+            CartesianHermiteInterpolator< StateScalarType, TimeType >& benchmarkInterpolator,
+            double& maximumPositionError )
+    {
+        return std::make_shared< FunctionStateHistorySink< StateScalarType, TimeType > >(
+                    [ &benchmarkInterpolator, &maximumPositionError ](
+                    const TimeType time, const Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 >& state )
+        {
+            const double positionError = static_cast< double >(
+                        ( state.segment( 0, 3 ) - benchmarkInterpolator.interpolate( time ).segment( 0, 3 ) ).norm( ) );
+            if( !( positionError <= maximumPositionError ) )
+            {
+                maximumPositionError = positionError;
+            }
+        } );
+    }
+
+    //! Function to select the settings with the lowest predicted cost from the probing results.
+    IntegratorTuningResult selectSettings( const double requiredPositionAccuracy )
+    {
+        const double targetError = requiredPositionAccuracy / safetyFactor_;
+
+        IntegratorTuningResult bestResult;
+        bestResult.predictedNumberOfFunctionEvaluations_ = std::numeric_limits< double >::infinity( );
+
+        // Probing results of each (candidate, propagator) are contiguous, in ascending order of the parameter.
+        unsigned int curveStart = 0;
+        while( curveStart < probingResults_.size( ) )
+        {
+            unsigned int curveEnd = curveStart + 1;
+            while( curveEnd < probingResults_.size( ) &&
+                   probingResults_.at( curveEnd ).candidateIndex_ == probingResults_.at( curveStart ).candidateIndex_ &&
+                   probingResults_.at( curveEnd ).propagatorType_ == probingResults_.at( curveStart ).propagatorType_ )
+            {
+                curveEnd++;
+            }
+
+            // Find loosest probed value meeting the target, within the range where the error increases with the parameter.
+            int selectedIndex = -1;
+            for( unsigned int i = curveStart; i < curveEnd; i++ )
+            {
+                const double error = probingResults_.at( i ).maximumPositionError_;
+                if( error <= targetError )
+                {
+                    selectedIndex = i;
+                }
+                else if( selectedIndex >= 0 )
+                {
+                    break;
+                }
+            }
+
+            if( selectedIndex >= 0 )
+            {
+                const IntegratorProbingResult& lowerResult = probingResults_.at( selectedIndex );
+                IntegratorTuningResult curveResult;
+                curveResult.candidateIndex_ = lowerResult.candidateIndex_;
+                curveResult.propagatorType_ = lowerResult.propagatorType_;
+                curveResult.parameterValue_ = lowerResult.parameterValue_;
+                curveResult.predictedNumberOfFunctionEvaluations_ = lowerResult.numberOfFunctionEvaluations_;
+                curveResult.predictedPositionError_ = lowerResult.maximumPositionError_;
+
+                // Interpolate (in logarithms of error and cost) towards the next, looser, probed value.
+                if( static_cast< unsigned int >( selectedIndex + 1 ) < curveEnd )
+                {
+                    const IntegratorProbingResult& upperResult = probingResults_.at( selectedIndex + 1 );
+                    if( std::isfinite( upperResult.maximumPositionError_ ) &&
+                            lowerResult.maximumPositionError_ > 0.0 &&
+                            lowerResult.numberOfFunctionEvaluations_ > 0.0 &&
+                            upperResult.numberOfFunctionEvaluations_ > 0.0 &&
+                            upperResult.maximumPositionError_ > lowerResult.maximumPositionError_ )
+                    {
+                        const double fraction =
+                                std::log( targetError / lowerResult.maximumPositionError_ ) /
+                                std::log( upperResult.maximumPositionError_ / lowerResult.maximumPositionError_ );
+                        curveResult.parameterValue_ = lowerResult.parameterValue_ +
+                                fraction * ( upperResult.parameterValue_ - lowerResult.parameterValue_ );
+                        curveResult.predictedNumberOfFunctionEvaluations_ =
+                                lowerResult.numberOfFunctionEvaluations_ * std::pow(
+                                    upperResult.numberOfFunctionEvaluations_ / lowerResult.numberOfFunctionEvaluations_,
+                                    fraction );
+                        curveResult.predictedPositionError_ = targetError;
+                    }
+                }
+
+                if( curveResult.predictedNumberOfFunctionEvaluations_ <
+                        bestResult.predictedNumberOfFunctionEvaluations_ )
+                {
+                    bestResult = curveResult;
+                }
+            }
+
+            curveStart = curveEnd;
+        }
+
+        if( !std::isfinite( bestResult.predictedNumberOfFunctionEvaluations_ ) )
+        {
+            std::ostringstream errorStream;
+            errorStream<<"Error, no probed integrator settings meet the required accuracy "<<requiredPositionAccuracy;
+            throw std::runtime_error( errorStream.str( ) );
+        }
+        return bestResult;
+    }
+
+    //! List of integrators that are considered.
+    std::vector< IntegratorTuningCandidate< TimeType > > integratorCandidates_;
+
+    //! List of propagators that are considered.
+    std::vector< tudat::propagators::TranslationalPropagatorType > propagatorTypes_;
+
+    //! Cache of selections, per orbit class and accuracy.
+    SweepJournal tuningCache_;
+
+    //! Factor by which the required accuracy is divided before selecting settings.
+    double safetyFactor_;
+
+    //! Results of the last probing campaign.
+    std::vector< IntegratorProbingResult > probingResults_;
+
+    //! Estimated error of the benchmark in the last probing campaign.
+    double benchmarkError_;
+};
+
+}
+
+#endif // TUDAT_INTEGRATORAUTOTUNER_H
@@ -0,0 +1,219 @@
+/*    Copyright (c) 2010-2018, Delft University of Technology
+ *    All rigths reserved
+ *
+ *    This file is part of the Tudat. Redistribution and use in source and
+ *    binary forms, with or without modification, are permitted exclusively
+ *    under the terms of the Modified BSD license. You should have received
+ *    a copy of the license with this file. If not, please or visit:
+ *    http://tudat.tudelft.nl/LICENSE.
+ */
+
+#ifndef TUDAT_LINEARIZEDCOVARIANCEPROPAGATION_H
+#define TUDAT_LINEARIZEDCOVARIANCEPROPAGATION_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <map>
+#include <stdexcept>
+#include <string>
+
+#include <Eigen/Core>
+#include <Eigen/Eigenvalues>
+
+#include "propagationAndOptimization/flatStateHistory.h"
+
+namespace tudat_applications
+{
+
+//! Get threshold on the linearized position spread above which a Monte Carlo linearity check is to be performed.
+/*!
+ *  Get threshold on the linearized position spread (see computeMaximumPositionStandardDeviation) above which the
+ *  linearized covariance is to be checked by sampling (i.e. by propagating a cloud of perturbed orbits). The value (in
+ *  meters) is read from the environment variable TUDAT_APPLICATION_LINEARITY_THRESHOLD if it is set (a value of 0 always
+ *  performs the check), and is equal to the provided default otherwise.
+ *  \param defaultThreshold Threshold to be used if the environment variable is not set.
+ *  \return Threshold on the linearized position spread.
+ */
+inline double getLinearityCheckThreshold( const double defaultThreshold )
+{
+    const char* thresholdSetting = std::getenv( "TUDAT_APPLICATION_LINEARITY_THRESHOLD" );
+    if( thresholdSetting != NULL && std::string( thresholdSetting ) != "" )
+    {
+        return std::atof( thresholdSetting );
+    }
+    return defaultThreshold;
+}
+
+//! Function to create a block-diagonal covariance of the initial state and (consider) parameters.
+/*!
+ *  Function to create a block-diagonal covariance of the initial state and (consider) parameters, for the case where the
+ *  uncertainties in the initial state and in the parameters are uncorrelated.
+ *  \param initialStateCovariance Covariance of the initial state.
+ *  \param parameterCovariance Covariance of the parameters (in the order of the columns of the sensitivity matrix).
+ *  \return Combined covariance, with the initial state first.
+ */
+inline Eigen::MatrixXd createBlockDiagonalCovariance( const Eigen::MatrixXd& initialStateCovariance,
+                                                      const Eigen::MatrixXd& parameterCovariance )
+{
+    const int stateSize = initialStateCovariance.rows( );
+    const int parameterSize = parameterCovariance.rows( );
+
+    Eigen::MatrixXd combinedCovariance = Eigen::MatrixXd::Zero( stateSize + parameterSize, stateSize + parameterSize );
+    combinedCovariance.block( 0, 0, stateSize, stateSize ) = initialStateCovariance;
+    combinedCovariance.block( stateSize, stateSize, parameterSize, parameterSize ) = parameterCovariance;
+    return combinedCovariance;
+}
+
+//! Function to propagate a covariance matrix, with the state size and combined state and parameter size as template arguments.
+/*!
+ *  Function to propagate a covariance matrix (see propagateCovariance), with the state size and combined state and
+ *  parameter size as template arguments (each either a compile-time size or Eigen::Dynamic), so that the state transition
+ *  and covariance blocks are fixed-size matrices for a Cartesian state. All matrices are allocated once, before the loop
+ *  over the epochs.
+ *  \param initialCovariance Covariance of the initial state and parameters.
+ *  \param stateTransitionHistory History of the state transition matrix.
+ *  \param sensitivityHistory History of the sensitivity matrix (may be empty).
+ *  \param covarianceHistory History of the propagated covariance, to which the covariance at each epoch is added.
+ */
+template< int StateSize, int CombinedSize >
+void propagateCovarianceWithFixedSizes(
+        const Eigen::MatrixXd& initialCovariance,
+        const std::map< double, Eigen::MatrixXd >& stateTransitionHistory,
+        const std::map< double, Eigen::MatrixXd >& sensitivityHistory,
+        FlatStateHistory< >& covarianceHistory )
+{
+    const int stateSize = stateTransitionHistory.begin( )->second.rows( );
+    const int parameterSize = initialCovariance.rows( ) - stateSize;
+
+    const Eigen::Matrix< double, CombinedSize, CombinedSize > combinedInitialCovariance = initialCovariance;
+    Eigen::Matrix< double, StateSize, CombinedSize > combinedPartials( stateSize, stateSize + parameterSize );
+    Eigen::Matrix< double, StateSize, CombinedSize > partialsTimesCovariance( stateSize, stateSize + parameterSize );
+    Eigen::Matrix< double, StateSize, StateSize > currentCovariance( stateSize, stateSize );
+    auto sensitivityIterator = sensitivityHistory.begin( );
+    for( auto stateTransitionIterator = stateTransitionHistory.begin( );
+         stateTransitionIterator != stateTransitionHistory.end( ); stateTransitionIterator++ )
+    {
+        combinedPartials.leftCols( stateSize ) = stateTransitionIterator->second;
+        if( parameterSize > 0 )
+        {
+            if( sensitivityIterator->first != stateTransitionIterator->first )
+            {
+                throw std::runtime_error(
+                            "Error when propagating covariance, state transition and sensitivity epochs differ." );
+            }
+            combinedPartials.rightCols( parameterSize ) = sensitivityIterator->second;
+            sensitivityIterator++;
+        }
+
+        partialsTimesCovariance.noalias( ) = combinedPartials * combinedInitialCovariance;
+        currentCovariance.noalias( ) = partialsTimesCovariance * combinedPartials.transpose( );
+        covarianceHistory.push_back(
+                    stateTransitionIterator->first,
+                    Eigen::Map< const Eigen::VectorXd >( currentCovariance.data( ), currentCovariance.size( ) ) );
+    }
+}
+
+//! Function to propagate a covariance matrix using the solution of the variational equations.
+/*!
+ *  Function to propagate a covariance matrix using the solution of the variational equations, as
+ *  P(t) = [ Phi(t) S(t) ] P0 [ Phi(t) S(t) ]^T, where Phi is the state transition matrix and S the sensitivity matrix. This
+ *  gives the linearized uncertainty of the propagated state for a single propagation of the variational equations, which
+ *  would otherwise be estimated from a large number of perturbed propagations.
+ *  \param initialCovariance Covariance of the initial state and parameters (size n + p, with n the state size and p the
+ *  number of columns of the sensitivity matrix), see createBlockDiagonalCovariance.
+ *  \param stateTransitionHistory History of the state transition matrix (n x n).
+ *  \param sensitivityHistory History of the sensitivity matrix (n x p), at the same epochs as the state transition matrix.
+ *  May be empty, in which case the parameters are not considered (and initialCovariance must be of size n).
+ *  \return History of the propagated covariance, where each state is the n x n covariance, stored column-major (see
+ *  getCovarianceMatrix).
+ */
+inline FlatStateHistory< > propagateCovariance(
+        const Eigen::MatrixXd& initialCovariance,
+        const std::map< double, Eigen::MatrixXd >& stateTransitionHistory,
+        const std::map< double, Eigen::MatrixXd >& sensitivityHistory = std::map< double, Eigen::MatrixXd >( ) )
+{
+    if( stateTransitionHistory.size( ) == 0 )
+    {
+        throw std::runtime_error( "Error when propagating covariance, no state transition matrices provided." );
+    }
+
+    const int stateSize = stateTransitionHistory.begin( )->second.rows( );
+    const int parameterSize = ( sensitivityHistory.size( ) > 0 ) ? sensitivityHistory.begin( )->second.cols( ) : 0;
+    if( initialCovariance.rows( ) != stateSize + parameterSize || initialCovariance.cols( ) != stateSize + parameterSize )
+    {
+        throw std::runtime_error( "Error when propagating covariance, size of initial covariance is inconsistent." );
+    }
+    else if( parameterSize > 0 && sensitivityHistory.size( ) != stateTransitionHistory.size( ) )
+    {
+        throw std::runtime_error( "Error when propagating covariance, state transition and sensitivity histories differ." );
+    }
+
+    // Use fixed-size matrices for a Cartesian state (with or without parameters).
+    FlatStateHistory< > covarianceHistory( stateSize * stateSize );
+    covarianceHistory.reserve( stateTransitionHistory.size( ) );
+    if( stateSize == 6 && parameterSize == 0 )
+    {
+        propagateCovarianceWithFixedSizes< 6, 6 >(
+                    initialCovariance, stateTransitionHistory, sensitivityHistory, covarianceHistory );
+    }
+    else if( stateSize == 6 )
+    {
+        propagateCovarianceWithFixedSizes< 6, Eigen::Dynamic >(
+                    initialCovariance, stateTransitionHistory, sensitivityHistory, covarianceHistory );
+    }
+    else
+    {
+        propagateCovarianceWithFixedSizes< Eigen::Dynamic, Eigen::Dynamic >(
+                    initialCovariance, stateTransitionHistory, sensitivityHistory, covarianceHistory );
+    }
+
+    return covarianceHistory;
+}
+
+//! Function to retrieve a covariance matrix from a covariance history created by propagateCovariance.
+inline Eigen::Map< const Eigen::MatrixXd > getCovarianceMatrix( const FlatStateHistory< >& covarianceHistory,
+                                                               const unsigned int index )
+{
+    const int stateSize = static_cast< int >( std::sqrt( static_cast< double >( covarianceHistory.getStateSize( ) ) ) + 0.5 );
+    return Eigen::Map< const Eigen::MatrixXd >( covarianceHistory.getState( index ).data( ), stateSize, stateSize );
+}
+
+//! Function to compute the history of formal errors (square roots of the diagonal) from a covariance history.
+inline FlatStateHistory< > computeFormalErrorHistory( const FlatStateHistory< >& covarianceHistory )
+{
+    const int stateSize = static_cast< int >( std::sqrt( static_cast< double >( covarianceHistory.getStateSize( ) ) ) + 0.5 );
+
+    FlatStateHistory< > formalErrorHistory( stateSize );
+    formalErrorHistory.reserve( covarianceHistory.size( ) );
+    for( unsigned int i = 0; i < covarianceHistory.size( ); i++ )
+    {
+        formalErrorHistory.push_back( covarianceHistory.getEpoch( i ),
+                                      getCovarianceMatrix( covarianceHistory, i ).diagonal( ).cwiseMax( 0.0 ).cwiseSqrt( ) );
+    }
+    return formalErrorHistory;
+}
+
+//! Function to compute the maximum (over all epochs) position standard deviation from a covariance history.
+/*!
+ *  Function to compute the maximum (over all epochs) position standard deviation from a covariance history, along the
+ *  major axis of the position error ellipsoid. Since the error of the linearization grows with the square of the size of
+ *  the perturbation, this value can be used to decide whether the linearized covariance is to be checked by sampling.
+ *  \param covarianceHistory Covariance history of Cartesian state, with position as the first three entries.
+ *  \return Maximum position standard deviation.
+ */
+inline double computeMaximumPositionStandardDeviation( const FlatStateHistory< >& covarianceHistory )
+{
+    double maximumVariance = 0.0;
+    Eigen::SelfAdjointEigenSolver< Eigen::Matrix3d > eigenSolver;
+    for( unsigned int i = 0; i < covarianceHistory.size( ); i++ )
+    {
+        eigenSolver.compute( getCovarianceMatrix( covarianceHistory, i ).block< 3, 3 >( 0, 0 ), Eigen::EigenvaluesOnly );
+        maximumVariance = std::max( maximumVariance, eigenSolver.eigenvalues( ).maxCoeff( ) );
+    }
+    return std::sqrt( maximumVariance );
+}
+
+}
+
+#endif // TUDAT_LINEARIZEDCOVARIANCEPROPAGATION_H
@@ -0,0 +1,39 @@
+function archive = openCampaignArchive(filePath)
+% Open a campaign archive written by CampaignArchiveWriter (see campaignArchive.h), reading its index.
+%
+% The returned struct contains the file path, and a containers.Map from case key to [offset size] of each entry, so that
+% an entry can be read using readCampaignArchiveEntry without scanning the file. Only finalized archives (with an index
+% at the end of the file) are supported; use CampaignArchiveReader to recover entries from an incomplete archive.
+
+fileId = fopen(filePath, 'r', 'ieee-le');
+if( fileId < 0 )
+    error(strcat('Error, could not open campaign archive ', filePath));
+end
+cleanup = onCleanup(@() fclose(fileId));
+
+archiveIdentifier = fread(fileId, [1 8], '*char');
+if( ~strcmp(archiveIdentifier(1:7), 'TUDATCA') )
+    error(strcat('Error, no campaign archive found in ', filePath));
+end
+
+fseek(fileId, -32, 'eof');
+indexOffset = fread(fileId, 1, 'uint64');
+numberOfEntries = fread(fileId, 1, 'uint64');
+fread(fileId, 2, 'uint32');
+trailerIdentifier = fread(fileId, [1 8], '*char');
+if( ~strcmp(trailerIdentifier, 'TUDATCAI') )
+    error(strcat('Error, campaign archive ', filePath, ' was not finalized'));
+end
+
+index = containers.Map('KeyType', 'char', 'ValueType', 'any');
+fseek(fileId, indexOffset, 'bof');
+for i = 1:numberOfEntries
+    keyLength = fread(fileId, 1, 'uint32');
+    caseKey = fread(fileId, [1 keyLength], '*char');
+    entryLocation = fread(fileId, [1 2], 'uint64');
+    index(caseKey) = entryLocation;
+end
+
+archive = struct('filePath', filePath, 'index', index);
+
+end
@@ -0,0 +1,159 @@
+/*    Copyright (c) 2010-2018, Delft University of Technology
+ *    All rigths reserved
+ *
+ *    This file is part of the Tudat. Redistribution and use in source and
+ *    binary forms, with or without modification, are permitted exclusively
+ *    under the terms of the Modified BSD license. You should have received
+ *    a copy of the license with this file. If not, please or visit:
+ *    http://tudat.tudelft.nl/LICENSE.
+ */
+
+#ifndef TUDAT_OUTPUTSCHEDULE_H
+#define TUDAT_OUTPUTSCHEDULE_H
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace tudat_applications
+{
+
+//! Types of output schedule, defining the epochs at which the propagated state is output.
+enum OutputScheduleType
+{
+    every_step_output,
+    final_state_output,
+    fixed_cadence_output,
+    epoch_list_output
+};
+
+//! Settings for the epochs at which the propagated state is output (see propagateToStateHistorySinks).
+/*!
+ *  Settings for the epochs at which the propagated state is output (see propagateToStateHistorySinks). For any schedule
+ *  other than every_step_output, the integration steps are shortened where needed to end exactly on the output epochs (and
+ *  on the final time), and only the states at the output epochs are passed on, so that no intermediate steps need to be
+ *  stored or processed. Note that shortening the steps changes the step-size sequence of variable step-size integrators;
+ *  where this is not desired, a DenseOutputStateHistorySink can be used instead (with every_step_output).
+ */
+template< typename TimeType = double >
+class OutputScheduleSettings
+{
+public:
+
+    //! Constructor
+    /*!
+     *  Constructor
+     *  \param outputScheduleType Type of output schedule.
+     *  \param outputInterval Interval between output epochs, starting at the initial time (fixed_cadence_output only).
+     *  \param outputEpochs List of output epochs (epoch_list_output only).
+     */
+    OutputScheduleSettings( const OutputScheduleType outputScheduleType,
+                            const TimeType outputInterval = TimeType( 0.0 ),
+                            const std::vector< TimeType >& outputEpochs = std::vector< TimeType >( ) ):
+        outputScheduleType_( outputScheduleType ), outputInterval_( outputInterval ), outputEpochs_( outputEpochs )
+    {
+        if( outputScheduleType_ == fixed_cadence_output && !( outputInterval_ > 0.0 ) )
+        {
+            throw std::runtime_error( "Error, output interval of fixed-cadence output schedule must be positive." );
+        }
+    }
+
+    //! Function to retrieve the type of output schedule.
+    OutputScheduleType getOutputScheduleType( ) const { return outputScheduleType_; }
+
+    //! Function to retrieve the output epochs of a propagation, in order of propagation.
+    /*!
+     *  Function to retrieve the output epochs of a propagation, in order of propagation (forward or backward in time).
+     *  Epochs outside the propagation interval are omitted.
+     *  \param initialTime Initial time of the propagation.
+     *  \param finalTime Final time of the propagation.
+     *  \return Output epochs (empty for every_step_output).
+     */
+    std::vector< TimeType > getOutputEpochs( const TimeType initialTime, const TimeType finalTime ) const
+    {
+        const bool isPropagationForward = ( finalTime > initialTime );
+        std::vector< TimeType > outputEpochs;
+        switch( outputScheduleType_ )
+        {
+        case every_step_output:
+            break;
+        case final_state_output:
+            outputEpochs.push_back( finalTime );
+            break;
+        case fixed_cadence_output:
+        {
+            unsigned int numberOfIntervals = 0;
+            TimeType currentEpoch = initialTime;
+            while( isPropagationForward ? !( currentEpoch > finalTime ) : !( currentEpoch < finalTime ) )
+            {
+                outputEpochs.push_back( currentEpoch );
+                numberOfIntervals++;
+
+                // Compute from initial time (rather than by repeated addition) to avoid accumulation of rounding errors.
+                currentEpoch = isPropagationForward ?
+                            initialTime + static_cast< double >( numberOfIntervals ) * outputInterval_ :
+                            initialTime - static_cast< double >( numberOfIntervals ) * outputInterval_;
+            }
+            break;
+        }
+        case epoch_list_output:
+            for( unsigned int i = 0; i < outputEpochs_.size( ); i++ )
+            {
+                const TimeType currentEpoch = outputEpochs_.at( i );
+                if( isPropagationForward ? ( !( currentEpoch < initialTime ) && !( currentEpoch > finalTime ) ) :
+                        ( !( currentEpoch > initialTime ) && !( currentEpoch < finalTime ) ) )
+                {
+                    outputEpochs.push_back( currentEpoch );
+                }
+            }
+            std::sort( outputEpochs.begin( ), outputEpochs.end( ) );
+            outputEpochs.erase( std::unique( outputEpochs.begin( ), outputEpochs.end( ) ), outputEpochs.end( ) );
+            if( !isPropagationForward )
+            {
+                std::reverse( outputEpochs.begin( ), outputEpochs.end( ) );
+            }
+            break;
+        default:
+            throw std::runtime_error( "Error, output schedule type not recognized." );
+        }
+        return outputEpochs;
+    }
+
+private:
+
+    //! Type of output schedule.
+    OutputScheduleType outputScheduleType_;
+
+    //! Interval between output epochs (fixed_cadence_output only).
+    TimeType outputInterval_;
+
+    //! List of output epochs (epoch_list_output only).
+    std::vector< TimeType > outputEpochs_;
+};
+
+//! Function to create an output schedule retaining only the final state of the propagation.
+template< typename TimeType = double >
+std::shared_ptr< OutputScheduleSettings< TimeType > > createFinalStateOutputSchedule( )
+{
+    return std::make_shared< OutputScheduleSettings< TimeType > >( final_state_output );
+}
+
+//! Function to create an output schedule with output at a fixed interval, starting at the initial time.
+template< typename TimeType = double >
+std::shared_ptr< OutputScheduleSettings< TimeType > > createFixedCadenceOutputSchedule( const TimeType outputInterval )
+{
+    return std::make_shared< OutputScheduleSettings< TimeType > >( fixed_cadence_output, outputInterval );
+}
+
+//! Function to create an output schedule with output at a list of epochs.
+template< typename TimeType = double >
+std::shared_ptr< OutputScheduleSettings< TimeType > > createEpochListOutputSchedule(
+        const std::vector< TimeType >& outputEpochs )
+{
+    return std::make_shared< OutputScheduleSettings< TimeType > >( epoch_list_output, TimeType( 0.0 ), outputEpochs );
+}
+
+}
+
+#endif // TUDAT_OUTPUTSCHEDULE_H
@@ -0,0 +1,577 @@
+/*    Copyright (c) 2010-2018, Delft University of Technology
+ *    All rigths reserved
+ *
+ *    This file is part of the Tudat. Redistribution and use in source and
+ *    binary forms, with or without modification, are permitted exclusively
+ *    under the terms of the Modified BSD license. You should have received
+ *    a copy of the license with this file. If not, please or visit:
+ *    http://tudat.tudelft.nl/LICENSE.
+ */
+
+#ifndef TUDAT_PACKEDSPHERICALHARMONICS_H
+#define TUDAT_PACKEDSPHERICALHARMONICS_H
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include <Eigen/Core>
+
+namespace tudat_applications
+{
+
+//! Gravity field evaluated from spherical harmonic coefficients stored as a packed triangle, for efficient evaluation.
+/*!
+ *  Gravity field evaluated from (geodesy-normalized) spherical harmonic coefficients stored as a packed triangle, for
+ *  efficient evaluation of the gravitational acceleration at high degree and order. The coefficients, and the factors of the
+ *  recursions for the normalized associated Legendre functions, are stored contiguously per degree (entry (n, m) at index
+ *  n(n+1)/2 + m), so that all loops over the order for a given degree run over contiguous memory, without data dependencies
+ *  between orders. These loops (including the sums, which are split over independent partial sums) are therefore
+ *  vectorized by the compiler (e.g. with AVX2 or AVX-512 when compiling for such targets), as opposed to the recursions of
+ *  the Legendre functions per order that are used by the SphericalHarmonicsGravityField in Tudat.
+ *
+ *  The acceleration is computed from the gradient of the potential in spherical coordinates, using the standard forward
+ *  column recursions for the Legendre functions, as in Tudat, so that results are equal to round-off. For fields up to
+ *  degree 8, a specialization with a compile-time maximum degree is used, for which all loops over the degree are
+ *  unrolled. The class holds the workspace used in the evaluation, so that no memory is allocated per evaluation; an object
+ *  must therefore not be used concurrently from multiple threads.
+ */
+class PackedSphericalHarmonicsGravityField
+{
+public:
+
+    //! Constructor
+    /*!
+     *  Constructor
+     *  \param referenceRadius Reference radius of the spherical harmonic expansion.
+     *  \param maximumDegree Maximum degree of the expansion that is used.
+     *  \param maximumOrder Maximum order of the expansion that is used.
+     *  \param cosineCoefficients Geodesy-normalized cosine coefficients (at least maximumDegree + 1 rows and maximumOrder + 1
+     *  columns, entry (n, m) being the coefficient of degree n and order m).
+     *  \param sineCoefficients Geodesy-normalized sine coefficients (same size as cosine coefficients).
+     */
+    PackedSphericalHarmonicsGravityField( const double referenceRadius,
+                                          const int maximumDegree,
+                                          const int maximumOrder,
+                                          const Eigen::MatrixXd& cosineCoefficients,
+                                          const Eigen::MatrixXd& sineCoefficients ):
+        referenceRadius_( referenceRadius ), maximumDegree_( maximumDegree ),
+        maximumOrder_( std::min( maximumOrder, maximumDegree ) )
+    {
+        if( maximumDegree_ < 0 || maximumOrder_ < 0 )
+        {
+            throw std::runtime_error( "Error, maximum degree and order of packed spherical harmonics must be non-negative." );
+        }
+
+        const int numberOfPackedEntries = getPackedIndex( maximumDegree_ + 1, 0 );
+        packedCosineCoefficients_.resize( numberOfPackedEntries );
+        packedSineCoefficients_.resize( numberOfPackedEntries );
+        computeRecursionFactors( );
+        setCoefficients( cosineCoefficients, sineCoefficients );
+
+        cosineOfOrderLongitude_.resize( maximumDegree_ + 2 );
+        sineOfOrderLongitude_.resize( maximumDegree_ + 2 );
+        blockCosineOfOrderLongitude_.resize( ( maximumDegree_ + 2 ) * numberOfPointsPerBlock );
+        blockSineOfOrderLongitude_.resize( ( maximumDegree_ + 2 ) * numberOfPointsPerBlock );
+        for( unsigned int i = 0; i < 3; i++ )
+        {
+            legendreRows_[ i ].resize( maximumDegree_ + 2 );
+            blockLegendreRows_[ i ].resize( ( maximumDegree_ + 2 ) * numberOfPointsPerBlock );
+        }
+
+        switch( maximumDegree_ )
+        {
+        case 0: gradientFunction_ = &PackedSphericalHarmonicsGravityField::computeGradientImplementation< 0 >; break;
+        case 1: gradientFunction_ = &PackedSphericalHarmonicsGravityField::computeGradientImplementation< 1 >; break;
+        case 2: gradientFunction_ = &PackedSphericalHarmonicsGravityField::computeGradientImplementation< 2 >; break;
+        case 3: gradientFunction_ = &PackedSphericalHarmonicsGravityField::computeGradientImplementation< 3 >; break;
+        case 4: gradientFunction_ = &PackedSphericalHarmonicsGravityField::computeGradientImplementation< 4 >; break;
+        case 5: gradientFunction_ = &PackedSphericalHarmonicsGravityField::computeGradientImplementation< 5 >; break;
+        case 6: gradientFunction_ = &PackedSphericalHarmonicsGravityField::computeGradientImplementation< 6 >; break;
+        case 7: gradientFunction_ = &PackedSphericalHarmonicsGravityField::computeGradientImplementation< 7 >; break;
+        case 8: gradientFunction_ = &PackedSphericalHarmonicsGravityField::computeGradientImplementation< 8 >; break;
+        default: gradientFunction_ = &PackedSphericalHarmonicsGravityField::computeGradientImplementation< -1 >; break;
+        }
+    }
+
+    //! Function to reset the coefficients (e.g. for a time-variable gravity field), packing them into contiguous storage.
+    /*!
+     *  Function to reset the coefficients (e.g. for a time-variable gravity field), packing them into contiguous storage.
+     *  \param cosineCoefficients Geodesy-normalized cosine coefficients (see constructor).
+     *  \param sineCoefficients Geodesy-normalized sine coefficients (see constructor).
+     */
+    void setCoefficients( const Eigen::MatrixXd& cosineCoefficients, const Eigen::MatrixXd& sineCoefficients )
+    {
+        if( cosineCoefficients.rows( ) <= maximumDegree_ || cosineCoefficients.cols( ) <= maximumOrder_ ||
+                sineCoefficients.rows( ) <= maximumDegree_ || sineCoefficients.cols( ) <= maximumOrder_ )
+        {
+            throw std::runtime_error( "Error, spherical harmonic coefficients are of insufficient degree and order." );
+        }
+
+        for( int n = 0; n <= maximumDegree_; n++ )
+        {
+            for( int m = 0; m <= n; m++ )
+            {
+                packedCosineCoefficients_[ getPackedIndex( n, m ) ] = ( m <= maximumOrder_ ) ? cosineCoefficients( n, m ) : 0.0;
+                packedSineCoefficients_[ getPackedIndex( n, m ) ] = ( m <= maximumOrder_ ) ? sineCoefficients( n, m ) : 0.0;
+            }
+        }
+    }
+
+    //! Function to compute the gradient of the potential (i.e. the gravitational acceleration) in the body-fixed frame.
+    /*!
+     *  Function to compute the gradient of the potential (i.e. the gravitational acceleration) in the body-fixed frame.
+     *  \param bodyFixedPosition Position at which the acceleration is computed, in the body-fixed frame (not on the polar
+     *  axis, as for the Tudat spherical harmonic acceleration).
+     *  \param gravitationalParameter Gravitational parameter of the body.
+     *  \return Gravitational acceleration, in the body-fixed frame.
+     */
+    Eigen::Vector3d computeGradient( const Eigen::Vector3d& bodyFixedPosition, const double gravitationalParameter )
+    {
+        return ( this->*gradientFunction_ )( bodyFixedPosition, gravitationalParameter );
+    }
+
+    //! Function to compute the gradient of the potential at multiple points in the body-fixed frame.
+    /*!
+     *  Function to compute the gradient of the potential (i.e. the gravitational acceleration) at multiple points in the
+     *  body-fixed frame (e.g. the members of an ensemble, or a grid of states, at a single epoch). The points are processed
+     *  in blocks of numberOfPointsPerBlock, for which the Legendre functions are computed together, with the values of all
+     *  points of a block for a given degree and order stored contiguously. Each coefficient and recursion factor is then
+     *  loaded once per block (rather than once per point), and the innermost loops (over the points of a block) are
+     *  vectorized by the compiler. Results are equal to those of computeGradient to round-off.
+     *  \param bodyFixedPositions Positions at which the acceleration is computed (one per column), in the body-fixed frame.
+     *  \param gravitationalParameter Gravitational parameter of the body.
+     *  \param gradients Gravitational accelerations (one per column), in the body-fixed frame (returned by reference).
+     */
+    void computeGradients( const Eigen::Matrix3Xd& bodyFixedPositions, const double gravitationalParameter,
+                           Eigen::Matrix3Xd& gradients )
+    {
+        const int blockSize = numberOfPointsPerBlock;
+        const int numberOfPoints = static_cast< int >( bodyFixedPositions.cols( ) );
+        gradients.resize( 3, numberOfPoints );
+        for( int firstPointIndex = 0; firstPointIndex < numberOfPoints; firstPointIndex += blockSize )
+        {
+            computeGradientBlock( bodyFixedPositions, firstPointIndex,
+                                  std::min( blockSize, numberOfPoints - firstPointIndex ),
+                                  gravitationalParameter, gradients );
+        }
+    }
+
+    //! Function to retrieve the maximum degree of the expansion.
+    int getMaximumDegree( ) const { return maximumDegree_; }
+
+    //! Function to retrieve the maximum order of the expansion.
+    int getMaximumOrder( ) const { return maximumOrder_; }
+
+    //! Function to retrieve the reference radius of the expansion.
+    double getReferenceRadius( ) const { return referenceRadius_; }
+
+    //! Number of points of which the gradient is computed together by computeGradients.
+    static const int numberOfPointsPerBlock = 8;
+
+private:
+
+    //! Function to retrieve the index of the entry of degree n and order m in the packed storage.
+    static int getPackedIndex( const int degree, const int order )
+    {
+        return degree * ( degree + 1 ) / 2 + order;
+    }
+
+    //! Function to compute the factors of the recursions of the normalized Legendre functions and their derivatives.
+    void computeRecursionFactors( )
+    {
+        const int numberOfPackedEntries = getPackedIndex( maximumDegree_ + 1, 0 );
+        firstRecursionFactors_.assign( numberOfPackedEntries, 0.0 );
+        secondRecursionFactors_.assign( numberOfPackedEntries, 0.0 );
+        derivativeFactors_.assign( numberOfPackedEntries, 0.0 );
+
+        for( int n = 1; n <= maximumDegree_; n++ )
+        {
+            const double degree = static_cast< double >( n );
+            for( int m = 0; m <= n - 2; m++ )
+            {
+                const double order = static_cast< double >( m );
+                firstRecursionFactors_[ getPackedIndex( n, m ) ] = std::sqrt(
+                            ( 2.0 * degree - 1.0 ) * ( 2.0 * degree + 1.0 ) / ( ( degree - order ) * ( degree + order ) ) );
+                secondRecursionFactors_[ getPackedIndex( n, m ) ] = std::sqrt(
+                            ( 2.0 * degree + 1.0 ) * ( degree + order - 1.0 ) * ( degree - order - 1.0 ) /
+                            ( ( degree - order ) * ( degree + order ) * ( 2.0 * degree - 3.0 ) ) );
+            }
+
+            // Factors for P(n, n-1) (from P(n-1, n-1)) and sectorial P(n, n) (from P(n-1, n-1)).
+            firstRecursionFactors_[ getPackedIndex( n, n - 1 ) ] = std::sqrt( 2.0 * degree + 1.0 );
+            firstRecursionFactors_[ getPackedIndex( n, n ) ] =
+                    ( n == 1 ) ? std::sqrt( 3.0 ) : std::sqrt( ( 2.0 * degree + 1.0 ) / ( 2.0 * degree ) );
+        }
+
+        for( int n = 0; n <= maximumDegree_; n++ )
+        {
+            const double degree = static_cast< double >( n );
+            for( int m = 0; m <= n; m++ )
+            {
+                const double order = static_cast< double >( m );
+                derivativeFactors_[ getPackedIndex( n, m ) ] = ( m == 0 ) ?
+                            std::sqrt( 0.5 * degree * ( degree + 1.0 ) ) :
+                            std::sqrt( ( degree - order ) * ( degree + order + 1.0 ) );
+            }
+        }
+    }
+
+    //! Function to compute the gradient of the potential, with a compile-time maximum degree (dynamic if negative).
+    template< int FixedMaximumDegree >
+    Eigen::Vector3d computeGradientImplementation( const Eigen::Vector3d& bodyFixedPosition,
+                                                   const double gravitationalParameter )
+    {
+        const int numberOfLanes = 4;
+        const int maximumDegree = ( FixedMaximumDegree >= 0 ) ? FixedMaximumDegree : maximumDegree_;
+        const int maximumOrder = maximumOrder_;
+
+        // Compute spherical coordinates.
+        const double radialDistance = bodyFixedPosition.norm( );
+        const double horizontalDistance = std::sqrt( bodyFixedPosition.x( ) * bodyFixedPosition.x( ) +
+                                                     bodyFixedPosition.y( ) * bodyFixedPosition.y( ) );
+        const double sineOfLatitude = bodyFixedPosition.z( ) / radialDistance;
+        const double cosineOfLatitude = horizontalDistance / radialDistance;
+        const double tangentOfLatitude = sineOfLatitude / cosineOfLatitude;
+        const double cosineOfLongitude = bodyFixedPosition.x( ) / horizontalDistance;
+        const double sineOfLongitude = bodyFixedPosition.y( ) / horizontalDistance;
+
+        // Compute cos(m lambda) and sin(m lambda).
+        double* cosineOfOrderLongitude = cosineOfOrderLongitude_.data( );
+        double* sineOfOrderLongitude = sineOfOrderLongitude_.data( );
+        cosineOfOrderLongitude[ 0 ] = 1.0;
+        sineOfOrderLongitude[ 0 ] = 0.0;
+        for( int m = 1; m <= maximumOrder; m++ )
+        {
+            cosineOfOrderLongitude[ m ] = cosineOfOrderLongitude[ m - 1 ] * cosineOfLongitude -
+                    sineOfOrderLongitude[ m - 1 ] * sineOfLongitude;
+            sineOfOrderLongitude[ m ] = sineOfOrderLongitude[ m - 1 ] * cosineOfLongitude +
+                    cosineOfOrderLongitude[ m - 1 ] * sineOfLongitude;
+        }
+
+        double* previousPreviousRow = legendreRows_[ 0 ].data( );
+        double* previousRow = legendreRows_[ 1 ].data( );
+        double* currentRow = legendreRows_[ 2 ].data( );
+        for( unsigned int i = 0; i < 3; i++ )
+        {
+            std::fill( legendreRows_[ i ].begin( ), legendreRows_[ i ].end( ), 0.0 );
+        }
+
+        const double radiusRatio = referenceRadius_ / radialDistance;
+        double radiusRatioPower = 1.0;
+        double radialDerivativeSum = 0.0;
+        double latitudeDerivativeSum = 0.0;
+        double longitudeDerivativeSum = 0.0;
+        for( int n = 0; n <= maximumDegree; n++ )
+        {
+            const int rowIndex = getPackedIndex( n, 0 );
+            const double* firstRecursionFactors = firstRecursionFactors_.data( ) + rowIndex;
+            const double* secondRecursionFactors = secondRecursionFactors_.data( ) + rowIndex;
+
+            // Compute Legendre functions of degree n, up to one order beyond the maximum (required for derivative).
+            const int legendreOrderLimit = std::min( n, maximumOrder + 1 );
+            if( n == 0 )
+            {
+                currentRow[ 0 ] = 1.0;
+            }
+            else
+            {
+                const int generalOrderLimit = std::min( n - 2, legendreOrderLimit );
+                for( int m = 0; m <= generalOrderLimit; m++ )
+                {
+                    currentRow[ m ] = firstRecursionFactors[ m ] * sineOfLatitude * previousRow[ m ] -
+                            secondRecursionFactors[ m ] * previousPreviousRow[ m ];
+                }
+                if( n - 1 <= legendreOrderLimit )
+                {
+                    currentRow[ n - 1 ] = firstRecursionFactors[ n - 1 ] * sineOfLatitude * previousRow[ n - 1 ];
+                }
+                if( n <= legendreOrderLimit )
+                {
+                    currentRow[ n ] = firstRecursionFactors[ n ] * cosineOfLatitude * previousRow[ n - 1 ];
+                }
+            }
+
+            // Compute contributions of degree n to the partial derivatives of the potential (using independent partial
+            // sums per lane, so that the loop over the order is vectorized).
+            const double* cosineCoefficients = packedCosineCoefficients_.data( ) + rowIndex;
+            const double* sineCoefficients = packedSineCoefficients_.data( ) + rowIndex;
+            const double* derivativeFactors = derivativeFactors_.data( ) + rowIndex;
+            const int orderLimit = std::min( n, maximumOrder );
+
+            double radialTerms[ numberOfLanes ] = { 0.0, 0.0, 0.0, 0.0 };
+            double latitudeTerms[ numberOfLanes ] = { 0.0, 0.0, 0.0, 0.0 };
+            double longitudeTerms[ numberOfLanes ] = { 0.0, 0.0, 0.0, 0.0 };
+            for( int blockStart = 0; blockStart <= orderLimit; blockStart += numberOfLanes )
+            {
+                for( int lane = 0; lane < numberOfLanes; lane++ )
+                {
+                    const int m = blockStart + lane;
+                    if( m <= orderLimit )
+                    {
+                        const double cosineTerm = cosineCoefficients[ m ] * cosineOfOrderLongitude[ m ] +
+                                sineCoefficients[ m ] * sineOfOrderLongitude[ m ];
+                        const double sineTerm = sineCoefficients[ m ] * cosineOfOrderLongitude[ m ] -
+                                cosineCoefficients[ m ] * sineOfOrderLongitude[ m ];
+                        radialTerms[ lane ] += currentRow[ m ] * cosineTerm;
+                        latitudeTerms[ lane ] += ( derivativeFactors[ m ] * currentRow[ m + 1 ] -
+                                                   static_cast< double >( m ) * tangentOfLatitude * currentRow[ m ] ) *
+                                cosineTerm;
+                        longitudeTerms[ lane ] += static_cast< double >( m ) * currentRow[ m ] * sineTerm;
+                    }
+                }
+            }
+
+            radialDerivativeSum += static_cast< double >( n + 1 ) * radiusRatioPower *
+                    ( ( radialTerms[ 0 ] + radialTerms[ 1 ] ) + ( radialTerms[ 2 ] + radialTerms[ 3 ] ) );
+            latitudeDerivativeSum += radiusRatioPower *
+                    ( ( latitudeTerms[ 0 ] + latitudeTerms[ 1 ] ) + ( latitudeTerms[ 2 ] + latitudeTerms[ 3 ] ) );
+            longitudeDerivativeSum += radiusRatioPower *
+                    ( ( longitudeTerms[ 0 ] + longitudeTerms[ 1 ] ) + ( longitudeTerms[ 2 ] + longitudeTerms[ 3 ] ) );
+
+            radiusRatioPower *= radiusRatio;
+            std::swap( previousPreviousRow, previousRow );
+            std::swap( previousRow, currentRow );
+        }
+
+        return computeCartesianGradient( gravitationalParameter, radialDistance, sineOfLatitude, cosineOfLatitude,
+                                         sineOfLongitude, cosineOfLongitude, radialDerivativeSum, latitudeDerivativeSum,
+                                         longitudeDerivativeSum );
+    }
+
+    //! Function to compute the gradient of the potential at a block of points (see computeGradients).
+    void computeGradientBlock( const Eigen::Matrix3Xd& bodyFixedPositions, const int firstPointIndex,
+                               const int numberOfPoints, const double gravitationalParameter, Eigen::Matrix3Xd& gradients )
+    {
+        const int blockSize = numberOfPointsPerBlock;
+        const int maximumDegree = maximumDegree_;
+        const int maximumOrder = maximumOrder_;
+
+        // Compute spherical coordinates (padding the block with copies of its last point).
+        double radialDistance[ blockSize ], sineOfLatitude[ blockSize ], cosineOfLatitude[ blockSize ];
+        double tangentOfLatitude[ blockSize ], sineOfLongitude[ blockSize ], cosineOfLongitude[ blockSize ];
+        double radiusRatio[ blockSize ], radiusRatioPower[ blockSize ];
+        double radialDerivativeSum[ blockSize ], latitudeDerivativeSum[ blockSize ], longitudeDerivativeSum[ blockSize ];
+        for( int p = 0; p < blockSize; p++ )
+        {
+            const Eigen::Vector3d& bodyFixedPosition =
+                    bodyFixedPositions.col( firstPointIndex + std::min( p, numberOfPoints - 1 ) );
+            const double horizontalDistance = std::sqrt( bodyFixedPosition.x( ) * bodyFixedPosition.x( ) +
+                                                         bodyFixedPosition.y( ) * bodyFixedPosition.y( ) );
+            radialDistance[ p ] = bodyFixedPosition.norm( );
+            sineOfLatitude[ p ] = bodyFixedPosition.z( ) / radialDistance[ p ];
+            cosineOfLatitude[ p ] = horizontalDistance / radialDistance[ p ];
+            tangentOfLatitude[ p ] = sineOfLatitude[ p ] / cosineOfLatitude[ p ];
+            cosineOfLongitude[ p ] = bodyFixedPosition.x( ) / horizontalDistance;
+            sineOfLongitude[ p ] = bodyFixedPosition.y( ) / horizontalDistance;
+            radiusRatio[ p ] = referenceRadius_ / radialDistance[ p ];
+            radiusRatioPower[ p ] = 1.0;
+            radialDerivativeSum[ p ] = 0.0;
+            latitudeDerivativeSum[ p ] = 0.0;
+            longitudeDerivativeSum[ p ] = 0.0;
+        }
+
+        // Compute cos(m lambda) and sin(m lambda), stored per order for all points of the block.
+        double* cosineOfOrderLongitude = blockCosineOfOrderLongitude_.data( );
+        double* sineOfOrderLongitude = blockSineOfOrderLongitude_.data( );
+        for( int p = 0; p < blockSize; p++ )
+        {
+            cosineOfOrderLongitude[ p ] = 1.0;
+            sineOfOrderLongitude[ p ] = 0.0;
+        }
+        for( int m = 1; m <= maximumOrder; m++ )
+        {
+            const double* previousCosine = cosineOfOrderLongitude + ( m - 1 ) * blockSize;
+            const double* previousSine = sineOfOrderLongitude + ( m - 1 ) * blockSize;
+            double* currentCosine = cosineOfOrderLongitude + m * blockSize;
+            double* currentSine = sineOfOrderLongitude + m * blockSize;
+            for( int p = 0; p < blockSize; p++ )
+            {
+                currentCosine[ p ] = previousCosine[ p ] * cosineOfLongitude[ p ] - previousSine[ p ] * sineOfLongitude[ p ];
+                currentSine[ p ] = previousSine[ p ] * cosineOfLongitude[ p ] + previousCosine[ p ] * sineOfLongitude[ p ];
+            }
+        }
+
+        double* previousPreviousRow = blockLegendreRows_[ 0 ].data( );
+        double* previousRow = blockLegendreRows_[ 1 ].data( );
+        double* currentRow = blockLegendreRows_[ 2 ].data( );
+        for( unsigned int i = 0; i < 3; i++ )
+        {
+            std::fill( blockLegendreRows_[ i ].begin( ), blockLegendreRows_[ i ].end( ), 0.0 );
+        }
+
+        for( int n = 0; n <= maximumDegree; n++ )
+        {
+            const int rowIndex = getPackedIndex( n, 0 );
+            const double* firstRecursionFactors = firstRecursionFactors_.data( ) + rowIndex;
+            const double* secondRecursionFactors = secondRecursionFactors_.data( ) + rowIndex;
+
+            // Compute Legendre functions of degree n for all points, up to one order beyond the maximum.
+            const int legendreOrderLimit = std::min( n, maximumOrder + 1 );
+            if( n == 0 )
+            {
+                for( int p = 0; p < blockSize; p++ )
+                {
+                    currentRow[ p ] = 1.0;
+                }
+            }
+            else
+            {
+                const int generalOrderLimit = std::min( n - 2, legendreOrderLimit );
+                for( int m = 0; m <= generalOrderLimit; m++ )
+                {
+                    const double firstFactor = firstRecursionFactors[ m ];
+                    const double secondFactor = secondRecursionFactors[ m ];
+                    for( int p = 0; p < blockSize; p++ )
+                    {
+                        currentRow[ m * blockSize + p ] = firstFactor * sineOfLatitude[ p ] * previousRow[ m * blockSize + p ] -
+                                secondFactor * previousPreviousRow[ m * blockSize + p ];
+                    }
+                }
+                if( n - 1 <= legendreOrderLimit )
+                {
+                    for( int p = 0; p < blockSize; p++ )
+                    {
+                        currentRow[ ( n - 1 ) * blockSize + p ] = firstRecursionFactors[ n - 1 ] * sineOfLatitude[ p ] *
+                                previousRow[ ( n - 1 ) * blockSize + p ];
+                    }
+                }
+                if( n <= legendreOrderLimit )
+                {
+                    for( int p = 0; p < blockSize; p++ )
+                    {
+                        currentRow[ n * blockSize + p ] = firstRecursionFactors[ n ] * cosineOfLatitude[ p ] *
+                                previousRow[ ( n - 1 ) * blockSize + p ];
+                    }
+                }
+            }
+
+            // Compute contributions of degree n, loading each coefficient once for all points of the block.
+            const double* cosineCoefficients = packedCosineCoefficients_.data( ) + rowIndex;
+            const double* sineCoefficients = packedSineCoefficients_.data( ) + rowIndex;
+            const double* derivativeFactors = derivativeFactors_.data( ) + rowIndex;
+            const int orderLimit = std::min( n, maximumOrder );
+
+            double radialTerms[ blockSize ], latitudeTerms[ blockSize ], longitudeTerms[ blockSize ];
+            std::fill( radialTerms, radialTerms + blockSize, 0.0 );
+            std::fill( latitudeTerms, latitudeTerms + blockSize, 0.0 );
+            std::fill( longitudeTerms, longitudeTerms + blockSize, 0.0 );
+            for( int m = 0; m <= orderLimit; m++ )
+            {
+                const double cosineCoefficient = cosineCoefficients[ m ];
+                const double sineCoefficient = sineCoefficients[ m ];
+                const double derivativeFactor = derivativeFactors[ m ];
+                const double order = static_cast< double >( m );
+                const double* legendreFunctions = currentRow + m * blockSize;
+                const double* nextOrderLegendreFunctions = currentRow + ( m + 1 ) * blockSize;
+                const double* cosineOfCurrentOrder = cosineOfOrderLongitude + m * blockSize;
+                const double* sineOfCurrentOrder = sineOfOrderLongitude + m * blockSize;
+                for( int p = 0; p < blockSize; p++ )
+                {
+                    const double cosineTerm = cosineCoefficient * cosineOfCurrentOrder[ p ] +
+                            sineCoefficient * sineOfCurrentOrder[ p ];
+                    const double sineTerm = sineCoefficient * cosineOfCurrentOrder[ p ] -
+                            cosineCoefficient * sineOfCurrentOrder[ p ];
+                    radialTerms[ p ] += legendreFunctions[ p ] * cosineTerm;
+                    latitudeTerms[ p ] += ( derivativeFactor * nextOrderLegendreFunctions[ p ] -
+                                            order * tangentOfLatitude[ p ] * legendreFunctions[ p ] ) * cosineTerm;
+                    longitudeTerms[ p ] += order * legendreFunctions[ p ] * sineTerm;
+                }
+            }
+
+            for( int p = 0; p < blockSize; p++ )
+            {
+                radialDerivativeSum[ p ] += static_cast< double >( n + 1 ) * radiusRatioPower[ p ] * radialTerms[ p ];
+                latitudeDerivativeSum[ p ] += radiusRatioPower[ p ] * latitudeTerms[ p ];
+                longitudeDerivativeSum[ p ] += radiusRatioPower[ p ] * longitudeTerms[ p ];
+                radiusRatioPower[ p ] *= radiusRatio[ p ];
+            }
+
+            std::swap( previousPreviousRow, previousRow );
+            std::swap( previousRow, currentRow );
+        }
+
+        for( int p = 0; p < numberOfPoints; p++ )
+        {
+            gradients.col( firstPointIndex + p ) = computeCartesianGradient(
+                        gravitationalParameter, radialDistance[ p ], sineOfLatitude[ p ], cosineOfLatitude[ p ],
+                        sineOfLongitude[ p ], cosineOfLongitude[ p ], radialDerivativeSum[ p ],
+                        latitudeDerivativeSum[ p ], longitudeDerivativeSum[ p ] );
+        }
+    }
+
+    //! Function to convert the sums of the expansion to the Cartesian gradient of the potential.
+    /*!
+     *  Function to convert the sums of the expansion (over the degree, of the normalized partial derivatives of the potential
+     *  w.r.t. radius, latitude and longitude) to the Cartesian gradient of the potential.
+     */
+    static Eigen::Vector3d computeCartesianGradient(
+            const double gravitationalParameter, const double radialDistance,
+            const double sineOfLatitude, const double cosineOfLatitude,
+            const double sineOfLongitude, const double cosineOfLongitude,
+            const double radialDerivativeSum, const double latitudeDerivativeSum, const double longitudeDerivativeSum )
+    {
+        const double potentialScaling = gravitationalParameter / radialDistance;
+        const double radialAcceleration = -potentialScaling / radialDistance * radialDerivativeSum;
+        const double latitudeAcceleration = potentialScaling * latitudeDerivativeSum / radialDistance;
+        const double longitudeAcceleration =
+                potentialScaling * longitudeDerivativeSum / ( radialDistance * cosineOfLatitude );
+
+        return Eigen::Vector3d(
+                    radialAcceleration * cosineOfLatitude * cosineOfLongitude -
+                    latitudeAcceleration * sineOfLatitude * cosineOfLongitude - longitudeAcceleration * sineOfLongitude,
+                    radialAcceleration * cosineOfLatitude * sineOfLongitude -
+                    latitudeAcceleration * sineOfLatitude * sineOfLongitude + longitudeAcceleration * cosineOfLongitude,
+                    radialAcceleration * sineOfLatitude + latitudeAcceleration * cosineOfLatitude );
+    }
+
+    //! Reference radius of the expansion.
+    double referenceRadius_;
+
+    //! Maximum degree of the expansion.
+    int maximumDegree_;
+
+    //! Maximum order of the expansion.
+    int maximumOrder_;
+
+    //! Packed cosine coefficients (zero for orders above the maximum order).
+    std::vector< double > packedCosineCoefficients_;
+
+    //! Packed sine coefficients (zero for orders above the maximum order).
+    std::vector< double > packedSineCoefficients_;
+
+    //! Packed factors multiplying P(n-1, m) in the recursion of P(n, m) (including those for P(n, n-1) and P(n, n)).
+    std::vector< double > firstRecursionFactors_;
+
+    //! Packed factors multiplying P(n-2, m) in the recursion of P(n, m).
+    std::vector< double > secondRecursionFactors_;
+
+    //! Packed factors multiplying P(n, m+1) in the derivative of P(n, m) w.r.t. latitude.
+    std::vector< double > derivativeFactors_;
+
+    //! Workspace for cos(m lambda).
+    std::vector< double > cosineOfOrderLongitude_;
+
+    //! Workspace for sin(m lambda).
+    std::vector< double > sineOfOrderLongitude_;
+
+    //! Workspace for the Legendre functions of the three most recent degrees.
+    std::vector< double > legendreRows_[ 3 ];
+
+    //! Workspace for cos(m lambda) of a block of points (all points of order m stored contiguously).
+    std::vector< double > blockCosineOfOrderLongitude_;
+
+    //! Workspace for sin(m lambda) of a block of points (all points of order m stored contiguously).
+    std::vector< double > blockSineOfOrderLongitude_;
+
+    //! Workspace for the Legendre functions of the three most recent degrees of a block of points.
+    std::vector< double > blockLegendreRows_[ 3 ];
+
+    //! Function computing the gradient (specialized for the maximum degree, if it is small).
+    Eigen::Vector3d ( PackedSphericalHarmonicsGravityField::*gradientFunction_ )( const Eigen::Vector3d&, const double );
+};
+
+}
+
+#endif // TUDAT_PACKEDSPHERICALHARMONICS_H
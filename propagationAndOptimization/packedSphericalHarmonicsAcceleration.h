@@ -0,0 +1,412 @@
+/*    Copyright (c) 2010-2018, Delft University of Technology
+ *    All rigths reserved
+ *
+ *    This file is part of the Tudat. Redistribution and use in source and
+ *    binary forms, with or without modification, are permitted exclusively
+ *    under the terms of the Modified BSD license. You should have received
+ *    a copy of the license with this file. If not, please or visit:
+ *    http://tudat.tudelft.nl/LICENSE.
+ */
+
+#ifndef TUDAT_PACKEDSPHERICALHARMONICSACCELERATION_H
+#define TUDAT_PACKEDSPHERICALHARMONICSACCELERATION_H
+
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+
+#include <Tudat/SimulationSetup/tudatSimulationHeader.h>
+
+#include "propagationAndOptimization/packedSphericalHarmonics.h"
+
+namespace tudat_applications
+{
+
+//! Function to retrieve the spherical harmonic gravity field of a body, throwing an error if there is none.
+inline std::shared_ptr< tudat::gravitation::SphericalHarmonicsGravityField > getPackedAccelerationGravityField(
+        const std::shared_ptr< tudat::simulation_setup::Body > body )
+{
+    std::shared_ptr< tudat::gravitation::SphericalHarmonicsGravityField > gravityField =
+            std::dynamic_pointer_cast< tudat::gravitation::SphericalHarmonicsGravityField >( body->getGravityFieldModel( ) );
+    if( gravityField == nullptr )
+    {
+        throw std::runtime_error( "Error, body exerting packed spherical harmonic acceleration has no spherical harmonic "
+                                  "gravity field." );
+    }
+    return gravityField;
+}
+
+//! Evaluator of the spherical harmonic acceleration exerted by a single body on one or more bodies, at a single epoch.
+/*!
+ *  Evaluator of the spherical harmonic acceleration exerted by a single body on one or more bodies (e.g. the members of an
+ *  ensemble propagated in a single simulation), using a PackedSphericalHarmonicsGravityField. At each update, the
+ *  accelerations of all bodies are computed together (see PackedSphericalHarmonicsGravityField::computeGradients), so that
+ *  the coefficients are loaded once per block of bodies. The coefficients are re-packed at each update only if the gravity
+ *  field of the exerting body is time-dependent.
+ */
+class PackedSphericalHarmonicsAccelerationEvaluator
+{
+public:
+
+    //! Constructor
+    /*!
+     *  Constructor
+     *  \param bodiesUndergoingAcceleration Bodies undergoing the acceleration.
+     *  \param bodyExertingAcceleration Body exerting the acceleration (with a spherical harmonic gravity field).
+     *  \param maximumDegree Maximum degree of the expansion that is used.
+     *  \param maximumOrder Maximum order of the expansion that is used.
+     */
+    PackedSphericalHarmonicsAccelerationEvaluator(
+            const std::vector< std::shared_ptr< tudat::simulation_setup::Body > >& bodiesUndergoingAcceleration,
+            const std::shared_ptr< tudat::simulation_setup::Body > bodyExertingAcceleration,
+            const int maximumDegree,
+            const int maximumOrder ):
+        bodiesUndergoingAcceleration_( bodiesUndergoingAcceleration ),
+        bodyExertingAcceleration_( bodyExertingAcceleration ),
+        gravityField_( getPackedAccelerationGravityField( bodyExertingAcceleration ) ),
+        isGravityFieldTimeDependent_(
+            std::dynamic_pointer_cast< tudat::gravitation::TimeDependentSphericalHarmonicsGravityField >(
+                gravityField_ ) != nullptr ),
+        packedGravityField_( gravityField_->getReferenceRadius( ), maximumDegree, maximumOrder,
+                             gravityField_->getCosineCoefficients( ), gravityField_->getSineCoefficients( ) ),
+        bodyFixedPositions_( 3, bodiesUndergoingAcceleration.size( ) ),
+        bodyFixedAccelerations_( 3, bodiesUndergoingAcceleration.size( ) ),
+        currentAccelerations_( Eigen::Matrix3Xd::Zero( 3, bodiesUndergoingAcceleration.size( ) ) ),
+        currentTime_( TUDAT_NAN )
+    { }
+
+    //! Function to update the accelerations of all bodies to the current time.
+    /*!
+     *  Function to update the accelerations of all bodies to the current time (if not yet done since the last reset), from
+     *  the current states and rotation of the bodies (which must have been updated to this time).
+     *  \param currentTime Time at which the accelerations are to be computed.
+     */
+    void update( const double currentTime )
+    {
+        if( !( currentTime_ == currentTime ) )
+        {
+            if( isGravityFieldTimeDependent_ )
+            {
+                packedGravityField_.setCoefficients(
+                            gravityField_->getCosineCoefficients( ), gravityField_->getSineCoefficients( ) );
+            }
+
+            const Eigen::Matrix3d rotationToInertialFrame =
+                    bodyExertingAcceleration_->getCurrentRotationToGlobalFrame( ).toRotationMatrix( );
+            const Eigen::Vector3d positionOfBodyExertingAcceleration = bodyExertingAcceleration_->getPosition( );
+            for( unsigned int i = 0; i < bodiesUndergoingAcceleration_.size( ); i++ )
+            {
+                bodyFixedPositions_.col( i ) = rotationToInertialFrame.transpose( ) *
+                        ( bodiesUndergoingAcceleration_.at( i )->getPosition( ) - positionOfBodyExertingAcceleration );
+            }
+            packedGravityField_.computeGradients(
+                        bodyFixedPositions_, gravityField_->getGravitationalParameter( ), bodyFixedAccelerations_ );
+            currentAccelerations_.noalias( ) = rotationToInertialFrame * bodyFixedAccelerations_;
+
+            currentTime_ = currentTime;
+        }
+    }
+
+    //! Function to reset the time of the last update (NaN forces a re-evaluation at the next update).
+    void resetTime( const double currentTime = TUDAT_NAN )
+    {
+        currentTime_ = currentTime;
+    }
+
+    //! Function to force re-packing of the coefficients (e.g. after these have been modified for a static gravity field).
+    void updateCoefficients( )
+    {
+        packedGravityField_.setCoefficients( gravityField_->getCosineCoefficients( ), gravityField_->getSineCoefficients( ) );
+        currentTime_ = TUDAT_NAN;
+    }
+
+    //! Function to retrieve the acceleration of a single body, as computed by the last update.
+    Eigen::Vector3d getAcceleration( const unsigned int bodyIndex ) const
+    {
+        return currentAccelerations_.col( bodyIndex );
+    }
+
+    //! Function to retrieve a body undergoing the acceleration.
+    std::shared_ptr< tudat::simulation_setup::Body > getBodyUndergoingAcceleration( const unsigned int bodyIndex ) const
+    {
+        return bodiesUndergoingAcceleration_.at( bodyIndex );
+    }
+
+    //! Function to retrieve the body exerting the acceleration.
+    std::shared_ptr< tudat::simulation_setup::Body > getBodyExertingAcceleration( ) const
+    {
+        return bodyExertingAcceleration_;
+    }
+
+private:
+
+    //! Bodies undergoing the acceleration.
+    std::vector< std::shared_ptr< tudat::simulation_setup::Body > > bodiesUndergoingAcceleration_;
+
+    //! Body exerting the acceleration.
+    std::shared_ptr< tudat::simulation_setup::Body > bodyExertingAcceleration_;
+
+    //! Gravity field of the body exerting the acceleration.
+    std::shared_ptr< tudat::gravitation::SphericalHarmonicsGravityField > gravityField_;
+
+    //! Boolean denoting whether the gravity field is time-dependent (requiring the coefficients to be re-packed).
+    bool isGravityFieldTimeDependent_;
+
+    //! Packed gravity field used to compute the accelerations.
+    PackedSphericalHarmonicsGravityField packedGravityField_;
+
+    //! Positions of the bodies undergoing the acceleration, in the body-fixed frame (one per column).
+    Eigen::Matrix3Xd bodyFixedPositions_;
+
+    //! Accelerations computed by the last update, in the body-fixed frame (one per column).
+    Eigen::Matrix3Xd bodyFixedAccelerations_;
+
+    //! Accelerations computed by the last update (one per column).
+    Eigen::Matrix3Xd currentAccelerations_;
+
+    //! Time of the last update.
+    double currentTime_;
+};
+
+//! Spherical harmonic gravitational acceleration, evaluated using a PackedSphericalHarmonicsGravityField.
+/*!
+ *  Spherical harmonic gravitational acceleration, evaluated using a PackedSphericalHarmonicsGravityField, as a replacement
+ *  for the Tudat SphericalHarmonicsGravitationalAccelerationModel (from which it derives, so that the environment updates
+ *  and dependent variables of the spherical harmonic acceleration are set up as usual). The acceleration is computed by a
+ *  PackedSphericalHarmonicsAccelerationEvaluator, which may be shared by the models of several bodies undergoing the
+ *  acceleration (all of which are then evaluated when the first of these models is updated). Only the direct acceleration
+ *  exerted by the central body on a body without gravity field (i.e. no mutual attraction) is supported. Note that the
+ *  members of the base class are not updated, so that this model cannot be used when estimating parameters or propagating
+ *  variational equations (which use these members to compute the partial derivatives).
+ */
+class PackedSphericalHarmonicsGravitationalAccelerationModel:
+        public tudat::gravitation::SphericalHarmonicsGravitationalAccelerationModel
+{
+public:
+
+    //! Constructor
+    /*!
+     *  Constructor
+     *  \param accelerationEvaluator Evaluator of the acceleration (possibly shared with models of other bodies).
+     *  \param bodyIndex Index of the body undergoing this acceleration in the evaluator.
+     */
+    PackedSphericalHarmonicsGravitationalAccelerationModel(
+            const std::shared_ptr< PackedSphericalHarmonicsAccelerationEvaluator > accelerationEvaluator,
+            const unsigned int bodyIndex ):
+        tudat::gravitation::SphericalHarmonicsGravitationalAccelerationModel(
+            [ = ]( Eigen::Vector3d& position ){
+                position = accelerationEvaluator->getBodyUndergoingAcceleration( bodyIndex )->getPosition( ); },
+            [ = ]( ){ return getPackedAccelerationGravityField(
+                    accelerationEvaluator->getBodyExertingAcceleration( ) )->getGravitationalParameter( ); },
+            getPackedAccelerationGravityField( accelerationEvaluator->getBodyExertingAcceleration( ) )->getReferenceRadius( ),
+            [ = ]( ){ return getPackedAccelerationGravityField(
+                    accelerationEvaluator->getBodyExertingAcceleration( ) )->getCosineCoefficients( ); },
+            [ = ]( ){ return getPackedAccelerationGravityField(
+                    accelerationEvaluator->getBodyExertingAcceleration( ) )->getSineCoefficients( ); },
+            [ = ]( Eigen::Vector3d& position ){
+                position = accelerationEvaluator->getBodyExertingAcceleration( )->getPosition( ); },
+            [ = ]( ){ return accelerationEvaluator->getBodyExertingAcceleration( )->getCurrentRotationToGlobalFrame( ); },
+            false ),
+        accelerationEvaluator_( accelerationEvaluator ), bodyIndex_( bodyIndex )
+    { }
+
+    //! Function to retrieve the current acceleration (as computed by the last call to updateMembers).
+    Eigen::Vector3d getAcceleration( )
+    {
+        return accelerationEvaluator_->getAcceleration( bodyIndex_ );
+    }
+
+    //! Function to update the acceleration to the current time.
+    /*!
+     *  Function to update the acceleration to the current time, from the current states and rotation of the bodies (which
+     *  must have been updated to this time).
+     *  \param currentTime Time at which the acceleration is to be computed.
+     */
+    void updateMembers( const double currentTime = TUDAT_NAN )
+    {
+        if( !( this->currentTime_ == currentTime ) )
+        {
+            accelerationEvaluator_->update( currentTime );
+            this->currentTime_ = currentTime;
+        }
+    }
+
+    //! Function to reset the time of the last update, also resetting the (shared) evaluator.
+    /*!
+     *  Function to reset the time of the last update, also resetting the (shared) evaluator, so that the accelerations of all
+     *  bodies are re-evaluated at the next update (e.g. for the next stage of an integrator, at the same time but with
+     *  different states).
+     *  \param currentTime Time to which the model is reset (NaN forces a re-evaluation at the next update).
+     */
+    void resetTime( const double currentTime = TUDAT_NAN )
+    {
+        this->currentTime_ = currentTime;
+        accelerationEvaluator_->resetTime( currentTime );
+    }
+
+    //! Function to force re-packing of the coefficients (e.g. after these have been modified for a static gravity field).
+    void updateCoefficients( )
+    {
+        accelerationEvaluator_->updateCoefficients( );
+        this->currentTime_ = TUDAT_NAN;
+    }
+
+    //! Function to retrieve the evaluator of the acceleration.
+    std::shared_ptr< PackedSphericalHarmonicsAccelerationEvaluator > getAccelerationEvaluator( )
+    {
+        return accelerationEvaluator_;
+    }
+
+private:
+
+    //! Evaluator of the acceleration (possibly shared with models of other bodies).
+    std::shared_ptr< PackedSphericalHarmonicsAccelerationEvaluator > accelerationEvaluator_;
+
+    //! Index of the body undergoing this acceleration in the evaluator.
+    unsigned int bodyIndex_;
+};
+
+//! Settings for a spherical harmonic acceleration evaluated by a PackedSphericalHarmonicsGravitationalAccelerationModel.
+/*!
+ *  Settings for a spherical harmonic acceleration evaluated by a PackedSphericalHarmonicsGravitationalAccelerationModel. The
+ *  model is only used when the acceleration models are created by createAccelerationModelsMapWithPackedSphericalHarmonics
+ *  (when using createAccelerationModelsMap, the regular Tudat model is created).
+ */
+class PackedSphericalHarmonicAccelerationSettings: public tudat::simulation_setup::SphericalHarmonicAccelerationSettings
+{
+public:
+
+    //! Constructor
+    /*!
+     *  Constructor
+     *  \param maximumDegree Maximum degree of the expansion that is used.
+     *  \param maximumOrder Maximum order of the expansion that is used.
+     */
+    PackedSphericalHarmonicAccelerationSettings( const int maximumDegree, const int maximumOrder ):
+        tudat::simulation_setup::SphericalHarmonicAccelerationSettings( maximumDegree, maximumOrder ){ }
+};
+
+//! Function to create acceleration models, using the packed spherical harmonic model where selected in the settings.
+/*!
+ *  Function to create acceleration models (see Tudat createAccelerationModelsMap), in which each spherical harmonic
+ *  acceleration defined by PackedSphericalHarmonicAccelerationSettings is evaluated by a
+ *  PackedSphericalHarmonicsGravitationalAccelerationModel. The models of all bodies undergoing the acceleration of the same
+ *  body, with the same maximum degree and order (e.g. the members of an ensemble), share a single evaluator, so that their
+ *  accelerations are computed together.
+ *  \param bodyMap List of body objects.
+ *  \param selectedAccelerationPerBody Settings for the accelerations, per body undergoing and exerting acceleration.
+ *  \param propagatedBodies Names of the propagated bodies.
+ *  \param centralBodies Names of the central bodies of the propagation.
+ *  \return Acceleration models, per body undergoing and exerting acceleration.
+ */
+inline tudat::basic_astrodynamics::AccelerationMap createAccelerationModelsMapWithPackedSphericalHarmonics(
+        const tudat::simulation_setup::NamedBodyMap& bodyMap,
+        const tudat::simulation_setup::SelectedAccelerationMap& selectedAccelerationPerBody,
+        const std::vector< std::string >& propagatedBodies,
+        const std::vector< std::string >& centralBodies )
+{
+    using namespace tudat::gravitation;
+
+    tudat::basic_astrodynamics::AccelerationMap accelerationModelMap = tudat::simulation_setup::createAccelerationModelsMap(
+                bodyMap, selectedAccelerationPerBody, propagatedBodies, centralBodies );
+
+    // Models to replace (name of body undergoing acceleration and index of model), per body exerting the acceleration and
+    // maximum degree and order.
+    std::map< std::tuple< std::string, int, int >, std::vector< std::pair< std::string, unsigned int > > > modelsToReplace;
+    for( auto undergoingIterator = selectedAccelerationPerBody.begin( );
+         undergoingIterator != selectedAccelerationPerBody.end( ); undergoingIterator++ )
+    {
+        for( auto exertingIterator = undergoingIterator->second.begin( );
+             exertingIterator != undergoingIterator->second.end( ); exertingIterator++ )
+        {
+            // Retrieve settings of packed spherical harmonic acceleration (if any).
+            std::shared_ptr< PackedSphericalHarmonicAccelerationSettings > packedSettings;
+            for( unsigned int i = 0; i < exertingIterator->second.size( ); i++ )
+            {
+                std::shared_ptr< PackedSphericalHarmonicAccelerationSettings > currentSettings =
+                        std::dynamic_pointer_cast< PackedSphericalHarmonicAccelerationSettings >(
+                            exertingIterator->second.at( i ) );
+                if( currentSettings != nullptr )
+                {
+                    if( packedSettings != nullptr )
+                    {
+                        throw std::runtime_error( "Error, multiple packed spherical harmonic accelerations exerted by " +
+                                                  exertingIterator->first + " on " + undergoingIterator->first + "." );
+                    }
+                    packedSettings = currentSettings;
+                }
+            }
+
+            if( packedSettings == nullptr )
+            {
+                continue;
+            }
+
+            // Find the (direct) spherical harmonic acceleration model created by Tudat.
+            std::vector< std::shared_ptr< tudat::basic_astrodynamics::AccelerationModel< Eigen::Vector3d > > >&
+                    accelerationModels = accelerationModelMap.at( undergoingIterator->first ).at( exertingIterator->first );
+            bool isModelFound = false;
+            for( unsigned int i = 0; i < accelerationModels.size( ); i++ )
+            {
+                std::shared_ptr< SphericalHarmonicsGravitationalAccelerationModel > sphericalHarmonicModel =
+                        std::dynamic_pointer_cast< SphericalHarmonicsGravitationalAccelerationModel >(
+                            accelerationModels.at( i ) );
+                if( sphericalHarmonicModel != nullptr )
+                {
+                    if( sphericalHarmonicModel->getIsMutualAttractionUsed( ) )
+                    {
+                        throw std::runtime_error( "Error, packed spherical harmonic acceleration not supported for mutual "
+                                                  "attraction (exerted by " + exertingIterator->first + " on " +
+                                                  undergoingIterator->first + ")." );
+                    }
+                    modelsToReplace[ std::make_tuple( exertingIterator->first, packedSettings->maximumDegree_,
+                                                      packedSettings->maximumOrder_ ) ].push_back(
+                                std::make_pair( undergoingIterator->first, i ) );
+                    isModelFound = true;
+                }
+            }
+
+            if( !isModelFound )
+            {
+                throw std::runtime_error( "Error, packed spherical harmonic acceleration is only supported for the central "
+                                          "body (exerted by " + exertingIterator->first + " on " +
+                                          undergoingIterator->first + ")." );
+            }
+        }
+    }
+
+    // Replace the models, using a single evaluator for all bodies undergoing the same acceleration.
+    for( auto groupIterator = modelsToReplace.begin( ); groupIterator != modelsToReplace.end( ); groupIterator++ )
+    {
+        const std::string& bodyExertingAcceleration = std::get< 0 >( groupIterator->first );
+        std::vector< std::shared_ptr< tudat::simulation_setup::Body > > bodiesUndergoingAcceleration;
+        for( unsigned int i = 0; i < groupIterator->second.size( ); i++ )
+        {
+            bodiesUndergoingAcceleration.push_back( bodyMap.at( groupIterator->second.at( i ).first ) );
+        }
+
+        std::shared_ptr< PackedSphericalHarmonicsAccelerationEvaluator > accelerationEvaluator =
+                std::make_shared< PackedSphericalHarmonicsAccelerationEvaluator >(
+                    bodiesUndergoingAcceleration, bodyMap.at( bodyExertingAcceleration ),
+                    std::get< 1 >( groupIterator->first ), std::get< 2 >( groupIterator->first ) );
+        for( unsigned int i = 0; i < groupIterator->second.size( ); i++ )
+        {
+            accelerationModelMap.at( groupIterator->second.at( i ).first ).at( bodyExertingAcceleration ).at(
+                        groupIterator->second.at( i ).second ) =
+                    std::make_shared< PackedSphericalHarmonicsGravitationalAccelerationModel >( accelerationEvaluator, i );
+        }
+    }
+
+    return accelerationModelMap;
+}
+
+}
+
+#endif // TUDAT_PACKEDSPHERICALHARMONICSACCELERATION_H
@@ -0,0 +1,212 @@
+/*    Copyright (c) 2010-2018, Delft University of Technology
+ *    All rigths reserved
+ *
+ *    This file is part of the Tudat. Redistribution and use in source and
+ *    binary forms, with or without modification, are permitted exclusively
+ *    under the terms of the Modified BSD license. You should have received
+ *    a copy of the license with this file. If not, please or visit:
+ *    http://tudat.tudelft.nl/LICENSE.
+ */
+
+#ifndef TUDAT_PROPAGATIONCHECKPOINT_H
+#define TUDAT_PROPAGATIONCHECKPOINT_H
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include <boost/filesystem.hpp>
+
+namespace tudat_applications
+{
+
+//! Settings for periodically checkpointing a single-arc propagation, so that it can be resumed after an interruption.
+struct PropagationCheckpointSettings
+{
+    //! Constructor
+    /*!
+     *  Constructor
+     *  \param checkpointFilePath Path of the file to which the checkpoint is written (and from which it is resumed).
+     *  \param checkpointInterval Wall-clock time (in seconds) between consecutive checkpoints.
+     */
+    PropagationCheckpointSettings( const std::string& checkpointFilePath, const double checkpointInterval = 600.0 ):
+        checkpointFilePath_( checkpointFilePath ), checkpointInterval_( checkpointInterval ){ }
+
+    //! Path of the file to which the checkpoint is written (and from which it is resumed).
+    std::string checkpointFilePath_;
+
+    //! Wall-clock time (in seconds) between consecutive checkpoints.
+    double checkpointInterval_;
+};
+
+//! Function to write a single value (of a trivially copyable type) to a checkpoint stream.
+template< typename ValueType >
+void writeCheckpointValue( std::ostream& checkpointStream, const ValueType& value )
+{
+    checkpointStream.write( reinterpret_cast< const char* >( &value ), sizeof( ValueType ) );
+}
+
+//! Function to read a single value (of a trivially copyable type) from a checkpoint stream.
+template< typename ValueType >
+void readCheckpointValue( std::istream& checkpointStream, ValueType& value )
+{
+    checkpointStream.read( reinterpret_cast< char* >( &value ), sizeof( ValueType ) );
+}
+
+//! Function to write a vector to a checkpoint stream, preceded by its size.
+template< typename ScalarType >
+void writeCheckpointVector( std::ostream& checkpointStream,
+                            const Eigen::Matrix< ScalarType, Eigen::Dynamic, 1 >& vector )
+{
+    writeCheckpointValue( checkpointStream, static_cast< std::uint64_t >( vector.rows( ) ) );
+    checkpointStream.write( reinterpret_cast< const char* >( vector.data( ) ), vector.rows( ) * sizeof( ScalarType ) );
+}
+
+//! Function to read a vector (preceded by its size) from a checkpoint stream.
+template< typename ScalarType >
+void readCheckpointVector( std::istream& checkpointStream, Eigen::Matrix< ScalarType, Eigen::Dynamic, 1 >& vector )
+{
+    std::uint64_t vectorSize = 0;
+    readCheckpointValue( checkpointStream, vectorSize );
+    vector.resize( vectorSize );
+    checkpointStream.read( reinterpret_cast< char* >( vector.data( ) ), vectorSize * sizeof( ScalarType ) );
+}
+
+//! Integrator and output state stored in a propagation checkpoint.
+/*!
+ *  Integrator and output state stored in a propagation checkpoint. For the integrator, only the current time, state and
+ *  step size are stored, so that only propagations with a single-step integrator can be resumed (exactly). The output
+ *  state consists of the data with which each sink of the propagation is resumed (see
+ *  StateHistorySink::writeCheckpointData), so that the output of a resumed propagation is identical to that of an
+ *  uninterrupted one.
+ */
+template< typename StateScalarType = double, typename TimeType = double >
+struct PropagationCheckpoint
+{
+    //! Current time of the propagation.
+    TimeType currentTime;
+
+    //! Step size that is to be used for the next step.
+    TimeType nextTimeStep;
+
+    //! Number of function evaluations up to the checkpoint.
+    std::uint64_t numberOfFunctionEvaluations;
+
+    //! Current propagated state (in the formulation used by the propagator, e.g. Encke deviation or USM elements).
+    Eigen::Matrix< StateScalarType, Eigen::Dynamic, Eigen::Dynamic > currentState;
+
+    //! Data with which each of the sinks of the propagation is resumed.
+    std::vector< std::string > sinkCheckpointData;
+};
+
+//! Function to write a propagation checkpoint to file.
+/*!
+ *  Function to write a propagation checkpoint to file. The checkpoint is written to a temporary file, which is then
+ *  renamed, so that an interruption while writing leaves the previous checkpoint intact.
+ *  \param checkpoint Checkpoint that is to be written.
+ *  \param checkpointFilePath Path of the checkpoint file.
+ */
+template< typename StateScalarType, typename TimeType >
+void writePropagationCheckpoint( const PropagationCheckpoint< StateScalarType, TimeType >& checkpoint,
+                                 const std::string& checkpointFilePath )
+{
+    const std::string temporaryFilePath = checkpointFilePath + ".tmp";
+    {
+        std::ofstream checkpointFile( temporaryFilePath, std::ios::binary | std::ios::trunc );
+        if( !checkpointFile.is_open( ) )
+        {
+            throw std::runtime_error( "Error, could not open propagation checkpoint " + temporaryFilePath );
+        }
+
+        const char checkpointIdentifier[ 8 ] = { 'T', 'U', 'D', 'A', 'T', 'C', 'P', '2' };
+        std::uint32_t scalarSizes[ 2 ] = { sizeof( StateScalarType ), sizeof( TimeType ) };
+        std::uint64_t stateSize[ 2 ] = { static_cast< std::uint64_t >( checkpoint.currentState.rows( ) ),
+                                         static_cast< std::uint64_t >( checkpoint.currentState.cols( ) ) };
+
+        checkpointFile.write( checkpointIdentifier, sizeof( checkpointIdentifier ) );
+        checkpointFile.write( reinterpret_cast< const char* >( scalarSizes ), sizeof( scalarSizes ) );
+        checkpointFile.write( reinterpret_cast< const char* >( stateSize ), sizeof( stateSize ) );
+        checkpointFile.write( reinterpret_cast< const char* >( &checkpoint.currentTime ), sizeof( TimeType ) );
+        checkpointFile.write( reinterpret_cast< const char* >( &checkpoint.nextTimeStep ), sizeof( TimeType ) );
+        checkpointFile.write( reinterpret_cast< const char* >( &checkpoint.numberOfFunctionEvaluations ),
+                              sizeof( std::uint64_t ) );
+        checkpointFile.write( reinterpret_cast< const char* >( checkpoint.currentState.data( ) ),
+                              checkpoint.currentState.size( ) * sizeof( StateScalarType ) );
+        writeCheckpointValue( checkpointFile, static_cast< std::uint64_t >( checkpoint.sinkCheckpointData.size( ) ) );
+        for( unsigned int i = 0; i < checkpoint.sinkCheckpointData.size( ); i++ )
+        {
+            writeCheckpointValue( checkpointFile,
+                                  static_cast< std::uint64_t >( checkpoint.sinkCheckpointData.at( i ).size( ) ) );
+            checkpointFile.write( checkpoint.sinkCheckpointData.at( i ).data( ),
+                                  checkpoint.sinkCheckpointData.at( i ).size( ) );
+        }
+        if( !checkpointFile )
+        {
+            throw std::runtime_error( "Error when writing propagation checkpoint " + temporaryFilePath );
+        }
+    }
+    boost::filesystem::rename( temporaryFilePath, checkpointFilePath );
+}
+
+//! Function to read a propagation checkpoint from file.
+/*!
+ *  Function to read a propagation checkpoint from file.
+ *  \param checkpointFilePath Path of the checkpoint file.
+ *  \param checkpoint Checkpoint read from file (returned by reference).
+ *  \return True if a valid checkpoint was read, false if the file does not exist.
+ */
+template< typename StateScalarType, typename TimeType >
+bool readPropagationCheckpoint( const std::string& checkpointFilePath,
+                                PropagationCheckpoint< StateScalarType, TimeType >& checkpoint )
+{
+    std::ifstream checkpointFile( checkpointFilePath, std::ios::binary );
+    if( !checkpointFile.is_open( ) )
+    {
+        return false;
+    }
+
+    char checkpointIdentifier[ 8 ];
+    std::uint32_t scalarSizes[ 2 ];
+    std::uint64_t stateSize[ 2 ];
+    checkpointFile.read( checkpointIdentifier, sizeof( checkpointIdentifier ) );
+    checkpointFile.read( reinterpret_cast< char* >( scalarSizes ), sizeof( scalarSizes ) );
+    checkpointFile.read( reinterpret_cast< char* >( stateSize ), sizeof( stateSize ) );
+    if( !checkpointFile || std::memcmp( checkpointIdentifier, "TUDATCP2", 8 ) != 0 ||
+            scalarSizes[ 0 ] != sizeof( StateScalarType ) || scalarSizes[ 1 ] != sizeof( TimeType ) )
+    {
+        throw std::runtime_error( "Error, " + checkpointFilePath + " is not a compatible propagation checkpoint." );
+    }
+
+    checkpoint.currentState.resize( stateSize[ 0 ], stateSize[ 1 ] );
+    checkpointFile.read( reinterpret_cast< char* >( &checkpoint.currentTime ), sizeof( TimeType ) );
+    checkpointFile.read( reinterpret_cast< char* >( &checkpoint.nextTimeStep ), sizeof( TimeType ) );
+    checkpointFile.read( reinterpret_cast< char* >( &checkpoint.numberOfFunctionEvaluations ), sizeof( std::uint64_t ) );
+    checkpointFile.read( reinterpret_cast< char* >( checkpoint.currentState.data( ) ),
+                         checkpoint.currentState.size( ) * sizeof( StateScalarType ) );
+    std::uint64_t numberOfSinks = 0;
+    readCheckpointValue( checkpointFile, numberOfSinks );
+    checkpoint.sinkCheckpointData.clear( );
+    for( std::uint64_t i = 0; checkpointFile && i < numberOfSinks; i++ )
+    {
+        std::uint64_t sinkDataSize = 0;
+        readCheckpointValue( checkpointFile, sinkDataSize );
+        checkpoint.sinkCheckpointData.push_back( std::string( sinkDataSize, '\0' ) );
+        checkpointFile.read( &checkpoint.sinkCheckpointData.back( )[ 0 ], sinkDataSize );
+    }
+    if( !checkpointFile )
+    {
+        throw std::runtime_error( "Error, propagation checkpoint " + checkpointFilePath + " is incomplete." );
+    }
+    return true;
+}
+
+}
+
+#endif // TUDAT_PROPAGATIONCHECKPOINT_H
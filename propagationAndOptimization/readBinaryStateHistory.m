@@ -0,0 +1,85 @@
+function [data, caseTag] = readBinaryStateHistory(filePath, baseOffset)
+% Read a binary state history written by writeDataMapToBinaryFile (see binaryStateHistoryOutput.h).
+%
+% The file is memory-mapped, and returned as a matrix with the same layout as obtained when using load on the text
+% output of writeDataMapToTextFile: the first column contains the epochs, and the remaining columns the states. Long
+% double (x87 extended precision) entries are converted to double precision. The optional baseOffset is the position
+% (in bytes) of the state history in the file, used to read entries of a campaign archive (see readCampaignArchiveEntry).
+
+if( nargin < 2 )
+    baseOffset = 0;
+end
+
+headerMap = memmapfile(filePath, 'Format', { ...
+    'uint8', [1 8], 'fileIdentifier'; ...
+    'uint32', [1 8], 'typeInformation'; ...
+    'uint64', [1 4], 'sizeInformation'; ...
+    'uint8', [1 184], 'caseTag' }, 'Offset', baseOffset, 'Repeat', 1);
+header = headerMap.Data;
+
+if( ~strcmp(char(header.fileIdentifier(1:7)), 'TUDATSH') )
+    error(strcat('Error, no binary state history found in ', filePath));
+end
+if( header.typeInformation(3) ~= hex2dec('01020304') )
+    error('Error, binary state history was written with different byte order');
+end
+
+epochScalarType = header.typeInformation(4);
+stateScalarType = header.typeInformation(6);
+stateScalarSize = double(header.typeInformation(7));
+numberOfEpochs = double(header.sizeInformation(1));
+stateSize = double(header.sizeInformation(2));
+epochColumnOffset = baseOffset + double(header.sizeInformation(3));
+stateColumnsOffset = baseOffset + double(header.sizeInformation(4));
+
+tagEnd = find(header.caseTag == 0, 1) - 1;
+if( isempty(tagEnd) )
+    tagEnd = length(header.caseTag);
+end
+caseTag = char(header.caseTag(1:tagEnd));
+
+if( epochScalarType ~= 2 )
+    error('Error, only double precision epochs are supported');
+end
+
+data = zeros(numberOfEpochs, stateSize + 1);
+if( numberOfEpochs == 0 )
+    return
+end
+
+epochMap = memmapfile(filePath, 'Format', {'double', [numberOfEpochs 1], 'epochs'}, ...
+    'Offset', epochColumnOffset, 'Repeat', 1);
+data(:,1) = epochMap.Data.epochs;
+
+if( stateSize == 0 )
+    return
+end
+
+if( stateScalarType == 1 )
+    stateMap = memmapfile(filePath, 'Format', {'single', [numberOfEpochs stateSize], 'states'}, ...
+        'Offset', stateColumnsOffset, 'Repeat', 1);
+    data(:,2:end) = double(stateMap.Data.states);
+elseif( stateScalarType == 2 )
+    stateMap = memmapfile(filePath, 'Format', {'double', [numberOfEpochs stateSize], 'states'}, ...
+        'Offset', stateColumnsOffset, 'Repeat', 1);
+    data(:,2:end) = stateMap.Data.states;
+elseif( stateScalarType == 3 )
+    % x87 extended precision: 64-bit mantissa (with explicit integer bit), followed by sign bit and 15-bit exponent.
+    stateMap = memmapfile(filePath, 'Format', {'uint8', [stateScalarSize numberOfEpochs*stateSize], 'states'}, ...
+        'Offset', stateColumnsOffset, 'Repeat', 1);
+    rawValues = stateMap.Data.states;
+    mantissa = zeros(1, numberOfEpochs*stateSize);
+    for byteIndex = 8:-1:1
+        mantissa = mantissa * 256 + double(rawValues(byteIndex,:));
+    end
+    signAndExponent = double(rawValues(9,:)) + 256 * double(rawValues(10,:));
+    exponent = mod(signAndExponent, 32768);
+    signs = 1 - 2 * (signAndExponent >= 32768);
+    values = signs .* pow2(mantissa * 2^-63, exponent - 16383);
+    values(exponent == 0 & mantissa == 0) = 0;
+    data(:,2:end) = reshape(values, numberOfEpochs, stateSize);
+else
+    error('Error, state scalar type of binary state history not supported');
+end
+
+end
@@ -0,0 +1,14 @@
+function data = readCampaignArchiveEntry(archive, caseKey)
+% Read a single state history from a campaign archive opened by openCampaignArchive.
+%
+% The entry is memory-mapped directly from its offset in the archive, and returned in the same format as by
+% readBinaryStateHistory (first column epochs, remaining columns states).
+
+if( ~isKey(archive.index, caseKey) )
+    error(strcat('Error, entry ', caseKey, ' not found in campaign archive ', archive.filePath));
+end
+
+entryLocation = archive.index(caseKey);
+data = readBinaryStateHistory(archive.filePath, entryLocation(1));
+
+end
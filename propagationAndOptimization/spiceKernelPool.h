@@ -0,0 +1,166 @@
+/*    Copyright (c) 2010-2018, Delft University of Technology
+ *    All rigths reserved
+ *
+ *    This file is part of the Tudat. Redistribution and use in source and
+ *    binary forms, with or without modification, are permitted exclusively
+ *    under the terms of the Modified BSD license. You should have received
+ *    a copy of the license with this file. If not, please or visit:
+ *    http://tudat.tudelft.nl/LICENSE.
+ */
+
+#ifndef TUDAT_SPICEKERNELPOOL_H
+#define TUDAT_SPICEKERNELPOOL_H
+
+#include <algorithm>
+#include <cstdlib>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <Tudat/External/SpiceInterface/spiceInterface.h>
+#include <Tudat/InputOutput/basicInputOutput.h>
+
+#include "propagationAndOptimization/sweepExecutor.h"
+
+namespace tudat_applications
+{
+
+//! Sets of SPICE kernels used by the applications.
+enum SpiceKernelSet
+{
+    //! Planetary constants, gravitational parameters, ephemerides and leap seconds (as spice_interface::loadStandardSpiceKernels).
+    standard_spice_kernels,
+
+    //! High-accuracy lunar orientation (DE421 principal axes) and associated frame definitions.
+    lunar_orientation_spice_kernels
+};
+
+//! Get list of ephemeris kernels that are to be loaded as part of the standard kernel set.
+/*!
+ *  Get list of ephemeris kernels that are to be loaded as part of the standard kernel set. The list is read from the
+ *  environment variable TUDAT_APPLICATION_EPHEMERIS_KERNELS (as a colon-separated list of file names) if it is set, and
+ *  consists of the merged Tudat ephemeris kernel otherwise. When running a campaign, the variable can be used to point to
+ *  a kernel containing only the segments for the bodies and time interval that are used (e.g. created once with the NAIF
+ *  spkmerge utility), which reduces the amount of data that has to be read by each run.
+ *  \return List of ephemeris kernel files.
+ */
+inline std::vector< std::string > getEphemerisKernelFiles( )
+{
+    std::vector< std::string > ephemerisKernels;
+    const char* ephemerisKernelsSetting = std::getenv( "TUDAT_APPLICATION_EPHEMERIS_KERNELS" );
+    if( ephemerisKernelsSetting != NULL && std::string( ephemerisKernelsSetting ) != "" )
+    {
+        std::stringstream kernelListStream( ephemerisKernelsSetting );
+        std::string kernelFile;
+        while( std::getline( kernelListStream, kernelFile, ':' ) )
+        {
+            if( kernelFile != "" )
+            {
+                ephemerisKernels.push_back( kernelFile );
+            }
+        }
+    }
+    else
+    {
+        ephemerisKernels.push_back( tudat::input_output::getSpiceKernelPath( ) + "tudat_merged_spk_kernel.bsp" );
+    }
+    return ephemerisKernels;
+}
+
+//! Get list of kernel files in a given kernel set.
+/*!
+ *  Get list of kernel files in a given kernel set.
+ *  \param kernelSet Kernel set for which the files are to be retrieved.
+ *  \param alternativeEphemerisKernels Ephemeris kernels to be used instead of those of getEphemerisKernelFiles (only used
+ *  for standard_spice_kernels, ignored if empty).
+ *  \return List of kernel files, in the order in which they are to be loaded.
+ */
+inline std::vector< std::string > getSpiceKernelSetFiles(
+        const SpiceKernelSet kernelSet,
+        const std::vector< std::string >& alternativeEphemerisKernels = std::vector< std::string >( ) )
+{
+    std::string kernelPath = tudat::input_output::getSpiceKernelPath( );
+    std::vector< std::string > kernelFiles;
+    switch( kernelSet )
+    {
+    case standard_spice_kernels:
+    {
+        kernelFiles.push_back( kernelPath + "pck00010.tpc" );
+        kernelFiles.push_back( kernelPath + "gm_de431.tpc" );
+        std::vector< std::string > ephemerisKernels =
+                alternativeEphemerisKernels.size( ) > 0 ? alternativeEphemerisKernels : getEphemerisKernelFiles( );
+        kernelFiles.insert( kernelFiles.end( ), ephemerisKernels.begin( ), ephemerisKernels.end( ) );
+        kernelFiles.push_back( kernelPath + "naif0012.tls" );
+        break;
+    }
+    case lunar_orientation_spice_kernels:
+        kernelFiles.push_back( kernelPath + "moon_pa_de421_1900-2050.bpc" );
+        kernelFiles.push_back( kernelPath + "moon_080317.tf" );
+        kernelFiles.push_back( kernelPath + "moon_assoc_pa.tf" );
+        break;
+    default:
+        throw std::runtime_error( "Error, SPICE kernel set not recognized." );
+    }
+    return kernelFiles;
+}
+
+//! Get list of kernel files that have been loaded by loadSpiceKernelsOnce, in order of loading.
+/*!
+ *  Get list of kernel files that have been loaded by loadSpiceKernelsOnce, in order of loading. Access to the list must be
+ *  protected by the SPICE interface mutex.
+ *  \return List of loaded kernel files.
+ */
+inline std::vector< std::string >& getLoadedSpiceKernelFiles( )
+{
+    static std::vector< std::string > loadedKernelFiles;
+    return loadedKernelFiles;
+}
+
+//! Function to load a list of SPICE kernels, skipping kernels that have already been loaded by this function.
+/*!
+ *  Function to load a list of SPICE kernels, skipping kernels that have already been loaded by this function. Loading a
+ *  kernel into CSPICE a second time does not replace the earlier copy, but adds it again to the kernel pool (so that the
+ *  pool grows, and lookups become slower), which this function prevents when kernels are requested by several parts of
+ *  an application. The function may be called from any thread, as it locks the SPICE interface mutex.
+ *  \param kernelFiles List of kernel files that are to be loaded (if not yet loaded).
+ *  \return Number of kernels that were loaded by this call.
+ */
+inline unsigned int loadSpiceKernelsOnce( const std::vector< std::string >& kernelFiles )
+{
+    std::lock_guard< std::recursive_mutex > lock( getSpiceInterfaceMutex( ) );
+
+    std::vector< std::string >& loadedKernelFiles = getLoadedSpiceKernelFiles( );
+    unsigned int numberOfLoadedKernels = 0;
+    for( unsigned int i = 0; i < kernelFiles.size( ); i++ )
+    {
+        if( std::find( loadedKernelFiles.begin( ), loadedKernelFiles.end( ), kernelFiles.at( i ) ) ==
+                loadedKernelFiles.end( ) )
+        {
+            tudat::spice_interface::loadSpiceKernelInTudat( kernelFiles.at( i ) );
+            loadedKernelFiles.push_back( kernelFiles.at( i ) );
+            numberOfLoadedKernels++;
+        }
+    }
+    return numberOfLoadedKernels;
+}
+
+//! Function to load a set of SPICE kernels, if not yet loaded.
+/*!
+ *  Function to load a set of SPICE kernels, if not yet loaded (see loadSpiceKernelsOnce). This function replaces direct
+ *  calls to spice_interface::loadStandardSpiceKernels and spice_interface::loadSpiceKernelInTudat in the applications.
+ *  \param kernelSet Kernel set that is to be loaded.
+ *  \param alternativeEphemerisKernels Ephemeris kernels to be used instead of those of getEphemerisKernelFiles (only used
+ *  for standard_spice_kernels, ignored if empty).
+ */
+inline void loadSpiceKernelSet(
+        const SpiceKernelSet kernelSet,
+        const std::vector< std::string >& alternativeEphemerisKernels = std::vector< std::string >( ) )
+{
+    loadSpiceKernelsOnce( getSpiceKernelSetFiles( kernelSet, alternativeEphemerisKernels ) );
+}
+
+}
+
+#endif // TUDAT_SPICEKERNELPOOL_H
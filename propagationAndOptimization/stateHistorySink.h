@@ -0,0 +1,1079 @@
+/*    Copyright (c) 2010-2018, Delft University of Technology
+ *    All rigths reserved
+ *
+ *    This file is part of the Tudat. Redistribution and use in source and
+ *    binary forms, with or without modification, are permitted exclusively
+ *    under the terms of the Modified BSD license. You should have received
+ *    a copy of the license with this file. If not, please or visit:
+ *    http://tudat.tudelft.nl/LICENSE.
+ */
+
+#ifndef TUDAT_STATEHISTORYSINK_H
+#define TUDAT_STATEHISTORYSINK_H
+
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <limits>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include <Tudat/SimulationSetup/tudatSimulationHeader.h>
+
+#include "propagationAndOptimization/butcherTableauIntegrator.h"
+#include "propagationAndOptimization/fixedSizeCowellStateDerivative.h"
+#include "propagationAndOptimization/flatStateHistory.h"
+#include "propagationAndOptimization/gaussJacksonIntegrator.h"
+#include "propagationAndOptimization/outputSchedule.h"
+#include "propagationAndOptimization/propagationCheckpoint.h"
+
+namespace tudat_applications
+{
+
+//! Base class for objects that process the propagated state at each integration step, as it is computed.
+/*!
+ *  Base class for objects that process the propagated state at each integration step, as it is computed (see
+ *  propagateToStateHistorySinks). Derived classes decide what (if anything) is retained, so that a propagation does not
+ *  need to keep the full state history in memory.
+ */
+template< typename StateScalarType = double, typename TimeType = double >
+class StateHistorySink
+{
+public:
+
+    //! Destructor
+    virtual ~StateHistorySink( ){ }
+
+    //! Function to process the (conventional, e.g. Cartesian) state at a single epoch. Epochs are provided in order.
+    virtual void processState( const TimeType time, const Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 >& state ) = 0;
+
+    //! Function to process the derivative of the state at the epoch of the last processed state.
+    /*!
+     *  Function to process the derivative of the (conventional) state at the epoch of the last processed state, where this
+     *  is retained by the integrator (see StepStartStateDerivativeInterface). The derivative at an epoch is provided after
+     *  the step starting at that epoch has been taken, and before the state at the end of that step is processed, so that
+     *  it is not provided for the final state. Derivatives are ignored by default.
+     *  \param time Epoch of the last processed state.
+     *  \param stateDerivative Derivative of the state at this epoch.
+     */
+    virtual void processStateDerivative( const TimeType time,
+                                         const Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 >& stateDerivative ){ }
+
+    //! Function called once after the last state has been processed.
+    virtual void finalize( ){ }
+
+    //! Function to check whether the sink can be resumed from a propagation checkpoint (see writeCheckpointData).
+    virtual bool isCheckpointSupported( ) const { return false; }
+
+    //! Function to write the data needed to resume the sink from a propagation checkpoint.
+    /*!
+     *  Function to write the data needed to resume the sink from a propagation checkpoint (i.e. what it retains of the
+     *  states processed so far), called by propagateToStateHistorySinks whenever a checkpoint is written. Sinks that
+     *  support checkpoints override this function, readCheckpointData and isCheckpointSupported.
+     *  \param checkpointStream Stream to which the data is written.
+     */
+    virtual void writeCheckpointData( std::ostream& checkpointStream )
+    {
+        throw std::runtime_error( "Error, state history sink does not support propagation checkpoints." );
+    }
+
+    //! Function to resume the sink from the data written to a propagation checkpoint, before any state is processed.
+    /*!
+     *  Function to resume the sink from the data written to a propagation checkpoint (see writeCheckpointData), called by
+     *  propagateToStateHistorySinks before any state is processed, when a propagation is resumed.
+     *  \param checkpointStream Stream from which the data is read.
+     */
+    virtual void readCheckpointData( std::istream& checkpointStream )
+    {
+        throw std::runtime_error( "Error, state history sink does not support propagation checkpoints." );
+    }
+};
+
+//! Sink calling a user-defined function for each state (e.g. to compare the state to an analytical solution).
+template< typename StateScalarType = double, typename TimeType = double >
+class FunctionStateHistorySink: public StateHistorySink< StateScalarType, TimeType >
+{
+public:
+
+    //! Constructor
+    /*!
+     *  Constructor
+     *  \param stateFunction Function that is to be called with each epoch and state.
+     */
+    FunctionStateHistorySink( const std::function< void( const TimeType,
+                                                         const Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 >& ) >
+                              stateFunction ):
+        stateFunction_( stateFunction ){ }
+
+    //! Function to process the state at a single epoch, calling the user-defined function.
+    void processState( const TimeType time, const Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 >& state )
+    {
+        stateFunction_( time, state );
+    }
+
+private:
+
+    //! Function that is called with each epoch and state.
+    std::function< void( const TimeType, const Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 >& ) > stateFunction_;
+};
+
+//! Sink transforming each state (e.g. to a different frame, or to a difference w.r.t. a reference) before passing it on.
+template< typename StateScalarType = double, typename TimeType = double >
+class TransformedStateHistorySink: public StateHistorySink< StateScalarType, TimeType >
+{
+public:
+
+    //! Typedef for state transformation function.
+    typedef std::function< Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 >(
+            const TimeType, const Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 >& ) > StateTransformationFunction;
+
+    //! Constructor
+    /*!
+     *  Constructor
+     *  \param stateTransformation Function transforming the state at a given epoch.
+     *  \param targetSink Sink to which the transformed states are passed.
+     */
+    TransformedStateHistorySink(
+            const StateTransformationFunction stateTransformation,
+            const std::shared_ptr< StateHistorySink< StateScalarType, TimeType > > targetSink ):
+        stateTransformation_( stateTransformation ), targetSink_( targetSink ){ }
+
+    //! Function to process the state at a single epoch, passing the transformed state to the target sink.
+    void processState( const TimeType time, const Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 >& state )
+    {
+        targetSink_->processState( time, stateTransformation_( time, state ) );
+    }
+
+    //! Function to finalize the target sink.
+    void finalize( )
+    {
+        targetSink_->finalize( );
+    }
+
+    //! Function to check whether the target sink can be resumed from a propagation checkpoint.
+    bool isCheckpointSupported( ) const { return targetSink_->isCheckpointSupported( ); }
+
+    //! Function to write the checkpoint data of the target sink.
+    void writeCheckpointData( std::ostream& checkpointStream )
+    {
+        targetSink_->writeCheckpointData( checkpointStream );
+    }
+
+    //! Function to resume the target sink from checkpoint data.
+    void readCheckpointData( std::istream& checkpointStream )
+    {
+        targetSink_->readCheckpointData( checkpointStream );
+    }
+
+private:
+
+    //! Function transforming the state at a given epoch.
+    StateTransformationFunction stateTransformation_;
+
+    //! Sink to which the transformed states are passed.
+    std::shared_ptr< StateHistorySink< StateScalarType, TimeType > > targetSink_;
+};
+
+//! Sink retaining only the initial and final epoch and state of the propagation.
+template< typename StateScalarType = double, typename TimeType = double >
+class BoundaryStateHistorySink: public StateHistorySink< StateScalarType, TimeType >
+{
+public:
+
+    //! Constructor
+    BoundaryStateHistorySink( ): numberOfProcessedStates_( 0 ){ }
+
+    //! Function to process the state at a single epoch, retaining it if it is the first or (so far) last state.
+    void processState( const TimeType time, const Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 >& state )
+    {
+        if( numberOfProcessedStates_ == 0 )
+        {
+            initialTime_ = time;
+            initialState_ = state;
+        }
+        finalTime_ = time;
+        finalState_ = state;
+        numberOfProcessedStates_++;
+    }
+
+    //! Function to retrieve the initial epoch.
+    TimeType getInitialTime( ) const { return initialTime_; }
+
+    //! Function to retrieve the initial state.
+    const Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 >& getInitialState( ) const { return initialState_; }
+
+    //! Function to retrieve the final epoch.
+    TimeType getFinalTime( ) const { return finalTime_; }
+
+    //! Function to retrieve the final state.
+    const Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 >& getFinalState( ) const { return finalState_; }
+
+    //! Function to retrieve the number of states that were processed (i.e. number of integration steps plus one).
+    unsigned int getNumberOfProcessedStates( ) const { return numberOfProcessedStates_; }
+
+    //! Function to check whether the sink can be resumed from a propagation checkpoint.
+    bool isCheckpointSupported( ) const { return true; }
+
+    //! Function to write the retained epochs and states to a checkpoint.
+    void writeCheckpointData( std::ostream& checkpointStream )
+    {
+        writeCheckpointValue( checkpointStream, numberOfProcessedStates_ );
+        if( numberOfProcessedStates_ > 0 )
+        {
+            writeCheckpointValue( checkpointStream, initialTime_ );
+            writeCheckpointVector( checkpointStream, initialState_ );
+            writeCheckpointValue( checkpointStream, finalTime_ );
+            writeCheckpointVector( checkpointStream, finalState_ );
+        }
+    }
+
+    //! Function to resume the sink from checkpoint data.
+    void readCheckpointData( std::istream& checkpointStream )
+    {
+        readCheckpointValue( checkpointStream, numberOfProcessedStates_ );
+        if( numberOfProcessedStates_ > 0 )
+        {
+            readCheckpointValue( checkpointStream, initialTime_ );
+            readCheckpointVector( checkpointStream, initialState_ );
+            readCheckpointValue( checkpointStream, finalTime_ );
+            readCheckpointVector( checkpointStream, finalState_ );
+        }
+    }
+
+private:
+
+    //! Initial epoch.
+    TimeType initialTime_;
+
+    //! Initial state.
+    Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 > initialState_;
+
+    //! Final epoch.
+    TimeType finalTime_;
+
+    //! Final state.
+    Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 > finalState_;
+
+    //! Number of states that were processed.
+    unsigned int numberOfProcessedStates_;
+};
+
+//! Sink retaining the full state history, at every saveFrequency-th step, in the format returned by the dynamics simulator.
+template< typename StateScalarType = double, typename TimeType = double >
+class StoredStateHistorySink: public StateHistorySink< StateScalarType, TimeType >
+{
+public:
+
+    //! Constructor
+    /*!
+     *  Constructor
+     *  \param saveFrequency Frequency (in number of steps) at which states are to be retained (final state is always
+     *  retained).
+     */
+    StoredStateHistorySink( const unsigned int saveFrequency = 1 ):
+        saveFrequency_( saveFrequency > 0 ? saveFrequency : 1 ), numberOfProcessedStates_( 0 ){ }
+
+    //! Function to process the state at a single epoch, retaining it if required by the save frequency.
+    void processState( const TimeType time, const Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 >& state )
+    {
+        if( numberOfProcessedStates_ % saveFrequency_ == 0 )
+        {
+            stateHistory_[ time ] = state;
+        }
+        lastTime_ = time;
+        lastState_ = state;
+        numberOfProcessedStates_++;
+    }
+
+    //! Function to add the final state to the history, if it was not retained due to the save frequency.
+    void finalize( )
+    {
+        if( numberOfProcessedStates_ > 0 )
+        {
+            stateHistory_[ lastTime_ ] = lastState_;
+        }
+    }
+
+    //! Function to retrieve the retained state history.
+    const std::map< TimeType, Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 > >& getStateHistory( ) const
+    {
+        return stateHistory_;
+    }
+
+    //! Function to check whether the sink can be resumed from a propagation checkpoint.
+    bool isCheckpointSupported( ) const { return true; }
+
+    //! Function to write the retained state history to a checkpoint.
+    void writeCheckpointData( std::ostream& checkpointStream )
+    {
+        writeCheckpointValue( checkpointStream, numberOfProcessedStates_ );
+        writeCheckpointValue( checkpointStream, static_cast< std::uint64_t >( stateHistory_.size( ) ) );
+        for( auto stateIterator = stateHistory_.begin( ); stateIterator != stateHistory_.end( ); stateIterator++ )
+        {
+            writeCheckpointValue( checkpointStream, stateIterator->first );
+            writeCheckpointVector( checkpointStream, stateIterator->second );
+        }
+        if( numberOfProcessedStates_ > 0 )
+        {
+            writeCheckpointValue( checkpointStream, lastTime_ );
+            writeCheckpointVector( checkpointStream, lastState_ );
+        }
+    }
+
+    //! Function to resume the sink from checkpoint data.
+    void readCheckpointData( std::istream& checkpointStream )
+    {
+        std::uint64_t numberOfStoredStates = 0;
+        readCheckpointValue( checkpointStream, numberOfProcessedStates_ );
+        readCheckpointValue( checkpointStream, numberOfStoredStates );
+        stateHistory_.clear( );
+        for( std::uint64_t i = 0; checkpointStream && i < numberOfStoredStates; i++ )
+        {
+            TimeType storedTime;
+            readCheckpointValue( checkpointStream, storedTime );
+            readCheckpointVector( checkpointStream, stateHistory_[ storedTime ] );
+        }
+        if( numberOfProcessedStates_ > 0 )
+        {
+            readCheckpointValue( checkpointStream, lastTime_ );
+            readCheckpointVector( checkpointStream, lastState_ );
+        }
+    }
+
+private:
+
+    //! Frequency (in number of steps) at which states are to be retained.
+    unsigned int saveFrequency_;
+
+    //! Number of states that were processed.
+    unsigned int numberOfProcessedStates_;
+
+    //! Retained state history.
+    std::map< TimeType, Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 > > stateHistory_;
+
+    //! Last processed epoch.
+    TimeType lastTime_;
+
+    //! Last processed state.
+    Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 > lastState_;
+};
+
+//! Sink retaining the full state history, at every saveFrequency-th step, as a contiguous FlatStateHistory.
+template< typename StateScalarType = double, typename TimeType = double >
+class FlatStateHistorySink: public StateHistorySink< StateScalarType, TimeType >
+{
+public:
+
+    //! Constructor
+    /*!
+     *  Constructor
+     *  \param stateSize Size of the propagated state.
+     *  \param saveFrequency Frequency (in number of steps) at which states are to be retained (final state is always
+     *  retained).
+     *  \param expectedNumberOfSteps Expected number of integration steps, used to pre-allocate the history.
+     */
+    FlatStateHistorySink( const unsigned int stateSize, const unsigned int saveFrequency = 1,
+                          const unsigned int expectedNumberOfSteps = 0 ):
+        saveFrequency_( saveFrequency > 0 ? saveFrequency : 1 ), numberOfProcessedStates_( 0 ),
+        stateHistory_( stateSize )
+    {
+        stateHistory_.reserve( expectedNumberOfSteps / saveFrequency_ + 1 );
+    }
+
+    //! Function to process the state at a single epoch, retaining it if required by the save frequency.
+    void processState( const TimeType time, const Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 >& state )
+    {
+        if( numberOfProcessedStates_ % saveFrequency_ == 0 )
+        {
+            stateHistory_.push_back( time, state );
+        }
+        lastTime_ = time;
+        lastState_ = state;
+        numberOfProcessedStates_++;
+    }
+
+    //! Function to add the final state to the history, if it was not retained due to the save frequency.
+    void finalize( )
+    {
+        if( numberOfProcessedStates_ > 0 &&
+                ( stateHistory_.empty( ) || stateHistory_.getEpochs( ).back( ) < lastTime_ ) )
+        {
+            stateHistory_.push_back( lastTime_, lastState_ );
+        }
+    }
+
+    //! Function to retrieve the retained state history.
+    const FlatStateHistory< StateScalarType, TimeType >& getStateHistory( ) const
+    {
+        return stateHistory_;
+    }
+
+    //! Function to check whether the sink can be resumed from a propagation checkpoint.
+    bool isCheckpointSupported( ) const { return true; }
+
+    //! Function to write the retained state history to a checkpoint.
+    void writeCheckpointData( std::ostream& checkpointStream )
+    {
+        writeCheckpointValue( checkpointStream, numberOfProcessedStates_ );
+        writeCheckpointValue( checkpointStream, static_cast< std::uint64_t >( stateHistory_.size( ) ) );
+        for( unsigned int i = 0; i < stateHistory_.size( ); i++ )
+        {
+            writeCheckpointValue( checkpointStream, stateHistory_.getEpoch( i ) );
+            writeCheckpointVector( checkpointStream, Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 >(
+                                       stateHistory_.getState( i ) ) );
+        }
+        if( numberOfProcessedStates_ > 0 )
+        {
+            writeCheckpointValue( checkpointStream, lastTime_ );
+            writeCheckpointVector( checkpointStream, lastState_ );
+        }
+    }
+
+    //! Function to resume the sink from checkpoint data.
+    void readCheckpointData( std::istream& checkpointStream )
+    {
+        std::uint64_t numberOfStoredStates = 0;
+        readCheckpointValue( checkpointStream, numberOfProcessedStates_ );
+        readCheckpointValue( checkpointStream, numberOfStoredStates );
+        stateHistory_.clear( );
+        TimeType storedTime;
+        Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 > storedState;
+        for( std::uint64_t i = 0; checkpointStream && i < numberOfStoredStates; i++ )
+        {
+            readCheckpointValue( checkpointStream, storedTime );
+            readCheckpointVector( checkpointStream, storedState );
+            stateHistory_.push_back( storedTime, storedState );
+        }
+        if( numberOfProcessedStates_ > 0 )
+        {
+            readCheckpointValue( checkpointStream, lastTime_ );
+            readCheckpointVector( checkpointStream, lastState_ );
+        }
+    }
+
+private:
+
+    //! Frequency (in number of steps) at which states are to be retained.
+    unsigned int saveFrequency_;
+
+    //! Number of states that were processed.
+    unsigned int numberOfProcessedStates_;
+
+    //! Retained state history.
+    FlatStateHistory< StateScalarType, TimeType > stateHistory_;
+
+    //! Last processed epoch.
+    TimeType lastTime_;
+
+    //! Last processed state.
+    Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 > lastState_;
+};
+
+//! Sink writing each state directly to a text file, in the same format as input_output::writeDataMapToTextFile.
+/*!
+ *  Sink writing each state directly to a text file, in the same format as input_output::writeDataMapToTextFile. The file
+ *  is created (or truncated) when the first state is written. When the sink is resumed from a propagation checkpoint, the
+ *  existing file is instead truncated to its size at the checkpoint and opened in append mode, so that the output written
+ *  before the checkpoint is retained, and the output written after it (before the interruption) is not duplicated.
+ */
+template< typename StateScalarType = double, typename TimeType = double >
+class TextFileStateHistorySink: public StateHistorySink< StateScalarType, TimeType >
+{
+public:
+
+    //! Constructor
+    /*!
+     *  Constructor
+     *  \param fileName Name of the output file.
+     *  \param outputDirectory Directory to which the file is to be written (must exist).
+     *  \param delimiter Delimiter between the columns of the file.
+     */
+    TextFileStateHistorySink( const std::string& fileName,
+                              const std::string& outputDirectory,
+                              const std::string& delimiter = "\t" ):
+        outputFilePath_( outputDirectory + fileName ), delimiter_( delimiter ), isOutputFileOpened_( false ){ }
+
+    //! Function to write the state at a single epoch as a single line of the file.
+    void processState( const TimeType time, const Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 >& state )
+    {
+        if( !isOutputFileOpened_ )
+        {
+            openOutputFile( false );
+        }
+
+        outputFile_<<time;
+        for( int i = 0; i < state.rows( ); i++ )
+        {
+            outputFile_<<delimiter_<<state( i );
+        }
+        outputFile_<<"\n";
+    }
+
+    //! Function to close the output file (created empty if no state was written).
+    void finalize( )
+    {
+        if( !isOutputFileOpened_ )
+        {
+            openOutputFile( false );
+        }
+        outputFile_.close( );
+    }
+
+    //! Function to check whether the sink can be resumed from a propagation checkpoint.
+    bool isCheckpointSupported( ) const { return true; }
+
+    //! Function to flush the output file, and write its size to a checkpoint.
+    void writeCheckpointData( std::ostream& checkpointStream )
+    {
+        if( !isOutputFileOpened_ )
+        {
+            openOutputFile( false );
+        }
+        outputFile_.flush( );
+        writeCheckpointValue( checkpointStream,
+                              static_cast< std::uint64_t >( boost::filesystem::file_size( outputFilePath_ ) ) );
+    }
+
+    //! Function to truncate the output file to its size at the checkpoint, and open it in append mode.
+    void readCheckpointData( std::istream& checkpointStream )
+    {
+        std::uint64_t checkpointFileSize = 0;
+        readCheckpointValue( checkpointStream, checkpointFileSize );
+        if( !boost::filesystem::exists( outputFilePath_ ) ||
+                boost::filesystem::file_size( outputFilePath_ ) < checkpointFileSize )
+        {
+            throw std::runtime_error( "Error, output file " + outputFilePath_ + " is shorter than at the checkpoint." );
+        }
+        boost::filesystem::resize_file( outputFilePath_, checkpointFileSize );
+        openOutputFile( true );
+    }
+
+private:
+
+    //! Function to open the output file, either truncated or in append mode.
+    void openOutputFile( const bool isFileAppended )
+    {
+        outputFile_.open( outputFilePath_, isFileAppended ? std::ios::app : std::ios::trunc );
+        if( !outputFile_.is_open( ) )
+        {
+            throw std::runtime_error( "Error, could not open output file " + outputFilePath_ );
+        }
+        outputFile_<<std::setprecision( std::numeric_limits< double >::digits10 );
+        isOutputFileOpened_ = true;
+    }
+
+    //! Path of the output file.
+    std::string outputFilePath_;
+
+    //! Stream to which the states are written.
+    std::ofstream outputFile_;
+
+    //! Delimiter between the columns of the file.
+    std::string delimiter_;
+
+    //! Boolean denoting whether the output file has been opened.
+    bool isOutputFileOpened_;
+};
+
+//! Function to create a sink that passes the state of a single member of an ensemble propagation to a target sink.
+/*!
+ *  Function to create a sink that passes the state of a single member of an ensemble propagation to a target sink. In an
+ *  ensemble propagation, a number of copies of a body (which may differ in e.g. initial state or vehicle parameters) are
+ *  propagated together in a single simulation, so that the full propagated state is the concatenation of the states of
+ *  all members.
+ *  \param memberIndex Index of the ensemble member in the propagated state.
+ *  \param memberStateSize Size of the state of a single member.
+ *  \param targetSink Sink to which the state of the member is to be passed.
+ *  \return Sink extracting the member state from the full propagated state.
+ */
+template< typename StateScalarType = double, typename TimeType = double >
+std::shared_ptr< StateHistorySink< StateScalarType, TimeType > > createEnsembleMemberSink(
+        const unsigned int memberIndex,
+        const unsigned int memberStateSize,
+        const std::shared_ptr< StateHistorySink< StateScalarType, TimeType > > targetSink )
+{
+    return std::make_shared< TransformedStateHistorySink< StateScalarType, TimeType > >(
+                [ = ]( const TimeType, const Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 >& ensembleState )
+    {
+        return Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 >(
+                    ensembleState.segment( memberIndex * memberStateSize, memberStateSize ) );
+    }, targetSink );
+}
+
+//! Function to step an integrator up to the final time, passing the states to a list of sinks.
+/*!
+ *  Function to step an integrator up to the final time, passing the states to a list of sinks, as used by
+ *  propagateToStateHistorySinks (see that function for the handling of output schedules and checkpoints).
+ *  \param integrator Numerical integrator, at the initial (or checkpoint) time and state.
+ *  \param convertToOutputState Function converting the propagated state at a given time to the (conventional) state that
+ *  is passed to the sinks, which is set by reference (to reuse its memory).
+ *  \param getNumberOfFunctionEvaluations Function returning the number of function evaluations (including those before
+ *  the checkpoint, if resumed), which is stored in the checkpoints.
+ *  \param initialTime Initial time of the propagation (not of the integrator, if resumed from a checkpoint).
+ *  \param timeStep Step size of the first step.
+ *  \param isStepSizeFixed Boolean denoting whether the integrator uses a fixed step size.
+ *  \param finalTime Final time of the propagation.
+ *  \param stateHistorySinks List of sinks to which the states are passed.
+ *  \param checkpointSettings Settings for checkpointing the propagation (no checkpoints are written if nullptr).
+ *  \param outputSchedule Settings for the epochs at which the state is passed to the sinks (every step if nullptr).
+ *  \param isPropagatedStateConventional Boolean denoting whether the propagated state is the conventional state, so that
+ *  the state derivatives retained by the integrator (if any, see StepStartStateDerivativeInterface) are passed to the
+ *  sinks (only if the state is passed at every step).
+ */
+template< typename StateScalarType, typename TimeType, typename StateType >
+void integrateToStateHistorySinks(
+        const std::shared_ptr< tudat::numerical_integrators::NumericalIntegrator< TimeType, StateType, StateType, TimeType > >
+        integrator,
+        const std::function< void( const StateType&, const TimeType, Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 >& ) >
+        convertToOutputState,
+        const std::function< unsigned int( ) > getNumberOfFunctionEvaluations,
+        const TimeType initialTime,
+        TimeType timeStep,
+        const bool isStepSizeFixed,
+        const TimeType finalTime,
+        const std::vector< std::shared_ptr< StateHistorySink< StateScalarType, TimeType > > >& stateHistorySinks,
+        const std::shared_ptr< PropagationCheckpointSettings > checkpointSettings,
+        const std::shared_ptr< OutputScheduleSettings< TimeType > > outputSchedule,
+        const bool isPropagatedStateConventional )
+{
+    TimeType currentTime = integrator->getCurrentIndependentVariable( );
+    StateType currentState = integrator->getCurrentState( );
+    const bool isPropagationForward = ( timeStep > 0.0 );
+
+    // Check whether the propagation is resumed from a checkpoint (in which case the sinks have already processed the
+    // state at the checkpoint epoch).
+    const bool isPropagationResumed = ( currentTime != initialTime );
+
+    // Define function to pass current (conventional) state to all sinks.
+    Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 > outputState;
+    auto processCurrentState = [ & ]( const TimeType outputTime )
+    {
+        convertToOutputState( currentState, currentTime, outputState );
+        for( unsigned int i = 0; i < stateHistorySinks.size( ); i++ )
+        {
+            stateHistorySinks.at( i )->processState( outputTime, outputState );
+        }
+    };
+
+    // Define function to pass state derivative at start of last step to all sinks, if retained by the integrator.
+    const std::shared_ptr< StepStartStateDerivativeInterface< StateType, TimeType > > stepStartStateDerivativeInterface =
+            isPropagatedStateConventional ?
+                std::dynamic_pointer_cast< StepStartStateDerivativeInterface< StateType, TimeType > >( integrator ) :
+                nullptr;
+    Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 > outputStateDerivative;
+    auto processPreviousStateDerivative = [ & ]( const TimeType previousTime )
+    {
+        if( stepStartStateDerivativeInterface != nullptr )
+        {
+            outputStateDerivative = stepStartStateDerivativeInterface->getPreviousStateDerivative( );
+            for( unsigned int i = 0; i < stateHistorySinks.size( ); i++ )
+            {
+                stateHistorySinks.at( i )->processStateDerivative( previousTime, outputStateDerivative );
+            }
+        }
+    };
+
+    // Retrieve output epochs (skipping those before the checkpoint epoch, if resumed).
+    const bool isOutputScheduled =
+            ( outputSchedule != nullptr && outputSchedule->getOutputScheduleType( ) != every_step_output );
+    std::vector< TimeType > outputEpochs;
+    unsigned int nextOutputIndex = 0;
+    if( isOutputScheduled )
+    {
+        outputEpochs = outputSchedule->getOutputEpochs( initialTime, finalTime );
+        while( nextOutputIndex < outputEpochs.size( ) && ( isPropagationForward ?
+                                                           ( outputEpochs.at( nextOutputIndex ) < currentTime ) :
+                                                           ( outputEpochs.at( nextOutputIndex ) > currentTime ) ) )
+        {
+            nextOutputIndex++;
+        }
+        if( isPropagationResumed && nextOutputIndex < outputEpochs.size( ) &&
+                outputEpochs.at( nextOutputIndex ) == currentTime )
+        {
+            nextOutputIndex++;
+        }
+    }
+
+    if( !isPropagationResumed && !isOutputScheduled )
+    {
+        processCurrentState( currentTime );
+    }
+    else if( !isPropagationResumed && nextOutputIndex < outputEpochs.size( ) &&
+             outputEpochs.at( nextOutputIndex ) == currentTime )
+    {
+        processCurrentState( currentTime );
+        nextOutputIndex++;
+    }
+
+    std::chrono::steady_clock::time_point lastCheckpointTime = std::chrono::steady_clock::now( );
+    bool isFinalTimeReached = false;
+    while( !isFinalTimeReached && ( isPropagationForward ? ( currentTime < finalTime ) : ( currentTime > finalTime ) ) )
+    {
+        if( !isOutputScheduled )
+        {
+            // Shorten step if it would pass the final time.
+            const TimeType remainingTimeBeforeStep = finalTime - currentTime;
+            const bool isStepShortened = ( isPropagationForward ? !( timeStep < remainingTimeBeforeStep ) :
+                                                                  !( timeStep > remainingTimeBeforeStep ) );
+
+            const TimeType previousTime = currentTime;
+            currentState = integrator->performIntegrationStep( isStepShortened ? remainingTimeBeforeStep : timeStep );
+            currentTime = integrator->getCurrentIndependentVariable( );
+            timeStep = integrator->getNextStepSize( );
+            processPreviousStateDerivative( previousTime );
+
+            // Check whether the final time was reached (the integrator may have reduced the step size).
+            const TimeType remainingTime = finalTime - currentTime;
+            isFinalTimeReached = ( isPropagationForward ? !( remainingTime > timeStep * 1.0E-6 ) :
+                                                          !( remainingTime < timeStep * 1.0E-6 ) );
+
+            processCurrentState( currentTime );
+        }
+        else
+        {
+            // Shorten step if it would pass the next output epoch (or the final time).
+            const TimeType stepEndLimit =
+                    ( nextOutputIndex < outputEpochs.size( ) ) ? outputEpochs.at( nextOutputIndex ) : finalTime;
+            const TimeType nominalTimeStep = timeStep;
+            TimeType currentTimeStep = stepEndLimit - currentTime;
+            const bool isStepShortened = ( isPropagationForward ? !( timeStep < currentTimeStep ) :
+                                                                  !( timeStep > currentTimeStep ) );
+            if( !isStepShortened )
+            {
+                currentTimeStep = timeStep;
+            }
+
+            const TimeType previousTime = currentTime;
+            currentState = integrator->performIntegrationStep( currentTimeStep );
+            currentTime = integrator->getCurrentIndependentVariable( );
+            timeStep = ( isStepShortened && isStepSizeFixed ) ? nominalTimeStep : integrator->getNextStepSize( );
+
+            // Check whether the limit was reached (the integrator may have reduced the step size below the requested one).
+            const TimeType remainingTime = stepEndLimit - currentTime;
+            const bool isStepEndLimitReached =
+                    ( isStepShortened && currentTime == previousTime + currentTimeStep ) ||
+                    ( isPropagationForward ? !( remainingTime > timeStep * 1.0E-6 ) :
+                                             !( remainingTime < timeStep * 1.0E-6 ) );
+            if( isStepEndLimitReached )
+            {
+                if( nextOutputIndex < outputEpochs.size( ) )
+                {
+                    processCurrentState( outputEpochs.at( nextOutputIndex ) );
+                    nextOutputIndex++;
+                }
+                isFinalTimeReached = ( stepEndLimit == finalTime );
+            }
+        }
+
+        // Write checkpoint if interval has passed.
+        if( checkpointSettings != nullptr &&
+                std::chrono::duration< double >( std::chrono::steady_clock::now( ) - lastCheckpointTime ).count( ) >=
+                checkpointSettings->checkpointInterval_ )
+        {
+            PropagationCheckpoint< StateScalarType, TimeType > currentCheckpoint;
+            currentCheckpoint.currentTime = currentTime;
+            currentCheckpoint.nextTimeStep = timeStep;
+            currentCheckpoint.numberOfFunctionEvaluations = getNumberOfFunctionEvaluations( );
+            currentCheckpoint.currentState = currentState;
+            for( unsigned int i = 0; i < stateHistorySinks.size( ); i++ )
+            {
+                std::ostringstream sinkCheckpointStream;
+                stateHistorySinks.at( i )->writeCheckpointData( sinkCheckpointStream );
+                currentCheckpoint.sinkCheckpointData.push_back( sinkCheckpointStream.str( ) );
+            }
+            writePropagationCheckpoint( currentCheckpoint, checkpointSettings->checkpointFilePath_ );
+            lastCheckpointTime = std::chrono::steady_clock::now( );
+        }
+    }
+}
+
+//! Function to create a copy of integrator settings, with a different initial time.
+/*!
+ *  Function to create a copy of integrator settings (of the same derived type), with a different initial time, so that an
+ *  integrator can be created at e.g. a checkpoint epoch without modifying settings that may be shared by concurrent
+ *  propagations.
+ *  \param integratorSettings Settings for the numerical integrator that are to be copied.
+ *  \param initialTime Initial time of the copied settings.
+ *  \return Copy of the integrator settings, with the given initial time.
+ */
+template< typename TimeType >
+std::shared_ptr< tudat::numerical_integrators::IntegratorSettings< TimeType > > copyIntegratorSettings(
+        const std::shared_ptr< tudat::numerical_integrators::IntegratorSettings< TimeType > > integratorSettings,
+        const TimeType initialTime )
+{
+    using namespace tudat::numerical_integrators;
+
+    std::shared_ptr< IntegratorSettings< TimeType > > copiedIntegratorSettings;
+    if( std::dynamic_pointer_cast< RungeKuttaVariableStepSizeSettings< TimeType > >( integratorSettings ) != nullptr )
+    {
+        copiedIntegratorSettings = std::make_shared< RungeKuttaVariableStepSizeSettings< TimeType > >(
+                    *std::dynamic_pointer_cast< RungeKuttaVariableStepSizeSettings< TimeType > >( integratorSettings ) );
+    }
+    else if( std::dynamic_pointer_cast< BulirschStoerIntegratorSettings< TimeType > >( integratorSettings ) != nullptr )
+    {
+        copiedIntegratorSettings = std::make_shared< BulirschStoerIntegratorSettings< TimeType > >(
+                    *std::dynamic_pointer_cast< BulirschStoerIntegratorSettings< TimeType > >( integratorSettings ) );
+    }
+    else if( std::dynamic_pointer_cast< AdamsBashforthMoultonSettings< TimeType > >( integratorSettings ) != nullptr )
+    {
+        copiedIntegratorSettings = std::make_shared< AdamsBashforthMoultonSettings< TimeType > >(
+                    *std::dynamic_pointer_cast< AdamsBashforthMoultonSettings< TimeType > >( integratorSettings ) );
+    }
+    else if( std::dynamic_pointer_cast< GaussJacksonIntegratorSettings< TimeType > >( integratorSettings ) != nullptr )
+    {
+        copiedIntegratorSettings = std::make_shared< GaussJacksonIntegratorSettings< TimeType > >(
+                    *std::dynamic_pointer_cast< GaussJacksonIntegratorSettings< TimeType > >( integratorSettings ) );
+    }
+    else if( integratorSettings->integratorType_ == euler || integratorSettings->integratorType_ == rungeKutta4 )
+    {
+        copiedIntegratorSettings = std::make_shared< IntegratorSettings< TimeType > >( *integratorSettings );
+    }
+    else
+    {
+        throw std::runtime_error( "Error, integrator settings of type " +
+                                  std::to_string( integratorSettings->integratorType_ ) + " cannot be copied." );
+    }
+    copiedIntegratorSettings->initialTime_ = initialTime;
+    return copiedIntegratorSettings;
+}
+
+//! Function to propagate the dynamics, passing the state at each integration step to a list of sinks.
+/*!
+ *  Function to propagate the dynamics, passing the state at each integration step to a list of sinks, instead of storing
+ *  the full numerical solution (as is done by SingleArcDynamicsSimulator). The state derivative model is set up by a
+ *  SingleArcDynamicsSimulator that is created without integrating the equations of motion, after which the integrator is
+ *  stepped directly. Each step is converted to the conventional (e.g. Cartesian) state, as in the output of
+ *  getEquationsOfMotionNumericalSolution, before being passed to the sinks. As with a PropagationTimeTerminationSettings
+ *  that terminates exactly on the final time, the last step is shortened to end on the final time (a step that ends
+ *  within 1E-6 step sizes of it is considered to end on it), so that no state beyond the final time is passed to the
+ *  sinks. Memory use is independent of the propagation length, unless a sink stores the states.
+ *
+ *  If checkpoint settings are provided, the integrator state (time, propagated state and next step size) and the data
+ *  retained by each sink (see StateHistorySink::writeCheckpointData) are written to file periodically, and a propagation
+ *  for which a checkpoint file exists is resumed from the checkpoint: the sinks are restored to their state at the
+ *  checkpoint, and then receive the states after the checkpoint epoch, so that the output is identical to that of an
+ *  uninterrupted propagation. The checkpoint file is removed when the propagation is complete. Checkpoints require sinks
+ *  that support them, and a single-step integrator: multi-step integrators (Adams-Bashforth-Moulton and Gauss-Jackson)
+ *  are rejected, as their history of previous steps is internal to the integrator.
+ *
+ *  If an output schedule is provided, the sinks only receive the states at the scheduled output epochs, and the steps are
+ *  shortened where needed to end exactly on these epochs and on the final time (see OutputScheduleSettings). A step that
+ *  ends within 1E-6 step sizes of an output epoch is considered to end on it. Fixed step-size integrators resume their
+ *  nominal step size after a shortened step.
+ *
+ *  The fourth-order Runge-Kutta and the Runge-Kutta-Fehlberg and Dormand-Prince variable step-size integrators are created
+ *  with a compile-time Butcher tableau (see createIntegratorWithButcherTableaus); other integrators are those of Tudat.
+ *  For these integrators, the translational dynamics of a single body with the Cowell propagator is propagated with
+ *  fixed-size (6-element) states, using a FixedSizeCowellStateDerivative instead of the state derivative model of Tudat,
+ *  so that no memory is allocated on the heap per integration stage. All other propagators (e.g. the unified state model)
+ *  use the dynamic-size state derivative model of Tudat. For the Cowell propagator, these integrators also
+ *  pass the state derivative at the start of each step (their first stage) to the sinks, if the state is passed at every
+ *  step (see StateHistorySink::processStateDerivative).
+ *
+ *  The Gauss-Jackson integrator (see GaussJacksonIntegratorSettings), which is not available in Tudat, is only supported
+ *  by this function, for translational dynamics with the Cowell propagator.
+ *  \param bodyMap List of bodies in the environment.
+ *  \param integratorSettings Settings for the numerical integrator.
+ *  \param propagatorSettings Settings for the propagator (termination settings are not used, the propagation ends on
+ *  finalTime; dependent variables are not supported).
+ *  \param finalTime Final time of the propagation.
+ *  \param stateHistorySinks List of sinks to which the state at each step (including the initial state) is passed.
+ *  \param checkpointSettings Settings for checkpointing the propagation (no checkpoints are written if nullptr).
+ *  \param outputSchedule Settings for the epochs at which the state is passed to the sinks (every step if nullptr).
+ *  \return Number of function evaluations used in the propagation.
+ */
+template< typename StateScalarType = double, typename TimeType = double >
+unsigned int propagateToStateHistorySinks(
+        const tudat::simulation_setup::NamedBodyMap& bodyMap,
+        const std::shared_ptr< tudat::numerical_integrators::IntegratorSettings< TimeType > > integratorSettings,
+        const std::shared_ptr< tudat::propagators::SingleArcPropagatorSettings< StateScalarType > > propagatorSettings,
+        const TimeType finalTime,
+        const std::vector< std::shared_ptr< StateHistorySink< StateScalarType, TimeType > > >& stateHistorySinks,
+        const std::shared_ptr< PropagationCheckpointSettings > checkpointSettings = nullptr,
+        const std::shared_ptr< OutputScheduleSettings< TimeType > > outputSchedule = nullptr )
+{
+    using namespace tudat;
+
+    typedef Eigen::Matrix< StateScalarType, Eigen::Dynamic, Eigen::Dynamic > StateType;
+
+    // Check that no dependent variables are requested, as these are not computed.
+    if( propagatorSettings->getDependentVariablesToSave( ) != nullptr &&
+            !propagatorSettings->getDependentVariablesToSave( )->dependentVariables_.empty( ) )
+    {
+        throw std::runtime_error( "Error, dependent variables are not supported when propagating to state history sinks, "
+                                  "use a SingleArcDynamicsSimulator instead." );
+    }
+
+    // Check whether the propagated state is the conventional (Cartesian) state, as for the Cowell propagator.
+    std::shared_ptr< propagators::TranslationalStatePropagatorSettings< StateScalarType > >
+            translationalPropagatorSettings = std::dynamic_pointer_cast<
+            propagators::TranslationalStatePropagatorSettings< StateScalarType > >( propagatorSettings );
+    const bool isCowellPropagatorUsed =
+            ( translationalPropagatorSettings != nullptr && translationalPropagatorSettings->propagator_ == propagators::cowell );
+
+    // Check that Gauss-Jackson integrator is used for the second-order equations of motion of the Cowell propagator.
+    const bool isGaussJacksonIntegratorUsed =
+            ( integratorSettings->integratorType_ == gaussJacksonIntegratorType );
+    if( isGaussJacksonIntegratorUsed && !isCowellPropagatorUsed )
+    {
+        throw std::runtime_error( "Error, Gauss-Jackson integrator requires translational dynamics with the Cowell "
+                                  "propagator." );
+    }
+
+    // Create state derivative model, without propagating (Gauss-Jackson settings, which Tudat does not support, are
+    // replaced by equivalent fixed step-size settings, as the integrator is not created by the simulator).
+    propagators::SingleArcDynamicsSimulator< StateScalarType, TimeType > dynamicsSimulator(
+                bodyMap, isGaussJacksonIntegratorUsed ?
+                    std::make_shared< numerical_integrators::IntegratorSettings< TimeType > >(
+                        numerical_integrators::rungeKutta4, integratorSettings->initialTime_,
+                        integratorSettings->initialTimeStep_ ) : integratorSettings,
+                propagatorSettings, false );
+    std::shared_ptr< propagators::DynamicsStateDerivativeModel< TimeType, StateScalarType > > stateDerivativeModel =
+            dynamicsSimulator.getDynamicsStateDerivative( );
+    stateDerivativeModel->resetFunctionEvaluationCounter( );
+
+    TimeType currentTime = integratorSettings->initialTime_;
+    StateType currentState = stateDerivativeModel->convertFromOutputSolution(
+                propagatorSettings->getInitialStates( ), currentTime );
+    TimeType timeStep = integratorSettings->initialTimeStep_;
+
+    // Check that checkpoints are supported by the integrator and the sinks.
+    if( checkpointSettings != nullptr )
+    {
+        if( isGaussJacksonIntegratorUsed ||
+                integratorSettings->integratorType_ == numerical_integrators::adamsBashforthMoulton )
+        {
+            throw std::runtime_error( "Error, propagation checkpoints are not supported for multi-step integrators, as "
+                                      "their history of previous steps is not stored." );
+        }
+        for( unsigned int i = 0; i < stateHistorySinks.size( ); i++ )
+        {
+            if( !stateHistorySinks.at( i )->isCheckpointSupported( ) )
+            {
+                throw std::runtime_error( "Error, propagation checkpoints are not supported by state history sink " +
+                                          std::to_string( i ) + "." );
+            }
+        }
+    }
+
+    // Resume integrator and sinks from checkpoint, if it exists.
+    PropagationCheckpoint< StateScalarType, TimeType > checkpoint;
+    checkpoint.numberOfFunctionEvaluations = 0;
+    if( checkpointSettings != nullptr &&
+            readPropagationCheckpoint( checkpointSettings->checkpointFilePath_, checkpoint ) )
+    {
+        if( checkpoint.sinkCheckpointData.size( ) != stateHistorySinks.size( ) )
+        {
+            throw std::runtime_error( "Error, propagation checkpoint " + checkpointSettings->checkpointFilePath_ +
+                                      " was written for a different number of state history sinks." );
+        }
+        for( unsigned int i = 0; i < stateHistorySinks.size( ); i++ )
+        {
+            std::istringstream sinkCheckpointStream( checkpoint.sinkCheckpointData.at( i ) );
+            stateHistorySinks.at( i )->readCheckpointData( sinkCheckpointStream );
+            if( !sinkCheckpointStream )
+            {
+                throw std::runtime_error( "Error, checkpoint data of state history sink " + std::to_string( i ) +
+                                          " is incomplete." );
+            }
+        }
+        currentTime = checkpoint.currentTime;
+        currentState = checkpoint.currentState;
+        timeStep = checkpoint.nextTimeStep;
+    }
+
+    const bool isStepSizeFixed = ( integratorSettings->integratorType_ == numerical_integrators::euler ||
+                                   integratorSettings->integratorType_ == numerical_integrators::rungeKutta4 );
+
+    // Create fixed-size state derivative, if the size of the propagated state is known.
+    typedef Eigen::Matrix< StateScalarType, 6, 1 > FixedSizeStateType;
+    std::shared_ptr< FixedSizeCowellStateDerivative< StateScalarType, TimeType > > fixedSizeStateDerivative =
+            createFixedSizeCowellStateDerivative< StateScalarType, TimeType >(
+                bodyMap, propagatorSettings, dynamicsSimulator.getEnvironmentUpdater( ) );
+
+    // Create integrator (at checkpoint epoch, if resumed), using fixed-size states if possible.
+    std::shared_ptr< numerical_integrators::NumericalIntegrator<
+            TimeType, FixedSizeStateType, FixedSizeStateType, TimeType > > fixedSizeIntegrator;
+    std::shared_ptr< numerical_integrators::NumericalIntegrator< TimeType, StateType, StateType, TimeType > > integrator;
+    const std::shared_ptr< numerical_integrators::IntegratorSettings< TimeType > > currentIntegratorSettings =
+            copyIntegratorSettings( integratorSettings, currentTime );
+    if( fixedSizeStateDerivative != nullptr )
+    {
+        const std::function< FixedSizeStateType( const TimeType, const FixedSizeStateType& ) >
+                fixedSizeStateDerivativeFunction = [ = ]( const TimeType time, const FixedSizeStateType& state )
+        {
+            return fixedSizeStateDerivative->computeStateDerivative( time, state );
+        };
+        if( isGaussJacksonIntegratorUsed )
+        {
+            fixedSizeIntegrator = createGaussJacksonIntegrator< TimeType, FixedSizeStateType >(
+                        fixedSizeStateDerivativeFunction, FixedSizeStateType( currentState ), currentIntegratorSettings );
+        }
+        else
+        {
+            fixedSizeIntegrator = createButcherTableauIntegrator< TimeType, FixedSizeStateType >(
+                        fixedSizeStateDerivativeFunction, FixedSizeStateType( currentState ), currentIntegratorSettings );
+        }
+    }
+    if( fixedSizeIntegrator == nullptr && isGaussJacksonIntegratorUsed )
+    {
+        integrator = createGaussJacksonIntegrator< TimeType, StateType >(
+                    dynamicsSimulator.getStateDerivativeFunction( ), currentState, currentIntegratorSettings );
+    }
+    else if( fixedSizeIntegrator == nullptr )
+    {
+        integrator = createIntegratorWithButcherTableaus< TimeType, StateType >(
+                    dynamicsSimulator.getStateDerivativeFunction( ), currentState, currentIntegratorSettings );
+    }
+
+    std::function< unsigned int( ) > getNumberOfFunctionEvaluations = [ & ]( )
+    {
+        return checkpoint.numberOfFunctionEvaluations + ( ( fixedSizeIntegrator != nullptr ) ?
+                    fixedSizeStateDerivative->getNumberOfFunctionEvaluations( ) :
+                    stateDerivativeModel->getNumberOfFunctionEvaluations( ) );
+    };
+
+    if( fixedSizeIntegrator != nullptr )
+    {
+        integrateToStateHistorySinks< StateScalarType, TimeType, FixedSizeStateType >(
+                    fixedSizeIntegrator,
+                    [ ]( const FixedSizeStateType& state, const TimeType,
+                         Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 >& outputState ){ outputState = state; },
+                    getNumberOfFunctionEvaluations, integratorSettings->initialTime_, timeStep, isStepSizeFixed, finalTime,
+                    stateHistorySinks, checkpointSettings, outputSchedule, true );
+    }
+    else
+    {
+        integrateToStateHistorySinks< StateScalarType, TimeType, StateType >(
+                    integrator,
+                    [ & ]( const StateType& state, const TimeType time,
+                           Eigen::Matrix< StateScalarType, Eigen::Dynamic, 1 >& outputState )
+        {
+            outputState = stateDerivativeModel->convertToOutputSolution( state, time );
+        }, getNumberOfFunctionEvaluations, integratorSettings->initialTime_, timeStep, isStepSizeFixed, finalTime,
+                    stateHistorySinks, checkpointSettings, outputSchedule, isCowellPropagatorUsed );
+    }
+
+    for( unsigned int i = 0; i < stateHistorySinks.size( ); i++ )
+    {
+        stateHistorySinks.at( i )->finalize( );
+    }
+
+    if( checkpointSettings != nullptr )
+    {
+        boost::filesystem::remove( checkpointSettings->checkpointFilePath_ );
+    }
+
+    return getNumberOfFunctionEvaluations( );
+}
+
+}
+
+#endif // TUDAT_STATEHISTORYSINK_H
@@ -0,0 +1,340 @@
+/*    Copyright (c) 2010-2018, Delft University of Technology
+ *    All rigths reserved
+ *
+ *    This file is part of the Tudat. Redistribution and use in source and
+ *    binary forms, with or without modification, are permitted exclusively
+ *    under the terms of the Modified BSD license. You should have received
+ *    a copy of the license with this file. If not, please or visit:
+ *    http://tudat.tudelft.nl/LICENSE.
+ */
+
+#ifndef TUDAT_SWEEPEXECUTOR_H
+#define TUDAT_SWEEPEXECUTOR_H
+
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace tudat_applications
+{
+
+//! Get number of worker threads to be used for a sweep over simulation cases.
+/*!
+ *  Get number of worker threads to be used for a sweep over simulation cases. The value is read from the environment
+ *  variable TUDAT_APPLICATION_THREADS if it is set to a positive integer (a value of 1 runs the sweep serially on the
+ *  calling thread), and is equal to the number of hardware threads otherwise (including for invalid settings, for which
+ *  a warning is printed).
+ *  \return Number of worker threads (at least 1).
+ */
+inline unsigned int getNumberOfSweepThreads( )
+{
+    unsigned int numberOfThreads = std::thread::hardware_concurrency( );
+    const char* numberOfThreadsSetting = std::getenv( "TUDAT_APPLICATION_THREADS" );
+    if( numberOfThreadsSetting != NULL && std::string( numberOfThreadsSetting ) != "" )
+    {
+        int requestedNumberOfThreads = 0;
+        std::size_t numberOfParsedCharacters = 0;
+        try
+        {
+            requestedNumberOfThreads = std::stoi( numberOfThreadsSetting, &numberOfParsedCharacters );
+        }
+        catch( const std::exception& )
+        {
+            requestedNumberOfThreads = 0;
+        }
+
+        if( requestedNumberOfThreads > 0 &&
+                numberOfParsedCharacters == std::string( numberOfThreadsSetting ).length( ) )
+        {
+            numberOfThreads = static_cast< unsigned int >( requestedNumberOfThreads );
+        }
+        else
+        {
+            std::cerr<<"Warning, invalid TUDAT_APPLICATION_THREADS setting "<<numberOfThreadsSetting<<
+                       ", using the number of hardware threads."<<std::endl;
+        }
+    }
+    return ( numberOfThreads > 0 ) ? numberOfThreads : 1;
+}
+
+//! Get mutex that is to be locked around any call into the (not thread-safe) CSPICE library from a sweep worker.
+/*!
+ *  Get mutex that is to be locked around any call into the (not thread-safe) CSPICE library from a sweep worker. Note that
+ *  creating bodies from default body settings queries SPICE, so environment creation must be done under this lock. The
+ *  mutex is recursive, so that functions locking it may be called while it is held.
+ *  \return Mutex protecting SPICE access.
+ */
+inline std::recursive_mutex& getSpiceInterfaceMutex( )
+{
+    static std::recursive_mutex spiceInterfaceMutex;
+    return spiceInterfaceMutex;
+}
+
+//! Get mutex that is to be locked when writing progress output to the console from a sweep worker.
+inline std::mutex& getConsoleOutputMutex( )
+{
+    static std::mutex consoleOutputMutex;
+    return consoleOutputMutex;
+}
+
+//! Class to execute a list of independent simulation cases on a pool of worker threads.
+/*!
+ *  Class to execute a list of independent simulation cases on a pool of worker threads. Each worker is assigned a contiguous
+ *  block of the task list (so that neighbouring cases, which typically have similar run times, are run by the same worker),
+ *  which it processes from the front. A worker that runs out of tasks steals from the back of the queue of another
+ *  worker, so that the load is balanced when the run times of the cases differ strongly (e.g. for different integrators).
+ *
+ *  Each task receives the index of the worker thread on which it is run, which can be used to retrieve a per-worker copy
+ *  of the environment (see PerWorkerResource), since the Body objects in a NamedBodyMap cache their current state, and may
+ *  therefore not be used by two propagations concurrently.
+ *
+ *  If EIGEN_RUNTIME_NO_MALLOC is defined (see ScopedEigenAllocationCheck), a single worker is used, since the check on
+ *  heap allocations by Eigen objects is process-wide.
+ */
+class SweepExecutor
+{
+public:
+
+    //! Typedef for a single task, with the index of the worker thread on which it is run as input.
+    typedef std::function< void( const unsigned int ) > SweepTask;
+
+    //! Constructor
+    /*!
+     *  Constructor
+     *  \param numberOfThreads Number of worker threads that are to be used.
+     */
+    SweepExecutor( const unsigned int numberOfThreads = getNumberOfSweepThreads( ) ):
+        numberOfThreads_( numberOfThreads > 0 ? numberOfThreads : 1 )
+    {
+#ifdef EIGEN_RUNTIME_NO_MALLOC
+        numberOfThreads_ = 1;
+#endif
+
+        for( unsigned int i = 0; i < numberOfThreads_; i++ )
+        {
+            workerQueues_.push_back( std::make_shared< WorkerQueue >( ) );
+        }
+    }
+
+    //! Function to retrieve the number of worker threads.
+    /*!
+     *  Function to retrieve the number of worker threads.
+     *  \return Number of worker threads.
+     */
+    unsigned int getNumberOfThreads( ) const
+    {
+        return numberOfThreads_;
+    }
+
+    //! Function to execute a list of tasks, returning when all tasks have been completed.
+    /*!
+     *  Function to execute a list of tasks, returning when all tasks have been completed. Tasks with an ordering
+     *  dependency must be provided in separate calls to this function. If any task throws an exception, the remaining
+     *  tasks are skipped, and the first exception is rethrown on the calling thread.
+     *  \param tasks List of tasks that are to be executed.
+     */
+    void executeTasks( const std::vector< SweepTask >& tasks )
+    {
+        firstException_ = nullptr;
+
+        // Distribute tasks over worker queues in contiguous blocks.
+        unsigned int numberOfTasks = tasks.size( );
+        for( unsigned int i = 0; i < numberOfThreads_; i++ )
+        {
+            unsigned int blockStart = ( numberOfTasks * i ) / numberOfThreads_;
+            unsigned int blockEnd = ( numberOfTasks * ( i + 1 ) ) / numberOfThreads_;
+            workerQueues_.at( i )->taskIndices.clear( );
+            for( unsigned int j = blockStart; j < blockEnd; j++ )
+            {
+                workerQueues_.at( i )->taskIndices.push_back( j );
+            }
+        }
+
+        if( numberOfThreads_ == 1 )
+        {
+            runWorker( tasks, 0 );
+        }
+        else
+        {
+            std::vector< std::thread > workerThreads;
+            for( unsigned int i = 0; i < numberOfThreads_; i++ )
+            {
+                workerThreads.push_back( std::thread( &SweepExecutor::runWorker, this, std::cref( tasks ), i ) );
+            }
+
+            for( unsigned int i = 0; i < numberOfThreads_; i++ )
+            {
+                workerThreads.at( i ).join( );
+            }
+        }
+
+        if( firstException_ != nullptr )
+        {
+            std::rethrow_exception( firstException_ );
+        }
+    }
+
+private:
+
+    //! Queue of task indices assigned to a single worker.
+    struct WorkerQueue
+    {
+        //! Mutex protecting the queue (locked by owner and by thieves).
+        std::mutex queueMutex;
+
+        //! Indices (in list of tasks) of tasks still to be executed.
+        std::deque< unsigned int > taskIndices;
+    };
+
+    //! Function to retrieve the next task for a given worker, stealing from other workers when its own queue is empty.
+    /*!
+     *  Function to retrieve the next task for a given worker, stealing from other workers when its own queue is empty.
+     *  \param workerIndex Index of worker requesting a task.
+     *  \param taskIndex Index of task that is to be executed (returned by reference).
+     *  \return True if a task was found, false if all queues are empty.
+     */
+    bool getNextTask( const unsigned int workerIndex, unsigned int& taskIndex )
+    {
+        {
+            WorkerQueue& ownQueue = *workerQueues_.at( workerIndex );
+            std::lock_guard< std::mutex > lock( ownQueue.queueMutex );
+            if( !ownQueue.taskIndices.empty( ) )
+            {
+                taskIndex = ownQueue.taskIndices.front( );
+                ownQueue.taskIndices.pop_front( );
+                return true;
+            }
+        }
+
+        for( unsigned int i = 1; i < numberOfThreads_; i++ )
+        {
+            WorkerQueue& victimQueue = *workerQueues_.at( ( workerIndex + i ) % numberOfThreads_ );
+            std::lock_guard< std::mutex > lock( victimQueue.queueMutex );
+            if( !victimQueue.taskIndices.empty( ) )
+            {
+                taskIndex = victimQueue.taskIndices.back( );
+                victimQueue.taskIndices.pop_back( );
+                return true;
+            }
+        }
+        return false;
+    }
+
+    //! Function run by each worker thread, executing tasks until none are left.
+    /*!
+     *  Function run by each worker thread, executing tasks until none are left.
+     *  \param tasks List of tasks that are to be executed.
+     *  \param workerIndex Index of this worker.
+     */
+    void runWorker( const std::vector< SweepTask >& tasks, const unsigned int workerIndex )
+    {
+        unsigned int taskIndex;
+        while( getNextTask( workerIndex, taskIndex ) )
+        {
+            {
+                std::lock_guard< std::mutex > lock( exceptionMutex_ );
+                if( firstException_ != nullptr )
+                {
+                    return;
+                }
+            }
+
+            try
+            {
+                tasks.at( taskIndex )( workerIndex );
+            }
+            catch( ... )
+            {
+                std::lock_guard< std::mutex > lock( exceptionMutex_ );
+                if( firstException_ == nullptr )
+                {
+                    firstException_ = std::current_exception( );
+                }
+            }
+        }
+    }
+
+    //! Number of worker threads.
+    unsigned int numberOfThreads_;
+
+    //! Task queue per worker thread.
+    std::vector< std::shared_ptr< WorkerQueue > > workerQueues_;
+
+    //! First exception thrown by any of the tasks (nullptr if none).
+    std::exception_ptr firstException_;
+
+    //! Mutex protecting firstException_.
+    std::mutex exceptionMutex_;
+};
+
+//! Class to hold one lazily created instance of a resource (e.g. environment and acceleration models) per worker thread.
+/*!
+ *  Class to hold one lazily created instance of a resource (e.g. environment and acceleration models) per worker thread.
+ *  The resource for a given worker is created on first request. Since creation of the environment typically calls SPICE,
+ *  creation is done while holding the SPICE interface mutex, unless the creation function is marked as thread-safe (e.g.
+ *  when creating body maps from an EnvironmentSnapshot). Retrieving the resource of a given worker is only safe from the
+ *  thread that is running that worker.
+ */
+template< typename ResourceType >
+class PerWorkerResource
+{
+public:
+
+    //! Constructor
+    /*!
+     *  Constructor
+     *  \param createResource Function creating a new instance of the resource.
+     *  \param numberOfWorkers Number of worker threads for which a resource is to be maintained.
+     *  \param isCreationThreadSafe Boolean denoting whether createResource may be called concurrently (if false, calls are
+     *  made while holding the SPICE interface mutex).
+     */
+    PerWorkerResource( const std::function< std::shared_ptr< ResourceType >( ) > createResource,
+                       const unsigned int numberOfWorkers,
+                       const bool isCreationThreadSafe = false ):
+        createResource_( createResource ), resources_( numberOfWorkers ), isCreationThreadSafe_( isCreationThreadSafe ){ }
+
+    //! Function to retrieve the resource of a given worker, creating it if it does not yet exist.
+    /*!
+     *  Function to retrieve the resource of a given worker, creating it if it does not yet exist.
+     *  \param workerIndex Index of worker thread for which the resource is to be retrieved.
+     *  \return Resource of requested worker.
+     */
+    ResourceType& get( const unsigned int workerIndex )
+    {
+        if( resources_.at( workerIndex ) == nullptr )
+        {
+            if( isCreationThreadSafe_ )
+            {
+                resources_.at( workerIndex ) = createResource_( );
+            }
+            else
+            {
+                std::lock_guard< std::recursive_mutex > lock( getSpiceInterfaceMutex( ) );
+                resources_.at( workerIndex ) = createResource_( );
+            }
+        }
+        return *resources_.at( workerIndex );
+    }
+
+private:
+
+    //! Function creating a new instance of the resource.
+    std::function< std::shared_ptr< ResourceType >( ) > createResource_;
+
+    //! Resource per worker (nullptr if not yet created).
+    std::vector< std::shared_ptr< ResourceType > > resources_;
+
+    //! Boolean denoting whether createResource_ may be called concurrently.
+    bool isCreationThreadSafe_;
+};
+
+}
+
+#endif // TUDAT_SWEEPEXECUTOR_H
@@ -0,0 +1,208 @@
+/*    Copyright (c) 2010-2018, Delft University of Technology
+ *    All rigths reserved
+ *
+ *    This file is part of the Tudat. Redistribution and use in source and
+ *    binary forms, with or without modification, are permitted exclusively
+ *    under the terms of the Modified BSD license. You should have received
+ *    a copy of the license with this file. If not, please or visit:
+ *    http://tudat.tudelft.nl/LICENSE.
+ */
+
+#ifndef TUDAT_SWEEPJOURNAL_H
+#define TUDAT_SWEEPJOURNAL_H
+
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+namespace tudat_applications
+{
+
+//! Get whether an interrupted sweep is to be resumed, skipping the cases that were completed in an earlier run.
+/*!
+ *  Get whether an interrupted sweep is to be resumed, skipping the cases that were completed in an earlier run (as
+ *  recorded in its SweepJournal). The value is read from the environment variable TUDAT_APPLICATION_RESUME (resuming if it
+ *  is set to a non-zero value); by default, a sweep is started from scratch, and any existing journal is overwritten.
+ *  \return True if an interrupted sweep is to be resumed.
+ */
+inline bool getSweepResumeSetting( )
+{
+    const char* resumeSetting = std::getenv( "TUDAT_APPLICATION_RESUME" );
+    return ( resumeSetting != NULL && std::atoi( resumeSetting ) != 0 );
+}
+
+//! Journal of the completed cases of a sweep, used to resume a sweep after it was interrupted.
+/*!
+ *  Journal of the completed cases of a sweep, used to resume a sweep after it was interrupted (e.g. by preemption of the
+ *  node on which it runs). Each completed case is appended to a text file as a single line containing its case key and
+ *  (optionally) a list of values, such as the summary results of the case that are otherwise only kept in memory. The line
+ *  is flushed to the file immediately, so that the journal can be read back after the program is aborted at any point; an
+ *  incomplete last line (which is not terminated by the end-of-entry marker) is ignored.
+ *
+ *  A case must only be marked as completed after all its output has been written (e.g. added to a CampaignArchiveWriter,
+ *  which flushes each entry).
+ */
+class SweepJournal
+{
+public:
+
+    //! Constructor, reads the completed cases from an existing journal when resuming, and creates a new journal otherwise.
+    /*!
+     *  Constructor, reads the completed cases from an existing journal when resuming, and creates a new journal otherwise.
+     *  \param fileName Name of the journal file.
+     *  \param outputDirectory Directory in which the journal is stored (created if it does not exist).
+     *  \param resumeSweep Boolean denoting whether an interrupted sweep is to be resumed (see getSweepResumeSetting).
+     */
+    SweepJournal( const std::string& fileName,
+                  const std::string& outputDirectory,
+                  const bool resumeSweep = getSweepResumeSetting( ) )
+    {
+        boost::filesystem::path outputPath( outputDirectory );
+        if( !outputDirectory.empty( ) && !boost::filesystem::exists( outputPath ) )
+        {
+            boost::filesystem::create_directories( outputPath );
+        }
+        filePath_ = ( outputPath / fileName ).string( );
+
+        if( resumeSweep && boost::filesystem::exists( filePath_ ) )
+        {
+            readJournal( );
+        }
+
+        // Rewrite journal with the valid entries only, so that an incomplete last line is removed.
+        journalFile_.open( filePath_, std::ios::trunc );
+        if( !journalFile_.is_open( ) )
+        {
+            throw std::runtime_error( "Error, could not open sweep journal " + filePath_ );
+        }
+        journalFile_<<std::setprecision( std::numeric_limits< double >::max_digits10 );
+        for( auto caseIterator = completedCases_.begin( ); caseIterator != completedCases_.end( ); caseIterator++ )
+        {
+            writeEntry( caseIterator->first, caseIterator->second );
+        }
+        journalFile_.flush( );
+    }
+
+    //! Function to check whether a case has been completed.
+    bool isCompleted( const std::string& caseKey )
+    {
+        std::lock_guard< std::mutex > lock( journalMutex_ );
+        return completedCases_.count( caseKey ) > 0;
+    }
+
+    //! Function to retrieve the values that were stored with a completed case.
+    std::vector< double > getCompletedCaseValues( const std::string& caseKey )
+    {
+        std::lock_guard< std::mutex > lock( journalMutex_ );
+        if( completedCases_.count( caseKey ) == 0 )
+        {
+            throw std::runtime_error( "Error, case " + caseKey + " not found in sweep journal " + filePath_ );
+        }
+        return completedCases_.at( caseKey );
+    }
+
+    //! Function to retrieve the number of completed cases.
+    unsigned int getNumberOfCompletedCases( )
+    {
+        std::lock_guard< std::mutex > lock( journalMutex_ );
+        return completedCases_.size( );
+    }
+
+    //! Function to mark a case as completed, writing it to the journal. This function may be called from any thread.
+    /*!
+     *  Function to mark a case as completed, writing it to the journal. This function may be called from any thread.
+     *  \param caseKey Unique key of the case (may not contain whitespace).
+     *  \param caseValues Values that are to be stored with the case (e.g. summary results).
+     */
+    void markCompleted( const std::string& caseKey, const std::vector< double >& caseValues = std::vector< double >( ) )
+    {
+        if( caseKey.empty( ) || caseKey.find_first_of( " \t\n" ) != std::string::npos )
+        {
+            throw std::runtime_error( "Error, sweep journal case key " + caseKey + " is empty or contains whitespace." );
+        }
+
+        std::lock_guard< std::mutex > lock( journalMutex_ );
+        completedCases_[ caseKey ] = caseValues;
+        writeEntry( caseKey, caseValues );
+        journalFile_.flush( );
+        if( !journalFile_ )
+        {
+            throw std::runtime_error( "Error when writing case " + caseKey + " to sweep journal " + filePath_ );
+        }
+    }
+
+private:
+
+    //! Function to read the completed cases from the journal file.
+    void readJournal( )
+    {
+        std::ifstream inputFile( filePath_ );
+        std::string journalLine;
+        while( std::getline( inputFile, journalLine ) )
+        {
+            std::istringstream lineStream( journalLine );
+            std::string caseKey, token;
+            std::vector< double > caseValues;
+            bool isEntryComplete = false;
+
+            lineStream >> caseKey;
+            while( lineStream >> token )
+            {
+                if( token == endOfEntryMarker( ) )
+                {
+                    isEntryComplete = true;
+                    break;
+                }
+                caseValues.push_back( std::strtod( token.c_str( ), NULL ) );
+            }
+
+            if( isEntryComplete && !caseKey.empty( ) )
+            {
+                completedCases_[ caseKey ] = caseValues;
+            }
+        }
+    }
+
+    //! Function to write a single entry to the journal file (without flushing).
+    void writeEntry( const std::string& caseKey, const std::vector< double >& caseValues )
+    {
+        journalFile_<<caseKey;
+        for( unsigned int i = 0; i < caseValues.size( ); i++ )
+        {
+            journalFile_<<" "<<caseValues.at( i );
+        }
+        journalFile_<<" "<<endOfEntryMarker( )<<"\n";
+    }
+
+    //! Marker denoting the end of a complete entry.
+    static std::string endOfEntryMarker( )
+    {
+        return "#";
+    }
+
+    //! Path of the journal file.
+    std::string filePath_;
+
+    //! Stream to which the journal is written.
+    std::ofstream journalFile_;
+
+    //! Values stored with each completed case, per case key.
+    std::map< std::string, std::vector< double > > completedCases_;
+
+    //! Mutex protecting the journal file and list of completed cases.
+    std::mutex journalMutex_;
+};
+
+}
+
+#endif // TUDAT_SWEEPJOURNAL_H
@@ -0,0 +1,362 @@
+/*    Copyright (c) 2010-2018, Delft University of Technology
+ *    All rigths reserved
+ *
+ *    This file is part of the Tudat. Redistribution and use in source and
+ *    binary forms, with or without modification, are permitted exclusively
+ *    under the terms of the Modified BSD license. You should have received
+ *    a copy of the license with this file. If not, please or visit:
+ *    http://tudat.tudelft.nl/LICENSE.
+ */
+
+#ifndef TUDAT_UNCERTAINTYSAMPLING_H
+#define TUDAT_UNCERTAINTYSAMPLING_H
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include <Tudat/Mathematics/Statistics/boostProbabilityDistributions.h>
+
+namespace tudat_applications
+{
+
+//! Methods by which samples of an uncertain vector can be drawn.
+enum SamplingMethod
+{
+    //! Independent pseudo-random samples.
+    pseudo_random_sampling,
+
+    //! Latin hypercube design: each marginal is sampled exactly once in each of N equiprobable strata.
+    latin_hypercube_sampling,
+
+    //! Halton low-discrepancy sequence (radical inverse in the first prime bases).
+    halton_sampling,
+
+    //! Sobol low-discrepancy sequence (Joe-Kuo direction numbers).
+    sobol_sampling
+};
+
+//! Generator of the Sobol low-discrepancy sequence in the unit hypercube.
+/*!
+ *  Generator of the Sobol low-discrepancy sequence in the unit hypercube, using the direction numbers of Joe and Kuo
+ *  (2008), and Gray-code ordering (so that each point is obtained from the previous one with a single XOR per dimension).
+ *  The first point of the sequence (the origin) is skipped, so that all points are strictly inside the unit hypercube
+ *  and can be mapped by an inverse cumulative distribution function.
+ */
+class SobolSequence
+{
+public:
+
+    //! Constructor.
+    /*!
+     *  Constructor.
+     *  \param dimension Dimension of the sequence (at most getMaximumDimension( )).
+     */
+    SobolSequence( const unsigned int dimension ):
+        dimension_( dimension ), index_( 0 ), currentPoint_( dimension, 0 )
+    {
+        // Degree, interior coefficients and initial direction numbers of primitive polynomials for dimensions 2 and up.
+        static const unsigned int polynomialDegrees[ ] = { 1, 2, 3, 3, 4, 4, 5, 5, 5, 5, 5, 5, 6, 6, 6 };
+        static const unsigned int polynomialCoefficients[ ] = { 0, 1, 1, 2, 1, 4, 2, 4, 7, 11, 13, 14, 1, 13, 16 };
+        static const unsigned int initialDirectionNumbers[ ][ 6 ] =
+        {
+            { 1 }, { 1, 3 }, { 1, 3, 1 }, { 1, 1, 1 }, { 1, 1, 3, 3 }, { 1, 3, 5, 13 }, { 1, 1, 5, 5, 17 },
+            { 1, 1, 5, 5, 5 }, { 1, 1, 7, 11, 19 }, { 1, 1, 5, 1, 1 }, { 1, 1, 1, 3, 11 }, { 1, 3, 5, 5, 31 },
+            { 1, 3, 3, 9, 7, 49 }, { 1, 1, 1, 15, 21, 21 }, { 1, 3, 1, 13, 27, 49 }
+        };
+
+        if( dimension_ > getMaximumDimension( ) )
+        {
+            throw std::runtime_error( "Error, Sobol sequence supports at most " +
+                                      std::to_string( getMaximumDimension( ) ) + " dimensions." );
+        }
+
+        directionNumbers_.resize( dimension_ );
+        for( unsigned int j = 0; j < dimension_; j++ )
+        {
+            std::vector< std::uint32_t >& currentDirectionNumbers = directionNumbers_[ j ];
+            currentDirectionNumbers.resize( numberOfBits_ + 1 );
+            if( j == 0 )
+            {
+                for( unsigned int i = 1; i <= numberOfBits_; i++ )
+                {
+                    currentDirectionNumbers[ i ] = std::uint32_t( 1 ) << ( numberOfBits_ - i );
+                }
+            }
+            else
+            {
+                const unsigned int degree = polynomialDegrees[ j - 1 ];
+                const unsigned int coefficients = polynomialCoefficients[ j - 1 ];
+                for( unsigned int i = 1; i <= degree; i++ )
+                {
+                    currentDirectionNumbers[ i ] = initialDirectionNumbers[ j - 1 ][ i - 1 ] << ( numberOfBits_ - i );
+                }
+                for( unsigned int i = degree + 1; i <= numberOfBits_; i++ )
+                {
+                    currentDirectionNumbers[ i ] =
+                            currentDirectionNumbers[ i - degree ] ^ ( currentDirectionNumbers[ i - degree ] >> degree );
+                    for( unsigned int k = 1; k < degree; k++ )
+                    {
+                        if( ( coefficients >> ( degree - 1 - k ) ) & 1 )
+                        {
+                            currentDirectionNumbers[ i ] ^= currentDirectionNumbers[ i - k ];
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    //! Function to retrieve the maximum dimension for which direction numbers are available.
+    static unsigned int getMaximumDimension( )
+    {
+        return 16;
+    }
+
+    //! Function to retrieve the next point of the sequence.
+    Eigen::VectorXd getNextPoint( )
+    {
+        // Find index of rightmost zero bit of the current index (Gray-code update).
+        unsigned int bitIndex = 1;
+        std::uint64_t shiftedIndex = index_;
+        while( shiftedIndex & 1 )
+        {
+            shiftedIndex >>= 1;
+            bitIndex++;
+        }
+        if( bitIndex > numberOfBits_ )
+        {
+            throw std::runtime_error( "Error, Sobol sequence exhausted." );
+        }
+        index_++;
+
+        Eigen::VectorXd point = Eigen::VectorXd( dimension_ );
+        for( unsigned int j = 0; j < dimension_; j++ )
+        {
+            currentPoint_[ j ] ^= directionNumbers_[ j ][ bitIndex ];
+            point( j ) = static_cast< double >( currentPoint_[ j ] ) / 4294967296.0;
+        }
+        return point;
+    }
+
+private:
+
+    //! Number of bits of the integer representation of the points.
+    static const unsigned int numberOfBits_ = 32;
+
+    //! Dimension of the sequence.
+    unsigned int dimension_;
+
+    //! Index of the last point that was generated.
+    std::uint64_t index_;
+
+    //! Integer representation of the last point that was generated.
+    std::vector< std::uint32_t > currentPoint_;
+
+    //! Direction numbers per dimension (entry i of each list is direction number i, with entry 0 unused).
+    std::vector< std::vector< std::uint32_t > > directionNumbers_;
+};
+
+//! Generator of the Halton low-discrepancy sequence in the unit hypercube.
+/*!
+ *  Generator of the Halton low-discrepancy sequence in the unit hypercube, in which dimension j is the radical inverse of
+ *  the point index in the j-th prime base. The first point of the sequence (the origin) is skipped. Note that the
+ *  projections onto pairs of high dimensions (large bases) are strongly correlated for small numbers of points, so that
+ *  the Sobol sequence is preferred for more than a few dimensions.
+ */
+class HaltonSequence
+{
+public:
+
+    //! Constructor.
+    /*!
+     *  Constructor.
+     *  \param dimension Dimension of the sequence.
+     */
+    HaltonSequence( const unsigned int dimension ): index_( 0 )
+    {
+        unsigned int candidate = 2;
+        while( bases_.size( ) < dimension )
+        {
+            bool isPrime = true;
+            for( unsigned int i = 0; i < bases_.size( ) && bases_[ i ] * bases_[ i ] <= candidate; i++ )
+            {
+                if( candidate % bases_[ i ] == 0 )
+                {
+                    isPrime = false;
+                    break;
+                }
+            }
+            if( isPrime )
+            {
+                bases_.push_back( candidate );
+            }
+            candidate++;
+        }
+    }
+
+    //! Function to retrieve the next point of the sequence.
+    Eigen::VectorXd getNextPoint( )
+    {
+        index_++;
+
+        Eigen::VectorXd point = Eigen::VectorXd( bases_.size( ) );
+        for( unsigned int j = 0; j < bases_.size( ); j++ )
+        {
+            double inverseBase = 1.0 / static_cast< double >( bases_[ j ] );
+            double digitWeight = inverseBase;
+            double radicalInverse = 0.0;
+            for( std::uint64_t remainingIndex = index_; remainingIndex > 0; remainingIndex /= bases_[ j ] )
+            {
+                radicalInverse += static_cast< double >( remainingIndex % bases_[ j ] ) * digitWeight;
+                digitWeight *= inverseBase;
+            }
+            point( j ) = radicalInverse;
+        }
+        return point;
+    }
+
+private:
+
+    //! Prime bases of each dimension.
+    std::vector< unsigned int > bases_;
+
+    //! Index of the last point that was generated.
+    std::uint64_t index_;
+};
+
+//! Function to create a Latin hypercube design in the unit hypercube.
+/*!
+ *  Function to create a Latin hypercube design in the unit hypercube, in which the range of each dimension is divided into
+ *  numberOfSamples equiprobable strata, each of which contains exactly one sample (at a random position in the stratum).
+ *  The strata are combined between dimensions by independent random permutations.
+ *  \param dimension Dimension of the design.
+ *  \param numberOfSamples Number of samples in the design.
+ *  \param seed Seed of the random number generator.
+ *  \return Samples, with one column per sample.
+ */
+inline Eigen::MatrixXd createLatinHypercubeDesign( const unsigned int dimension,
+                                                   const unsigned int numberOfSamples,
+                                                   const unsigned int seed )
+{
+    std::mt19937 randomNumberGenerator( seed );
+    std::uniform_real_distribution< double > uniformDistribution( 0.0, 1.0 );
+
+    Eigen::MatrixXd design = Eigen::MatrixXd( dimension, numberOfSamples );
+    std::vector< unsigned int > strata( numberOfSamples );
+    for( unsigned int j = 0; j < dimension; j++ )
+    {
+        std::iota( strata.begin( ), strata.end( ), 0 );
+        std::shuffle( strata.begin( ), strata.end( ), randomNumberGenerator );
+        for( unsigned int i = 0; i < numberOfSamples; i++ )
+        {
+            // Position in stratum is kept away from 0, so that inverse cumulative distribution is finite.
+            double positionInStratum = std::max( uniformDistribution( randomNumberGenerator ), 1.0E-12 );
+            design( j, i ) = ( static_cast< double >( strata[ i ] ) + positionInStratum ) /
+                    static_cast< double >( numberOfSamples );
+        }
+    }
+    return design;
+}
+
+//! Function to create a generator of samples of a vector with independent uncertain entries.
+/*!
+ *  Function to create a generator of samples of a vector with independent uncertain entries (e.g. the perturbations of the
+ *  initial state and model parameters of a Monte Carlo analysis). Points in the unit hypercube are generated by the
+ *  selected method, and mapped to the distribution of each entry through its inverse cumulative distribution function.
+ *  Low-discrepancy (Halton, Sobol) and Latin hypercube samples fill the space of uncertainties more evenly than
+ *  independent pseudo-random samples, so that statistics of the propagated results converge with fewer propagations.
+ *  \param marginalDistributions Distribution of each entry of the vector (e.g. created by
+ *  statistics::createBoostRandomVariable).
+ *  \param samplingMethod Method by which the samples are to be generated.
+ *  \param numberOfSamples Number of samples that is to be drawn (required for, and only used by, Latin hypercube sampling,
+ *  for which the generator throws an exception when called more often).
+ *  \param seed Seed of the random number generator (not used for Halton and Sobol sampling).
+ *  \return Function returning the next sample at each call.
+ */
+inline std::function< Eigen::VectorXd( ) > createVectorRandomVariableGeneratorFunction(
+        const std::vector< std::shared_ptr< tudat::statistics::InvertibleContinuousProbabilityDistribution< double > > >&
+        marginalDistributions,
+        const SamplingMethod samplingMethod,
+        const unsigned int numberOfSamples = 0,
+        const unsigned int seed = 0 )
+{
+    const unsigned int dimension = marginalDistributions.size( );
+
+    // Create generator of points in unit hypercube.
+    std::function< Eigen::VectorXd( ) > unitHypercubeGenerator;
+    switch( samplingMethod )
+    {
+    case pseudo_random_sampling:
+    {
+        std::shared_ptr< std::mt19937 > randomNumberGenerator = std::make_shared< std::mt19937 >( seed );
+        unitHypercubeGenerator = [ = ]( )
+        {
+            std::uniform_real_distribution< double > uniformDistribution( 0.0, 1.0 );
+            Eigen::VectorXd point = Eigen::VectorXd( dimension );
+            for( unsigned int j = 0; j < dimension; j++ )
+            {
+                point( j ) = std::max( uniformDistribution( *randomNumberGenerator ), 1.0E-12 );
+            }
+            return point;
+        };
+        break;
+    }
+    case latin_hypercube_sampling:
+    {
+        if( numberOfSamples == 0 )
+        {
+            throw std::runtime_error( "Error, number of samples must be provided for Latin hypercube sampling." );
+        }
+        std::shared_ptr< Eigen::MatrixXd > design = std::make_shared< Eigen::MatrixXd >(
+                    createLatinHypercubeDesign( dimension, numberOfSamples, seed ) );
+        std::shared_ptr< unsigned int > sampleIndex = std::make_shared< unsigned int >( 0 );
+        unitHypercubeGenerator = [ = ]( )
+        {
+            if( *sampleIndex >= static_cast< unsigned int >( design->cols( ) ) )
+            {
+                throw std::runtime_error( "Error, Latin hypercube design exhausted." );
+            }
+            return Eigen::VectorXd( design->col( ( *sampleIndex )++ ) );
+        };
+        break;
+    }
+    case halton_sampling:
+    {
+        std::shared_ptr< HaltonSequence > haltonSequence = std::make_shared< HaltonSequence >( dimension );
+        unitHypercubeGenerator = [ = ]( ){ return haltonSequence->getNextPoint( ); };
+        break;
+    }
+    case sobol_sampling:
+    {
+        std::shared_ptr< SobolSequence > sobolSequence = std::make_shared< SobolSequence >( dimension );
+        unitHypercubeGenerator = [ = ]( ){ return sobolSequence->getNextPoint( ); };
+        break;
+    }
+    default:
+        throw std::runtime_error( "Error, sampling method not recognized." );
+    }
+
+    // Map points to distributions of entries.
+    return [ = ]( )
+    {
+        Eigen::VectorXd sample = unitHypercubeGenerator( );
+        for( unsigned int j = 0; j < dimension; j++ )
+        {
+            sample( j ) = marginalDistributions.at( j )->evaluateInverseCdf( sample( j ) );
+        }
+        return sample;
+    };
+}
+
+}
+
+#endif // TUDAT_UNCERTAINTYSAMPLING_H